@@ -0,0 +1,135 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Headless replay of recorded caption user data through the shared caption engine.
+//
+// The input is a text file with one SEI payload per line: the presentation time in 100ns ticks, followed by the
+// payload bytes in hex (the user_data_registered_itu_t_t35 body, i.e. everything from the country code on - the
+// decoder looks for the "GA94" identifier itself). Blank lines and lines starting with # are skipped.
+//
+// usage: CC608Replay <file> [track (1-10, default 1)] [iterations (default 100)]
+//
+// Prints every caption screen (as WebVTT cues) followed by the decode throughput over the requested number of passes.
+
+#include "ByteDecoder.h"
+#include "CaptionExporter.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Microsoft::CC608;
+using namespace std;
+
+static bool ReadPayloads(const char* path, CaptionExporter::segmentdata_t& payloads)
+{
+  ifstream in(path);
+  if (!in)
+  {
+    return false;
+  }
+
+  string line;
+  while (getline(in, line))
+  {
+    if (line.empty() || line[0] == '#' || line[0] == '\r')
+    {
+      continue;
+    }
+
+    istringstream ss(line);
+    unsigned long long ticks = 0;
+    string hex;
+    if (!(ss >> ticks >> hex) || hex.size() % 2 != 0)
+    {
+      cerr << "malformed line: " << line << endl;
+      return false;
+    }
+
+    vector<byte_t> data;
+    data.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2)
+    {
+      data.push_back(static_cast<byte_t>(strtoul(hex.substr(i, 2).c_str(), nullptr, 16)));
+    }
+
+    payloads.emplace_back(Timestamp(ticks), data);
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    cerr << "usage: CC608Replay <file> [track] [iterations]" << endl;
+    return 2;
+  }
+
+  auto track = argc > 2 ? atoi(argv[2]) : 1;
+  auto iterations = argc > 3 ? atoi(argv[3]) : 100;
+  if (track < 1 || track > ByteDecoder::LastCaptionTrack || iterations < 1)
+  {
+    cerr << "track must be 1-" << ByteDecoder::LastCaptionTrack << " and iterations at least 1" << endl;
+    return 2;
+  }
+
+  CaptionExporter::segmentdata_t payloads;
+  if (!ReadPayloads(argv[1], payloads))
+  {
+    cerr << "could not read " << argv[1] << endl;
+    return 1;
+  }
+
+  // caption screen snapshots
+  CaptionExporter exporter(track);
+  auto cues = exporter.Decode(vector<CaptionExporter::segmentdata_t>(1, payloads));
+  wcout << CaptionExporter::ToWebVtt(cues);
+
+  // throughput of the real time path (extraction and decoding frame by frame, the way Core drives it)
+  auto start = chrono::steady_clock::now();
+  for (auto i = 0; i < iterations; ++i)
+  {
+    auto spModel = make_shared<Model>();
+    auto spModel708 = make_shared<Model708>();
+    ByteDecoder decoder(spModel, spModel708);
+    decoder.SetCaptionTrack(track);
+
+    for (const auto& payload : payloads)
+    {
+      decoder.ParseBytes(decoder.ExtractByteCodes(payload.second));
+    }
+  }
+  auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+  auto decoded = static_cast<double>(payloads.size()) * iterations;
+  wcout << L"NOTE " << cues.size() << L" caption screens, " << payloads.size() << L" payloads x " << iterations << L" passes: "
+    << (decoded > 0 ? elapsed / decoded : 0.0) << L" ns/payload, "
+    << (elapsed > 0 ? decoded * 1e9 / elapsed : 0.0) << L" payloads/s" << endl;
+
+  return 0;
+}
@@ -20,7 +20,7 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
+#include "CC608Types.h"
 #include <algorithm>
 #include <iostream>
 #include "ByteDecoder.h"
@@ -46,7 +46,13 @@ std::vector<byte_t> ByteDecoder::PopulateHeader()
   return v;
 }
 
-ByteDecoder::ByteDecoder(shared_ptr<Model> model) : _spModel(model), _decodeLogic(), _desiredField(1), _desiredChannel(1), _currentChannel(1), _captionsActive(false)
+ByteDecoder::ByteDecoder(shared_ptr<Model> model) : ByteDecoder(model, make_shared<Model708>())
+{
+}
+
+ByteDecoder::ByteDecoder(shared_ptr<Model> model, shared_ptr<Model708> model708) : _spModel(model), _decodeLogic(), 
+  _spModel708(model708), _packetAssembler(), _serviceDecoder(model708), _desiredService(0),
+  _desiredField(1), _desiredChannel(1), _currentChannel(1), _captionsActive(false)
 {
   Initialize();
 }
@@ -60,7 +66,7 @@ void ByteDecoder::Initialize()
   SetCaptionTrack(0);
 }
 
-std::vector<byte_t> ByteDecoder::Extract608ByteCodes(const std::vector<byte_t>& data)
+std::vector<byte_t> ByteDecoder::ExtractByteCodes(const std::vector<byte_t>& data)
 {
   // user data envelope format:
   // 
@@ -154,12 +160,12 @@ std::vector<byte_t> ByteDecoder::Extract608ByteCodes(const std::vector<byte_t>&
       continue;
     }
 
-    // cc_type is two bits: 00 = field 1 608, 01 = field 2 608, anything else is non-608
+    // cc_type is two bits: 00 = field 1 608, 01 = field 2 608, 10 / 11 = DTVCC (708) packet data / packet start
     byte_t ccType = ccFlag & 0x03;
     switch(ccType)
     {
     case 0x00:
-      if (_desiredField != 1)
+      if (_desiredService != 0 || _desiredField != 1)
       {
         // this is field 1 data, but we aren't processing field 1
         continue;
@@ -167,7 +173,7 @@ std::vector<byte_t> ByteDecoder::Extract608ByteCodes(const std::vector<byte_t>&
       break;
 
     case 0x01:
-      if (_desiredField != 2)
+      if (_desiredService != 0 || _desiredField != 2)
       {
         // this is field 2 data, but we aren't processing field 2
         continue;
@@ -175,8 +181,15 @@ std::vector<byte_t> ByteDecoder::Extract608ByteCodes(const std::vector<byte_t>&
       break;
 
     default:
-      // this is not 608 data
-      continue;
+      if (_desiredService == 0)
+      {
+        // this is 708 data, but we are processing 608
+        continue;
+      }
+
+      // keep the cc_type with the pair, the packet starts need to be found again after the data has been queued
+      result.push_back(ccType);
+      break;
     }
 
     // if we got here, add the data to the result--these are valid byte codes (but not yet checked for parity)
@@ -226,9 +239,20 @@ void ByteDecoder::SetCaptionTrack(const int captionTrack)
     break;
 
   default:
-    assert(false);
+    assert(captionTrack >= FirstServiceTrack && captionTrack <= LastCaptionTrack);
+    _captionsActive = true;
+    _desiredService = static_cast<short>(captionTrack - FirstServiceTrack + 1);
+    break;
   }
 
+  if (!IsServiceTrack(captionTrack))
+  {
+    _desiredService = 0;
+  }
+
+  _serviceDecoder.SetService(_desiredService);
+  _packetAssembler.Reset();
+
   if (oldField != _desiredField)
   {
     // if we switched fields, then the current channel info is out of date--reset it to one (not necessarily correct but we don't have any better data)
@@ -244,12 +268,38 @@ void ByteDecoder::ParseBytes(const std::vector<byte_t>& data)
     return;
   }
 
+  if (_desiredService != 0)
+  {
+    ParseDtvccBytes(data);
+    return;
+  }
+
   for (size_t i = 0; i < data.size(); i += 2)
   {
     DecodeBytePair(data[i], data[i + 1]);
   }
 }
 
+void ByteDecoder::ParseDtvccBytes(const std::vector<byte_t>& data)
+{
+  // data is in cc_type / byte pair triplets (see ExtractByteCodes)
+  for (size_t i = 0; i + 2 < data.size(); i += 3)
+  {
+    if (_packetAssembler.AddPair(data[i] == 0x03, data[i + 1], data[i + 2]))
+    {
+      _serviceDecoder.DecodePacket(_packetAssembler.GetPacketData(), _packetAssembler.GetPacketDataSize());
+    }
+  }
+
+  // lay out the windows once for the whole batch rather than for every packet
+  _spModel708->Refresh();
+}
+
+void ByteDecoder::Flush()
+{
+  _packetAssembler.Reset();
+}
+
 void ByteDecoder::DecodeBytePair(byte_t first, byte_t second)
 {
   if ((first == 0x80) && (second == 0x80))
@@ -25,10 +25,13 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <vector>
 
-#include "pch.h"
+#include "CC608Types.h"
 #include "Model.h"
 #include "DecodeLogic.h"
 #include "DecodedPac.h"
+#include "Model708.h"
+#include "DtvccPacketAssembler.h"
+#include "ServiceBlockDecoder.h"
 
 namespace Microsoft { namespace CC608 {
 
@@ -40,20 +43,33 @@ namespace Microsoft { namespace CC608 {
     MiscControl
   };
 
-  // Decodes CC 608 bytes
+  // Decodes CC 608 bytes, and the 708 caption services carried next to them
   class ByteDecoder
   {
   public:
+    // tracks 1-4 are CC1-CC4 (608), tracks 5-10 are the 708 caption services 1-6
+    static const int FirstServiceTrack = 5;
+    static const int LastCaptionTrack = 10;
+
+    static bool IsServiceTrack(const int captionTrack) { return captionTrack >= FirstServiceTrack; }
+
     ByteDecoder(std::shared_ptr<Model> model);
+    ByteDecoder(std::shared_ptr<Model> model, std::shared_ptr<Model708> model708);
     void Initialize();
     void ParseBytes(const std::vector<byte_t>& data);
     
     // processes the user data wrapper and extracts byte codes
-    std::vector<byte_t> Extract608ByteCodes(const std::vector<byte_t>& data);
+    // (608 byte pairs, or cc_type / byte pair triplets of DTVCC data when a 708 service is selected)
+    std::vector<byte_t> ExtractByteCodes(const std::vector<byte_t>& data);
 
     void SetCaptionTrack(const int captionTrack);
 
+    // drops any partially received 708 packet (used when seeking)
+    void Flush();
+
   private:
+    void ParseDtvccBytes(const std::vector<byte_t>& data);
+
     void DecodeBytePair(byte_t data1, byte_t data2);
     void ProcessFailedParity() const;
     CC608ControlCode GetControlCode(const byte_t first, const byte_t second);
@@ -88,6 +104,13 @@ namespace Microsoft { namespace CC608 {
     std::shared_ptr<Model> _spModel;
     DecodeLogic _decodeLogic;
 
+    std::shared_ptr<Model708> _spModel708;
+    DtvccPacketAssembler _packetAssembler;
+    ServiceBlockDecoder _serviceDecoder;
+
+    // the 708 service we are processing, 0 when processing 608 data
+    short _desiredService;
+
     // information on which track we are processing (field 1 or 2, and channel 1 or 2)
     short _desiredField;
     short _desiredChannel;
@@ -22,24 +22,13 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include "pch.h"
-#include <vector>
-#include "DecodedPac.h"
+// Common definitions for the platform-free caption engine (decoder, model and caption data queue).
+// Nothing in here (or in the engine) may depend on C++/CX or the Windows Runtime, so that the engine
+// can be compiled into the Windows caption plugins as well as into headless tools.
 
-namespace Microsoft { namespace CC608 {
+#include <cstdint>
+#include <cassert>
+#include "StandardsExtensions.h"
+#include "Logger.h"
 
-// unit-testable decoding logic
-class DecodeLogic
-{
-public:
-  DecodeLogic(void);
-  ~DecodeLogic(void);
-
-  DecodedPac DecodePac(const byte_t first, const byte_t second) const;
-  bool ParityValid(byte_t b) const;
-
-private:
-  std::vector<short> _pacToRow;
-};
-
-}}
\ No newline at end of file
+typedef uint8_t byte_t;
@@ -0,0 +1,191 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "CC608Types.h"
+#include <algorithm>
+#include "CaptionDataQueue.h"
+
+using namespace Microsoft::CC608;
+using namespace std;
+
+const size_t CaptionDataQueue::Capacity;
+const size_t CaptionDataQueue::EntryBytes;
+
+CaptionDataQueue::CaptionDataQueue(void) : _entries(Capacity), _write(0), _read(0), _clearedUpTo(0), _newestTicks(0), _droppedDuplicate(0), _droppedOverflow(0), _producerMtx()
+{
+}
+
+CaptionDataQueue::~CaptionDataQueue(void)
+{
+}
+
+// add a single timestamp of caption data
+void CaptionDataQueue::AddCaptionData(const Timestamp ts, const std::vector<byte_t>& captionByteData)
+{
+  lock_guard<mutex> lock(_producerMtx);
+
+  auto write = _write.load(memory_order_relaxed);
+  auto read = _read.load(memory_order_acquire);
+  auto newest = _newestTicks.load(memory_order_relaxed);
+
+  if (ts.GetTicks() <= newest && newest != 0)
+  {
+    // already have this frame
+    _droppedDuplicate.fetch_add(1, memory_order_relaxed);
+    return;
+  }
+
+  Publish(write, Stage(write, read, ts, captionByteData));
+}
+
+// adds a range of caption data, skipping the frames that are already in the queue
+void CaptionDataQueue::AddCaptionData(const vector<pair<Timestamp, vector<byte_t>>>& data)
+{
+  if (data.size() == 0)
+  {
+    // no data to process
+    return;
+  }
+
+  lock_guard<mutex> lock(_producerMtx);
+
+  auto write = _write.load(memory_order_relaxed);
+  auto read = _read.load(memory_order_acquire);
+  auto newest = _newestTicks.load(memory_order_relaxed);
+
+  auto staged = write;
+  unsigned long long duplicates = 0;
+  for (auto& e : data)
+  {
+    if (e.first.GetTicks() <= newest && newest != 0)
+    {
+      ++duplicates;
+      continue;
+    }
+
+    staged = Stage(staged, read, e.first, e.second);
+  }
+
+  if (duplicates != 0)
+  {
+    _droppedDuplicate.fetch_add(duplicates, memory_order_relaxed);
+    DebugWrite(L"caption data queue already has data up to " << newest << ", dropped " << duplicates << " frames");
+  }
+
+  // the data comes in decode order, so sort the staged entries by timestamp (insertion sort: the frames are only
+  // locally out of order and it keeps the pieces of a split payload in order)
+  for (auto i = write + 1; i < staged; ++i)
+  {
+    for (auto j = i; j > write && _entries[j % Capacity].Ts < _entries[(j - 1) % Capacity].Ts; --j)
+    {
+      swap(_entries[j % Capacity], _entries[(j - 1) % Capacity]);
+    }
+  }
+
+  Publish(write, staged);
+}
+
+unsigned long long CaptionDataQueue::Stage(unsigned long long write, const unsigned long long read, const Timestamp ts, const std::vector<byte_t>& captionByteData)
+{
+  size_t offset = 0;
+
+  do
+  {
+    if (write - read >= Capacity)
+    {
+      // the consumer is not keeping up (or not running)--drop the data rather than wait for it
+      DebugWrite(L"caption data queue full, dropping caption data at " << ts.GetTicks());
+      _droppedOverflow.fetch_add(1, memory_order_relaxed);
+      break;
+    }
+
+    auto& entry = _entries[write % Capacity];
+    entry.Ts = ts;
+    entry.Size = min(EntryBytes, captionByteData.size() - offset);
+    copy(captionByteData.begin() + offset, captionByteData.begin() + offset + entry.Size, entry.Bytes.begin());
+
+    offset += entry.Size;
+    ++write;
+  } while (offset < captionByteData.size());
+
+  return write;
+}
+
+void CaptionDataQueue::Publish(const unsigned long long write, const unsigned long long staged)
+{
+  for (auto i = write; i < staged; ++i)
+  {
+    const auto& entry = _entries[i % Capacity];
+    if (entry.Ts.GetTicks() > _newestTicks.load(memory_order_relaxed))
+    {
+      _newestTicks.store(entry.Ts.GetTicks(), memory_order_relaxed);
+    }
+  }
+
+  _write.store(staged, memory_order_release);
+}
+
+// clear all caption data
+void CaptionDataQueue::Clear()
+{
+  // waits for a batch being staged to be published, so it cannot show up (or move the newest timestamp) after the clear
+  lock_guard<mutex> lock(_producerMtx);
+
+  _clearedUpTo.store(_write.load(memory_order_relaxed), memory_order_release);
+  _newestTicks.store(0, memory_order_relaxed);
+}
+
+unsigned long long CaptionDataQueue::GetDroppedDuplicateCount() const
+{
+  return _droppedDuplicate.load(memory_order_relaxed);
+}
+
+unsigned long long CaptionDataQueue::GetDroppedOverflowCount() const
+{
+  return _droppedOverflow.load(memory_order_relaxed);
+}
+
+// return caption data for the specified timestamp range
+void CaptionDataQueue::GetSortedCaptionData(const Timestamp startTs, const Timestamp endTs, std::vector<byte_t>& result)
+{
+  result.clear();
+
+  auto read = max(_read.load(memory_order_relaxed), _clearedUpTo.load(memory_order_acquire));
+  auto write = _write.load(memory_order_acquire);
+
+  if (endTs >= startTs)
+  {
+    // the entries are in timestamp order, so stop at the first one past the range
+    for (; read < write && _entries[read % Capacity].Ts <= endTs; ++read)
+    {
+      const auto& entry = _entries[read % Capacity];
+
+      // entries before the range are stale (they were never played), drop them
+      if (entry.Ts >= startTs)
+      {
+        result.insert(result.end(), entry.Bytes.begin(), entry.Bytes.begin() + entry.Size);
+      }
+    }
+  }
+
+  _read.store(read, memory_order_release);
+}
@@ -0,0 +1,107 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <array>
+#include <vector>
+
+#include "CC608Types.h"
+#include "Timestamp.h"
+
+namespace Microsoft { namespace CC608 {
+
+  // stores incoming raw caption data--external components add data to the queue, and the 
+  // processing thread gets the data as needed
+  //
+  // the data lives in a pre-allocated ring of timestamped entries with one producer (the thread adding data) and one
+  // consumer (the render tick calling GetSortedCaptionData), so neither side allocates and the consumer never waits
+  class CaptionDataQueue
+  {
+  public:
+    // number of entries in the ring (a bit over two minutes of 60 fps video)
+    static const size_t Capacity = 8192;
+
+    // caption bytes per entry--enough for the 31 triplets a frame can carry, larger payloads use several entries
+    static const size_t EntryBytes = 96;
+
+    CaptionDataQueue(void);
+    ~CaptionDataQueue(void);
+
+    // data at or before the newest timestamp already queued is dropped (the same frames coming in again, e.g. from
+    // a segment that was downloaded twice) rather than replaced--published entries may be in the middle of being read
+    // by the consumer. Each call is sorted by timestamp before the consumer can see it
+    void AddCaptionData(const Timestamp ts, const std::vector<byte_t>& captionByteData);
+    void AddCaptionData(const std::vector<std::pair<Timestamp, std::vector<byte_t>>>& data);
+
+    // fills result with the caption data for the specified timestamp range, and removes it from the queue along with
+    // any older data (result is reused so the caller can keep its capacity across calls)
+    void GetSortedCaptionData(const Timestamp startTs, const Timestamp endTs, std::vector<byte_t>& result);
+
+    // clears the data in the queue (used when seeking in a stream or when switching media sources)
+    // may be called from any thread--it runs on the producer side, after any data being added has been published, and
+    // the consumer drops the cleared entries the next time it reads
+    void Clear();
+
+    // number of frames dropped because they were at or before the newest timestamp already queued
+    unsigned long long GetDroppedDuplicateCount() const;
+
+    // number of frames (or the rest of a frame) dropped because the ring was full
+    unsigned long long GetDroppedOverflowCount() const;
+
+  private:
+    struct Entry
+    {
+      Timestamp Ts;
+      size_t Size;
+      std::array<byte_t, EntryBytes> Bytes;
+    };
+
+    // writes the data to the slots after the published ones, returns the new (unpublished) write index
+    unsigned long long Stage(unsigned long long write, const unsigned long long read, const Timestamp ts, const std::vector<byte_t>& captionByteData);
+
+    // makes the staged entries visible to the consumer
+    void Publish(const unsigned long long write, const unsigned long long staged);
+
+    std::vector<Entry> _entries;
+
+    // indexes only ever increase, the slot is the index modulo Capacity
+    std::atomic<unsigned long long> _write;
+    std::atomic<unsigned long long> _read;
+
+    // entries before this index were cleared
+    std::atomic<unsigned long long> _clearedUpTo;
+
+    // ticks of the newest timestamp added since the last clear
+    std::atomic<unsigned long long> _newestTicks;
+
+    std::atomic<unsigned long long> _droppedDuplicate;
+    std::atomic<unsigned long long> _droppedOverflow;
+
+    // taken by producers (in case data for the same queue arrives on more than one thread) and by Clear, never by the
+    // consumer
+    std::mutex _producerMtx;
+  };
+
+}}
\ No newline at end of file
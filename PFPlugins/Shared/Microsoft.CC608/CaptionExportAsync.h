@@ -0,0 +1,82 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <ppltasks.h>
+
+#include "CaptionExporter.h"
+#include "ByteDecoder.h"
+#include "RawCaptionDataInternal.h"
+
+namespace Microsoft { namespace CC608 {
+
+  // The caption export calls the XAML and HTML controllers of every platform hand out (only built with the WinRT
+  // plugins--RawCaptionData and RawCaptionDataInternal come from the platform project that includes this)
+  class CaptionExportAsync
+  {
+  public:
+    static Windows::Foundation::IAsyncOperation<Platform::String^>^ ExportWebVttAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+    {
+      auto data = ReadSegments(segments, captionTrack);
+
+      return concurrency::create_async([data, captionTrack]()
+      {
+        auto cues = CaptionExporter(captionTrack).Decode(data);
+        return ref new Platform::String(CaptionExporter::ToWebVtt(cues).c_str());
+      });
+    }
+
+    static Windows::Foundation::IAsyncOperation<Platform::String^>^ ExportTtmlAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+    {
+      auto data = ReadSegments(segments, captionTrack);
+
+      return concurrency::create_async([data, captionTrack]()
+      {
+        auto cues = CaptionExporter(captionTrack).Decode(data);
+        return ref new Platform::String(CaptionExporter::ToTtml(cues).c_str());
+      });
+    }
+
+  private:
+    // validates the track and copies the segments to the internal representation (on the calling thread)
+    static std::vector<CaptionExporter::segmentdata_t> ReadSegments(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+    {
+      if ((captionTrack < 1) || (captionTrack > ByteDecoder::LastCaptionTrack))
+      {
+        throw ref new Platform::InvalidArgumentException("captionTrack must be between 1 and 4 (for CC1 through CC4) or between 5 and 10 (for 708 services 1 through 6) when exporting captions.\nValue encountered: [" + captionTrack + "].");
+      }
+
+      std::vector<CaptionExporter::segmentdata_t> result;
+
+      for (auto segment : segments)
+      {
+        RawCaptionDataInternal d(segment);
+        result.push_back(d.Data);
+      }
+
+      return result;
+    }
+  };
+
+}}
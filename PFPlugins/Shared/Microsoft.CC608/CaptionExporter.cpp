@@ -0,0 +1,320 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "CC608Types.h"
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <thread>
+#include "CaptionExporter.h"
+#include "ByteDecoder.h"
+#include "Model.h"
+#include "Model708.h"
+#include "MemorySize.h"
+
+using namespace Microsoft::CC608;
+using namespace std;
+
+// formats ticks as hh:mm:ss.mmm (the clock time format both WebVTT and TTML accept)
+static wstring FormatTime(const Timestamp ts)
+{
+  auto ms = ts.GetTicks() / Timestamp::TicksPerMillisecond;
+
+  wostringstream ss;
+  ss << setfill(L'0') << setw(2) << (ms / 3600000) << L":" << setw(2) << (ms / 60000 % 60) << L":" << setw(2) << (ms / 1000 % 60) << L"." << setw(3) << (ms % 1000);
+  return ss.str();
+}
+
+// escapes the characters that are markup in both WebVTT and TTML
+static wstring Escape(const wstring& text)
+{
+  wstring result;
+  result.reserve(text.size());
+
+  for (auto c : text)
+  {
+    switch (c)
+    {
+    case L'&': result += L"&amp;"; break;
+    case L'<': result += L"&lt;"; break;
+    case L'>': result += L"&gt;"; break;
+    default: result += c; break;
+    }
+  }
+
+  return result;
+}
+
+CaptionExporter::CaptionExporter(const int captionTrack) : _captionTrack(captionTrack)
+{
+  assert(captionTrack > 0 && captionTrack <= ByteDecoder::LastCaptionTrack);
+}
+
+CaptionExporter::~CaptionExporter(void)
+{
+}
+
+std::vector<CaptionCue> CaptionExporter::Decode(const std::vector<segmentdata_t>& segments) const
+{
+  // extracting the byte codes is independent per segment, so spread it over the cores
+  vector<segmentdata_t> extracted(segments.size());
+  atomic<size_t> next(0);
+
+  auto worker = [&]()
+  {
+    for (auto i = next++; i < segments.size(); i = next++)
+    {
+      extracted[i] = ExtractSegment(segments[i]);
+    }
+  };
+
+  auto threadCount = min<size_t>(max(thread::hardware_concurrency(), 1u), segments.size());
+  vector<thread> threads;
+  for (size_t i = 1; i < threadCount; ++i)
+  {
+    threads.emplace_back(worker);
+  }
+
+  worker();
+
+  for (auto& t : threads)
+  {
+    t.join();
+  }
+
+  // decoding is stateful, so it runs through the segments in order with a single decoder
+  auto spModel = make_shared<Model>();
+  auto spModel708 = make_shared<Model708>();
+  ByteDecoder decoder(spModel, spModel708);
+  decoder.SetCaptionTrack(_captionTrack);
+
+  auto serviceTrack = ByteDecoder::IsServiceTrack(_captionTrack);
+  unsigned int displayVersion = 0;
+
+  vector<CaptionCue> cues;
+  bool cueOpen = false;
+  Timestamp last;
+
+  for (const auto& segment : extracted)
+  {
+    for (const auto& frame : segment)
+    {
+      decoder.ParseBytes(frame.second);
+      last = frame.first;
+
+      auto version = serviceTrack ? spModel708->GetDisplayVersionNumber() : spModel->GetDisplayVersionNumber();
+      if (version == displayVersion)
+      {
+        continue;
+      }
+
+      displayVersion = version;
+
+      // whatever was on screen ends at this frame
+      if (cueOpen)
+      {
+        cues.back().End = frame.first;
+        cueOpen = false;
+      }
+
+      auto cue = ReadCue(serviceTrack ? spModel708->displayedMemory : spModel->displayedMemory);
+      if (!cue.Lines.empty())
+      {
+        cue.Start = frame.first;
+        cues.push_back(cue);
+        cueOpen = true;
+      }
+    }
+  }
+
+  // the last caption stays up until the end of the data
+  if (cueOpen)
+  {
+    cues.back().End = last;
+  }
+
+  return cues;
+}
+
+CaptionExporter::segmentdata_t CaptionExporter::ExtractSegment(const segmentdata_t& segment) const
+{
+  // each worker needs its own decoder, it only holds the track settings used for extraction
+  ByteDecoder decoder(make_shared<Model>(), make_shared<Model708>());
+  decoder.SetCaptionTrack(_captionTrack);
+
+  segmentdata_t result;
+  result.reserve(segment.size());
+
+  for (const auto& frame : segment)
+  {
+    result.emplace_back(frame.first, decoder.ExtractByteCodes(frame.second));
+  }
+
+  // the frames come in decode order
+  stable_sort(result.begin(), result.end(), [](const segmentdata_t::value_type& a, const segmentdata_t::value_type& b)
+  {
+    return a.first < b.first;
+  });
+
+  return result;
+}
+
+CaptionCue CaptionExporter::ReadCue(const Memory& displayedMemory)
+{
+  CaptionCue cue;
+  cue.Row = 0;
+
+  for (short r = 0; r < MemorySize::Rows; ++r)
+  {
+    const auto& row = displayedMemory.Rows[r];
+    if (!row.ContainsText())
+    {
+      continue;
+    }
+
+    if (cue.Lines.empty())
+    {
+      cue.Row = r;
+    }
+
+    vector<CaptionSpan> line;
+    bool italics = false;
+    bool underline = false;
+
+    for (const auto& cell : row.Cells)
+    {
+      // a cell with attributes starts a new style that lasts until the next one
+      if (cell.Attributes.ContainsAttributes())
+      {
+        italics = cell.Attributes.IsItalics();
+        underline = cell.Attributes.IsUnderline();
+      }
+
+      auto c = cell.IsTransparentSpaceOrNullChar() ? L' ' : cell.Character;
+
+      if (line.empty() || line.back().Italics != italics || line.back().Underline != underline)
+      {
+        CaptionSpan span = { wstring(), italics, underline };
+        line.push_back(span);
+      }
+
+      line.back().Text += c;
+    }
+
+    // the leading and trailing spaces only position the text in the 608 grid
+    while (!line.empty() && line.front().Text.find_first_not_of(L' ') == wstring::npos)
+    {
+      line.erase(line.begin());
+    }
+
+    while (!line.empty() && line.back().Text.find_first_not_of(L' ') == wstring::npos)
+    {
+      line.pop_back();
+    }
+
+    if (!line.empty())
+    {
+      line.front().Text.erase(0, line.front().Text.find_first_not_of(L' '));
+      line.back().Text.erase(line.back().Text.find_last_not_of(L' ') + 1);
+      cue.Lines.push_back(line);
+    }
+  }
+
+  return cue;
+}
+
+std::wstring CaptionExporter::ToWebVtt(const std::vector<CaptionCue>& cues)
+{
+  wostringstream ss;
+  ss << L"WEBVTT\n\n";
+
+  for (size_t i = 0; i < cues.size(); ++i)
+  {
+    const auto& cue = cues[i];
+
+    // the 608 rows cover the middle 80% of the picture
+    auto line = 10 + (cue.Row * 80) / MemorySize::Rows;
+
+    ss << (i + 1) << L"\n";
+    ss << FormatTime(cue.Start) << L" --> " << FormatTime(cue.End) << L" line:" << line << L"%\n";
+
+    for (const auto& spans : cue.Lines)
+    {
+      for (const auto& span : spans)
+      {
+        if (span.Italics) ss << L"<i>";
+        if (span.Underline) ss << L"<u>";
+        ss << Escape(span.Text);
+        if (span.Underline) ss << L"</u>";
+        if (span.Italics) ss << L"</i>";
+      }
+
+      ss << L"\n";
+    }
+
+    ss << L"\n";
+  }
+
+  return ss.str();
+}
+
+std::wstring CaptionExporter::ToTtml(const std::vector<CaptionCue>& cues)
+{
+  wostringstream ss;
+  ss << L"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+  ss << L"<tt xmlns=\"http://www.w3.org/ns/ttml\" xmlns:tts=\"http://www.w3.org/ns/ttml#styling\">\n";
+  ss << L"<body>\n<div>\n";
+
+  for (const auto& cue : cues)
+  {
+    ss << L"<p begin=\"" << FormatTime(cue.Start) << L"\" end=\"" << FormatTime(cue.End) << L"\">";
+
+    for (size_t i = 0; i < cue.Lines.size(); ++i)
+    {
+      if (i > 0)
+      {
+        ss << L"<br/>";
+      }
+
+      for (const auto& span : cue.Lines[i])
+      {
+        if (span.Italics || span.Underline)
+        {
+          ss << L"<span";
+          if (span.Italics) ss << L" tts:fontStyle=\"italic\"";
+          if (span.Underline) ss << L" tts:textDecoration=\"underline\"";
+          ss << L">" << Escape(span.Text) << L"</span>";
+        }
+        else
+        {
+          ss << Escape(span.Text);
+        }
+      }
+    }
+
+    ss << L"</p>\n";
+  }
+
+  ss << L"</div>\n</body>\n</tt>\n";
+
+  return ss.str();
+}
@@ -0,0 +1,85 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CC608Types.h"
+#include "Timestamp.h"
+#include "Memory.h"
+
+namespace Microsoft { namespace CC608 {
+
+  // a run of caption text with the same style
+  struct CaptionSpan
+  {
+    std::wstring Text;
+    bool Italics;
+    bool Underline;
+  };
+
+  // one caption as it was on screen: from the frame that displayed it to the frame that changed or erased it
+  struct CaptionCue
+  {
+    Timestamp Start;
+    Timestamp End;
+
+    // the screen row of the first line (0-14), used to position the cue
+    short Row;
+
+    // one entry per row that contains text
+    std::vector<std::vector<CaptionSpan>> Lines;
+  };
+
+  // Decodes the in-band caption data of whole segments into timed cues without playing them, and writes the cues
+  // out as WebVTT or TTML sidecar captions
+  class CaptionExporter
+  {
+  public:
+    typedef std::vector<std::pair<Timestamp, std::vector<byte_t>>> segmentdata_t;
+
+    // captionTrack takes the same values as Core (1-4 for CC1-CC4, 5-10 for the 708 services 1-6)
+    explicit CaptionExporter(const int captionTrack);
+    ~CaptionExporter(void);
+
+    // decodes the user data envelopes of the segments, which must be passed in playback order
+    // (the byte codes of all segments are extracted in parallel, the decoding then runs through the segments in order
+    // so the caption state at the end of one segment carries over into the next)
+    std::vector<CaptionCue> Decode(const std::vector<segmentdata_t>& segments) const;
+
+    static std::wstring ToWebVtt(const std::vector<CaptionCue>& cues);
+    static std::wstring ToTtml(const std::vector<CaptionCue>& cues);
+
+  private:
+    // extracts the byte codes of one segment and sorts its frames into presentation order
+    segmentdata_t ExtractSegment(const segmentdata_t& segment) const;
+
+    // returns the text of the displayed memory (no lines if nothing is displayed)
+    static CaptionCue ReadCue(const Memory& displayedMemory);
+
+    int _captionTrack;
+  };
+
+}}
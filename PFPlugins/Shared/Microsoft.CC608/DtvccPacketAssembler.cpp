@@ -20,38 +20,69 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
-#include <algorithm>
-#include "MemorySize.h"
-#include "MemoryRow.h"
+#include "CC608Types.h"
+#include "DtvccPacketAssembler.h"
 
 using namespace Microsoft::CC608;
 
-MemoryRow::MemoryRow(void)
+DtvccPacketAssembler::DtvccPacketAssembler(void) : _packet()
 {
-  Cells.resize(MemorySize::Cells);
+  Reset();
 }
 
-MemoryRow::~MemoryRow(void)
+DtvccPacketAssembler::~DtvccPacketAssembler(void)
 {
 }
 
-void MemoryRow::Clear()
+void DtvccPacketAssembler::Reset()
 {
-  for (MemoryCell& cell : Cells)
-  {
-    cell.Clear();
-  }
+  _size = 0;
+  _expectedSize = 0;
+  _completedSize = 0;
 }
 
-bool MemoryRow::ContainsText() const
+bool DtvccPacketAssembler::AddPair(const bool packetStart, const byte_t data1, const byte_t data2)
 {
-  for (const MemoryCell& cell : Cells)
+  if (packetStart)
+  {
+    if (_size != 0)
+    {
+      DebugWrite("WARNING: DTVCC packet start encountered before the previous packet was complete (Dropping partial packet)");
+    }
+
+    // packet header: sequence_number (2 bits), packet_size_code (6 bits), the size is in pairs of bytes and includes the header
+    auto sizeCode = data1 & 0x3F;
+    _expectedSize = (sizeCode == 0) ? MaxPacketSize : sizeCode * 2;
+    _size = 0;
+  }
+  else if (_expectedSize == 0)
   {
-    if (cell.Character != L'')
-      return true;
+    // packet data without a packet start--wait until we see the start of the next packet
+    return false;
   }
 
-  return false;
+  _packet[_size++] = data1;
+  _packet[_size++] = data2;
+
+  if (_size < _expectedSize)
+  {
+    return false;
+  }
+
+  _completedSize = _expectedSize;
+  _expectedSize = 0;
+  _size = 0;
+
+  return true;
 }
 
+const byte_t* DtvccPacketAssembler::GetPacketData() const
+{
+  // skip the packet header
+  return _packet.data() + 1;
+}
+
+size_t DtvccPacketAssembler::GetPacketDataSize() const
+{
+  return (_completedSize == 0) ? 0 : _completedSize - 1;
+}
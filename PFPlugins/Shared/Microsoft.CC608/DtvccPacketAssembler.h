@@ -22,42 +22,38 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include "pch.h"
-#include "CC608CharColor.h"
+#include <array>
+
+#include "CC608Types.h"
 
 namespace Microsoft { namespace CC608 {
 
-  // attributes for a cell, this is very memory efficient, using one byte to 
-  // store all of the attributes for a cell, might not be necessary but wanted
-  // to use the least amount of memory possible for each cell
-  class MemoryAttributes
+  // Reassembles CEA-708 DTVCC packets from the cc_data pairs (cc_type 2 and 3) of the caption user data.
+  // The packet is kept in a fixed buffer so that no allocation happens while caption data is streaming in.
+  class DtvccPacketAssembler
   {
   public:
-    MemoryAttributes(void);
-    ~MemoryAttributes(void);
-
-    void Clear();
-    bool ContainsAttributes() const;
+    // largest DTVCC packet (packet_size_code of zero)
+    static const size_t MaxPacketSize = 128;
 
-    void SetUnderline(bool value);
-    bool IsUnderline() const;
+    DtvccPacketAssembler(void);
+    ~DtvccPacketAssembler(void);
 
-    void SetItalics(bool value);
-    bool IsItalics() const;
+    // adds one cc_data pair, returns true if the pair completed a packet
+    bool AddPair(const bool packetStart, const byte_t data1, const byte_t data2);
 
-    void SetFlash(bool value);
-    bool IsFlash() const;
+    // service block data of the last completed packet (the packet header byte is not included)
+    const byte_t* GetPacketData() const;
+    size_t GetPacketDataSize() const;
 
-    void SetColor(CC608CharColor value);
-    CC608CharColor GetColor() const;
+    // drops any partially assembled packet (used when seeking or switching tracks)
+    void Reset();
 
   private:
-    void SetBit(unsigned char mask, bool value);
-    bool GetBit(unsigned char mask) const;
-
-  private: 
-    unsigned char _attributes;
+    std::array<byte_t, MaxPacketSize> _packet;
+    size_t _size;
+    size_t _expectedSize;
+    size_t _completedSize;
   };
 
 }}
-
@@ -22,16 +22,22 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#define NOMINMAX
-#include <Windows.h>
 #include <sstream>
 
-#include "pch.h"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <iostream>
+#endif
 
 namespace Microsoft { namespace CC608 {
 
 #ifdef _DEBUG
 
+#ifdef _WIN32
   #define DebugWrite(s) \
   {\
     SYSTEMTIME systime;\
@@ -40,6 +46,15 @@ namespace Microsoft { namespace CC608 {
     _log <<"["<<systime.wHour<<":"<<systime.wMinute<<":"<<systime.wSecond<<":"<<systime.wMilliseconds<<"]608 Captions>"<<s <<"\r\n"; \
     OutputDebugString(_log.str().data());\
   }
+#else
+  // headless builds (no debugger output window) log to stderr
+  #define DebugWrite(s) \
+  {\
+    std::wostringstream _log;\
+    _log <<"608 Captions>"<<s <<"\n"; \
+    std::wcerr << _log.str();\
+  }
+#endif
 
 #else
 
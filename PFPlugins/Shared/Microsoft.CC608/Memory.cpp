@@ -20,7 +20,7 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
+#include "CC608Types.h"
 #include <algorithm>
 #include "Memory.h"
 #include "MemorySize.h"
@@ -65,6 +65,7 @@ void Memory::Character(const wchar_t character)
 {
   // set character for current position
   Rows[_currentRow].Cells[_currentCell].Character = character;
+  Rows[_currentRow].Touch();
 
   // move to next position, stay on last cell if at end of row
   _currentCell = GetValidCellPosition(_currentCell + 1);
@@ -74,6 +75,7 @@ void Memory::TransparentSpace()
 {
    // set transparanent space for current position
   Rows[_currentRow].Cells[_currentCell].IsTransparentSpace = true;
+  Rows[_currentRow].Touch();
 
   // move to next position, stay on last cell if at end of row
   _currentCell = GetValidCellPosition(_currentCell + 1);
@@ -91,6 +93,7 @@ void Memory::Pac(const short row, const short indent, const CC608CharColor color
   Rows[_currentRow].Cells[_currentCell].Attributes.SetColor(color);
   Rows[_currentRow].Cells[_currentCell].Attributes.SetUnderline(underline);
   Rows[_currentRow].Cells[_currentCell].Attributes.SetItalics(italics);
+  Rows[_currentRow].Touch();
 }
 
 void Memory::MidRowCode(const CC608CharColor color, const bool underline)
@@ -101,6 +104,7 @@ void Memory::MidRowCode(const CC608CharColor color, const bool underline)
 
   // miderow code always turns flash off
   Rows[_currentRow].Cells[_currentCell].Attributes.SetFlash(false);
+  Rows[_currentRow].Touch();
 
   // midrow code adds a space char
   Character(L' ');
@@ -114,6 +118,7 @@ void Memory::MidRowCode(const bool underline, const bool italics)
 
   // miderow code always turns flash off
   Rows[_currentRow].Cells[_currentCell].Attributes.SetFlash(false);
+  Rows[_currentRow].Touch();
 
   // midrow code adds a space char
   Character(L' ');
@@ -124,6 +129,7 @@ void Memory::FlashOn()
   // first set the flash attribute for the current position,
   // does not change any other attributes
   Rows[_currentRow].Cells[_currentCell].Attributes.SetFlash(true);
+  Rows[_currentRow].Touch();
 
   // flash code adds a space char
   Character(L' ');
@@ -134,6 +140,7 @@ void Memory::Backspace()
   // move back one position, clear cell (character and any attributes)
   _currentCell = GetValidCellPosition(_currentCell - 1);
   Rows[_currentRow].Cells[_currentCell].Clear();
+  Rows[_currentRow].Touch();
 
   // if this is the first cell in the row, reset the default attribute
   if (_currentCell == 0)
@@ -150,6 +157,8 @@ void Memory::DeleteToEndOfRow()
   {
     Rows[_currentRow].Cells[i].Clear();
   }
+
+  Rows[_currentRow].Touch();
 }
 
 void Memory::SetRollUpBaseRow(short baseRow)
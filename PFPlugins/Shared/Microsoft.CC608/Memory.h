@@ -24,7 +24,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <vector>
 
-#include "pch.h"
+#include "CC608Types.h"
 #include "MemoryRow.h"
 
 namespace Microsoft { namespace CC608 {
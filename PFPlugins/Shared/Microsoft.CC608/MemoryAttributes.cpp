@@ -20,7 +20,7 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
+#include "CC608Types.h"
 #include "MemoryAttributes.h"
 
 using namespace Microsoft::CC608;
@@ -20,16 +20,19 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
+#include "CC608Types.h"
 #include <algorithm>
 #include "MemorySize.h"
 #include "MemoryRow.h"
 
 using namespace Microsoft::CC608;
 
-MemoryRow::MemoryRow(void)
+std::atomic<unsigned int> MemoryRow::_nextVersion(0);
+
+MemoryRow::MemoryRow(void) : _version(0)
 {
   Cells.resize(MemorySize::Cells);
+  Touch();
 }
 
 MemoryRow::~MemoryRow(void)
@@ -42,6 +45,8 @@ void MemoryRow::Clear()
   {
     cell.Clear();
   }
+
+  Touch();
 }
 
 bool MemoryRow::ContainsText() const
@@ -56,3 +61,12 @@ bool MemoryRow::ContainsText() const
   return false;
 }
 
+unsigned int MemoryRow::GetVersion() const
+{
+  return _version;
+}
+
+void MemoryRow::Touch()
+{
+  _version = ++_nextVersion;
+}
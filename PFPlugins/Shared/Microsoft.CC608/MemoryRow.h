@@ -23,8 +23,9 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <vector>
+#include <atomic>
 
-#include "pch.h"
+#include "CC608Types.h"
 #include "MemoryCell.h"
 
 namespace Microsoft { namespace CC608 {
@@ -38,7 +39,19 @@ namespace Microsoft { namespace CC608 {
     void Clear();
     bool ContainsText() const;
 
+    // the version changes whenever the content of the row changes--versions are unique across all rows, so renderers
+    // can tell a row changed even after rows were copied around or displayed and non-displayed memory were swapped
+    unsigned int GetVersion() const;
+
+    // marks the row as changed (call after changing Cells directly)
+    void Touch();
+
     std::vector<MemoryCell> Cells;
+
+  private:
+    unsigned int _version;
+
+    static std::atomic<unsigned int> _nextVersion;
   };
 
 }}
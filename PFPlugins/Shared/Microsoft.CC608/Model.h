@@ -22,7 +22,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include "pch.h"
+#include "CC608Types.h"
 #include "CC608CharColor.h"
 #include "Memory.h"
 #include "ModelMode.h"
@@ -0,0 +1,379 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "CC608Types.h"
+#include "Model708.h"
+#include "MemorySize.h"
+
+using namespace Microsoft::CC608;
+
+// 708 grid used for absolute anchor positions (the 16:9 grid, 4:3 content only uses the left part of it)
+const short AbsoluteGridRows = 75;
+const short AbsoluteGridColumns = 210;
+
+// returns true if the two attributes render the same way
+static bool SameAttributes(const MemoryAttributes& a, const MemoryAttributes& b)
+{
+  return a.GetColor() == b.GetColor() && a.IsItalics() == b.IsItalics() && a.IsUnderline() == b.IsUnderline() && a.IsFlash() == b.IsFlash();
+}
+
+// returns true if the two rows render the same way
+static bool SameRow(const MemoryRow& a, const MemoryRow& b)
+{
+  for (short i = 0; i < MemorySize::Cells; ++i)
+  {
+    const auto& cellA = a.Cells[i];
+    const auto& cellB = b.Cells[i];
+
+    if (cellA.Character != cellB.Character || cellA.IsTransparentSpace != cellB.IsTransparentSpace ||
+      cellA.Attributes.ContainsAttributes() != cellB.Attributes.ContainsAttributes() ||
+      (cellA.Attributes.ContainsAttributes() && !SameAttributes(cellA.Attributes, cellB.Attributes)))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+Model708::Model708(void) : displayedMemory(), _windows(), _currentWindow(-1), _layout(), _pendingRefresh(false), _displayVersion(0)
+{
+}
+
+Model708::~Model708(void)
+{
+}
+
+void Model708::SetCurrentWindow(const short id)
+{
+  _currentWindow = id;
+}
+
+void Model708::DefineWindow(const short id, const bool visible, const bool rowLock, const bool columnLock, const short priority, const bool relativePositioning,
+  const short anchorVertical, const short anchorHorizontal, const short anchorPoint, const short rowCount, const short columnCount)
+{
+  auto& window = _windows[id];
+  auto wasVisible = window.Defined && window.Visible;
+
+  window.Define(visible, rowLock, columnLock, priority, relativePositioning, anchorVertical, anchorHorizontal, anchorPoint, rowCount, columnCount);
+
+  // defining a window also makes it the current window
+  _currentWindow = id;
+
+  if (wasVisible || window.Visible)
+  {
+    _pendingRefresh = true;
+  }
+}
+
+void Model708::ClearWindows(const byte_t windowBitmap)
+{
+  for (short i = 0; i < MaxWindows; ++i)
+  {
+    if ((windowBitmap & (1 << i)) != 0 && _windows[i].Defined)
+    {
+      _windows[i].ClearText();
+      WindowChanged(_windows[i]);
+    }
+  }
+}
+
+void Model708::DisplayWindows(const byte_t windowBitmap)
+{
+  for (short i = 0; i < MaxWindows; ++i)
+  {
+    if ((windowBitmap & (1 << i)) != 0 && _windows[i].Defined && !_windows[i].Visible)
+    {
+      _windows[i].Visible = true;
+      _pendingRefresh = true;
+    }
+  }
+}
+
+void Model708::HideWindows(const byte_t windowBitmap)
+{
+  for (short i = 0; i < MaxWindows; ++i)
+  {
+    if ((windowBitmap & (1 << i)) != 0 && _windows[i].Defined && _windows[i].Visible)
+    {
+      _windows[i].Visible = false;
+      _pendingRefresh = true;
+    }
+  }
+}
+
+void Model708::ToggleWindows(const byte_t windowBitmap)
+{
+  for (short i = 0; i < MaxWindows; ++i)
+  {
+    if ((windowBitmap & (1 << i)) != 0 && _windows[i].Defined)
+    {
+      _windows[i].Visible = !_windows[i].Visible;
+      _pendingRefresh = true;
+    }
+  }
+}
+
+void Model708::DeleteWindows(const byte_t windowBitmap)
+{
+  for (short i = 0; i < MaxWindows; ++i)
+  {
+    if ((windowBitmap & (1 << i)) != 0 && _windows[i].Defined)
+    {
+      WindowChanged(_windows[i]);
+      _windows[i].Delete();
+
+      if (_currentWindow == i)
+      {
+        _currentWindow = -1;
+      }
+    }
+  }
+}
+
+void Model708::Reset()
+{
+  DeleteWindows(0xFF);
+  _currentWindow = -1;
+}
+
+void Model708::Character(const wchar_t c)
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->Character(c);
+    WindowChanged(*window);
+  }
+}
+
+void Model708::TransparentSpace()
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->TransparentSpace();
+    WindowChanged(*window);
+  }
+}
+
+void Model708::Backspace()
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->Backspace();
+    WindowChanged(*window);
+  }
+}
+
+void Model708::CarriageReturn()
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->CarriageReturn();
+    WindowChanged(*window);
+  }
+}
+
+void Model708::HorizontalCarriageReturn()
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->HorizontalCarriageReturn();
+    WindowChanged(*window);
+  }
+}
+
+void Model708::FormFeed()
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->FormFeed();
+    WindowChanged(*window);
+  }
+}
+
+void Model708::SetPenLocation(const short row, const short column)
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->SetPenLocation(row, column);
+  }
+}
+
+void Model708::SetPenAttributes(const bool underline, const bool italics)
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->SetPenAttributes(underline, italics);
+  }
+}
+
+void Model708::SetPenColor(const CC608CharColor color)
+{
+  auto window = GetCurrentWindow();
+  if (window != nullptr)
+  {
+    window->SetPenColor(color);
+  }
+}
+
+void Model708::Refresh()
+{
+  if (!_pendingRefresh)
+  {
+    return;
+  }
+
+  _pendingRefresh = false;
+  _layout.Clear();
+
+  // lay out the lowest priority windows (highest number) first, so higher priority windows end up on top
+  for (short priority = 7; priority >= 0; --priority)
+  {
+    for (const auto& window : _windows)
+    {
+      if (window.Defined && window.Visible && window.Priority == priority)
+      {
+        LayoutWindow(window);
+      }
+    }
+  }
+
+  // typically only the row the pen is on changed, so keep the others (and their versions) as they are
+  bool changed = false;
+  for (short i = 0; i < MemorySize::Rows; ++i)
+  {
+    if (!SameRow(_layout.Rows[i], displayedMemory.Rows[i]))
+    {
+      displayedMemory.Rows[i] = _layout.Rows[i];
+      displayedMemory.Rows[i].Touch();
+      changed = true;
+    }
+  }
+
+  if (changed)
+  {
+    ++_displayVersion;
+  }
+}
+
+// returns a version number to be used to determine if anything visual has changed
+unsigned int Model708::GetDisplayVersionNumber() const
+{
+  return _displayVersion;
+}
+
+// clear all windows and reset to initial state
+void Model708::Clear()
+{
+  for (auto& window : _windows)
+  {
+    window.Delete();
+  }
+
+  _currentWindow = -1;
+  displayedMemory.Clear();
+
+  _pendingRefresh = false;
+
+  // the cleared screen still needs to be rendered once
+  _displayVersion = 1;
+}
+
+Window708* Model708::GetCurrentWindow()
+{
+  if (_currentWindow < 0 || !_windows[_currentWindow].Defined)
+  {
+    // commands for a window that was never defined are ignored
+    return nullptr;
+  }
+
+  return &_windows[_currentWindow];
+}
+
+// text changes only need a new layout when they can be seen
+void Model708::WindowChanged(const Window708& window)
+{
+  if (window.Visible)
+  {
+    _pendingRefresh = true;
+  }
+}
+
+// copies the text of a window onto the layout memory, clipping it to the 608-sized grid
+void Model708::LayoutWindow(const Window708& window)
+{
+  short rows = (window.RowCount > MemorySize::Rows) ? MemorySize::Rows : window.RowCount;
+  short cells = (window.ColumnCount > MemorySize::Cells) ? MemorySize::Cells : window.ColumnCount;
+
+  short anchorRow = window.RelativePositioning ? (window.AnchorVertical * MemorySize::Rows / 100) : (window.AnchorVertical * MemorySize::Rows / AbsoluteGridRows);
+  short anchorCell = window.RelativePositioning ? (window.AnchorHorizontal * MemorySize::Cells / 100) : (window.AnchorHorizontal * MemorySize::Cells / AbsoluteGridColumns);
+
+  // anchor points 0-2 are on the top edge, 3-5 in the middle and 6-8 on the bottom edge (left, center and right respectively)
+  short top = anchorRow - ((window.AnchorPoint / 3) * (rows - 1)) / 2;
+  short left = anchorCell - ((window.AnchorPoint % 3) * (cells - 1)) / 2;
+
+  // keep the whole window on the screen
+  if (top > MemorySize::Rows - rows) top = MemorySize::Rows - rows;
+  if (top < 0) top = 0;
+  if (left > MemorySize::Cells - cells) left = MemorySize::Cells - cells;
+  if (left < 0) left = 0;
+
+  for (short r = 0; r < rows; ++r)
+  {
+    const MemoryCell* previous = nullptr;
+
+    for (short c = 0; c < cells; ++c)
+    {
+      const auto& source = window.Rows[r][c];
+      auto& target = _layout.Rows[top + r].Cells[left + c];
+
+      if (source.Character == L'\0' && !source.IsTransparentSpace)
+      {
+        previous = nullptr;
+        continue;
+      }
+
+      target.Character = source.Character;
+      target.IsTransparentSpace = source.IsTransparentSpace;
+
+      // only mark where the style changes, the renderers start a new run for every cell that carries attributes
+      if (previous == nullptr || !SameAttributes(previous->Attributes, source.Attributes))
+      {
+        target.Attributes = source.Attributes;
+      }
+      else
+      {
+        target.Attributes.Clear();
+      }
+
+      previous = &source;
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <array>
+
+#include "CC608Types.h"
+#include "CC608CharColor.h"
+#include "Memory.h"
+#include "Window708.h"
+
+namespace Microsoft { namespace CC608 {
+
+  // Represents the current state of one CEA-708 caption service: its eight windows, and the screen they compose into.
+  // The visible windows are laid out onto a displayed memory grid so they can be rendered the same way as 608 captions.
+  class Model708
+  {
+  public:
+    static const short MaxWindows = 8;
+
+    Model708(void);
+    ~Model708(void);
+
+    // window commands (the bitmap variants take one bit per window id)
+    void SetCurrentWindow(const short id);
+    void DefineWindow(const short id, const bool visible, const bool rowLock, const bool columnLock, const short priority, const bool relativePositioning,
+      const short anchorVertical, const short anchorHorizontal, const short anchorPoint, const short rowCount, const short columnCount);
+    void ClearWindows(const byte_t windowBitmap);
+    void DisplayWindows(const byte_t windowBitmap);
+    void HideWindows(const byte_t windowBitmap);
+    void ToggleWindows(const byte_t windowBitmap);
+    void DeleteWindows(const byte_t windowBitmap);
+    void Reset();
+
+    // text and pen commands, applied to the current window
+    void Character(const wchar_t c);
+    void TransparentSpace();
+    void Backspace();
+    void CarriageReturn();
+    void HorizontalCarriageReturn();
+    void FormFeed();
+    void SetPenLocation(const short row, const short column);
+    void SetPenAttributes(const bool underline, const bool italics);
+    void SetPenColor(const CC608CharColor color);
+
+    // lays the visible windows out onto the displayed memory if anything visible changed since the last call
+    void Refresh();
+
+    Memory displayedMemory;
+
+    // returns a version number indicating if the display memory has changed
+    unsigned int GetDisplayVersionNumber() const;
+
+    void Clear();
+
+  private:
+    Window708* GetCurrentWindow();
+    void WindowChanged(const Window708& window);
+    void LayoutWindow(const Window708& window);
+
+    std::array<Window708, MaxWindows> _windows;
+    short _currentWindow;
+
+    // the windows are laid out here first, only the rows that come out different are copied to the displayed memory
+    Memory _layout;
+
+    bool _pendingRefresh;
+    unsigned int _displayVersion;
+  };
+
+}}
@@ -0,0 +1,415 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "CC608Types.h"
+#include "ServiceBlockDecoder.h"
+
+using namespace Microsoft::CC608;
+using namespace std;
+
+// C0 codes
+const byte_t ETX = 0x03;
+const byte_t BS = 0x08;
+const byte_t FF = 0x0C;
+const byte_t CR = 0x0D;
+const byte_t HCR = 0x0E;
+const byte_t EXT1 = 0x10;
+const byte_t P16 = 0x18;
+
+// C1 codes
+const byte_t CW7 = 0x87;
+const byte_t CLW = 0x88;
+const byte_t DSW = 0x89;
+const byte_t HDW = 0x8A;
+const byte_t TGW = 0x8B;
+const byte_t DLW = 0x8C;
+const byte_t DLY = 0x8D;
+const byte_t DLC = 0x8E;
+const byte_t RST = 0x8F;
+const byte_t SPA = 0x90;
+const byte_t SPC = 0x91;
+const byte_t SPL = 0x92;
+const byte_t SWA = 0x97;
+const byte_t DF0 = 0x98;
+
+ServiceBlockDecoder::ServiceBlockDecoder(shared_ptr<Model708> model) : _spModel(model), _service(0)
+{
+}
+
+ServiceBlockDecoder::~ServiceBlockDecoder(void)
+{
+}
+
+void ServiceBlockDecoder::SetService(const short service)
+{
+  assert(service >= 0 && service <= 63);
+  _service = service;
+}
+
+short ServiceBlockDecoder::GetService() const
+{
+  return _service;
+}
+
+void ServiceBlockDecoder::DecodePacket(const byte_t* data, const size_t size)
+{
+  size_t i = 0;
+
+  while (i < size)
+  {
+    // service block header: service_number (3 bits), block_size (5 bits)
+    short serviceNumber = data[i] >> 5;
+    size_t blockSize = data[i] & 0x1F;
+    ++i;
+
+    if (serviceNumber == 0)
+    {
+      // null block header--the rest of the packet is padding
+      break;
+    }
+
+    if (serviceNumber == 7)
+    {
+      // extended service number in the next byte
+      if (i == size)
+      {
+        break;
+      }
+
+      serviceNumber = data[i++] & 0x3F;
+    }
+
+    if (blockSize > size - i)
+    {
+      DebugWrite("WARNING: DTVCC service block runs past the end of the packet (Skipping rest of packet)");
+      break;
+    }
+
+    if (serviceNumber == _service)
+    {
+      DecodeServiceBlock(data + i, blockSize);
+    }
+
+    i += blockSize;
+  }
+}
+
+void ServiceBlockDecoder::DecodeServiceBlock(const byte_t* data, const size_t size)
+{
+  size_t i = 0;
+
+  while (i < size)
+  {
+    byte_t code = data[i];
+    size_t used = 1;
+
+    if (code <= 0x1F)
+    {
+      used = DecodeC0(data + i, size - i);
+    }
+    else if (code <= 0x7F)
+    {
+      // G0 is ASCII, except for the music note
+      _spModel->Character(code == 0x7F ? L'\x266A' : static_cast<wchar_t>(code));
+    }
+    else if (code <= 0x9F)
+    {
+      used = DecodeC1(data + i, size - i);
+    }
+    else
+    {
+      // G1 is ISO 8859-1
+      _spModel->Character(static_cast<wchar_t>(code));
+    }
+
+    if (used == 0)
+    {
+      // commands never span service blocks
+      DebugWrite("WARNING: DTVCC command cut off at the end of the service block " << std::hex << code);
+      break;
+    }
+
+    i += used;
+  }
+}
+
+size_t ServiceBlockDecoder::DecodeC0(const byte_t* data, const size_t size)
+{
+  byte_t code = data[0];
+
+  if (code == EXT1)
+  {
+    return DecodeExtendedCode(data, size);
+  }
+
+  // 0x00-0x0F have no parameters, 0x10-0x17 one and 0x18-0x1F two
+  size_t length = (code <= 0x0F) ? 1 : ((code <= 0x17) ? 2 : 3);
+  if (length > size)
+  {
+    return 0;
+  }
+
+  switch (code)
+  {
+  case BS:
+    _spModel->Backspace();
+    break;
+
+  case FF:
+    _spModel->FormFeed();
+    break;
+
+  case CR:
+    _spModel->CarriageReturn();
+    break;
+
+  case HCR:
+    _spModel->HorizontalCarriageReturn();
+    break;
+
+  case P16:
+    _spModel->Character(static_cast<wchar_t>((data[1] << 8) | data[2]));
+    break;
+
+  case ETX:
+  default:
+    // NUL, ETX and the unassigned codes do nothing
+    break;
+  }
+
+  return length;
+}
+
+size_t ServiceBlockDecoder::DecodeC1(const byte_t* data, const size_t size)
+{
+  byte_t code = data[0];
+
+  size_t length = 1 + GetC1ParameterCount(code);
+  if (length > size)
+  {
+    return 0;
+  }
+
+  if (code <= CW7)
+  {
+    _spModel->SetCurrentWindow(code & 0x07);
+    return length;
+  }
+
+  if (code >= DF0)
+  {
+    // visible (1), row lock (1), column lock (1), priority (3)
+    // relative positioning (1), anchor vertical (7)
+    // anchor horizontal (8)
+    // anchor point (4), row count - 1 (4)
+    // column count - 1 (6)
+    // window style (3), pen style (3)--the predefined styles are not used, the default pen is applied instead
+    _spModel->DefineWindow(code & 0x07, (data[1] & 0x20) != 0, (data[1] & 0x10) != 0, (data[1] & 0x08) != 0, data[1] & 0x07,
+      (data[2] & 0x80) != 0, data[2] & 0x7F, data[3], data[4] >> 4, (data[4] & 0x0F) + 1, (data[5] & 0x3F) + 1);
+    return length;
+  }
+
+  switch (code)
+  {
+  case CLW:
+    _spModel->ClearWindows(data[1]);
+    break;
+
+  case DSW:
+    _spModel->DisplayWindows(data[1]);
+    break;
+
+  case HDW:
+    _spModel->HideWindows(data[1]);
+    break;
+
+  case TGW:
+    _spModel->ToggleWindows(data[1]);
+    break;
+
+  case DLW:
+    _spModel->DeleteWindows(data[1]);
+    break;
+
+  case RST:
+    _spModel->Reset();
+    break;
+
+  case SPA:
+    // italics and underline are the top two bits of the second parameter (size, offset, edge and font are not rendered)
+    _spModel->SetPenAttributes((data[2] & 0x40) != 0, (data[2] & 0x80) != 0);
+    break;
+
+  case SPC:
+    // foreground opacity (2), red (2), green (2), blue (2)--background and edge colors are not rendered
+    _spModel->SetPenColor(GetCharColor(data[1] & 0x3F));
+    break;
+
+  case SPL:
+    _spModel->SetPenLocation(data[1] & 0x0F, data[2] & 0x3F);
+    break;
+
+  case DLY:
+  case DLC:
+    // the caption data queue already releases the data at its presentation time, so service delays are not applied
+  case SWA:
+  default:
+    break;
+  }
+
+  return length;
+}
+
+size_t ServiceBlockDecoder::DecodeExtendedCode(const byte_t* data, const size_t size)
+{
+  if (size < 2)
+  {
+    return 0;
+  }
+
+  byte_t code = data[1];
+  size_t length = 2;
+
+  if (code <= 0x1F)
+  {
+    // C2: no defined commands, just skip the parameters
+    length += (code <= 0x07) ? 0 : ((code <= 0x0F) ? 1 : ((code <= 0x17) ? 2 : 3));
+  }
+  else if (code <= 0x7F)
+  {
+    // G2
+    if (code == 0x20)
+    {
+      _spModel->TransparentSpace();
+    }
+    else
+    {
+      _spModel->Character(GetG2Character(code));
+    }
+  }
+  else if (code <= 0x9F)
+  {
+    // C3: fixed length up to 0x8F, then variable length commands where the next byte holds the length
+    if (code <= 0x87)
+    {
+      length += 4;
+    }
+    else if (code <= 0x8F)
+    {
+      length += 5;
+    }
+    else
+    {
+      if (size < 3)
+      {
+        return 0;
+      }
+
+      length += 1 + (data[2] & 0x1F);
+    }
+  }
+  else
+  {
+    // G3: only the [CC] icon is defined, show an underscore like other unsupported characters
+    _spModel->Character(L'_');
+  }
+
+  return (length > size) ? 0 : length;
+}
+
+size_t ServiceBlockDecoder::GetC1ParameterCount(const byte_t code)
+{
+  if (code <= CW7) return 0;
+  if (code <= DLY) return 1;
+  if (code >= DF0) return 6;
+
+  switch (code)
+  {
+  case SPA:
+    return 2;
+
+  case SPC:
+    return 3;
+
+  case SPL:
+    return 2;
+
+  case SWA:
+    return 4;
+
+  default:
+    // DLC, RST and the reserved codes
+    return 0;
+  }
+}
+
+wchar_t ServiceBlockDecoder::GetG2Character(const byte_t code)
+{
+  switch (code)
+  {
+  case 0x21: return L'\x00A0';  // non-breaking transparent space
+  case 0x25: return L'\x2026';  // ellipsis
+  case 0x2A: return L'\x0160';  // S caron
+  case 0x2C: return L'\x0152';  // OE
+  case 0x30: return L'\x2588';  // solid block
+  case 0x31: return L'\x2018';  // open single quote
+  case 0x32: return L'\x2019';  // close single quote
+  case 0x33: return L'\x201C';  // open double quote
+  case 0x34: return L'\x201D';  // close double quote
+  case 0x35: return L'\x2022';  // bullet
+  case 0x39: return L'\x2122';  // trademark
+  case 0x3A: return L'\x0161';  // s caron
+  case 0x3C: return L'\x0153';  // oe
+  case 0x3D: return L'\x2120';  // service mark
+  case 0x3F: return L'\x0178';  // Y diaeresis
+  case 0x76: return L'\x215B';  // 1/8
+  case 0x77: return L'\x215C';  // 3/8
+  case 0x78: return L'\x215D';  // 5/8
+  case 0x79: return L'\x215E';  // 7/8
+  case 0x7A: return L'\x2502';  // box drawing
+  case 0x7B: return L'\x2510';
+  case 0x7C: return L'\x2514';
+  case 0x7D: return L'\x2500';
+  case 0x7E: return L'\x2518';
+  case 0x7F: return L'\x250C';
+  default: return L'_';
+  }
+}
+
+// maps a 708 color (2 bits each of red, green and blue) to the nearest 608 character color
+CC608CharColor ServiceBlockDecoder::GetCharColor(const byte_t rgb)
+{
+  bool red = ((rgb >> 4) & 0x03) >= 2;
+  bool green = ((rgb >> 2) & 0x03) >= 2;
+  bool blue = (rgb & 0x03) >= 2;
+
+  if (red && green && blue) return CC608CharColor::White;
+  if (red && green) return CC608CharColor::Yellow;
+  if (red && blue) return CC608CharColor::Magenta;
+  if (green && blue) return CC608CharColor::Cyan;
+  if (red) return CC608CharColor::Red;
+  if (green) return CC608CharColor::Green;
+  if (blue) return CC608CharColor::Blue;
+
+  // black and dark colors have no 608 equivalent, keep them readable
+  return CC608CharColor::White;
+}
@@ -22,49 +22,43 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include <vector>
+#include <memory>
 
-#include "pch.h"
-#include "MemoryRow.h"
+#include "CC608Types.h"
+#include "CC608CharColor.h"
+#include "Model708.h"
 
 namespace Microsoft { namespace CC608 {
 
-  // Represents a grid of CC memory (either display or non-display)
-  class Memory
+  // Decodes the service blocks of a CEA-708 DTVCC packet, and applies the commands and text of the selected
+  // caption service to the 708 model (the code sets are C0, G0, C1 and G1, plus the G2 / G3 extended characters)
+  class ServiceBlockDecoder
   {
   public:
-    Memory(void);
-    ~Memory(void);
-
-    void Character(const wchar_t character);
-    void TransparentSpace();
-    void Pac(short row, const short indent, const CC608CharColor color, const bool underline, const bool italics);
-    void MidRowCode(const CC608CharColor color, const bool underline);
-    void MidRowCode(const bool underline, const bool italics);
-    void FlashOn();
-    void CarriageReturn();
-    void TabOffset(const short columns);
-    void Backspace();
-    void DeleteToEndOfRow();
-    void EraseDisplayedMemory();
-    void EraseNonDisplayedMemory();
-    void SetRollUpBaseRow(short baseRow);
-    void SetRollUpRowNumber(short numberRows);
-    void Clear();
-
-    void Dump();
-
-    std::vector<MemoryRow> Rows;
+    ServiceBlockDecoder(std::shared_ptr<Model708> model);
+    ~ServiceBlockDecoder(void);
 
-  private:
-    short GetValidRowPosition(short position);
-    short GetValidCellPosition(short position);
+    // 1 through 63, or 0 to ignore all services
+    void SetService(const short service);
+    short GetService() const;
+
+    // decodes all service blocks in one complete packet (without the packet header byte)
+    void DecodePacket(const byte_t* data, const size_t size);
 
   private:
-    short _currentRow;
-    short _currentCell;
-    short _rollUpBaseRow;
-    short _rollUpNumberRows;
+    void DecodeServiceBlock(const byte_t* data, const size_t size);
+
+    // each of these returns the number of bytes used, or 0 if the code is cut off by the end of the block
+    size_t DecodeC0(const byte_t* data, const size_t size);
+    size_t DecodeC1(const byte_t* data, const size_t size);
+    size_t DecodeExtendedCode(const byte_t* data, const size_t size);
+
+    static size_t GetC1ParameterCount(const byte_t code);
+    static wchar_t GetG2Character(const byte_t code);
+    static CC608CharColor GetCharColor(const byte_t rgb);
+
+    std::shared_ptr<Model708> _spModel;
+    short _service;
   };
 
 }}
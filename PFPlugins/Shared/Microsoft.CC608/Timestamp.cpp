@@ -20,7 +20,7 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#include "pch.h"
+#include "CC608Types.h"
 
 #include <exception>
 #include "Timestamp.h"
@@ -55,9 +55,11 @@ Timestamp::Timestamp(void) : _ts(0)
 {
 }
 
+#ifdef __cplusplus_winrt
 Timestamp::Timestamp(const Windows::Foundation::TimeSpan timeSpan) : _ts(timeSpan.Duration)
 {
 }
+#endif
 
 Timestamp::Timestamp(const unsigned long long ticks) : _ts(ticks)
 {
@@ -22,6 +22,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
+#include "CC608Types.h"
+
 namespace Microsoft { namespace CC608 {
 
 // Simple class to represent a media timestamp--a point in the media playback
@@ -30,7 +32,9 @@ class Timestamp
 {
 public:
   Timestamp(void);
+#ifdef __cplusplus_winrt
   Timestamp(const Windows::Foundation::TimeSpan timeSpan);
+#endif
   Timestamp(const unsigned long long ticks);
 
   unsigned long long GetTicks() const;
@@ -0,0 +1,193 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "CC608Types.h"
+#include "Window708.h"
+
+using namespace Microsoft::CC608;
+
+Window708::Window708(void)
+{
+  Delete();
+}
+
+Window708::~Window708(void)
+{
+}
+
+void Window708::Define(const bool visible, const bool rowLock, const bool columnLock, const short priority, const bool relativePositioning,
+  const short anchorVertical, const short anchorHorizontal, const short anchorPoint, const short rowCount, const short columnCount)
+{
+  Visible = visible;
+  RowLock = rowLock;
+  ColumnLock = columnLock;
+  Priority = priority;
+  RelativePositioning = relativePositioning;
+  AnchorVertical = anchorVertical;
+  AnchorHorizontal = anchorHorizontal;
+  AnchorPoint = (anchorPoint > 8) ? 0 : anchorPoint;
+  RowCount = (rowCount > MaxRows) ? MaxRows : rowCount;
+  ColumnCount = (columnCount > MaxColumns) ? MaxColumns : columnCount;
+
+  if (!Defined)
+  {
+    // a new window starts out empty with the pen at the origin
+    ClearText();
+    _penRow = 0;
+    _penColumn = 0;
+    _penAttributes.Clear();
+    _penAttributes.SetColor(CC608CharColor::White);
+    Defined = true;
+  }
+  else
+  {
+    // redefining an existing window keeps its text, just make sure the pen is still inside it
+    SetPenLocation(_penRow, _penColumn);
+  }
+}
+
+void Window708::Delete()
+{
+  Defined = false;
+  Visible = false;
+  RowLock = false;
+  ColumnLock = false;
+  Priority = 0;
+  RelativePositioning = false;
+  AnchorVertical = 0;
+  AnchorHorizontal = 0;
+  AnchorPoint = 0;
+  RowCount = 1;
+  ColumnCount = 1;
+
+  _penRow = 0;
+  _penColumn = 0;
+  _penAttributes.Clear();
+
+  ClearText();
+}
+
+void Window708::ClearText()
+{
+  for (auto& row : Rows)
+  {
+    for (auto& cell : row)
+    {
+      cell.Clear();
+    }
+  }
+}
+
+void Window708::Character(const wchar_t character)
+{
+  auto& cell = Rows[_penRow][_penColumn];
+  cell.Character = character;
+  cell.IsTransparentSpace = false;
+  cell.Attributes = _penAttributes;
+
+  AdvancePen();
+}
+
+void Window708::TransparentSpace()
+{
+  auto& cell = Rows[_penRow][_penColumn];
+  cell.Clear();
+  cell.IsTransparentSpace = true;
+
+  AdvancePen();
+}
+
+void Window708::Backspace()
+{
+  if (_penColumn > 0)
+  {
+    --_penColumn;
+  }
+
+  Rows[_penRow][_penColumn].Clear();
+}
+
+void Window708::CarriageReturn()
+{
+  _penColumn = 0;
+
+  if (_penRow < RowCount - 1)
+  {
+    ++_penRow;
+    return;
+  }
+
+  // on the last row--scroll the text up by one row
+  for (short i = 0; i < RowCount - 1; ++i)
+  {
+    Rows[i] = Rows[i + 1];
+  }
+
+  for (auto& cell : Rows[RowCount - 1])
+  {
+    cell.Clear();
+  }
+}
+
+void Window708::HorizontalCarriageReturn()
+{
+  // clear the current row and move the pen to its start
+  for (auto& cell : Rows[_penRow])
+  {
+    cell.Clear();
+  }
+
+  _penColumn = 0;
+}
+
+void Window708::FormFeed()
+{
+  ClearText();
+  _penRow = 0;
+  _penColumn = 0;
+}
+
+void Window708::SetPenLocation(const short row, const short column)
+{
+  _penRow = (row < RowCount) ? row : RowCount - 1;
+  _penColumn = (column < ColumnCount) ? column : ColumnCount - 1;
+}
+
+void Window708::SetPenAttributes(const bool underline, const bool italics)
+{
+  _penAttributes.SetUnderline(underline);
+  _penAttributes.SetItalics(italics);
+}
+
+void Window708::SetPenColor(const CC608CharColor color)
+{
+  _penAttributes.SetColor(color);
+}
+
+// move to the next column, stay on the last column if at the end of the row
+void Window708::AdvancePen()
+{
+  if (_penColumn < ColumnCount - 1)
+  {
+    ++_penColumn;
+  }
+}
@@ -0,0 +1,87 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <array>
+
+#include "CC608Types.h"
+#include "MemoryCell.h"
+
+namespace Microsoft { namespace CC608 {
+
+  // A single CEA-708 caption window: where it sits on the screen, its size and priority, and the text written to it
+  class Window708
+  {
+  public:
+    static const short MaxRows = 15;
+    static const short MaxColumns = 42;
+
+    typedef std::array<MemoryCell, MaxColumns> row_t;
+
+    Window708(void);
+    ~Window708(void);
+
+    void Define(const bool visible, const bool rowLock, const bool columnLock, const short priority, const bool relativePositioning,
+      const short anchorVertical, const short anchorHorizontal, const short anchorPoint, const short rowCount, const short columnCount);
+    void Delete();
+    void ClearText();
+
+    void Character(const wchar_t character);
+    void TransparentSpace();
+    void Backspace();
+    void CarriageReturn();
+    void HorizontalCarriageReturn();
+    void FormFeed();
+
+    void SetPenLocation(const short row, const short column);
+    void SetPenAttributes(const bool underline, const bool italics);
+    void SetPenColor(const CC608CharColor color);
+
+    bool Defined;
+    bool Visible;
+    bool RowLock;
+    bool ColumnLock;
+    short Priority;
+
+    // anchor is a percentage of the screen when positioning is relative, otherwise it is in 708 grid units (75 x 210)
+    bool RelativePositioning;
+    short AnchorVertical;
+    short AnchorHorizontal;
+
+    // 0-8, the corner / edge / center of the window the anchor refers to (0 is top left, 4 is center, 8 is bottom right)
+    short AnchorPoint;
+
+    short RowCount;
+    short ColumnCount;
+
+    std::array<row_t, MaxRows> Rows;
+
+  private:
+    void AdvancePen();
+
+    short _penRow;
+    short _penColumn;
+    MemoryAttributes _penAttributes;
+  };
+
+}}
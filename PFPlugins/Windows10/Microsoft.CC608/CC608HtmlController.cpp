@@ -29,6 +29,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "CC608HtmlController.h"
 #include "MockDataSource.h"
 #include "RawCaptionDataInternal.h"
+#include "CaptionExportAsync.h"
 
 using namespace Microsoft::CC608;
 using namespace Windows::Foundation;
@@ -161,3 +162,13 @@ void CC608HtmlController::Reset()
 
   _core.Reset();
 }
+
+Windows::Foundation::IAsyncOperation<Platform::String^>^ CC608HtmlController::ExportWebVttAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+{
+  return CaptionExportAsync::ExportWebVttAsync(segments, captionTrack);
+}
+
+Windows::Foundation::IAsyncOperation<Platform::String^>^ CC608HtmlController::ExportTtmlAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+{
+  return CaptionExportAsync::ExportTtmlAsync(segments, captionTrack);
+}
@@ -26,6 +26,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "XamlCaptionsData.h"
 #include "Core.h"
 #include "RawCaptionData.h"
+#include "CaptionExporter.h"
 #include "CaptionOptions.h"
 
 namespace Microsoft { namespace CC608 {
@@ -55,6 +56,12 @@ public:
   // use when switching media sources
   void Reset();
 
+  // decodes the caption data of whole segments into WebVTT or TTML without playing them (one RawCaptionData of user
+  // data envelopes per segment, in playback order--captionTrack takes the same values as ActiveCaptionTrack except 0)
+  // (the SDK demuxes the envelopes out of segments without playback: IHLSSegment::ExtractInbandCCUnitsAsync, HLSInbandCCExtractor)
+  Windows::Foundation::IAsyncOperation<Platform::String^>^ ExportWebVttAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack);
+  Windows::Foundation::IAsyncOperation<Platform::String^>^ ExportTtmlAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack);
+
   // Caption Options
   property CaptionOptions^ Options
   {
@@ -71,15 +78,15 @@ public:
 	  }
   }
 
-  // valid values are 1, 2, 3, and 4 (for CC1, CC2, CC3, and CC4), as well as 0 (zero) for no captions
+  // valid values are 1, 2, 3, and 4 (for CC1, CC2, CC3, and CC4), 5 through 10 (for 708 services 1 through 6), as well as 0 (zero) for no captions
   property int ActiveCaptionTrack
   {
     int get() { return _core.GetCaptionTrack(); }
     void set(int t) 
     {
-      if ((t < 0) || (t > 4))
+      if ((t < 0) || (t > ByteDecoder::LastCaptionTrack))
       {
-        throw ref new Platform::InvalidArgumentException("ActiveCaptionTrack property on CC608XamlController must be 0 (for no captions) or between 1 and 4 (for CC1 through CC4).\nValue encountered: [" + t + "].");
+        throw ref new Platform::InvalidArgumentException("ActiveCaptionTrack property on CC608XamlController must be 0 (for no captions), between 1 and 4 (for CC1 through CC4) or between 5 and 10 (for 708 services 1 through 6).\nValue encountered: [" + t + "].");
       }
 
       _core.SetCaptionTrack(t);
@@ -89,6 +96,7 @@ public:
 private:
   Core _core;
   std::mutex _mtx;
+
   Microsoft::CC608::CaptionOptions^ options;
 
   [Windows::Foundation::Metadata::DefaultOverload]
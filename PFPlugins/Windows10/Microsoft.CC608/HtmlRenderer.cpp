@@ -27,7 +27,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 using namespace Microsoft::CC608;
 using namespace std;
 
-HtmlRenderer::HtmlRenderer(void) : _rowLogic()
+HtmlRenderer::HtmlRenderer(void) : _rowLogic(), _rowHtml(), _rowVersions()
 {
 }
 
@@ -46,16 +46,27 @@ std::wstring HtmlRenderer::RenderHtml(const Memory& displayMemory, const unsigne
 }
 
 // creates the core HTML without scaling information
+// (the row markup doesn't depend on the scaling, so only the rows that changed since the last call are rendered again)
 std::wstring HtmlRenderer::RenderCoreHtml(const Memory& displayMemory)
 {
+  _rowHtml.resize(displayMemory.Rows.size());
+  _rowVersions.resize(displayMemory.Rows.size(), 0);
+
   wstringstream ss;
 
   // top 10% spacer (at top of screen)
   ss << L"<div style=\"height: 10%;\"></div>\n";
 
-  for(const auto& row : displayMemory.Rows)
+  for (size_t i = 0; i < displayMemory.Rows.size(); ++i)
   {
-    ss << _rowLogic.RenderRow(row);
+    const auto& row = displayMemory.Rows[i];
+    if (_rowVersions[i] != row.GetVersion())
+    {
+      _rowHtml[i] = _rowLogic.RenderRow(row);
+      _rowVersions[i] = row.GetVersion();
+    }
+
+    ss << _rowHtml[i];
   }
 
   // bottom 10% spacer
@@ -23,6 +23,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "pch.h"
 #include "Memory.h"
@@ -43,6 +44,10 @@ public:
 private:
   HtmlRowLogic _rowLogic;
 
+  // the markup of each row from the last render, and the row version it was rendered from
+  std::vector<std::wstring> _rowHtml;
+  std::vector<unsigned int> _rowVersions;
+
   std::wstring HtmlRenderer::RenderCoreHtml(const Memory& displayMemory);
   std::wstring HtmlRenderer::WrapCoreHtml(const unsigned short videoHeightPixels, const std::wstring& coreHtml, const bool animateUp);
 };
@@ -27,8 +27,5 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-#include <cassert>
-#include "StandardsExtensions.h"
-#include "Logger.h"
-
-typedef uint8 byte_t;
+// byte_t, DebugWrite and friends come from the shared caption engine
+#include "CC608Types.h"
@@ -27,6 +27,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "CC608XamlController.h"
 #include "MockDataSource.h"
 #include "RawCaptionDataInternal.h"
+#include "CaptionExportAsync.h"
 
 using namespace Microsoft::CC608;
 using namespace Windows::UI::Xaml::Controls;
@@ -175,3 +176,13 @@ void CC608XamlController::Reset()
 
   _core.Reset();
 }
+
+Windows::Foundation::IAsyncOperation<Platform::String^>^ CC608XamlController::ExportWebVttAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+{
+  return CaptionExportAsync::ExportWebVttAsync(segments, captionTrack);
+}
+
+Windows::Foundation::IAsyncOperation<Platform::String^>^ CC608XamlController::ExportTtmlAsync(Windows::Foundation::Collections::IVector<RawCaptionData^>^ segments, int captionTrack)
+{
+  return CaptionExportAsync::ExportTtmlAsync(segments, captionTrack);
+}
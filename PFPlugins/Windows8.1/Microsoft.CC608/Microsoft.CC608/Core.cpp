@@ -30,9 +30,9 @@ using namespace Microsoft::CC608;
 using namespace std;
 
 Core::Core() : _htmlRenderer(), _xamlRenderer(), _upDecoder(nullptr), 
-_spModel(make_shared<Model>()), _currentPosition(0), _previousDisplayVersionNumber(0), _captionTrack(0), Options(nullptr)
+_spModel(make_shared<Model>()), _spModel708(make_shared<Model708>()), _currentPosition(0), _pendingBytes(), _previousDisplayVersionNumber(0), _captionTrack(0), Options(nullptr)
 {
-  _upDecoder = unique_ptr<ByteDecoder>(new ByteDecoder(_spModel));
+  _upDecoder = unique_ptr<ByteDecoder>(new ByteDecoder(_spModel, _spModel708));
 }
 
 Core::~Core(void)
@@ -51,7 +51,7 @@ void Core::AddCaptionData(const std::vector<std::pair<Timestamp, std::vector<byt
 
 void Core::AddCaptionDataInUserDataEnvelope(const Timestamp ts, const std::vector<byte_t>& bytes)
 {
-  auto byteCodes = _upDecoder->Extract608ByteCodes(bytes);
+  auto byteCodes = _upDecoder->ExtractByteCodes(bytes);
 
   _queue.AddCaptionData(ts, byteCodes);
 }
@@ -65,7 +65,7 @@ void Core::AddCaptionDataInUserDataEnvelope(const std::vector<std::pair<Timestam
     //LogRawData(d);
 
     Timestamp ts(d.first);
-    auto byteCodes = _upDecoder->Extract608ByteCodes(d.second);
+    auto byteCodes = _upDecoder->ExtractByteCodes(d.second);
     v.emplace_back(make_pair(ts, byteCodes));
   }
 
@@ -76,6 +76,8 @@ void Core::Seek(const Timestamp seekPosition)
 {
   _currentPosition = seekPosition;
   _spModel->Clear();
+  _spModel708->Clear();
+  _upDecoder->Flush();
   _queue.Clear();
   _previousDisplayVersionNumber = 0;
 }
@@ -85,14 +87,16 @@ void Core::Reset()
   _currentPosition = Timestamp();
   _queue.Clear();
   _spModel->Clear();
+  _spModel708->Clear();
+  _upDecoder->Flush();
   _previousDisplayVersionNumber = 0;
 }
 
 void Core::AdvanceModelTo(const Timestamp newPosition)
 {
-  auto bytes = _queue.GetSortedCaptionData(_currentPosition, newPosition);
+  _queue.GetSortedCaptionData(_currentPosition, newPosition, _pendingBytes);
 
-  _upDecoder->ParseBytes(bytes);
+  _upDecoder->ParseBytes(_pendingBytes);
 
   _currentPosition = newPosition;
 }
@@ -106,12 +110,19 @@ bool Core::NeedsUpdate() const
   }
 
   // only update if the model has a different version number than the last rendered value
-  return (_previousDisplayVersionNumber != _spModel->GetDisplayVersionNumber());
+  return (_previousDisplayVersionNumber != GetDisplayVersionNumber());
 }
 
 std::wstring Core::GetCurrentHtml(const unsigned short videoHeightPixels)
 {
-  _previousDisplayVersionNumber = _spModel->GetDisplayVersionNumber();
+  _previousDisplayVersionNumber = GetDisplayVersionNumber();
+
+  if (ByteDecoder::IsServiceTrack(_captionTrack))
+  {
+    // 708 windows are not animated
+    return _htmlRenderer.RenderHtml(_spModel708->displayedMemory, videoHeightPixels, false);
+  }
+
   return _htmlRenderer.RenderHtml(_spModel->displayedMemory, videoHeightPixels, _spModel->NeedsAnimation());
 }
 
@@ -119,13 +130,20 @@ Windows::UI::Xaml::UIElement^ Core::GetCurrentXaml(const unsigned short videoHei
 {
 	_xamlRenderer.SetOptions(this->Options);
 
-  _previousDisplayVersionNumber = _spModel->GetDisplayVersionNumber();
+  _previousDisplayVersionNumber = GetDisplayVersionNumber();
+
+  if (ByteDecoder::IsServiceTrack(_captionTrack))
+  {
+    // 708 windows are not animated
+    return _xamlRenderer.RenderXaml(_spModel708->displayedMemory, videoHeightPixels, false);
+  }
+
   return _xamlRenderer.RenderXaml(_spModel->displayedMemory, videoHeightPixels, _spModel->NeedsAnimation());
 }
 
 void Core::SetCaptionTrack(const int captionTrack)
 {
-  assert(captionTrack >= 0 && captionTrack < 5);
+  assert(captionTrack >= 0 && captionTrack <= ByteDecoder::LastCaptionTrack);
 
   if (_captionTrack == captionTrack)
   {
@@ -134,7 +152,7 @@ void Core::SetCaptionTrack(const int captionTrack)
   }
 
   // if switching from one field to another, need to clear the queue of any data, as this data will be invalid
-  // (CC1 and CC2 are field 1, while CC3 and CC4 are field 2)
+  // (CC1 and CC2 are field 1, while CC3 and CC4 are field 2, and the 708 services queue DTVCC data instead)
   switch(captionTrack)
   {
   case 0:
@@ -145,7 +163,7 @@ void Core::SetCaptionTrack(const int captionTrack)
   case 2:
     if (_captionTrack > 2)
     {
-      // switching from field 2 to field 1
+      // switching from field 2 (or 708) to field 1
       
       // all data in the queue is now worthless
       _queue.Clear();
@@ -154,24 +172,38 @@ void Core::SetCaptionTrack(const int captionTrack)
 
   case 3:
   case 4:
-    if (_captionTrack < 3)
+    if (_captionTrack < 3 || ByteDecoder::IsServiceTrack(_captionTrack))
     {
-      // switching from field 1 to field 2
+      // switching from field 1 (or 708) to field 2
 
       // clear cache (as all data is now incorrect)
       _queue.Clear();
     }
     break;
+
+  default:
+    // the DTVCC data in the queue carries all services, so only switching from 608 makes it worthless
+    if (!ByteDecoder::IsServiceTrack(_captionTrack))
+    {
+      _queue.Clear();
+    }
+    break;
   }
 
   // regardless of field, existing data in model is now invalid
   _spModel->Clear();
+  _spModel708->Clear();
   _previousDisplayVersionNumber = 0;
 
   _captionTrack = captionTrack;
   _upDecoder->SetCaptionTrack(captionTrack);
 }
 
+unsigned int Core::GetDisplayVersionNumber() const
+{
+  return ByteDecoder::IsServiceTrack(_captionTrack) ? _spModel708->GetDisplayVersionNumber() : _spModel->GetDisplayVersionNumber();
+}
+
 void Core::LogRawData(const std::pair<Timestamp, std::vector<byte_t>>& d) const
 {
   unsigned int displayCounter = 0;
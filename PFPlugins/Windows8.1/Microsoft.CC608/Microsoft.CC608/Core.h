@@ -33,6 +33,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "HtmlCaptionsData.h"
 #include "XamlCaptionsData.h"
 #include "Model.h"
+#include "Model708.h"
 #include "ByteDecoder.h"
 #include "Timestamp.h"
 
@@ -67,7 +68,7 @@ public:
 
   Windows::UI::Xaml::UIElement^ GetCurrentXaml(const unsigned short videoHeightPixels);
 
-  // valid values are 1, 2, 3, and 4 (for CC1, CC2, CC3, and CC4), and 0 for no captions
+  // valid values are 1, 2, 3, and 4 (for CC1, CC2, CC3, and CC4), 5 through 10 (for 708 services 1 through 6), and 0 for no captions
   int GetCaptionTrack() { return _captionTrack; }
   void SetCaptionTrack(const int captionTrack);
 
@@ -94,13 +95,20 @@ private:
   XamlRenderer _xamlRenderer;
 
   std::shared_ptr<Microsoft::CC608::Model> _spModel;
+  std::shared_ptr<Microsoft::CC608::Model708> _spModel708;
 
   // the timestamp for the caption state that the model currently represents
   Timestamp _currentPosition;
 
+  // the bytes taken from the queue on each advance (kept so its capacity is reused)
+  std::vector<byte_t> _pendingBytes;
+
   unsigned int _previousDisplayVersionNumber;
   int _captionTrack;
 
+  // the display version of the model for the active track (608 or 708)
+  unsigned int GetDisplayVersionNumber() const;
+
   void LogRawData(const std::pair<Timestamp, std::vector<byte_t>>& data) const;
 };
 
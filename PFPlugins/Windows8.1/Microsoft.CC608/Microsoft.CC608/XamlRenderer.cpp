@@ -34,7 +34,7 @@ using namespace Windows::UI::Xaml::Media;
 using namespace Windows::UI::Xaml::Media::Animation;
 
 
-XamlRenderer::XamlRenderer(void) : _rowLogic()
+XamlRenderer::XamlRenderer(void) : _rowLogic(), _stackPanel(nullptr), _rowVersions(), _renderedVideoHeight(0), _renderedOptions(nullptr)
 {
 }
 
@@ -53,6 +53,8 @@ UIElement^ XamlRenderer::RenderXaml(const Memory& displayMemory,
   if (animateUp)
   {
     // build animated captions that roll up
+    // (every row moves, so there is nothing to reuse--the next non-animated render starts over as well)
+    _stackPanel = nullptr;
 
     float captionBlockHeight = videoHeightPixels * 0.80f;
 
@@ -133,6 +135,23 @@ UIElement^ XamlRenderer::RenderXaml(const Memory& displayMemory,
 
     return rollUpContainer;
   }
+  else if (_stackPanel != nullptr && _renderedVideoHeight == videoHeightPixels && _renderedOptions == _rowLogic.Options)
+  {
+    // the layout is unchanged, only replace the rows that changed since the last render
+    unsigned int index = 0;
+    for (const MemoryRow& row : displayMemory.Rows)
+    {
+      if (_rowVersions[index] != row.GetVersion())
+      {
+        _stackPanel->Children->SetAt(index, _rowLogic.RenderRow(row));
+        _rowVersions[index] = row.GetVersion();
+      }
+
+      ++index;
+    }
+
+    return _stackPanel;
+  }
   else
   {
     // if no animations, just render the simple object tree to speed up display
@@ -160,11 +179,17 @@ UIElement^ XamlRenderer::RenderXaml(const Memory& displayMemory,
     stackPanel->Orientation = Orientation::Vertical;
     stackPanel->VerticalAlignment = VerticalAlignment::Center;
 
+    _rowVersions.clear();
     for (const MemoryRow& row : displayMemory.Rows)
     {
       stackPanel->Children->Append(_rowLogic.RenderRow(row));
+      _rowVersions.push_back(row.GetVersion());
     }
 
+    _stackPanel = stackPanel;
+    _renderedVideoHeight = videoHeightPixels;
+    _renderedOptions = _rowLogic.Options;
+
     return stackPanel;
   }
 }
@@ -22,6 +22,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
+#include <vector>
+
 #include "Memory.h"
 #include "XamlRowLogic.h"
 #include "CaptionOptions.h"
@@ -44,6 +46,13 @@ public:
 
 private:
   XamlRowLogic _rowLogic;
+
+  // the last non-animated tree, reused as long as the video height and options stay the same
+  // (only the rows whose version changed since are rendered again)
+  Windows::UI::Xaml::Controls::StackPanel^ _stackPanel;
+  std::vector<unsigned int> _rowVersions;
+  unsigned short _renderedVideoHeight;
+  CaptionOptions^ _renderedOptions;
 };
 
 
@@ -0,0 +1,182 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Measures how long it takes to find the packed audio timestamp (the PRIV frame owned by
+// com.apple.streaming.transportStreamTimestamp) with the ID3 frame walk that MediaSegment::HasAACTimestampTag uses, against
+// the byte by byte string scan it replaced. Both must report the same offset.
+//
+// usage: AACTimestampTagBench [iterations (default 200)]
+
+#include "pch.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "ID3TagParser.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+//the scan HasAACTimestampTag used before it walked the ID3 frames
+static ULONG StringScan(const BYTE *tsdata, ULONG size)
+{
+  ULONG idx = 0;
+  //read 3 bytes at a time and carry on until you find "ID3"
+  for (; idx < size; idx++)
+  {
+    BYTE tagid[4];
+    ZeroMemory(tagid, 4);
+    memcpy_s(tagid, 3, tsdata + idx, 3);
+    if (string((char *) tagid) == "ID3")
+    {
+      idx += 3;
+      break;
+    }
+  }
+  if (idx >= size)
+    return size;
+
+  for (; idx < size; idx++)
+  {
+    BYTE tagid[5];
+    ZeroMemory(tagid, 5);
+    memcpy_s(tagid, 4, tsdata + idx, 4);
+    if (string((char *) tagid) == "PRIV")
+    {
+      idx += 4;
+      break;
+    }
+  }
+  if (idx >= size)
+    return size;
+
+  for (; idx < size; idx++)
+  {
+    BYTE tagid[45];
+    ZeroMemory(tagid, 45);
+    memcpy_s(tagid, 45, tsdata + idx, 45);
+    if (string((char *) tagid) == "com.apple.streaming.transportStreamTimestamp")
+    {
+      idx += 45;
+      break;
+    }
+  }
+  return idx;
+}
+
+static void AppendSynchsafe(std::vector<BYTE>& data, ULONG value)
+{
+  data.push_back((BYTE) ((value >> 21) & 0x7F));
+  data.push_back((BYTE) ((value >> 14) & 0x7F));
+  data.push_back((BYTE) ((value >> 7) & 0x7F));
+  data.push_back((BYTE) (value & 0x7F));
+}
+
+static void AppendFrame(std::vector<BYTE>& tag, const char *id, const std::vector<BYTE>& body)
+{
+  tag.insert(tag.end(), id, id + 4);
+  AppendSynchsafe(tag, (ULONG) body.size());
+  tag.push_back(0);
+  tag.push_back(0);
+  tag.insert(tag.end(), body.begin(), body.end());
+}
+
+//pseudo random media data that never contains an 'I', so neither scan can find a stray "ID3"
+static void AppendMediaData(std::vector<BYTE>& data, size_t size)
+{
+  unsigned int seed = 0x12345678;
+  for (size_t i = 0; i < size; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    BYTE b = (BYTE) (seed >> 16);
+    data.push_back(b == 'I' ? (BYTE) 0 : b);
+  }
+}
+
+//packed audio: an ID3 tag with a text frame and the timestamp PRIV frame, followed by the ADTS frames
+static std::vector<BYTE> PackedAudioSegment(size_t mediasize)
+{
+  static const char owner[] = "com.apple.streaming.transportStreamTimestamp";
+
+  std::vector<BYTE> txxx = { 0x03, 'i', 'd', 0x00 };
+  txxx.insert(txxx.end(), 64, 'x');
+  std::vector<BYTE> priv(owner, owner + sizeof(owner));
+  BYTE timestamp[8] = { 0, 0, 0, 0, 0, 0x01, 0x5F, 0x90 };
+  priv.insert(priv.end(), timestamp, timestamp + 8);
+
+  std::vector<BYTE> frames;
+  AppendFrame(frames, "TXXX", txxx);
+  AppendFrame(frames, "PRIV", priv);
+
+  std::vector<BYTE> data = { 'I', 'D', '3', 0x04, 0x00, 0x00 };
+  AppendSynchsafe(data, (ULONG) frames.size());
+  data.insert(data.end(), frames.begin(), frames.end());
+  AppendMediaData(data, mediasize);
+  return data;
+}
+
+//a transport stream (or any segment) without the tag - both scans have to look at every byte
+static std::vector<BYTE> SegmentWithoutTag(size_t size)
+{
+  std::vector<BYTE> data;
+  AppendMediaData(data, size);
+  return data;
+}
+
+static double NanosecondsPerCall(ULONG(*scan)(const BYTE*, ULONG), const std::vector<BYTE>& data, ULONG size, int iterations, ULONG& result)
+{
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; i++)
+    result = scan(&data[0], size);
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  return (double) elapsed / iterations;
+}
+
+static bool Measure(const char *name, std::vector<BYTE> data, int iterations)
+{
+  ULONG size = (ULONG) data.size();
+  //the string scan copies 45 bytes at a time and can read past the end of the segment
+  data.resize(data.size() + 64, 0);
+
+  ULONG walkresult = 0, scanresult = 0;
+  double walk = NanosecondsPerCall(&ID3TagParser::FindTransportStreamTimestamp, data, size, iterations, walkresult);
+  double scan = NanosecondsPerCall(&StringScan, data, size, iterations, scanresult);
+
+  printf("%-24s %8u bytes  frame walk %12.0f ns  string scan %12.0f ns  %8.1fx\n", name, size, walk, scan, walk > 0 ? scan / walk : 0.0);
+  if (walkresult != scanresult)
+  {
+    printf("%s: frame walk found offset %u, string scan found %u\n", name, walkresult, scanresult);
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  int iterations = argc > 1 ? atoi(argv[1]) : 200;
+  if (iterations <= 0)
+    iterations = 1;
+
+  bool ok = Measure("packed audio (200KB)", PackedAudioSegment(200 * 1024), iterations);
+  ok = Measure("no timestamp tag (1MB)", SegmentWithoutTag(1024 * 1024), iterations) && ok;
+  return ok ? 0 : 1;
+}
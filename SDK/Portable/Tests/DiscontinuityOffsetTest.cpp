@@ -0,0 +1,137 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Replays the audio hand-off of a bitrate switch across a discontinuity: the unread audio samples of the segment being
+// switched away from are moved to the front of the target segment, the target is remapped onto the presentation timeline,
+// and every audio sample in the target (moved or not) has to come out on that timeline, one frame after the last sample
+// that was played.
+
+#include "pch.h"
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include "SampleData.h"
+#include "Timestamp.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+static const unsigned long long FRAMEDIST = 213333;
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL: line %d: %s\n", __LINE__, #cond); failures++; } } while (0)
+
+// The parts of a media segment that take part in the remap, for a single audio PID
+struct Segment
+{
+  std::deque<std::shared_ptr<SampleData>> ReadQueue;
+  std::deque<std::shared_ptr<SampleData>> UnreadQueue;
+  std::shared_ptr<DiscontinuityOffset> spOffset = std::make_shared<DiscontinuityOffset>();
+
+  void Add(unsigned long long firstpts, unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      auto sd = std::make_shared<SampleData>();
+      sd->SamplePTS = std::make_shared<Timestamp>(firstpts + i * FRAMEDIST);
+      sd->spDiscontinuityOffset = spOffset;
+      UnreadQueue.push_back(sd);
+    }
+  }
+
+  void Read(unsigned int count)
+  {
+    for (unsigned int i = 0; i < count; i++)
+    {
+      ReadQueue.push_back(UnreadQueue.front());
+      UnreadQueue.pop_front();
+    }
+  }
+
+  // same as MediaSegment::SetDiscontinuityOffsets - the first unread sample lands one frame after lastts
+  void SetOffset(unsigned long long lastts)
+  {
+    spOffset->Offset = (long long) (lastts + FRAMEDIST) - (long long) UnreadQueue.front()->SamplePTS->ValueInTicks;
+    spOffset->IsSet = true;
+  }
+};
+
+static void CheckContiguous(Segment& seg, unsigned long long expectedfirst)
+{
+  auto expected = expectedfirst;
+  for (auto& sd : seg.UnreadQueue)
+  {
+    CHECK(sd->spDiscontinuityOffset == seg.spOffset);
+    CHECK(sd->HasDiscontinousTS());
+    CHECK(sd->GetDiscontinousTSValue() == expected);
+    expected += FRAMEDIST;
+  }
+}
+
+int main()
+{
+  // source segment on its own timeline (not discontinuous): 10 frames, 4 already played
+  Segment src;
+  src.Add(90000000, 10);
+  src.Read(4);
+  auto lastplayed = src.ReadQueue.back()->GetDiscontinousTSValue();
+
+  // target segment is discontinuous and its audio picks up where the source left off
+  Segment target;
+  target.Add(src.UnreadQueue.back()->SamplePTS->ValueInTicks + FRAMEDIST, 10);
+
+  for (auto itr = src.UnreadQueue.rbegin(); itr != src.UnreadQueue.rend(); itr++)
+    target.UnreadQueue.push_front(*itr);
+  DiscontinuityOffset::Attach(target.spOffset, target.UnreadQueue.begin(), target.UnreadQueue.end());
+
+  // the previous playlist had already been remapped - the target lands well past the raw timestamps
+  auto anchor = lastplayed + 40000000;
+  target.SetOffset(anchor);
+  CHECK(target.UnreadQueue.size() == 16);
+  CheckContiguous(target, anchor + FRAMEDIST);
+
+  // samples already played stay where they were
+  for (auto& sd : src.ReadQueue)
+    CHECK(sd->HasDiscontinousTS() == false);
+
+  // a source that was itself remapped - re-anchoring it later must not move the samples it handed over
+  Segment discsrc;
+  discsrc.Add(120000000, 8);
+  discsrc.SetOffset(30000000);
+  discsrc.Read(3);
+  auto discsrclast = discsrc.ReadQueue.back()->GetDiscontinousTSValue();
+
+  Segment disctarget;
+  disctarget.Add(discsrc.UnreadQueue.back()->SamplePTS->ValueInTicks + FRAMEDIST, 6);
+  for (auto itr = discsrc.UnreadQueue.rbegin(); itr != discsrc.UnreadQueue.rend(); itr++)
+    disctarget.UnreadQueue.push_front(*itr);
+  DiscontinuityOffset::Attach(disctarget.spOffset, disctarget.UnreadQueue.begin(), disctarget.UnreadQueue.end());
+  disctarget.SetOffset(discsrclast);
+
+  discsrc.spOffset->Offset += 50000000;
+  CheckContiguous(disctarget, discsrclast + FRAMEDIST);
+
+  if (failures == 0)
+    printf("PASS\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,224 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Parses a minimal CMAF initialization segment (one AVC and one HE-AAC track) and a media segment with one fragment per
+// track, and checks the tracks, the sample timestamps and the framing the parser puts in front of the samples.
+
+#include "pch.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "FMP4Parser.h"
+#include "SampleData.h"
+#include "Timestamp.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+static const unsigned int VIDEOTRACK = 1;
+static const unsigned int AUDIOTRACK = 2;
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL: line %d: %s\n", __LINE__, #cond); failures++; } } while (0)
+
+static void Put32(std::vector<BYTE>& v, unsigned int val)
+{
+  BYTE b[4] = { (BYTE) (val >> 24), (BYTE) (val >> 16), (BYTE) (val >> 8), (BYTE) val };
+  v.insert(v.end(), b, b + 4);
+}
+
+static void Put64(std::vector<BYTE>& v, unsigned long long val)
+{
+  Put32(v, (unsigned int) (val >> 32));
+  Put32(v, (unsigned int) val);
+}
+
+static std::vector<BYTE> Box(const char *type, const std::vector<BYTE>& payload)
+{
+  std::vector<BYTE> box;
+  Put32(box, (unsigned int) (payload.size() + 8));
+  box.insert(box.end(), type, type + 4);
+  box.insert(box.end(), payload.begin(), payload.end());
+  return box;
+}
+
+static std::vector<BYTE> Join(std::initializer_list<std::vector<BYTE>> parts)
+{
+  std::vector<BYTE> ret;
+  for (auto& p : parts)
+    ret.insert(ret.end(), p.begin(), p.end());
+  return ret;
+}
+
+static std::vector<BYTE> Track(unsigned int trackid, const char *handler, unsigned int timescale, const std::vector<BYTE>& sampleentry)
+{
+  std::vector<BYTE> tkhd(84, 0);
+  tkhd[15] = (BYTE) trackid;
+  std::vector<BYTE> mdhd(24, 0);
+  mdhd[12] = (BYTE) (timescale >> 24); mdhd[13] = (BYTE) (timescale >> 16); mdhd[14] = (BYTE) (timescale >> 8); mdhd[15] = (BYTE) timescale;
+  std::vector<BYTE> hdlr(25, 0);
+  memcpy(&hdlr[8], handler, 4);
+  std::vector<BYTE> stsd;
+  Put32(stsd, 0);
+  Put32(stsd, 1);
+  stsd.insert(stsd.end(), sampleentry.begin(), sampleentry.end());
+
+  return Box("trak", Join({ Box("tkhd", tkhd), Box("mdia", Join({ Box("mdhd", mdhd), Box("hdlr", hdlr),
+    Box("minf", Box("stbl", Box("stsd", stsd))) })) }));
+}
+
+static std::vector<BYTE> Trex(unsigned int trackid, unsigned int duration, unsigned int flags)
+{
+  std::vector<BYTE> trex;
+  Put32(trex, 0);
+  Put32(trex, trackid);
+  Put32(trex, 1);
+  Put32(trex, duration);
+  Put32(trex, 0);
+  Put32(trex, flags);
+  return Box("trex", trex);
+}
+
+//one traf - tfhd (offsets from the moof), tfdt (version 1) and a trun with a data offset and the per sample fields asked for
+static std::vector<BYTE> Traf(unsigned int trackid, unsigned long long decodetime, unsigned int trunflags, unsigned int dataoffset,
+  const std::vector<std::vector<unsigned int>>& entries)
+{
+  std::vector<BYTE> tfhd, tfdt, trun;
+  Put32(tfhd, 0x020000);
+  Put32(tfhd, trackid);
+  Put32(tfdt, 0x01000000);
+  Put64(tfdt, decodetime);
+  Put32(trun, trunflags);
+  Put32(trun, (unsigned int) entries.size());
+  Put32(trun, dataoffset);
+  if (trunflags & 0x4)
+    Put32(trun, 0); //first sample is a sync sample
+  for (auto& e : entries)
+    for (auto val : e)
+      Put32(trun, val);
+  return Box("traf", Join({ Box("tfhd", tfhd), Box("tfdt", tfdt), Box("trun", trun) }));
+}
+
+int main()
+{
+  const std::vector<BYTE> sps = { 0x67, 0x42, 0xC0, 0x1E, 0xD9, 0x00 };
+  const std::vector<BYTE> pps = { 0x68, 0xCE, 0x3C, 0x80 };
+
+  //avc1 - 78 byte visual sample entry, then avcC with 4 byte NAL unit lengths
+  std::vector<BYTE> avcc = { 0x01, 0x42, 0xC0, 0x1E, 0xFF, 0xE1, 0x00, (BYTE) sps.size() };
+  avcc.insert(avcc.end(), sps.begin(), sps.end());
+  avcc.insert(avcc.end(), { 0x01, 0x00, (BYTE) pps.size() });
+  avcc.insert(avcc.end(), pps.begin(), pps.end());
+  auto avc1 = Box("avc1", Join({ std::vector<BYTE>(78, 0), Box("avcC", avcc) }));
+
+  //mp4a - 28 byte audio sample entry, then esds. AudioSpecificConfig signals HE-AAC explicitly: AOT 5, 24KHz core, stereo,
+  //48KHz SBR output, AAC LC core
+  std::vector<BYTE> esds = { 0x00, 0x00, 0x00, 0x00,
+    0x03, 0x17, 0x00, 0x02, 0x00,
+    0x04, 0x12, 0x40, 0x15, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x05, 0x03, 0x2B, 0x11, 0x88 };
+  auto mp4a = Box("mp4a", Join({ std::vector<BYTE>(28, 0), Box("esds", esds) }));
+
+  auto init = Join({ Box("ftyp", { 'c', 'm', 'f', 'c', 0, 0, 0, 0 }),
+    Box("moov", Join({ Track(VIDEOTRACK, "vide", 90000, avc1), Track(AUDIOTRACK, "soun", 48000, mp4a),
+    Box("mvex", Join({ Trex(VIDEOTRACK, 3000, 0x10000), Trex(AUDIOTRACK, 1024, 0) })) })) });
+
+  std::map<unsigned int, shared_ptr<FMP4TrackInfo>> tracks;
+  CHECK(FMP4Parser::ParseInitSegment(init.data(), (ULONG) init.size(), tracks));
+  CHECK(tracks.size() == 2);
+  if (tracks.size() != 2)
+    return 1;
+
+  auto video = tracks[VIDEOTRACK];
+  auto audio = tracks[AUDIOTRACK];
+  CHECK(video->Type == VIDEO && !video->IsHEVC && video->Timescale == 90000 && video->NALULengthSize == 4);
+  CHECK(video->DefaultSampleDuration == 3000 && video->DefaultSampleFlags == 0x10000);
+  CHECK(video->ParameterSets.size() == sps.size() + pps.size() + 8);
+  CHECK(audio->Type == AUDIO && audio->Timescale == 48000 && audio->DefaultSampleDuration == 1024);
+  CHECK(audio->AudioObjectType == 2 && audio->SamplingFrequencyIndex == 6 && audio->ChannelConfiguration == 2);
+  CHECK(audio->ExtensionAudioObjectType == 5 && audio->ExtensionSamplingFrequencyIndex == 3);
+
+  //IDR then a non-IDR slice, each one length prefixed NAL unit, and two raw AAC frames
+  const std::vector<BYTE> idr = { 0x00, 0x00, 0x00, 0x04, 0x65, 0x88, 0x84, 0x21 };
+  const std::vector<BYTE> slice = { 0x00, 0x00, 0x00, 0x03, 0x41, 0x9A, 0x02 };
+  const std::vector<BYTE> aac1(10, 0x21), aac2(12, 0x21);
+  auto mdat = Box("mdat", Join({ idr, slice, aac1, aac2 }));
+
+  //sample size and composition offset for video, sample size for audio - the moof size does not depend on the offsets
+  auto buildmoof = [&](unsigned int videooffset, unsigned int audiooffset)
+  {
+    return Box("moof", Join({ Box("mfhd", { 0, 0, 0, 0, 0, 0, 0, 1 }),
+      Traf(VIDEOTRACK, 900000, 0x001 | 0x004 | 0x200 | 0x800, videooffset, { { (unsigned int) idr.size(), 3000 }, { (unsigned int) slice.size(), 6000 } }),
+      Traf(AUDIOTRACK, 480000, 0x001 | 0x200, audiooffset, { { (unsigned int) aac1.size() }, { (unsigned int) aac2.size() } }) }));
+  };
+  auto styp = Box("styp", { 'm', 's', 'd', 'h', 0, 0, 0, 0 });
+  auto moofsize = (unsigned int) buildmoof(0, 0).size();
+  auto moof = buildmoof(moofsize + 8, moofsize + 8 + (unsigned int) (idr.size() + slice.size()));
+  auto segment = Join({ styp, moof, mdat });
+
+  CHECK(FMP4Parser::IsFragmentedMP4(segment.data(), (ULONG) segment.size()));
+  CHECK(!FMP4Parser::IsFragmentedMP4(mdat.data() + 8, (ULONG) mdat.size() - 8));
+
+  FMP4Parser parser;
+  std::map<ContentType, unsigned short> pidmap;
+  std::map<unsigned short, std::deque<std::shared_ptr<SampleData>>> queues;
+  std::vector<std::shared_ptr<Timestamp>> timeline;
+  std::vector<shared_ptr<SampleData>> ccsamples;
+  std::map<unsigned short, ContentType> demuxed;
+  std::vector<BYTE> framing;
+  parser.Parse(segment.data(), (ULONG) segment.size(), tracks, pidmap, std::map<ContentType, unsigned short>(), queues, timeline, ccsamples, demuxed, framing);
+
+  CHECK(demuxed.size() == 2 && pidmap[VIDEO] == VIDEOTRACK && pidmap[AUDIO] == AUDIOTRACK);
+  CHECK(queues[VIDEOTRACK].size() == 2 && queues[AUDIOTRACK].size() == 2);
+  if (queues[VIDEOTRACK].size() != 2 || queues[AUDIOTRACK].size() != 2)
+    return 1;
+
+  //10s in at 90KHz plus the composition offsets - the second sample decodes one default duration later
+  auto v0 = queues[VIDEOTRACK][0];
+  auto v1 = queues[VIDEOTRACK][1];
+  CHECK(v0->IsSampleIDR && !v1->IsSampleIDR);
+  CHECK(v0->SamplePTS->ValueInTicks == 100333333ULL && v1->SamplePTS->ValueInTicks == 101000000ULL);
+  //parameter sets go ahead of the sync sample, and the NAL unit length is swapped for a start code
+  CHECK(v0->elemData.size() == 3 && v0->TotalLen == video->ParameterSets.size() + 4 + 4);
+  CHECK(v1->elemData.size() == 2 && v1->TotalLen == 4 + 3);
+  CHECK(memcmp(std::get<0>(v1->elemData[0]), "\0\0\0\1", 4) == 0 && std::get<0>(v1->elemData[1])[0] == 0x41);
+
+  //10s in at 48KHz, then one default duration (1024 samples) later
+  auto a0 = queues[AUDIOTRACK][0];
+  auto a1 = queues[AUDIOTRACK][1];
+  CHECK(a0->SamplePTS->ValueInTicks == 100000000ULL && a1->SamplePTS->ValueInTicks == 100213333ULL);
+  //ADTS header for the LC core at 24KHz, stereo, frame length includes the header
+  CHECK(a0->elemData.size() == 2 && a0->TotalLen == aac1.size() + 7);
+  const BYTE *adts = std::get<0>(a0->elemData[0]);
+  CHECK(adts[0] == 0xFF && adts[1] == 0xF1 && adts[2] == 0x58 && (adts[3] & 0xC0) == 0x80);
+  CHECK((((adts[3] & 0x3) << 11) | (adts[4] << 3) | (adts[5] >> 5)) == (int) (aac1.size() + 7));
+
+  CHECK(timeline.size() == 4);
+  if (timeline.size() == 4)
+    CHECK(timeline.front()->ValueInTicks == 100000000ULL && timeline.back()->ValueInTicks == 101000000ULL);
+
+  if (failures != 0)
+    return 1;
+
+  printf("PASS\n");
+  return 0;
+}
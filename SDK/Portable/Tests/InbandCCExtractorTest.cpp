@@ -0,0 +1,162 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Demuxes a transport stream segment that carries CEA-608 captions in H.264 SEI messages, the way caption export does
+// (no media source involved), and decodes the caption units with the shared caption engine.
+
+#include "pch.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "InbandCCExtractor.h"
+#include "CaptionExporter.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+static const unsigned short PMTPID = 0x1000;
+static const unsigned short VIDEOPID = 0x100;
+
+static BYTE OddParity(BYTE b)
+{
+  BYTE bits = 0;
+  for (BYTE v = b; v != 0; v >>= 1)
+    bits += v & 1;
+  return (bits % 2 == 0) ? (BYTE) (b | 0x80) : b;
+}
+
+//splits a PAT/PMT section or a PES packet into 188 byte transport packets (stuffing the last one through the adaptation field)
+static void Packetize(std::vector<BYTE>& ts, unsigned short pid, const std::vector<BYTE>& payload, bool section, BYTE& cc)
+{
+  size_t offset = 0;
+  bool first = true;
+  while (offset < payload.size())
+  {
+    std::vector<BYTE> body;
+    if (section && first)
+      body.push_back(0); //pointer field
+    size_t chunk = payload.size() - offset;
+    if (chunk > 184 - body.size())
+      chunk = 184 - body.size();
+    body.insert(body.end(), payload.begin() + offset, payload.begin() + offset + chunk);
+    offset += chunk;
+
+    BYTE hdr[4] = { 0x47, (BYTE) ((first ? 0x40 : 0x00) | ((pid >> 8) & 0x1F)), (BYTE) (pid & 0xFF), 0 };
+    size_t stuffing = 184 - body.size();
+    hdr[3] = (BYTE) ((stuffing > 0 ? 0x30 : 0x10) | (cc++ & 0x0F));
+    ts.insert(ts.end(), hdr, hdr + 4);
+    if (stuffing > 0)
+    {
+      ts.push_back((BYTE) (stuffing - 1));
+      if (stuffing > 1)
+      {
+        ts.push_back(0x00);
+        ts.insert(ts.end(), stuffing - 2, 0xFF);
+      }
+    }
+    ts.insert(ts.end(), body.begin(), body.end());
+    first = false;
+  }
+}
+
+static std::vector<BYTE> Section(BYTE tableid, const std::vector<BYTE>& body)
+{
+  //section_length covers the 5 byte header extension, the body and the CRC (which the parser does not check)
+  unsigned short len = (unsigned short) (5 + body.size() + 4);
+  std::vector<BYTE> s = { tableid, (BYTE) (0xB0 | (len >> 8)), (BYTE) (len & 0xFF), 0x00, 0x01, 0xC1, 0x00, 0x00 };
+  s.insert(s.end(), body.begin(), body.end());
+  s.insert(s.end(), 4, 0xFF);
+  return s;
+}
+
+static std::vector<BYTE> VideoPES(unsigned long long pts90k, BYTE cc1, BYTE cc2)
+{
+  std::vector<BYTE> pes = { 0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x80, 0x05,
+    (BYTE) (0x21 | ((pts90k >> 29) & 0x0E)), (BYTE) (pts90k >> 22), (BYTE) (0x01 | ((pts90k >> 14) & 0xFE)), (BYTE) (pts90k >> 7), (BYTE) (0x01 | ((pts90k << 1) & 0xFE)) };
+  //access unit delimiter
+  BYTE aud[] = { 0x00, 0x00, 0x00, 0x01, 0x09, 0xF0 };
+  pes.insert(pes.end(), aud, aud + sizeof(aud));
+  //SEI - user_data_registered_itu_t_t35 carrying one ATSC A/53 cc_data packet
+  BYTE t35[] = { 0xB5, 0x00, 0x31, 'G', 'A', '9', '4', 0x03, 0xC1, 0xFF, 0xFC, OddParity(cc1), OddParity(cc2), 0xFF };
+  BYTE seihdr[] = { 0x00, 0x00, 0x01, 0x06, 0x04, (BYTE) sizeof(t35) };
+  pes.insert(pes.end(), seihdr, seihdr + sizeof(seihdr));
+  pes.insert(pes.end(), t35, t35 + sizeof(t35));
+  pes.push_back(0x80);
+  //a token IDR slice
+  BYTE idr[] = { 0x00, 0x00, 0x01, 0x65, 0x88, 0x84, 0x21, 0xA0 };
+  pes.insert(pes.end(), idr, idr + sizeof(idr));
+  return pes;
+}
+
+int main()
+{
+  std::vector<std::pair<BYTE, BYTE>> pairs = { { 0x14, 0x20 }, { 0x14, 0x20 }, { 0x14, 0x70 }, { 0x14, 0x70 } };
+  std::string text = "HELLO WORLD ";
+  for (size_t i = 0; i < text.size(); i += 2)
+    pairs.push_back({ (BYTE) text[i], (BYTE) text[i + 1] });
+  pairs.push_back({ 0x14, 0x2F });
+  pairs.push_back({ 0x14, 0x2F });
+  for (int i = 0; i < 30; i++)
+    pairs.push_back({ 0x00, 0x00 });
+  pairs.push_back({ 0x14, 0x2C });
+  pairs.push_back({ 0x14, 0x2C });
+
+  std::vector<BYTE> ts;
+  BYTE patcc = 0, pmtcc = 0, videocc = 0;
+  Packetize(ts, 0, Section(0x00, { 0x00, 0x01, (BYTE) (0xE0 | (PMTPID >> 8)), (BYTE) (PMTPID & 0xFF) }), true, patcc);
+  Packetize(ts, PMTPID, Section(0x02, { (BYTE) (0xE0 | (VIDEOPID >> 8)), (BYTE) (VIDEOPID & 0xFF), 0xF0, 0x00,
+    0x1B, (BYTE) (0xE0 | (VIDEOPID >> 8)), (BYTE) (VIDEOPID & 0xFF), 0xF0, 0x00 }), true, pmtcc);
+
+  //10 seconds in, one frame per 3003 90KHz ticks (29.97 fps)
+  const unsigned long long basepts = 900000;
+  for (size_t i = 0; i < pairs.size(); i++)
+    Packetize(ts, VIDEOPID, VideoPES(basepts + i * 3003, pairs[i].first, pairs[i].second), false, videocc);
+
+  std::vector<InbandCCExtractor::ccunit_t> units;
+  if (FAILED(InbandCCExtractor::ExtractFromTransportStream(ts.data(), (ULONG) ts.size(), units)))
+  {
+    printf("FAIL: segment was not recognized as a transport stream\n");
+    return 1;
+  }
+  if (units.size() != pairs.size())
+  {
+    printf("FAIL: expected %u caption units, got %u\n", (unsigned int) pairs.size(), (unsigned int) units.size());
+    return 1;
+  }
+
+  Microsoft::CC608::CaptionExporter::segmentdata_t segment;
+  for (auto& u : units)
+    segment.emplace_back(Microsoft::CC608::Timestamp(std::get<0>(u)), std::vector<byte_t>(std::get<1>(u).get(), std::get<1>(u).get() + std::get<2>(u)));
+
+  auto cues = Microsoft::CC608::CaptionExporter(1).Decode(std::vector<Microsoft::CC608::CaptionExporter::segmentdata_t>(1, segment));
+  auto vtt = Microsoft::CC608::CaptionExporter::ToWebVtt(cues);
+
+  //the caption goes up with the end-of-caption (frame 10) and comes down with the erase (frame 42) - the repeated codes are ignored
+  if (cues.size() != 1 || vtt.find(L"00:00:10.333 --> 00:00:11.401") == std::wstring::npos || vtt.find(L"HELLO WORLD") == std::wstring::npos)
+  {
+    printf("FAIL: unexpected captions\n%ls\n", vtt.c_str());
+    return 1;
+  }
+
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,211 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Drives the timer wheel that backs SharedTimer with a fake clock - expiry rounding and coalescing, periodic timers not drifting,
+// cancellation, timers beyond the range of the wheel and missed periods after a suspend.
+
+#include "pch.h"
+#include <cstdio>
+#include <vector>
+#include "TimerWheel.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+//10 ms slots, as used by the media source
+static const unsigned long long RESOLUTION = 100000;
+static const unsigned long long SECOND = 10000000;
+
+static int failures = 0;
+
+static void Check(bool condition, const char *what)
+{
+  if (!condition)
+  {
+    printf("FAIL: %s\n", what);
+    failures++;
+  }
+}
+
+//moves the fake clock from From to To in Step increments, raising the callbacks the way SharedTimer does
+static void Run(TimerWheel& wheel, unsigned long long& now, unsigned long long To, unsigned long long Step)
+{
+  for (; now <= To; now += Step)
+  {
+    for (auto timer : wheel.Advance(now))
+      timer->Callback();
+  }
+}
+
+static void OneShot()
+{
+  TimerWheel wheel(RESOLUTION);
+  unsigned long long now = 0;
+  std::vector<unsigned long long> fired;
+  wheel.Schedule(SECOND / 2, 0, [&]() { fired.push_back(now); });
+
+  unsigned long long expiry = 0;
+  Check(wheel.GetNextExpiry(expiry) && expiry == SECOND / 2, "one shot timer reports its expiry");
+
+  Run(wheel, now, 2 * SECOND, RESOLUTION / 4);
+  Check(fired.size() == 1, "one shot timer fires once");
+  Check(fired.size() == 1 && fired[0] == SECOND / 2, "one shot timer fires on its slot boundary");
+  Check(wheel.Count() == 0 && !wheel.GetNextExpiry(expiry), "one shot timer is dropped after it fires");
+}
+
+static void Coalesce()
+{
+  TimerWheel wheel(RESOLUTION);
+  unsigned long long now = 0;
+  std::vector<unsigned long long> fired;
+  //both round up to the 510 ms slot
+  wheel.Schedule(SECOND / 2 + 10000, 0, [&]() { fired.push_back(now); });
+  wheel.Schedule(SECOND / 2 + 90000, 0, [&]() { fired.push_back(now); });
+
+  unsigned long long expiry = 0;
+  Check(wheel.GetNextExpiry(expiry) && expiry == SECOND / 2 + RESOLUTION, "expiry is rounded up to the slot");
+
+  Run(wheel, now, SECOND, 10000);
+  Check(fired.size() == 2 && fired[0] == fired[1] && fired[0] == SECOND / 2 + RESOLUTION, "timers in the same slot fire together");
+}
+
+static void Periodic()
+{
+  TimerWheel wheel(RESOLUTION);
+  unsigned long long now = 0;
+  std::vector<unsigned long long> fired;
+  //2.003 seconds - not a multiple of the slot, so rounding must not accumulate
+  wheel.Schedule(2 * SECOND + 30000, 2 * SECOND + 30000, [&]() { fired.push_back(now); });
+
+  Run(wheel, now, 200 * SECOND, RESOLUTION);
+  Check(fired.size() == 99, "periodic timer fires once per period");
+  bool drifted = false;
+  for (size_t i = 0; i < fired.size(); i++)
+  {
+    auto due = (i + 1) * (2 * SECOND + 30000);
+    if (fired[i] < due || fired[i] >= due + RESOLUTION)
+      drifted = true;
+  }
+  Check(!drifted, "periodic timer fires within a slot of every due time");
+}
+
+static void Cancel()
+{
+  TimerWheel wheel(RESOLUTION);
+  unsigned long long now = 0;
+  int cancelledfired = 0, keptfired = 0, periodicfired = 0;
+  auto cancelled = wheel.Schedule(SECOND, 0, [&]() { cancelledfired++; });
+  auto kept = wheel.Schedule(SECOND, 0, [&]() { keptfired++; });
+  auto periodic = wheel.Schedule(SECOND / 10, SECOND / 10, [&]() { periodicfired++; });
+
+  Check(wheel.Cancel(cancelled), "pending timer can be cancelled");
+  Check(!wheel.Cancel(cancelled), "timer cannot be cancelled twice");
+
+  Run(wheel, now, SECOND / 2, RESOLUTION);
+  Check(wheel.Cancel(periodic), "periodic timer can be cancelled after it fired");
+  auto periodiccount = periodicfired;
+
+  Run(wheel, now, 2 * SECOND, RESOLUTION);
+  Check(cancelledfired == 0, "cancelled timer does not fire");
+  Check(keptfired == 1, "timer in the same slot as a cancelled one still fires");
+  Check(periodiccount == 5 && periodicfired == 5, "cancelled periodic timer stops firing");
+  Check(!wheel.Cancel(kept), "one shot timer cannot be cancelled after it fired");
+}
+
+static void BeyondRange()
+{
+  //one level spans 64 slots - these need one, two and all four levels, and the last one is past the range of the wheel
+  std::vector<unsigned long long> dues = { 30 * SECOND, 300 * SECOND, 3000 * SECOND, 64ULL * 64 * 64 * 64 * 3 * RESOLUTION + 12345 };
+  for (auto due : dues)
+  {
+    TimerWheel wheel(RESOLUTION);
+    unsigned long long now = 0;
+    std::vector<unsigned long long> fired;
+    wheel.Schedule(due, 0, [&]() { fired.push_back(now); });
+
+    //walk the clock one second at a time - every level cascades on the way
+    Run(wheel, now, due + 2 * SECOND, SECOND);
+    Check(fired.size() == 1 && fired[0] >= due && fired[0] < due + SECOND + RESOLUTION, "far timer fires once, on time, when the clock walks");
+
+    //and the same timer when the clock jumps straight past it
+    TimerWheel jumped(RESOLUTION);
+    int jumpedfired = 0;
+    jumped.Schedule(due, 0, [&]() { jumpedfired++; });
+    for (auto timer : jumped.Advance(due - RESOLUTION))
+      timer->Callback();
+    Check(jumpedfired == 0, "far timer does not fire early when the clock jumps");
+    for (auto timer : jumped.Advance(due + RESOLUTION))
+      timer->Callback();
+    Check(jumpedfired == 1, "far timer fires when the clock jumps past it");
+  }
+}
+
+static void Suspend()
+{
+  TimerWheel wheel(RESOLUTION);
+  unsigned long long now = 0;
+  std::vector<unsigned long long> fired;
+  wheel.Schedule(SECOND, SECOND, [&]() { fired.push_back(now); });
+
+  Run(wheel, now, 3 * SECOND, RESOLUTION);
+  Check(fired.size() == 3, "periodic timer fires before the suspend");
+
+  //the device sleeps for 10.5 seconds - the missed periods are skipped, not fired in a burst
+  now = 13 * SECOND + SECOND / 2;
+  Run(wheel, now, now, RESOLUTION);
+  Check(fired.size() == 4, "missed periods fire once on resume");
+
+  Run(wheel, now, 15 * SECOND + SECOND / 2, RESOLUTION);
+  Check(fired.size() == 6 && fired[4] == 14 * SECOND && fired[5] == 15 * SECOND, "periodic timer keeps its phase after a suspend");
+}
+
+static void StartedLate()
+{
+  //a wheel created on a clock that has been running for a while
+  TimerWheel wheel(RESOLUTION, 1000 * SECOND);
+  unsigned long long now = 1000 * SECOND;
+  int fired = 0;
+  wheel.Schedule(now + SECOND, 0, [&]() { fired++; });
+  //a timer that is already due goes off on the next slot
+  wheel.Schedule(now - SECOND, 0, [&]() { fired++; });
+
+  Run(wheel, now, 1000 * SECOND + RESOLUTION, RESOLUTION);
+  Check(fired == 1, "overdue timer fires on the next slot");
+  Run(wheel, now, 1002 * SECOND, RESOLUTION);
+  Check(fired == 2, "timer scheduled on a running clock fires");
+}
+
+int main()
+{
+  OneShot();
+  Coalesce();
+  Periodic();
+  Cancel();
+  BeyondRange();
+  Suspend();
+  StartedLate();
+
+  if (failures > 0)
+    return 1;
+  printf("PASS\n");
+  return 0;
+}
@@ -0,0 +1,168 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+// Demuxes a transport stream with two HEVC video PIDs, indexing both the way the parser does when all elementary streams
+// are demuxed, and checks that each PID keeps its own parameter sets and key frames - the PID that is not being played
+// must not leak into the video format of the one that is.
+
+#include "pch.h"
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+#include "TransportStreamParser.h"
+#include "Timestamp.h"
+
+using namespace Microsoft::HLSClient::Private;
+
+static const unsigned short PMTPID = 0x1000;
+static const unsigned short ACTIVEPID = 0x100;
+static const unsigned short INACTIVEPID = 0x101;
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { printf("FAIL: line %d: %s\n", __LINE__, #cond); failures++; } } while (0)
+
+//splits a PAT/PMT section or a PES packet into 188 byte transport packets (stuffing the last one through the adaptation field)
+static void Packetize(std::vector<BYTE>& ts, unsigned short pid, const std::vector<BYTE>& payload, bool section, BYTE& cc)
+{
+  size_t offset = 0;
+  bool first = true;
+  while (offset < payload.size())
+  {
+    std::vector<BYTE> body;
+    if (section && first)
+      body.push_back(0); //pointer field
+    size_t chunk = payload.size() - offset;
+    if (chunk > 184 - body.size())
+      chunk = 184 - body.size();
+    body.insert(body.end(), payload.begin() + offset, payload.begin() + offset + chunk);
+    offset += chunk;
+
+    BYTE hdr[4] = { 0x47, (BYTE) ((first ? 0x40 : 0x00) | ((pid >> 8) & 0x1F)), (BYTE) (pid & 0xFF), 0 };
+    size_t stuffing = 184 - body.size();
+    hdr[3] = (BYTE) ((stuffing > 0 ? 0x30 : 0x10) | (cc++ & 0x0F));
+    ts.insert(ts.end(), hdr, hdr + 4);
+    if (stuffing > 0)
+    {
+      ts.push_back((BYTE) (stuffing - 1));
+      if (stuffing > 1)
+      {
+        ts.push_back(0x00);
+        ts.insert(ts.end(), stuffing - 2, 0xFF);
+      }
+    }
+    ts.insert(ts.end(), body.begin(), body.end());
+    first = false;
+  }
+}
+
+static std::vector<BYTE> Section(BYTE tableid, const std::vector<BYTE>& body)
+{
+  //section_length covers the 5 byte header extension, the body and the CRC (which the parser does not check)
+  unsigned short len = (unsigned short) (5 + body.size() + 4);
+  std::vector<BYTE> s = { tableid, (BYTE) (0xB0 | (len >> 8)), (BYTE) (len & 0xFF), 0x00, 0x01, 0xC1, 0x00, 0x00 };
+  s.insert(s.end(), body.begin(), body.end());
+  s.insert(s.end(), 4, 0xFF);
+  return s;
+}
+
+//an HEVC access unit - VPS, SPS and PPS tagged with the PID they belong to, followed by an IDR slice
+static std::vector<BYTE> VideoPES(unsigned long long pts90k, BYTE tag)
+{
+  std::vector<BYTE> pes = { 0x00, 0x00, 0x01, 0xE0, 0x00, 0x00, 0x80, 0x80, 0x05,
+    (BYTE) (0x21 | ((pts90k >> 29) & 0x0E)), (BYTE) (pts90k >> 22), (BYTE) (0x01 | ((pts90k >> 14) & 0xFE)), (BYTE) (pts90k >> 7), (BYTE) (0x01 | ((pts90k << 1) & 0xFE)) };
+  BYTE au[] = {
+    0x00, 0x00, 0x01, 0x40, 0x01, 0x0C, tag, //VPS
+    0x00, 0x00, 0x01, 0x42, 0x01, 0x01, tag, //SPS
+    0x00, 0x00, 0x01, 0x44, 0x01, 0xC1, tag, //PPS
+    0x00, 0x00, 0x01, 0x26, 0x01, 0xAF, 0x06, 0xB8, 0x63 }; //IDR_W_RADL
+  pes.insert(pes.end(), au, au + sizeof(au));
+  return pes;
+}
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+      class TransportStreamParserTest
+      {
+      public:
+        static void Run(const std::vector<BYTE>& ts)
+        {
+          TransportStreamParser parser(true);
+          std::map<ContentType, unsigned short> pidmap;
+          std::vector<unsigned short> metadatastreams;
+          std::map<unsigned short, std::deque<std::shared_ptr<SampleData>>> unreadqueues;
+          std::vector<std::shared_ptr<Timestamp>> timeline;
+          std::vector<std::shared_ptr<SampleData>> ccsamples;
+
+          parser.Parse(ts.data(), (ULONG) ts.size(), pidmap, std::map<ContentType, unsigned short>(), metadatastreams, unreadqueues, timeline, ccsamples);
+
+          //the lowest PID is played even though the other one showed up first
+          CHECK(pidmap.size() == 1 && pidmap[VIDEO] == ACTIVEPID);
+          CHECK(parser.ElementaryStreams.size() == 2);
+          CHECK(unreadqueues[ACTIVEPID].size() == 2);
+          CHECK(unreadqueues[INACTIVEPID].size() == 2);
+          for (auto& itm : unreadqueues)
+          {
+            for (auto& sd : itm.second)
+              CHECK(sd->IsSampleIDR);
+          }
+
+          auto paramsets = parser.TakeHEVCParameterSets();
+          CHECK(paramsets.size() == 2);
+          //VPS, SPS and PPS - 8 bytes each once the parser puts a 4 byte start code in front, the last byte of each is the tag
+          CHECK(paramsets[ACTIVEPID].size() == 24);
+          CHECK(paramsets[INACTIVEPID].size() == 24);
+          for (size_t i = 7; i < 24 && paramsets[ACTIVEPID].size() == 24 && paramsets[INACTIVEPID].size() == 24; i += 8)
+          {
+            CHECK(paramsets[ACTIVEPID][i] == 0xAA);
+            CHECK(paramsets[INACTIVEPID][i] == 0xBB);
+          }
+        }
+      };
+    }
+  }
+}
+
+int main()
+{
+  std::vector<BYTE> ts;
+  BYTE patcc = 0, pmtcc = 0, activecc = 0, inactivecc = 0;
+  Packetize(ts, 0, Section(0x00, { 0x00, 0x01, (BYTE) (0xE0 | (PMTPID >> 8)), (BYTE) (PMTPID & 0xFF) }), true, patcc);
+  Packetize(ts, PMTPID, Section(0x02, { (BYTE) (0xE0 | (ACTIVEPID >> 8)), (BYTE) (ACTIVEPID & 0xFF), 0xF0, 0x00,
+    0x24, (BYTE) (0xE0 | (ACTIVEPID >> 8)), (BYTE) (ACTIVEPID & 0xFF), 0xF0, 0x00,
+    0x24, (BYTE) (0xE0 | (INACTIVEPID >> 8)), (BYTE) (INACTIVEPID & 0xFF), 0xF0, 0x00 }), true, pmtcc);
+
+  //the PID we will not play comes first, so its first access unit is parsed before any from the PID we play
+  const unsigned long long basepts = 900000;
+  Packetize(ts, INACTIVEPID, VideoPES(basepts, 0xBB), false, inactivecc);
+  Packetize(ts, INACTIVEPID, VideoPES(basepts + 3003, 0xBB), false, inactivecc);
+  Packetize(ts, ACTIVEPID, VideoPES(basepts, 0xAA), false, activecc);
+  Packetize(ts, ACTIVEPID, VideoPES(basepts + 3003, 0xAA), false, activecc);
+
+  TransportStreamParserTest::Run(ts);
+
+  if (failures == 0)
+    printf("PASS\n");
+  return failures == 0 ? 0 : 1;
+}
@@ -22,23 +22,10 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include <vector>
+// Precompiled header stand-in for the portable build (see CMakeLists.txt at the root of the repository).
+// Only the platform-free parts of the SDK (parsers) are compiled against it - everything that
+// needs Media Foundation or WinRT is built by the Visual Studio projects.
 
-#include "pch.h"
-#include "MemoryCell.h"
-
-namespace Microsoft { namespace CC608 {
-
-  class MemoryRow
-  {
-  public:
-    MemoryRow(void);
-    ~MemoryRow(void);
-
-    void Clear();
-    bool ContainsText() const;
-
-    std::vector<MemoryCell> Cells;
-  };
-
-}}
+#include <cstdlib>
+#include <cstring>
+#include <wtypes.h>
@@ -88,7 +88,7 @@ void SupplementalInfo::Parse()
   else
   {
     while (naluData[readctr++] != 0x01); //skip prefix
-    readctr++;//skip NALU header;
+    readctr += HeaderLength;//skip NALU header;
     data = naluData;
 
   }
@@ -58,13 +58,15 @@ namespace Microsoft {
         unique_ptr<BYTE[]> naluDataEmulPrevBytesRemoved;
         unsigned int length;
         NALUType nalutype;
+        ///<summary>Size of the NALU header - 1 byte for H.264, 2 bytes for HEVC</summary>
+        unsigned short HeaderLength;
         NALUnitBase(NALUType type, const BYTE *data, unsigned int len) :
-          nalutype(type), naluData(data), length(len), naluDataEmulPrevBytesRemoved(nullptr)
+          nalutype(type), naluData(data), length(len), naluDataEmulPrevBytesRemoved(nullptr), HeaderLength(1)
         {
         }
 
         NALUnitBase(const BYTE *data, unsigned int len) :
-          nalutype(NALUType::NALUTYPE_NOTRELEVANT), naluData(data), length(len), naluDataEmulPrevBytesRemoved(nullptr)
+          nalutype(NALUType::NALUTYPE_NOTRELEVANT), naluData(data), length(len), naluDataEmulPrevBytesRemoved(nullptr), HeaderLength(1)
         {
         }
         virtual void Parse();
@@ -74,7 +76,7 @@ namespace Microsoft {
           std::vector<BYTE> vecnaluDataEmulByteRemoved;
           unsigned int readctr = 0;
           while (naluData[readctr++] != 0x01); //skip prefix
-          readctr++;//skip NALU header;
+          readctr += HeaderLength;//skip NALU header;
           bool foundEmulPreventByte = false;
           while (readctr < length)
           {
@@ -171,8 +173,9 @@ namespace Microsoft {
       public:
         SEIType PayloadType;
         shared_ptr<SEIMessageITUT_T35> spMsgITUT_T35;
-        SupplementalInfo(const BYTE *data, unsigned int len) : NALUnitBase(NALUType::NALUTYPE_SEI, data, len), PayloadType(SEIType::SEITYPE_NOTRELEVANT)
+        SupplementalInfo(const BYTE *data, unsigned int len, unsigned short headerlength = 1) : NALUnitBase(NALUType::NALUTYPE_SEI, data, len), PayloadType(SEIType::SEITYPE_NOTRELEVANT)
         {
+          HeaderLength = headerlength;
           CleanRBSPOfEmulPreventionBytes();
         }
 
@@ -230,7 +233,7 @@ namespace Microsoft {
           }
           return (2 * LeadingZeroBitCount) + 1;
         }
-        bool FindNextMatchingBitSequence(unsigned int sequencevalue, unsigned short numbits, unsigned int startat, const BYTE *data, unsigned int size, unsigned int& MatchPos)
+        static bool FindNextMatchingBitSequence(unsigned int sequencevalue, unsigned short numbits, unsigned int startat, const BYTE *data, unsigned int size, unsigned int& MatchPos)
         {
           MatchPos = size;
           if (size < numbits) return false;
@@ -32,7 +32,8 @@ using namespace Microsoft::HLSClient::Private;
 
 ///<summary>Constructor</summary>
 HeuristicsManager::HeuristicsManager(CHLSMediaSource *ptrms) : MaxBound(UINT32_MAX), MinBound(0),
-LastSuggestedBandwidth(0), pms(ptrms), LastMeasuredBandwidth(0), IgnoreDownshiftTolerance(false)
+LastSuggestedBandwidth(0), pms(ptrms), LastMeasuredBandwidth(0), IgnoreDownshiftTolerance(false), NextDownloadMeasureHandle(1),
+EstimatedRoundTrip(0), SegmentDuration(0)
 {
   OnNotifierTick = [this]()
   {
@@ -73,6 +74,9 @@ LastSuggestedBandwidth(0), pms(ptrms), LastMeasuredBandwidth(0), IgnoreDownshift
 
     }
   };
+
+  if (pms != nullptr)
+    tickstopwatch.spSharedTimer = pms->spSharedTimer;
 }
 
 ///<summary>Notifies that a bitrate change should be considered</summary>
@@ -95,7 +99,7 @@ void HeuristicsManager::NotifyBitrateChangeIfNeeded(double bitspersec, double la
   }
 
 
-  LOG("NotifyBitrateChangeIfNeeded : Reported - " << bitspersec << ", Last Suggested : " << LastSuggestedBandwidth << ", New Suggestion : " << suggestion << ",Upshift Padding : " << (double) Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift * 100 << " %, Downshift Tolerance : " << (double) Configuration::GetCurrent()->MaximumToleranceForBitrateDownshift * 100 << " %");
+  LOG("NotifyBitrateChangeIfNeeded : Reported - " << bitspersec << ", Last Suggested : " << LastSuggestedBandwidth << ", New Suggestion : " << suggestion << ",Upshift Padding : " << (double) Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift * 100 << " %, Downshift Tolerance : " << (double) Configuration::GetCurrent()->MaximumToleranceForBitrateDownshift * 100 << " %, Round Trip : " << EstimatedRoundTrip / 10000 << " ms");
   //if this is not the same as the last bitrate we suggested
   if (suggestion != LastSuggestedBandwidth)
   {
@@ -24,10 +24,15 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 #define CHECKBITRATE_MIN_BYTES 1024 * 1024
+#define DOWNLOAD_HISTORY_POINTS 128
+#define INVALID_DOWNLOAD_MEASURE 0
 #include "pch.h"
 #include <functional>  
 #include <tuple>
 #include <unordered_map> 
+#include <array>
+#include <atomic>
+#include <cfloat>
 #include <memory>
 #include <mutex>
 #include <algorithm>
@@ -52,11 +57,16 @@ namespace Microsoft
       {
       public:
         long long AtElapsed;
+        //cumulative byte count at this point - the difference between any two points is the byte count for the span between them
         unsigned long long TotalBytes;
-        unsigned long long BytesSinceLastUpdate;
 
-        DownloadDataPoint(long long atElapsed, unsigned long long totalBytes, unsigned long long bytesSinceLastUpdate) :
-          AtElapsed(atElapsed), TotalBytes(totalBytes), BytesSinceLastUpdate(bytesSinceLastUpdate)
+        DownloadDataPoint() : AtElapsed(0), TotalBytes(0)
+        {
+
+        }
+
+        DownloadDataPoint(long long atElapsed, unsigned long long totalBytes) :
+          AtElapsed(atElapsed), TotalBytes(totalBytes)
         {
 
         }
@@ -65,24 +75,77 @@ namespace Microsoft
 
       class DownloadEntry
       {
+      private:
+        //ring buffer of the most recent progress points - the oldest is overwritten once it is full
+        std::array<DownloadDataPoint, DOWNLOAD_HISTORY_POINTS> Data;
+        unsigned int DataHead, DataCount;
+        bool DataOverwritten;
+
+        const DownloadDataPoint& PointAt(unsigned int idx) const
+        {
+          return Data[(DataHead + idx) % DOWNLOAD_HISTORY_POINTS];
+        }
+
+        ///<summary>Cumulative byte count at a point in time</summary>
+        ///<remarks>Binary search over the ring - bounded by the ring size and not by the number of progress updates</remarks>
+        unsigned long long BytesAt(long long atElapsed) const
+        {
+          if (DataCount == 0 || atElapsed < PointAt(0).AtElapsed)
+          {
+            //older points have been overwritten - interpolate between the start of the download and the oldest point we have
+            if (DataOverwritten && DataCount > 0 && PointAt(0).AtElapsed > MinElapsed && atElapsed > MinElapsed)
+              return (unsigned long long)((double)PointAt(0).TotalBytes * (atElapsed - MinElapsed) / (PointAt(0).AtElapsed - MinElapsed));
+            return 0;
+          }
+
+          unsigned int lo = 0, hi = DataCount - 1;
+          while (lo < hi)
+          {
+            unsigned int mid = (lo + hi + 1) / 2;
+            if (PointAt(mid).AtElapsed <= atElapsed)
+              lo = mid;
+            else
+              hi = mid - 1;
+          }
+          return PointAt(lo).TotalBytes;
+        }
+
       public:
-        std::vector<DownloadDataPoint> Data;
         unsigned long long TotalBytes;
+        //MinElapsed is when the response started arriving (or the request was sent if that is never reported) - the byte span measures the body transfer only
         long long MaxElapsed, MinElapsed;
+        //when the request was sent, and how long it took for the response to start arriving
+        long long RequestElapsed, TimeToFirstByte;
+        bool FirstByteReceived;
         bool Completed;
         unsigned long long LastCheckedByteThreshold;
 
         double RunningRate;
-        DownloadEntry() {};
 
         DownloadEntry(long long atElapsed) :
+          DataHead(0), DataCount(0), DataOverwritten(false),
           TotalBytes(0), MaxElapsed(0), Completed(false), RunningRate(0),
-          MinElapsed(atElapsed), LastCheckedByteThreshold(0)
+          MinElapsed(atElapsed), LastCheckedByteThreshold(0),
+          RequestElapsed(atElapsed), TimeToFirstByte(0), FirstByteReceived(false)
         {}
 
+        void SetFirstByte(long long atElapsed)
+        {
+          TimeToFirstByte = atElapsed - RequestElapsed;
+          MinElapsed = atElapsed;
+          FirstByteReceived = true;
+        }
+
         void AddEntry(long long atElapsed, unsigned long long bytes)
         {
-          Data.push_back(DownloadDataPoint(atElapsed, bytes, bytes - TotalBytes));
+          if (DataCount < DOWNLOAD_HISTORY_POINTS)
+            DataCount++;
+          else
+          {
+            DataHead = (DataHead + 1) % DOWNLOAD_HISTORY_POINTS;
+            DataOverwritten = true;
+          }
+          Data[(DataHead + DataCount - 1) % DOWNLOAD_HISTORY_POINTS] = DownloadDataPoint(atElapsed, bytes);
 
           LastCheckedByteThreshold += bytes - TotalBytes;
           TotalBytes = bytes;
@@ -100,46 +163,19 @@ namespace Microsoft
             return false;
         }
 
-
-
-
-        double GetRateInSpan(long long spanStart, long long spanEnd)
+        double GetRateInSpan(long long spanStart, long long spanEnd) const
         {
           if (MaxElapsed < spanStart || MinElapsed > spanEnd) //no overlap
             return 0;
 
-          double retval = ((double)TotalBytes * 8 / ((double)(MaxElapsed - MinElapsed) / 10000000));
-          if (MinElapsed >= spanStart && MaxElapsed <= spanEnd) //full overlap
-            return retval;
-
-          //if neither we approximate assuming uniform prorities being given to all parallel downloads i.e. each of them downloading 
-          //at 1/x of the total possible rate when there are x downloads going
-
-
-          if (MinElapsed >= spanStart && MaxElapsed > spanEnd)
-          {
-            unsigned long long TotBytes = 0;
-            for (auto ddp : Data)
-            {
-              if (ddp.AtElapsed > spanEnd) break;
-              TotBytes += ddp.BytesSinceLastUpdate;
-            }
-            return ((double)TotBytes * 8 / ((double)(spanEnd - MinElapsed) / 10000000));
-          }
-
-          else if (MinElapsed < spanStart && MaxElapsed <= spanEnd)
-          {
-            unsigned long long TotBytes = 0;
-            for (auto ddp : Data)
-            {
-              if (ddp.AtElapsed < spanStart) continue;
-              TotBytes += ddp.BytesSinceLastUpdate;
-            }
-
-            return ((double)TotBytes * 8 / ((double)(MaxElapsed - spanStart) / 10000000));
-          }
+          //clip the span to the portion this download was active in
+          long long start = max(spanStart, MinElapsed);
+          long long end = min(spanEnd, MaxElapsed);
+          if (end <= start)
+            return 0;
 
-          return 0;
+          auto bytes = (end == MaxElapsed ? TotalBytes : BytesAt(end)) - (start == MinElapsed ? 0 : BytesAt(start));
+          return ((double)bytes * 8 / ((double)(end - start) / 10000000));
         }
 
 
@@ -168,7 +204,12 @@ namespace Microsoft
         bool IgnoreDownshiftTolerance;
         TaskRegistry<HRESULT> _notificationtasks;
         shared_ptr<StopWatch> swDownloadMeasure;
-        std::unordered_map<std::wstring, DownloadEntry> DownloadMeasureData;
+        std::unordered_map<unsigned int, DownloadEntry> DownloadMeasureData;
+        std::atomic<unsigned int> NextDownloadMeasureHandle;
+        //smoothed request round trip (time to first byte) in ticks - kept apart from the body transfer rate. Written under LockAccess, read lock free by the predictors
+        std::atomic<long long> EstimatedRoundTrip;
+        //duration of the segments being downloaded in ticks - used to predict download times
+        std::atomic<unsigned long long> SegmentDuration;
 
       public:
         //handler for bitrate change notification
@@ -197,16 +238,13 @@ namespace Microsoft
 
 
         ///<summary>Starts measuring a download</summary>
-        std::wstring StartDownloadMeasure(bool ActiveVariant = true)
+        ///<remarks>Call when the request is sent so that the time to first byte can be told apart from the body transfer</remarks>
+        ///<returns>Handle that identifies the measurement in subsequent calls - never INVALID_DOWNLOAD_MEASURE</returns>
+        unsigned int StartDownloadMeasure(bool ActiveVariant = true)
         {
-
-          
-          //create a GUID to represent the unique ID for the stopwatch
-          WCHAR buff[128];
-          GUID id = GUID_NULL;
-          CoCreateGuid(&id);
-          ::StringFromGUID2(id, buff, 128);
-          wstring ret = std::wstring(buff);
+          unsigned int ret = NextDownloadMeasureHandle++;
+          if (ret == INVALID_DOWNLOAD_MEASURE) //wrapped around
+            ret = NextDownloadMeasureHandle++;
 
           if (!tickstopwatch.IsTicking) return ret;
 
@@ -214,79 +252,104 @@ namespace Microsoft
           DownloadMeasureData.emplace(ret, DownloadEntry(swDownloadMeasure->GetElapsed()));
 
 
-          //return the stopwatch id
+          //return the measurement handle
           return ret;
         }
 
-        double CalculateRate(wstring measureID)
+        double CalculateRate(const DownloadEntry& entry, unsigned int measureID)
         {
 
-          unsigned long long TotBytes = DownloadMeasureData[measureID].TotalBytes;
-          long long elapsed = DownloadMeasureData[measureID].MaxElapsed - DownloadMeasureData[measureID].MinElapsed;
+          unsigned long long TotBytes = entry.TotalBytes;
+          long long elapsed = entry.MaxElapsed - entry.MinElapsed;
           double rate = ((double)TotBytes * 8) / ((double)elapsed / 10000000);
 
           {
             std::lock_guard<std::recursive_mutex> lock(LockAccess);
-            if (DownloadMeasureData.size() > 0)
+            for (auto& download : DownloadMeasureData)
             {
-              for (auto download : DownloadMeasureData)
-              {
-                if (download.first != measureID)
-                {
-                  //TotBytes += download.second.GetBytesInSpan(DownloadMeasureData[measureID].MinElapsed, DownloadMeasureData[measureID].MaxElapsed);
-                  rate += download.second.GetRateInSpan(DownloadMeasureData[measureID].MinElapsed, DownloadMeasureData[measureID].MaxElapsed);
-                }
-              }
+              if (download.first != measureID)
+                rate += download.second.GetRateInSpan(entry.MinElapsed, entry.MaxElapsed);
             }
           }
 
           //calculate bitrate
-          return rate;// ((double) TotBytes * 8) / ((double) elapsed / 10000000);
+          return rate;
+        }
+
+        ///<summary>Records that the response for a measured download has started arriving</summary>
+        void MarkDownloadMeasureFirstByte(unsigned int measureID)
+        {
+          if (!tickstopwatch.IsTicking) return;
+
+          std::lock_guard<std::recursive_mutex> lock(LockAccess);
+
+          auto itr = DownloadMeasureData.find(measureID);
+          if (itr == DownloadMeasureData.end() || itr->second.FirstByteReceived)
+            return;
+
+          swDownloadMeasure->Pause();
+          itr->second.SetFirstByte(swDownloadMeasure->GetElapsed());
+          swDownloadMeasure->Resume();
+
+          //smooth the round trip samples the way TCP does (1/8 gain)
+          long long rtt = EstimatedRoundTrip;
+          EstimatedRoundTrip = rtt == 0 ? itr->second.TimeToFirstByte :
+            (rtt * 7 + itr->second.TimeToFirstByte) / 8;
         }
 
-        void UpdateDownloadMeasure(std::wstring measureID, unsigned long long BytesDownloaded, bool CurrentVariant = true)
+        void UpdateDownloadMeasure(unsigned int measureID, unsigned long long BytesDownloaded, bool CurrentVariant = true)
         {
           if (!tickstopwatch.IsTicking) return;
 
           std::lock_guard<std::recursive_mutex> lock(LockAccess);
 
+          auto itr = DownloadMeasureData.find(measureID);
+          if (itr == DownloadMeasureData.end()) //started before the notifier was running
+            return;
+          auto& entry = itr->second;
+
           swDownloadMeasure->Pause();
-          DownloadMeasureData[measureID].AddEntry(swDownloadMeasure->GetElapsed(), BytesDownloaded);
+          entry.AddEntry(swDownloadMeasure->GetElapsed(), BytesDownloaded);
           swDownloadMeasure->Resume();
 
           //calculate bitrate
-          if (CurrentVariant && DownloadMeasureData[measureID].IsCheckPoint())
+          if (CurrentVariant && entry.IsCheckPoint())
           {
-            DownloadMeasureData[measureID].RunningRate = CalculateRate(measureID);
-            if (IsBitrateChangeNotifierRunning() && DownloadMeasureData[measureID].RunningRate < LastSuggestedBandwidth)
-              NotifyBitrateChangeIfNeeded(DownloadMeasureData[measureID].RunningRate, DownloadMeasureData[measureID].RunningRate);
+            entry.RunningRate = CalculateRate(entry, measureID);
+            if (IsBitrateChangeNotifierRunning() && entry.RunningRate < LastSuggestedBandwidth)
+              NotifyBitrateChangeIfNeeded(entry.RunningRate, entry.RunningRate);
           }
 
 
         }
 
 
-        void CompleteDownloadMeasure(std::wstring measureID, bool Discard = false, bool CurrentVariant = true)
+        void CompleteDownloadMeasure(unsigned int measureID, bool Discard = false, bool CurrentVariant = true)
         {
 
           if (!tickstopwatch.IsTicking) return;
           std::lock_guard<std::recursive_mutex> lock(LockAccess);
 
-          DownloadMeasureData[measureID].Completed = true;
+          auto itr = DownloadMeasureData.find(measureID);
+          if (itr == DownloadMeasureData.end()) //started before the notifier was running
+            return;
+          auto& entry = itr->second;
+
+          entry.Completed = true;
 
           if (CurrentVariant && !Discard)
           {
-            DownloadMeasureData[measureID].RunningRate = CalculateRate(measureID);
+            entry.RunningRate = CalculateRate(entry, measureID);
 
             if (IsBitrateChangeNotifierRunning() && !Configuration::GetCurrent()->UseTimeAveragedNetworkMeasure ||
-              DownloadMeasureData[measureID].RunningRate < LastSuggestedBandwidth)
+              entry.RunningRate < LastSuggestedBandwidth)
             {
-              NotifyBitrateChangeIfNeeded(DownloadMeasureData[measureID].RunningRate, DownloadMeasureData[measureID].RunningRate);
+              NotifyBitrateChangeIfNeeded(entry.RunningRate, entry.RunningRate);
             }
             else
             {
               //store bitrate in history 
-              BitrateHistory.push_back(DownloadMeasureData[measureID].RunningRate);
+              BitrateHistory.push_back(entry.RunningRate);
               LastMeasuredBandwidth = (unsigned int)BitrateHistory.back();
             }
           }
@@ -300,7 +363,7 @@ namespace Microsoft
         void CleanupDownloadHistory()
         {
           if (DownloadMeasureData.size() == 1 ||
-            std::find_if(DownloadMeasureData.begin(), DownloadMeasureData.end(), [this](std::pair<std::wstring, DownloadEntry> v)
+            std::find_if(DownloadMeasureData.begin(), DownloadMeasureData.end(), [this](const std::pair<const unsigned int, DownloadEntry>& v)
           {
             return  v.second.Completed == false;
           }) == DownloadMeasureData.end())
@@ -311,7 +374,7 @@ namespace Microsoft
 
           //get the minimum start point for all active downloads
           auto itrMinMinElapsed =
-            std::min_element(DownloadMeasureData.begin(), DownloadMeasureData.end(), [this](std::pair<std::wstring, DownloadEntry> v1, std::pair<std::wstring, DownloadEntry> v2)
+            std::min_element(DownloadMeasureData.begin(), DownloadMeasureData.end(), [this](const std::pair<const unsigned int, DownloadEntry>& v1, const std::pair<const unsigned int, DownloadEntry>& v2)
           {
             return v1.second.MinElapsed < v2.second.MinElapsed && (v1.second.Completed == false && v2.second.Completed == false);
           });
@@ -319,8 +382,8 @@ namespace Microsoft
           if (itrMinMinElapsed == DownloadMeasureData.end())
             return;
 
-          std::vector<wstring> toRemove;
-          for (auto p : DownloadMeasureData)
+          std::vector<unsigned int> toRemove;
+          for (auto& p : DownloadMeasureData)
           {
             if (p.second.MaxElapsed < (*itrMinMinElapsed).second.MinElapsed && p.second.Completed)
               toRemove.push_back(p.first);
@@ -387,6 +450,40 @@ namespace Microsoft
           return LastMeasuredBandwidth;
         }
 
+        ///<summary>Returns the smoothed request round trip in ticks</summary>
+        long long GetEstimatedRoundTrip()
+        {
+          return EstimatedRoundTrip;
+        }
+
+        ///<summary>Sets the duration (in ticks) of the segments being downloaded</summary>
+        void SetSegmentDuration(unsigned long long Duration)
+        {
+          std::lock_guard<std::recursive_mutex> lock(LockAccess);
+          SegmentDuration = Duration;
+        }
+
+        ///<summary>Predicts how long a segment at a given bitrate takes to download</summary>
+        ///<param name='Bandwidth'>Candidate bitrate (bits per second)</param>
+        ///<param name='Goodput'>Measured body transfer rate (bits per second)</param>
+        ///<returns>Ticks - one round trip to the first byte plus the body at the measured goodput</returns>
+        double PredictDownloadTime(double Bandwidth, double Goodput)
+        {
+          if (Goodput <= 0)
+            return DBL_MAX;
+          return (double)EstimatedRoundTrip + (Bandwidth * SegmentDuration / Goodput);
+        }
+
+        ///<summary>Checks if a segment at a given bitrate can be downloaded faster than it plays</summary>
+        ///<remarks>Without a segment duration this reduces to comparing the bitrate with the goodput</remarks>
+        bool FitsDownloadBudget(double Bandwidth, double Goodput)
+        {
+          unsigned long long segduration = SegmentDuration;
+          if (segduration == 0)
+            return Bandwidth < Goodput;
+          return PredictDownloadTime(Bandwidth, Goodput) < (double)segduration;
+        }
+
         ///<summary>Sets the last suggested bandwidth</summary>
         void SetLastSuggestedBandwidth(unsigned int Bandwidth)
         {
@@ -572,7 +669,7 @@ namespace Microsoft
             if (Bitrate <= MinBound)
               retval = MinBound;
             //cannot go above max bound
-            else if (Bitrate >= (MaxBound *(1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift)) && !Configuration::GetCurrent()->UpshiftBitrateInSteps)
+            else if (FitsDownloadBudget(MaxBound *(1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift), Bitrate) && !Configuration::GetCurrent()->UpshiftBitrateInSteps)
               retval = MaxBound;
             else
             {
@@ -588,7 +685,7 @@ namespace Microsoft
                   {
                     return val > LastSuggestedBandwidth;
                   });
-                  if (next != Bandwidths.end() && ((*next) * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift) < Bitrate))
+                  if (next != Bandwidths.end() && FitsDownloadBudget((*next) * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift), Bitrate))
                     retval = *next;
                 }
                 else
@@ -598,8 +695,8 @@ namespace Microsoft
                   for (auto itr = enditr; itr > startitr; itr--)
                   {
                     auto bwval = *itr;
-                    //switch to the largest bitrate that is less than measured bitrate minus any padding 
-                    if (itr != startitr && (bwval * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift) < Bitrate))
+                    //switch to the largest bitrate that is predicted to download (with any padding) within a segment duration 
+                    if (itr != startitr && FitsDownloadBudget(bwval * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift), Bitrate))
                     {
                       retval = bwval;
                       break;
@@ -619,7 +716,7 @@ namespace Microsoft
                 for (auto itr = enditr; itr > startitr; itr--)
                 {
                   auto bwval = *itr;
-                  if (itr != startitr && bwval * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift) <= Bitrate)
+                  if (itr != startitr && FitsDownloadBudget(bwval * (1 + Configuration::GetCurrent()->MinimumPaddingForBitrateUpshift), Bitrate))
                   {
                     retval = *(--itr);;// bwval;
                     break;
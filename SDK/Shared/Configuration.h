@@ -43,6 +43,8 @@ namespace Microsoft {
         unsigned long long PreFetchLengthInTicks;
         //length of the look ahead buffer in ticks
         unsigned long long LABLengthInTicks; 
+        //most bytes of segment data a media source keeps in memory across all its variants and renditions - 0 means no limit
+        unsigned long long MaximumBufferSizeInBytes;
         unsigned long long MinimumLiveLatency;
         //bitrate change notification interval in milliseconds
         unsigned long long BitrateChangeNotificationInterval;
@@ -62,6 +64,22 @@ namespace Microsoft {
         Microsoft::HLSClient::SegmentMatchCriterion MatchSegmentsUsing;
         ContentType ContentTypeFilter; 
         bool TryEnsureSeamlessBitrateSwitch;
+        //keep the playlists for the variants adjacent to the active one downloaded (and refreshed if live)
+        bool WarmAdjacentVariantPlaylists;
+        //also prefetch the segment at the likely switch point on the adjacent variants
+        bool PrefetchAdjacentVariantSegment;
+        //fetch the variant and alternate audio playlists (and their first segments) in parallel on open
+        bool EnableFastStart;
+        //start closer to the live edge and use conditional/blocking playlist reloads when the server supports them
+        bool EnableLowLatencyLive;
+        //speed playback up slightly to get back to the live start position after falling behind
+        bool EnableLiveCatchup;
+        //how far (in ticks) behind the live start position we can fall before suggesting a seek instead - 0 means 3 times the minimum live latency
+        unsigned long long LiveCatchupSeekThreshold;
+        //keep the samples for every audio and video PID in a transport stream segment so that switching in-band tracks does not need a re-parse
+        bool DemuxAllElementaryStreams;
+        //switch bitrates only where the source segments already fetched end, and never have more than one segment download in flight while switching
+        bool SwitchBitrateOnSegmentBoundary;
         static std::shared_ptr<Configuration> GetCurrent()
         {
           if (_current == nullptr)
@@ -74,6 +92,7 @@ namespace Microsoft {
           PreFetchLengthInTicks(0),
           MinimumLiveLatency(0),
           LABLengthInTicks(0), 
+          MaximumBufferSizeInBytes(0),
           SegmentTryLimitOnBitrateSwitch(2),
           BitrateChangeNotificationInterval(15 * (unsigned long long)10000000),
           EnableBitrateMonitor(true), 
@@ -88,6 +107,14 @@ namespace Microsoft {
 
  
           TryEnsureSeamlessBitrateSwitch(true), 
+          WarmAdjacentVariantPlaylists(true),
+          PrefetchAdjacentVariantSegment(false),
+          EnableFastStart(false),
+          EnableLowLatencyLive(false),
+          EnableLiveCatchup(false),
+          LiveCatchupSeekThreshold(0),
+          DemuxAllElementaryStreams(false),
+          SwitchBitrateOnSegmentBoundary(false),
           MaximumToleranceForBitrateDownshift(0.0f),
           AllowSegmentSkipOnSegmentFailure(true),
           ForceKeyFrameMatchOnSeek(true),  
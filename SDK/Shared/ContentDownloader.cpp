@@ -54,6 +54,7 @@ _verb(L"GET"),
 _isbusy(false),
 _externalDownloader(nullptr),
 _activeMeasure(true),
+_measureid(INVALID_DOWNLOAD_MEASURE),
 _downloadedbytecount(0), _heuristicsupdatebytecounter(0)
 {
 
@@ -124,9 +125,10 @@ HttpRequestMessage^ DefaultContentDownloader::PrepareRequestMessage()
       headers->Append(ref new Platform::String(pair.first.data()), ref new Platform::String(pair.second.data()));
     }
   }
-  if (_IfModifiedSince.empty() == false)
+  if (_IfModifiedSince.empty() == false || _ETag.empty() == false)
   {
-    requestMessage->Headers->Insert(ref new Platform::String(L"If-Modified-Since"), ref new Platform::String(_IfModifiedSince.data()));
+    if (_IfModifiedSince.empty() == false)
+      requestMessage->Headers->Insert(ref new Platform::String(L"If-Modified-Since"), ref new Platform::String(_IfModifiedSince.data()));
     if (_ETag.empty() == false)
       requestMessage->Headers->Insert(ref new Platform::String(L"If-None-Match"), ref new Platform::String(_ETag.data()));
   }
@@ -246,6 +248,11 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
 
     task_completion_event<void> tceDownloadCompleted = task_completion_event<void>();
 
+    //start measuring as the request goes out so that the time to first byte is kept apart from the body transfer
+    _measureid = INVALID_DOWNLOAD_MEASURE;
+    if (_pHeuristicsManager != nullptr && Configuration::GetCurrent()->EnableBitrateMonitor)
+      _measureid = _pHeuristicsManager->StartDownloadMeasure(_activeMeasure);
+
     auto op = client->SendRequestAsync(requestmessage, HttpCompletionOption::ResponseContentRead);
 
     if (_pHeuristicsManager != nullptr && Configuration::GetCurrent()->EnableBitrateMonitor)
@@ -260,7 +267,7 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
         case Windows::Web::Http::HttpProgressStage::ReceivingHeaders:
 
           if (_pHeuristicsManager != nullptr) {
-            _measureid = _pHeuristicsManager->StartDownloadMeasure(_activeMeasure);
+            _pHeuristicsManager->MarkDownloadMeasureFirstByte(_measureid);
           }
           break;
 
@@ -281,6 +288,16 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
     {
       CHKTASK(currenttoken)
 
+      //conditional request - the resource has not changed since we last fetched it
+      if (response->StatusCode == HttpStatusCode::NotModified)
+      {
+        if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
+          _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
+        Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::NotModified));
+        LOG("Download Not Modified : " << this->DownloaderID);
+        return;
+      }
+
         response->EnsureSuccessStatusCode();
       {
         IBuffer^ buffer = create_task(response->Content->ReadAsBufferAsync(), task_options(currenttoken)).get();
@@ -291,7 +308,7 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
             throw ref new Platform::NullReferenceException();
           else
           {
-            if (_pHeuristicsManager != nullptr && !_measureid.empty())
+            if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
               _pHeuristicsManager->CompleteDownloadMeasure(_measureid, false, _activeMeasure);
 
             CHKTASK(currenttoken);
@@ -313,7 +330,7 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
       }
       catch (task_canceled tc)
       {
-        if (_pHeuristicsManager != nullptr && !_measureid.empty())
+        if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
           _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
 
         Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::Ok));
@@ -321,14 +338,14 @@ IAsyncAction^ DefaultContentDownloader::DownloadAsync()
       }
       catch (Platform::COMException^ comex)
       {
-        if (_pHeuristicsManager != nullptr && !_measureid.empty())
+        if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
           _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
         Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::BadRequest));
         LOG("Download Error : " << comex->Message->Data() << " [ " << this->DownloaderID << " ] ");
       }
       catch (...)
       {
-        if (_pHeuristicsManager != nullptr && !_measureid.empty())
+        if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
           _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
         Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::BadRequest));
         LOG("Download Error : " << this->DownloaderID);
@@ -355,20 +372,20 @@ if (_pHeuristicsManager != nullptr && Configuration::GetCurrent()->EnableBitrate
       {
         if (args->IsSuccessStatusCode == false)
         {
-          if (_pHeuristicsManager != nullptr && !_measureid.empty())
+          if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
             _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
           Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::Ok));
         }
         else
         {
-          if (_pHeuristicsManager != nullptr && !_measureid.empty())
+          if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
             _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
           Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::BadRequest));
         }
       }
 
 
-      if (_pHeuristicsManager != nullptr && !_measureid.empty())
+      if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
 		{
 		_pHeuristicsManager->UpdateDownloadMeasure(_measureid, buffer->Length, _activeMeasure);
         _pHeuristicsManager->CompleteDownloadMeasure(_measureid, false, _activeMeasure);
@@ -383,7 +400,7 @@ if (_pHeuristicsManager != nullptr && Configuration::GetCurrent()->EnableBitrate
     {
 
 
-      if (_pHeuristicsManager != nullptr && !_measureid.empty())
+      if (_pHeuristicsManager != nullptr && _measureid != INVALID_DOWNLOAD_MEASURE)
         _pHeuristicsManager->CompleteDownloadMeasure(_measureid, true);
       Error(this, ref new DefaultContentDownloadErrorArgs(HttpStatusCode::BadRequest));
 
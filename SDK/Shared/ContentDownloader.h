@@ -222,7 +222,7 @@ namespace Microsoft {
         Microsoft::HLSClient::Private::HeuristicsManager* _pHeuristicsManager;
         std::wstring _downloaderid;
         Microsoft::HLSClient::Private::TaskRegistry<void> _downloadtasks;
-        std::wstring _measureid;
+        unsigned int _measureid;
         bool _isbusy;
         unsigned long long _downloadedbytecount,_heuristicsupdatebytecounter;
         Microsoft::HLSClient::IHLSContentDownloader^ _externalDownloader;
@@ -97,7 +97,7 @@ task<HRESULT> EncryptionKey::DownloadKeyAsync(task_completion_event<HRESULT> tce
   std::map<wstring, wstring> headers;
   std::vector<shared_ptr<Cookie>> cookies;
   Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
-  wstring url = KeyUri;
+  wstring url = GetKeyUri();
   pParentPlaylist->cpMediaSource->cpController->RaisePrepareResourceRequest(ResourceType::KEY, url, cookies, headers,&external);
 
   DefaultContentDownloader^ downloader = ref new DefaultContentDownloader();
@@ -132,7 +132,10 @@ task<HRESULT> EncryptionKey::DownloadKeyAsync(task_completion_event<HRESULT> tce
         else
         {
           //in case of a redirect
-          KeyUri = args->ContentUri->AbsoluteUri->Data();
+          {
+            std::lock_guard<std::recursive_mutex> lock(LockKey);
+            KeyUri = args->ContentUri->AbsoluteUri->Data();
+          }
            
           this->OnKeyDownloadCompleted(MemoryCache, tceKeyDownloadCompleted);
         }
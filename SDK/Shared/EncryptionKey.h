@@ -60,6 +60,7 @@ namespace Microsoft {
         ///<summary>Initialization vector string from the playlist</summary>
         std::wstring InitializationVector;
         EncryptionMethod Method;
+        ///<summary>Absolute key URI - read through GetKeyUri() once the key is shared with the download path</summary>
         std::wstring KeyUri;
         ///<summary>Key Length</summary>
         unsigned long KeyLengthInBytes;
@@ -89,6 +90,20 @@ namespace Microsoft {
         ///<returns>A shared pointer to a vector of bytes representing the IV</returns>
         std::shared_ptr<std::vector<BYTE>> ToInitializationVector(unsigned int number);
 
+        std::wstring GetKeyUri()
+        {
+          std::lock_guard<std::recursive_mutex> lock(LockKey);
+          return KeyUri;
+        }
+        ///<summary>Points a key that has not been fetched yet at a different URI (e.g. the same key on a redundant stream)</summary>
+        ///<param name='uri'>The new key URI</param>
+        void RepointKeyUri(const std::wstring& uri)
+        {
+          std::lock_guard<std::recursive_mutex> lock(LockKey);
+          if (cpCryptoKey == nullptr && !uri.empty())
+            KeyUri = uri;
+        }
+
         ///<summary>
         ~EncryptionKey()
         {
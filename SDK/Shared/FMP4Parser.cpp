@@ -0,0 +1,623 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <algorithm>
+#include "FMP4Parser.h"
+#include "SampleData.h"
+#include "Timestamp.h"
+#include "BitOp.h"
+
+using namespace Microsoft::HLSClient;
+using namespace Microsoft::HLSClient::Private;
+
+//replaces the NAL unit length field in front of every NAL unit in a video sample
+static const BYTE NALUStartCode[4] = { 0x00, 0x00, 0x00, 0x01 };
+
+bool FMP4Parser::ReadBoxHeader(const BYTE *data, ULONG size, ULONG pos, ULONG& boxsize, unsigned int& boxtype, ULONG& headersize)
+{
+  if (pos > size || size - pos < 8)
+    return false;
+
+  unsigned long long sz = BitOp::ToInteger<unsigned int>(data + pos, 4);
+  boxtype = BitOp::ToInteger<unsigned int>(data + pos + 4, 4);
+  headersize = 8;
+  if (sz == 1) //64 bit size
+  {
+    if (size - pos < 16)
+      return false;
+    sz = BitOp::ToInteger<unsigned long long>(data + pos + 8, 8);
+    headersize = 16;
+  }
+  else if (sz == 0) //box runs to the end of the data
+    sz = size - pos;
+
+  if (sz < headersize || sz > size - pos)
+    return false;
+
+  boxsize = (ULONG) sz;
+  return true;
+}
+
+///<summary>Calls the handler for every box between start and end - stops at the first box that does not fit</summary>
+void FMP4Parser::ForEachBox(const BYTE *data, ULONG start, ULONG end, std::function<void(unsigned int boxtype, ULONG boxstart, ULONG payload, ULONG boxend)> handler)
+{
+  ULONG pos = start;
+  ULONG boxsize = 0, headersize = 0;
+  unsigned int boxtype = 0;
+  while (ReadBoxHeader(data, end, pos, boxsize, boxtype, headersize))
+  {
+    handler(boxtype, pos, pos + headersize, pos + boxsize);
+    pos += boxsize;
+  }
+}
+
+bool FMP4Parser::IsFragmentedMP4(const BYTE *data, ULONG size)
+{
+  ULONG boxsize = 0, headersize = 0;
+  unsigned int boxtype = 0;
+  if (data == nullptr || !ReadBoxHeader(data, size, 0, boxsize, boxtype, headersize))
+    return false;
+  return boxtype == BOX_STYP || boxtype == BOX_MOOF || boxtype == BOX_SIDX ||
+    boxtype == BOX_FTYP || boxtype == BOX_EMSG || boxtype == BOX_PRFT;
+}
+
+bool FMP4Parser::ParseInitSegment(const BYTE *data, ULONG size, std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks)
+{
+  //trex boxes can come before or after the trak boxes they apply to - hold on to them till we have read all the tracks
+  std::vector<tuple<unsigned int, unsigned int, unsigned int, unsigned int>> trexdefaults;
+
+  ForEachBox(data, 0, size, [&](unsigned int boxtype, ULONG, ULONG payload, ULONG boxend)
+  {
+    if (boxtype != BOX_MOOV) return;
+    ForEachBox(data, payload, boxend, [&](unsigned int childtype, ULONG, ULONG childpayload, ULONG childend)
+    {
+      if (childtype == BOX_TRAK)
+        ParseTrack(data, childpayload, childend, Tracks);
+      else if (childtype == BOX_MVEX)
+      {
+        ForEachBox(data, childpayload, childend, [&](unsigned int mvextype, ULONG, ULONG p, ULONG mvexend)
+        {
+          //version/flags(4), track_ID(4), default_sample_description_index(4), default_sample_duration(4), default_sample_size(4), default_sample_flags(4)
+          if (mvextype == BOX_TREX && mvexend - p >= 24)
+            trexdefaults.push_back(tuple<unsigned int, unsigned int, unsigned int, unsigned int>(
+            BitOp::ToInteger<unsigned int>(data + p + 4, 4), BitOp::ToInteger<unsigned int>(data + p + 12, 4),
+            BitOp::ToInteger<unsigned int>(data + p + 16, 4), BitOp::ToInteger<unsigned int>(data + p + 20, 4)));
+        });
+      }
+    });
+  });
+
+  for (auto itm : trexdefaults)
+  {
+    auto found = Tracks.find(std::get<0>(itm));
+    if (found == Tracks.end()) continue;
+    found->second->DefaultSampleDuration = std::get<1>(itm);
+    found->second->DefaultSampleSize = std::get<2>(itm);
+    found->second->DefaultSampleFlags = std::get<3>(itm);
+  }
+
+  //we only play audio and video tracks
+  for (auto itr = Tracks.begin(); itr != Tracks.end();)
+  {
+    if ((itr->second->Type != AUDIO && itr->second->Type != VIDEO) || itr->second->Timescale == 0)
+      itr = Tracks.erase(itr);
+    else
+      ++itr;
+  }
+
+  return !Tracks.empty();
+}
+
+void FMP4Parser::ParseTrack(const BYTE *data, ULONG start, ULONG end, std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks)
+{
+  auto track = std::make_shared<FMP4TrackInfo>();
+  bool hastrackid = false;
+
+  ForEachBox(data, start, end, [&](unsigned int boxtype, ULONG, ULONG p, ULONG boxend)
+  {
+    if (boxtype == BOX_TKHD && boxend - p >= 24)
+    {
+      //track_ID follows the creation and modification times - 32 bit times in version 0, 64 bit in version 1
+      track->TrackID = BitOp::ToInteger<unsigned int>(data + p + (data[p] == 1 ? 20 : 12), 4);
+      hastrackid = true;
+    }
+    else if (boxtype == BOX_MDIA)
+    {
+      ForEachBox(data, p, boxend, [&](unsigned int mdiatype, ULONG, ULONG mp, ULONG mdiaend)
+      {
+        if (mdiatype == BOX_MDHD && mdiaend - mp >= 24)
+          track->Timescale = BitOp::ToInteger<unsigned int>(data + mp + (data[mp] == 1 ? 20 : 12), 4);
+        else if (mdiatype == BOX_HDLR && mdiaend - mp >= 12)
+        {
+          auto handlertype = BitOp::ToInteger<unsigned int>(data + mp + 8, 4);
+          track->Type = handlertype == 0x76696465 ? VIDEO : (handlertype == 0x736F756E ? AUDIO : UNKNOWN); //'vide' or 'soun'
+        }
+        else if (mdiatype == BOX_MINF)
+        {
+          ForEachBox(data, mp, mdiaend, [&](unsigned int minftype, ULONG, ULONG np, ULONG minfend)
+          {
+            if (minftype != BOX_STBL) return;
+            ForEachBox(data, np, minfend, [&](unsigned int stbltype, ULONG, ULONG sp, ULONG stblend)
+            {
+              //version/flags(4) and entry_count(4) come before the sample entries
+              if (stbltype == BOX_STSD && stblend - sp > 8)
+                ParseSampleDescription(data, sp + 8, stblend, track);
+            });
+          });
+        }
+      });
+    }
+  });
+
+  if (hastrackid)
+    Tracks[track->TrackID] = track;
+}
+
+///<summary>Reads the codec setup from the first sample entry in a stsd box</summary>
+void FMP4Parser::ParseSampleDescription(const BYTE *data, ULONG start, ULONG end, shared_ptr<FMP4TrackInfo> track)
+{
+  ULONG boxsize = 0, headersize = 0;
+  unsigned int boxtype = 0;
+  if (!ReadBoxHeader(data, end, start, boxsize, boxtype, headersize))
+    return;
+
+  ULONG entrypayload = start + headersize;
+  ULONG entryend = start + boxsize;
+
+  if (boxtype == BOX_AVC1 || boxtype == BOX_AVC3 || boxtype == BOX_HVC1 || boxtype == BOX_HEV1)
+  {
+    track->IsHEVC = (boxtype == BOX_HVC1 || boxtype == BOX_HEV1);
+    //child boxes follow the 78 byte visual sample entry
+    if (entryend - entrypayload < 78) return;
+    ForEachBox(data, entrypayload + 78, entryend, [&](unsigned int childtype, ULONG, ULONG p, ULONG childend)
+    {
+      ULONG ctr = 0;
+      if (childtype == BOX_AVCC && childend - p >= 7)
+      {
+        track->NALULengthSize = (data[p + 4] & 0x3) + 1;
+        //SPS array then PPS array - each NALU with a 2 byte length
+        ctr = p + 5;
+        for (int arr = 0; arr < 2 && ctr < childend; arr++)
+        {
+          unsigned short count = arr == 0 ? (data[ctr] & 0x1F) : data[ctr];
+          ctr += 1;
+          for (unsigned short i = 0; i < count && ctr + 2 <= childend; i++)
+          {
+            unsigned short len = BitOp::ToInteger<unsigned short>(data + ctr, 2);
+            ctr += 2;
+            if (ctr + len > childend) return;
+            track->ParameterSets.insert(track->ParameterSets.end(), NALUStartCode, NALUStartCode + 4);
+            track->ParameterSets.insert(track->ParameterSets.end(), data + ctr, data + ctr + len);
+            ctr += len;
+          }
+        }
+      }
+      else if (childtype == BOX_HVCC && childend - p >= 23)
+      {
+        track->NALULengthSize = (data[p + 21] & 0x3) + 1;
+        BYTE numarrays = data[p + 22];
+        ctr = p + 23;
+        //each array is NAL unit type(1), NALU count(2) and then NALUs with a 2 byte length
+        for (BYTE arr = 0; arr < numarrays && ctr + 3 <= childend; arr++)
+        {
+          unsigned short count = BitOp::ToInteger<unsigned short>(data + ctr + 1, 2);
+          ctr += 3;
+          for (unsigned short i = 0; i < count && ctr + 2 <= childend; i++)
+          {
+            unsigned short len = BitOp::ToInteger<unsigned short>(data + ctr, 2);
+            ctr += 2;
+            if (ctr + len > childend) return;
+            track->ParameterSets.insert(track->ParameterSets.end(), NALUStartCode, NALUStartCode + 4);
+            track->ParameterSets.insert(track->ParameterSets.end(), data + ctr, data + ctr + len);
+            ctr += len;
+          }
+        }
+      }
+    });
+  }
+  else if (boxtype == BOX_MP4A)
+  {
+    //child boxes follow the 28 byte audio sample entry
+    if (entryend - entrypayload < 28) return;
+    ForEachBox(data, entrypayload + 28, entryend, [&](unsigned int childtype, ULONG, ULONG p, ULONG childend)
+    {
+      //skip version/flags
+      if (childtype == BOX_ESDS && childend - p > 4)
+        ParseAudioConfig(data, p + 4, childend, track);
+    });
+  }
+}
+
+///<summary>Walks the MPEG-4 descriptors in an esds box down to the AAC AudioSpecificConfig</summary>
+void FMP4Parser::ParseAudioConfig(const BYTE *data, ULONG start, ULONG end, shared_ptr<FMP4TrackInfo> track)
+{
+  ULONG ctr = start;
+  while (ctr + 2 <= end)
+  {
+    BYTE tag = data[ctr++];
+    //descriptor length is 1 to 4 bytes, 7 bits each
+    ULONG len = 0;
+    for (int i = 0; i < 4 && ctr < end; i++)
+    {
+      BYTE b = data[ctr++];
+      len = (len << 7) | (b & 0x7F);
+      if ((b & 0x80) == 0) break;
+    }
+
+    if (tag == 0x03) //ES_Descriptor - step in past ES_ID and the optional fields its flags call for
+    {
+      if (ctr + 3 > end) return;
+      BYTE flags = data[ctr + 2];
+      ctr += 3;
+      if (flags & 0x80) ctr += 2; //dependsOn_ES_ID
+      if ((flags & 0x40) && ctr < end) ctr += 1 + data[ctr]; //URL
+      if (flags & 0x20) ctr += 2; //OCR_ES_Id
+    }
+    else if (tag == 0x04) //DecoderConfigDescriptor - step in past the fixed fields
+      ctr += 13;
+    else if (tag == 0x05) //DecoderSpecificInfo - AudioSpecificConfig
+    {
+      if (len < 2 || ctr + 2 > end) return;
+      ParseAudioSpecificConfig(data + ctr, __min(len, end - ctr), track);
+      return;
+    }
+    else
+      ctr += len;
+  }
+}
+
+///<remarks>ISO/IEC 14496-3 1.6.2.1 - HE-AAC (AOT 5) and HE-AACv2 (AOT 29) signalled explicitly carry the SBR output rate and 
+///then the object type of the core, which is what the ADTS header has room for</remarks>
+void FMP4Parser::ParseAudioSpecificConfig(const BYTE *data, ULONG size, shared_ptr<FMP4TrackInfo> track)
+{
+  static const unsigned int Frequencies[] = { 96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350 };
+  ULONG bitpos = 0;
+
+  auto ReadBits = [&](unsigned int numbits, unsigned int& val)
+  {
+    if (bitpos + numbits > size * 8)
+      return false;
+    val = 0;
+    for (unsigned int i = 0; i < numbits; i++, bitpos++)
+      val = (val << 1) | ((data[bitpos >> 3] >> (7 - (bitpos & 0x7))) & 0x1);
+    return true;
+  };
+  //5 bits, with an escape to 6 more for the object types past 31
+  auto ReadObjectType = [&](unsigned int& aot)
+  {
+    if (!ReadBits(5, aot))
+      return false;
+    unsigned int ext = 0;
+    if (aot == 31)
+    {
+      if (!ReadBits(6, ext))
+        return false;
+      aot = 32 + ext;
+    }
+    return true;
+  };
+  //4 bit index, with an escape to an explicit 24 bit frequency - ADTS only takes the index, so use the closest one
+  auto ReadFrequencyIndex = [&](unsigned int& index)
+  {
+    if (!ReadBits(4, index))
+      return false;
+    unsigned int freq = 0;
+    if (index == 0xF)
+    {
+      if (!ReadBits(24, freq))
+        return false;
+      index = 0;
+      for (unsigned int i = 1; i < sizeof(Frequencies) / sizeof(Frequencies[0]); i++)
+      {
+        if ((freq > Frequencies[i] ? freq - Frequencies[i] : Frequencies[i] - freq) < (freq > Frequencies[index] ? freq - Frequencies[index] : Frequencies[index] - freq))
+          index = i;
+      }
+    }
+    return true;
+  };
+
+  unsigned int aot = 0, freqindex = 0, channels = 0, extaot = 0, extfreqindex = 0;
+  if (!ReadObjectType(aot) || !ReadFrequencyIndex(freqindex) || !ReadBits(4, channels))
+    return;
+
+  if (aot == 5 || aot == 29)
+  {
+    extaot = aot;
+    if (!ReadFrequencyIndex(extfreqindex) || !ReadObjectType(aot))
+      return;
+  }
+  else
+    extfreqindex = freqindex;
+
+  track->AudioObjectType = (BYTE) aot;
+  track->SamplingFrequencyIndex = (BYTE) freqindex;
+  track->ChannelConfiguration = (BYTE) channels;
+  track->ExtensionAudioObjectType = (BYTE) extaot;
+  track->ExtensionSamplingFrequencyIndex = (BYTE) extfreqindex;
+}
+
+void FMP4Parser::ParseFragment(const BYTE *data, ULONG size, ULONG moofstart, ULONG moofpayload, ULONG moofend,
+  const std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks, std::vector<FragmentSample>& Samples)
+{
+  ForEachBox(data, moofpayload, moofend, [&](unsigned int boxtype, ULONG, ULONG trafpayload, ULONG trafend)
+  {
+    if (boxtype != BOX_TRAF) return;
+
+    shared_ptr<FMP4TrackInfo> track = nullptr;
+    unsigned long long basedataoffset = moofstart;
+    //where the data for a trun without a data offset starts
+    unsigned long long nextdataoffset = moofstart;
+    unsigned long long decodetime = 0;
+    unsigned int defaultduration = 0, defaultsize = 0, defaultflags = 0;
+
+    ForEachBox(data, trafpayload, trafend, [&](unsigned int childtype, ULONG, ULONG p, ULONG childend)
+    {
+      if (childtype == BOX_TFHD && childend - p >= 8)
+      {
+        unsigned int flags = BitOp::ToInteger<unsigned int>(data + p, 4) & 0xFFFFFF;
+        auto found = Tracks.find(BitOp::ToInteger<unsigned int>(data + p + 4, 4));
+        track = found != Tracks.end() ? found->second : nullptr;
+        if (track == nullptr) return;
+
+        defaultduration = track->DefaultSampleDuration;
+        defaultsize = track->DefaultSampleSize;
+        defaultflags = track->DefaultSampleFlags;
+
+        ULONG ctr = p + 8;
+        //base-data-offset-present - otherwise offsets are from the start of the moof
+        if ((flags & 0x1) && ctr + 8 <= childend)
+        {
+          basedataoffset = BitOp::ToInteger<unsigned long long>(data + ctr, 8);
+          ctr += 8;
+        }
+        if (flags & 0x2) ctr += 4; //sample-description-index-present
+        if ((flags & 0x8) && ctr + 4 <= childend)
+        {
+          defaultduration = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+          ctr += 4;
+        }
+        if ((flags & 0x10) && ctr + 4 <= childend)
+        {
+          defaultsize = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+          ctr += 4;
+        }
+        if ((flags & 0x20) && ctr + 4 <= childend)
+          defaultflags = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+
+        nextdataoffset = basedataoffset;
+      }
+      else if (childtype == BOX_TFDT && track != nullptr && childend - p >= 8)
+      {
+        if (data[p] == 1)
+        {
+          if (childend - p >= 12)
+            decodetime = BitOp::ToInteger<unsigned long long>(data + p + 4, 8);
+        }
+        else
+          decodetime = BitOp::ToInteger<unsigned int>(data + p + 4, 4);
+      }
+      else if (childtype == BOX_TRUN && track != nullptr && childend - p >= 8)
+      {
+        BYTE version = data[p];
+        unsigned int flags = BitOp::ToInteger<unsigned int>(data + p, 4) & 0xFFFFFF;
+        unsigned int count = BitOp::ToInteger<unsigned int>(data + p + 4, 4);
+        ULONG ctr = p + 8;
+
+        unsigned long long dataoffset = nextdataoffset;
+        if ((flags & 0x1) && ctr + 4 <= childend) //data-offset-present
+        {
+          dataoffset = basedataoffset + (long long) (int) BitOp::ToInteger<unsigned int>(data + ctr, 4);
+          ctr += 4;
+        }
+        bool hasfirstflags = (flags & 0x4) != 0;
+        unsigned int firstflags = 0;
+        if (hasfirstflags && ctr + 4 <= childend)
+        {
+          firstflags = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+          ctr += 4;
+        }
+
+        unsigned int entrysize = ((flags & 0x100) ? 4 : 0) + ((flags & 0x200) ? 4 : 0) + ((flags & 0x400) ? 4 : 0) + ((flags & 0x800) ? 4 : 0);
+        if (ctr + (unsigned long long) count * entrysize > childend)
+          return;
+
+        for (unsigned int i = 0; i < count; i++)
+        {
+          unsigned int duration = defaultduration;
+          unsigned int samplesize = defaultsize;
+          unsigned int sampleflags = (i == 0 && hasfirstflags) ? firstflags : defaultflags;
+          long long cto = 0;
+          if (flags & 0x100)
+          {
+            duration = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+            ctr += 4;
+          }
+          if (flags & 0x200)
+          {
+            samplesize = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+            ctr += 4;
+          }
+          if (flags & 0x400)
+          {
+            sampleflags = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+            ctr += 4;
+          }
+          if (flags & 0x800)
+          {
+            //composition time offsets are signed in version 1
+            unsigned int val = BitOp::ToInteger<unsigned int>(data + ctr, 4);
+            cto = version == 0 ? (long long) val : (long long) (int) val;
+            ctr += 4;
+          }
+
+          if (dataoffset + samplesize > size) //sample runs past the end of the segment
+            return;
+
+          FragmentSample fs;
+          fs.TrackID = track->TrackID;
+          fs.Offset = (ULONG) dataoffset;
+          fs.Size = samplesize;
+          fs.DecodeTime = decodetime;
+          fs.CompositionOffset = cto;
+          fs.Flags = sampleflags;
+          Samples.push_back(fs);
+
+          dataoffset += samplesize;
+          decodetime += duration;
+        }
+        nextdataoffset = dataoffset;
+      }
+    });
+  });
+}
+
+void FMP4Parser::WriteADTSHeader(const FMP4TrackInfo& track, ULONG payloadsize, std::vector<BYTE>& FramingData)
+{
+  //7 byte header, no CRC
+  ULONG framelength = payloadsize + 7;
+  //ADTS has 2 bits for the profile (object type - 1) - HE-AAC goes out as its LC core at the core rate, and the decoder finds the 
+  //SBR/PS data in the raw frames (implicit signalling)
+  BYTE profile = (track.AudioObjectType >= 1 && track.AudioObjectType <= 4) ? track.AudioObjectType - 1 : 1;
+  FramingData.push_back(0xFF);
+  FramingData.push_back(0xF1);
+  FramingData.push_back((BYTE) (((profile & 0x3) << 6) | ((track.SamplingFrequencyIndex & 0xF) << 2) | ((track.ChannelConfiguration >> 2) & 0x1)));
+  FramingData.push_back((BYTE) (((track.ChannelConfiguration & 0x3) << 6) | ((framelength >> 11) & 0x3)));
+  FramingData.push_back((BYTE) ((framelength >> 3) & 0xFF));
+  FramingData.push_back((BYTE) (((framelength & 0x7) << 5) | 0x1F));
+  FramingData.push_back(0xFC);
+}
+
+void FMP4Parser::Parse(const BYTE *data, ULONG size,
+  const std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks,
+  std::map<ContentType, unsigned short>& MediaTypePIDMap,
+  std::map<ContentType, unsigned short> PIDFilter,
+  std::map<unsigned short, std::deque<std::shared_ptr<SampleData>>>& UnreadQueues,
+  std::vector<std::shared_ptr<Timestamp>>& Timeline,
+  std::vector<shared_ptr<SampleData>>& CCSamples,
+  std::map<unsigned short, ContentType>& DemuxedTracks,
+  std::vector<BYTE>& FramingData)
+{
+  std::vector<FragmentSample> samples;
+  ForEachBox(data, 0, size, [&](unsigned int boxtype, ULONG boxstart, ULONG payload, ULONG boxend)
+  {
+    if (boxtype == BOX_MOOF)
+      ParseFragment(data, size, boxstart, payload, boxend, Tracks, samples);
+  });
+
+  size_t audiosamplecount = 0;
+  for (auto& fs : samples)
+  {
+    auto type = Tracks.find(fs.TrackID)->second->Type;
+    DemuxedTracks[(unsigned short) fs.TrackID] = type;
+    if (type == AUDIO)
+      audiosamplecount++;
+  }
+
+  //pick a track for each media type - the one the filter names if we have it, else the lowest track ID
+  for (auto itm : DemuxedTracks)
+  {
+    auto foundinfilter = PIDFilter.find(itm.second);
+    if (foundinfilter != PIDFilter.end() && DemuxedTracks.find(foundinfilter->second) != DemuxedTracks.end() && DemuxedTracks[foundinfilter->second] == itm.second)
+      MediaTypePIDMap[itm.second] = foundinfilter->second;
+    else if (MediaTypePIDMap.find(itm.second) == MediaTypePIDMap.end())
+      MediaTypePIDMap[itm.second] = itm.first;
+  }
+
+  //size the framing buffer up front - the samples hold pointers into it
+  FramingData.clear();
+  FramingData.reserve(audiosamplecount * 7);
+
+  for (auto& fs : samples)
+  {
+    auto track = Tracks.find(fs.TrackID)->second;
+    unsigned short PID = (unsigned short) fs.TrackID;
+    const BYTE *sampledata = data + fs.Offset;
+
+    auto sd = std::make_shared<SampleData>();
+    long long pts = (long long) fs.DecodeTime + fs.CompositionOffset;
+    sd->SamplePTS = std::make_shared<Timestamp>(ToTicks(pts < 0 ? 0 : (unsigned long long) pts, track->Timescale));
+
+    if (track->Type == AUDIO)
+    {
+      WriteADTSHeader(*track, fs.Size, FramingData);
+      sd->elemData.push_back(tuple<const BYTE*, unsigned int>(&(*(FramingData.end() - 7)), 7));
+      sd->elemData.push_back(tuple<const BYTE*, unsigned int>(sampledata, fs.Size));
+      sd->TotalLen = fs.Size + 7;
+    }
+    else
+    {
+      //sample_is_non_sync_sample
+      sd->IsSampleIDR = (fs.Flags & 0x10000) == 0;
+      if (sd->IsSampleIDR && !track->ParameterSets.empty())
+      {
+        sd->elemData.push_back(tuple<const BYTE*, unsigned int>(&(*(track->ParameterSets.begin())), (unsigned int) track->ParameterSets.size()));
+        sd->TotalLen += (unsigned int) track->ParameterSets.size();
+      }
+
+      bool HasSEI = false;
+      ULONG ctr = 0;
+      while (ctr + track->NALULengthSize <= fs.Size)
+      {
+        ULONG nalulen = BitOp::ToInteger<ULONG>(sampledata + ctr, track->NALULengthSize);
+        ctr += track->NALULengthSize;
+        if (nalulen == 0 || nalulen > fs.Size - ctr)
+          break;
+
+        if (track->IsHEVC)
+        {
+          auto nal_unit_type = BitOp::ExtractBits(sampledata[ctr], 1, 6);
+          HasSEI = HasSEI || nal_unit_type == HEVCNALUType::HEVCNALUTYPE_PREFIX_SEI || nal_unit_type == HEVCNALUType::HEVCNALUTYPE_SUFFIX_SEI;
+        }
+        else
+          HasSEI = HasSEI || BitOp::ExtractBits(sampledata[ctr], 3, 5) == NALUType::NALUTYPE_SEI;
+
+        sd->elemData.push_back(tuple<const BYTE*, unsigned int>(NALUStartCode, 4));
+        sd->elemData.push_back(tuple<const BYTE*, unsigned int>(sampledata + ctr, nalulen));
+        sd->TotalLen += nalulen + 4;
+        ctr += nalulen;
+      }
+
+      //the NAL parsers copy the sample - only hand them the ones that can carry captions
+      if (HasSEI)
+      {
+        if (track->IsHEVC)
+          hevcparser.Parse(sd);
+        else
+          avcparser.Parse(sd);
+      }
+    }
+
+    UnreadQueues[PID].push_back(sd);
+    sd->Index = (unsigned int) UnreadQueues[PID].size() - 1;
+
+    if (MediaTypePIDMap[track->Type] == PID)
+    {
+      Timeline.push_back(sd->SamplePTS);
+      if (sd->spInBandCC != nullptr)
+        CCSamples.push_back(sd);
+    }
+  }
+
+  //samples are in track order and video is in decode order - the segment start is the earliest timestamp
+  std::sort(Timeline.begin(), Timeline.end(), [](const std::shared_ptr<Timestamp>& a, const std::shared_ptr<Timestamp>& b) { return a->ValueInTicks < b->ValueInTicks; });
+}
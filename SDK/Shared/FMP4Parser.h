@@ -0,0 +1,145 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include "pch.h"
+#include <deque>
+#include <map>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <wtypes.h>
+#include "TSConstants.h"
+#include "AVCParser.h"
+#include "HEVCParser.h"
+
+using namespace std;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      class Timestamp;
+      class SampleData;
+
+      enum MP4BoxType : unsigned int
+      {
+        BOX_FTYP = 0x66747970, BOX_STYP = 0x73747970, BOX_SIDX = 0x73696478, BOX_EMSG = 0x656D7367, BOX_PRFT = 0x70726674,
+        BOX_MOOV = 0x6D6F6F76, BOX_TRAK = 0x7472616B, BOX_TKHD = 0x746B6864, BOX_MDIA = 0x6D646961, BOX_MDHD = 0x6D646864,
+        BOX_HDLR = 0x68646C72, BOX_MINF = 0x6D696E66, BOX_STBL = 0x7374626C, BOX_STSD = 0x73747364, BOX_MVEX = 0x6D766578,
+        BOX_TREX = 0x74726578, BOX_AVC1 = 0x61766331, BOX_AVC3 = 0x61766333, BOX_AVCC = 0x61766343, BOX_HVC1 = 0x68766331,
+        BOX_HEV1 = 0x68657631, BOX_HVCC = 0x68766343, BOX_MP4A = 0x6D703461, BOX_ESDS = 0x65736473, BOX_MOOF = 0x6D6F6F66,
+        BOX_TRAF = 0x74726166, BOX_TFHD = 0x74666864, BOX_TFDT = 0x74666474, BOX_TRUN = 0x7472756E, BOX_MDAT = 0x6D646174
+      };
+
+      ///<summary>Codec setup and fragment defaults for one track - read from the moov box of an EXT-X-MAP initialization segment</summary>
+      class FMP4TrackInfo
+      {
+      public:
+        unsigned int TrackID;
+        ContentType Type;
+        bool IsHEVC;
+        ///<summary>Media timescale (units per second) from the mdhd box</summary>
+        unsigned int Timescale;
+        unsigned int DefaultSampleDuration;
+        unsigned int DefaultSampleSize;
+        unsigned int DefaultSampleFlags;
+        ///<summary>Size in bytes of the length field in front of every NAL unit in a video sample</summary>
+        unsigned short NALULengthSize;
+        ///<summary>SPS and PPS (VPS, SPS and PPS for HEVC) from avcC/hvcC, each with a start code - sent ahead of every sync sample</summary>
+        std::vector<BYTE> ParameterSets;
+        ///<summary>From the AAC AudioSpecificConfig - used to write the ADTS header on each audio sample. For HE-AAC these describe 
+        ///the core (AAC LC) stream</summary>
+        BYTE AudioObjectType;
+        BYTE SamplingFrequencyIndex;
+        BYTE ChannelConfiguration;
+        ///<summary>5 (SBR) or 29 (SBR and PS) when the config signals HE-AAC explicitly, else 0</summary>
+        BYTE ExtensionAudioObjectType;
+        ///<summary>Output sampling frequency index of the SBR extension</summary>
+        BYTE ExtensionSamplingFrequencyIndex;
+
+        FMP4TrackInfo(unsigned int trackid = 0) : TrackID(trackid), Type(ContentType::UNKNOWN), IsHEVC(false), Timescale(0),
+          DefaultSampleDuration(0), DefaultSampleSize(0), DefaultSampleFlags(0), NALULengthSize(4),
+          AudioObjectType(2), SamplingFrequencyIndex(4), ChannelConfiguration(2), ExtensionAudioObjectType(0), ExtensionSamplingFrequencyIndex(4)
+        {}
+      };
+
+      ///<summary>Parses fragmented MP4 (CMAF) media segments into the same sample queues and timeline the transport stream parser produces</summary>
+      ///<remarks>Sample payloads are not copied - each sample points at its bytes in the mdat box. Video NAL length fields are replaced with start codes and
+      ///audio samples get an ADTS header, so the samples look the same to the media streams as the ones demuxed from a transport stream</remarks>
+      class FMP4Parser
+      {
+      private:
+        ///<summary>One sample described by a trun box</summary>
+        struct FragmentSample
+        {
+          unsigned int TrackID;
+          ULONG Offset;
+          ULONG Size;
+          unsigned long long DecodeTime;
+          long long CompositionOffset;
+          unsigned int Flags;
+        };
+
+        AVCParser avcparser;
+        HEVCParser hevcparser;
+
+        static bool ReadBoxHeader(const BYTE *data, ULONG size, ULONG pos, ULONG& boxsize, unsigned int& boxtype, ULONG& headersize);
+        static void ForEachBox(const BYTE *data, ULONG start, ULONG end, std::function<void(unsigned int boxtype, ULONG boxstart, ULONG payload, ULONG boxend)> handler);
+        static void ParseTrack(const BYTE *data, ULONG start, ULONG end, std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks);
+        static void ParseSampleDescription(const BYTE *data, ULONG start, ULONG end, shared_ptr<FMP4TrackInfo> track);
+        static void ParseAudioConfig(const BYTE *data, ULONG start, ULONG end, shared_ptr<FMP4TrackInfo> track);
+        static void ParseAudioSpecificConfig(const BYTE *data, ULONG size, shared_ptr<FMP4TrackInfo> track);
+        static void ParseFragment(const BYTE *data, ULONG size, ULONG moofstart, ULONG moofpayload, ULONG moofend,
+          const std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks, std::vector<FragmentSample>& Samples);
+        static void WriteADTSHeader(const FMP4TrackInfo& track, ULONG payloadsize, std::vector<BYTE>& FramingData);
+
+        ///<summary>Converts a value in a track timescale to 100ns ticks</summary>
+        static unsigned long long ToTicks(unsigned long long value, unsigned int timescale)
+        {
+          return (value / timescale) * 10000000ULL + ((value % timescale) * 10000000ULL) / timescale;
+        }
+      public:
+        ///<summary>True if the data starts with a box a CMAF media segment can start with</summary>
+        static bool IsFragmentedMP4(const BYTE *data, ULONG size);
+
+        ///<summary>Reads the tracks from the moov box of an initialization segment</summary>
+        ///<returns>False if no audio or video track was found</returns>
+        static bool ParseInitSegment(const BYTE *data, ULONG size, std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks);
+
+        ///<summary>Builds samples for every audio and video track in the segment</summary>
+        ///<remarks>The lowest track ID of each media type (or the one PIDFilter names) is mapped, same as a PID in a transport stream.
+        ///Track IDs stand in for PIDs in the maps. ADTS headers are written to FramingData, which has to stay alive as long as the samples do</remarks>
+        void Parse(const BYTE *data, ULONG size,
+          const std::map<unsigned int, shared_ptr<FMP4TrackInfo>>& Tracks,
+          std::map<ContentType, unsigned short>& MediaTypePIDMap,
+          std::map<ContentType, unsigned short> PIDFilter,
+          std::map<unsigned short, std::deque<std::shared_ptr<SampleData>>>& UnreadQueues,
+          std::vector<std::shared_ptr<Timestamp>>& Timeline,
+          std::vector<shared_ptr<SampleData>>& CCSamples,
+          std::map<unsigned short, ContentType>& DemuxedTracks,
+          std::vector<BYTE>& FramingData);
+      };
+    }
+  }
+}
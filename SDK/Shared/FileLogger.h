@@ -25,15 +25,19 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #define LOGGER_INCL
 #include <pch.h>
 #include <memory>
-#include <ppltasks.h>
 #include <sstream>
 #include <string> 
+#ifdef __cplusplus_winrt
+#include <ppltasks.h>
 #include <windows.storage.h>  
 #include <windows.applicationmodel.core.h>
 #include <windows.ui.core.h> 
+#endif
 
 using namespace std;
+#ifdef __cplusplus_winrt
 using namespace Concurrency;
+#endif
 
 
 #if defined(_VSLOG) && defined(LOGGER_INCL) && defined(_DEBUG)
@@ -182,6 +186,8 @@ if(!(cond))\
 
 #endif
 
+//the file logger writes through WinRT storage - the portable (parser only) build just gets the no-op macros above
+#ifdef __cplusplus_winrt
 namespace Microsoft {
   namespace HLSClient {
     namespace Private {
@@ -260,4 +266,5 @@ namespace Microsoft {
 
     }
   }
-} 
\ No newline at end of file
+}
+#endif
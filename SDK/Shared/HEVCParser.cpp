@@ -0,0 +1,120 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h" 
+#include "HEVCParser.h" 
+#include "SampleData.h" 
+
+using namespace Microsoft::HLSClient;
+using namespace Microsoft::HLSClient::Private;
+
+void HEVCParser::Parse(shared_ptr<SampleData> spsd)
+{
+
+  std::vector<BYTE> ElemDataBuff;
+  for (auto itr = spsd->elemData.begin(); itr != spsd->elemData.end(); itr++)
+  {
+    auto oldSize = ElemDataBuff.size();
+    if (std::get<1>(*itr) > 0)
+    {
+      ElemDataBuff.resize(oldSize + std::get<1>(*itr));
+      memcpy_s(&(*(ElemDataBuff.begin() + oldSize)), std::get<1>(*itr), std::get<0>(*itr), std::get<1>(*itr));
+    }
+  }
+
+  if (ElemDataBuff.empty())
+    return;
+
+  const BYTE* elemData = &(*(ElemDataBuff.begin()));
+
+
+  unsigned int size = (unsigned int) ElemDataBuff.size();
+  unsigned int readbytecount = 0;
+
+  //parameter sets found in this access unit - we only keep them if we get all three
+  std::vector<BYTE> paramsets;
+  bool foundvps = false, foundsps = false, foundpps = false;
+
+  //skip leading zero bytes and position on first prefix
+  while (readbytecount + 3 < size && elemData[readbytecount] == 0x00 && BitOp::ToInteger<unsigned int>(elemData + readbytecount, 3) != 0x000001)
+    ++readbytecount;
+
+  if (readbytecount + 4 >= size) //nothing to parse
+    return;
+
+  while (true)
+  {
+
+    unsigned int NumBytesInNALUnit = 0;
+    unsigned int BitSequenceMatchPos = 0;
+    //find the next prefix match - after this prefix
+    if (AVCParser::FindNextMatchingBitSequence(0x000001, 3, readbytecount + 3, elemData, size, BitSequenceMatchPos) == true)
+      //if found - find the number of bytes in the NALU
+      NumBytesInNALUnit = BitSequenceMatchPos - readbytecount;
+    else
+      NumBytesInNALUnit = size - readbytecount;
+
+    //the NALU header is 2 bytes - skip over the forbidden bit (1 bit) to get nal_unit_type (6 bits)
+    auto nal_unit_type = BitOp::ExtractBits(elemData[readbytecount + 3], 1, 6);
+
+    if (HEVCParser::IsRandomAccessPoint(nal_unit_type))
+    {
+      spsd->IsSampleIDR = true;
+    }
+    else if (nal_unit_type == HEVCNALUType::HEVCNALUTYPE_PREFIX_SEI || nal_unit_type == HEVCNALUType::HEVCNALUTYPE_SUFFIX_SEI)
+    {
+      auto spsei = std::make_shared<SupplementalInfo>(elemData + readbytecount, NumBytesInNALUnit, 2);
+      spsei->Parse();
+      if (spsei->PayloadType == SEIType::SEITYPE_ITUT_T35 && spsei->spMsgITUT_T35 != nullptr)
+      {
+        spsd->spInBandCC = make_shared<tuple<shared_ptr<BYTE>, unsigned int>>(
+          shared_ptr<BYTE>(spsei->spMsgITUT_T35->Payload.release(), [](BYTE *data) { delete[] data; }),//provide deleter for shared_ptr
+          spsei->spMsgITUT_T35->PayloadSize);
+      }
+    }
+    else if (ParameterSets.empty() &&
+      (nal_unit_type == HEVCNALUType::HEVCNALUTYPE_VPS || nal_unit_type == HEVCNALUType::HEVCNALUTYPE_SPS || nal_unit_type == HEVCNALUType::HEVCNALUTYPE_PPS))
+    {
+      static const BYTE startcode[] = { 0x00, 0x00, 0x00, 0x01 };
+      paramsets.insert(paramsets.end(), startcode, startcode + 4);
+      paramsets.insert(paramsets.end(), elemData + readbytecount + 3, elemData + readbytecount + NumBytesInNALUnit);
+      if (nal_unit_type == HEVCNALUType::HEVCNALUTYPE_VPS)
+        foundvps = true;
+      else if (nal_unit_type == HEVCNALUType::HEVCNALUTYPE_SPS)
+        foundsps = true;
+      else
+        foundpps = true;
+    }
+
+    //done processing
+    readbytecount += NumBytesInNALUnit;
+
+    if (BitSequenceMatchPos == size || size - readbytecount <= 4) //we did not find the start of another NALU last time we checked - or nothing else left to parse
+      break;
+  }
+
+  if (foundvps && foundsps && foundpps)
+    ParameterSets = std::move(paramsets);
+
+  return;
+
+}
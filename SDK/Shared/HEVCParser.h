@@ -22,36 +22,47 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 ***********************************************************************************************************************/
 #pragma once
 
-#include <mutex>
-#include <map>
+#include "pch.h"
+#include <memory>
 #include <vector>
+#include <wtypes.h>
+#include "AVCParser.h"
+
+
+using namespace std;
 
-#include "pch.h"
-#include "Timestamp.h"
 
-namespace Microsoft { namespace CC608 {
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
 
-  // stores incoming raw caption data--external components add data to the queue, and the 
-  // processing thread gets the data as needed
-  class CaptionDataQueue
-  {
-  typedef std::map<Timestamp, std::vector<byte_t>> captiondataqueuemap_t;
 
-  public:
-    CaptionDataQueue(void);
-    ~CaptionDataQueue(void);
+      class SampleData;
 
-    void AddCaptionData(const Timestamp ts, const std::vector<byte_t>& captionByteData);
-    void AddCaptionData(const std::vector<std::pair<Timestamp, std::vector<byte_t>>>& data);
 
-    std::vector<byte_t> GetSortedCaptionData(const Timestamp startTs, const Timestamp endTs);
+      enum HEVCNALUType : short
+      {
+        HEVCNALUTYPE_BLA_W_LP = 16, HEVCNALUTYPE_BLA_W_RADL = 17, HEVCNALUTYPE_BLA_N_LP = 18,
+        HEVCNALUTYPE_IDR_W_RADL = 19, HEVCNALUTYPE_IDR_N_LP = 20, HEVCNALUTYPE_CRA = 21,
+        HEVCNALUTYPE_VPS = 32, HEVCNALUTYPE_SPS = 33, HEVCNALUTYPE_PPS = 34, HEVCNALUTYPE_AUD = 35,
+        HEVCNALUTYPE_PREFIX_SEI = 39, HEVCNALUTYPE_SUFFIX_SEI = 40
+      };
 
-    // clears the data in the queue (used when seeking in a stream or when switching media sources)
-    void Clear();
+      ///<summary>Parses HEVC(H.265) access units</summary>
+      ///<remarks>Marks random access points (IDR, CRA and BLA pictures) as key frames, extracts captions from SEI user data and collects the parameter sets the decoder needs to start</remarks>
+      class HEVCParser
+      {
+      public:
+        ///<summary>VPS, SPS and PPS (each with a start code) from the first access unit that carried all three</summary>
+        std::vector<BYTE> ParameterSets;
 
-  private:
-    std::mutex _mtx;
-    captiondataqueuemap_t _map;
-  };
+        void Parse(shared_ptr<SampleData> spsd);
 
-}}
\ No newline at end of file
+        static bool IsRandomAccessPoint(unsigned short nal_unit_type)
+        {
+          return nal_unit_type >= HEVCNALUType::HEVCNALUTYPE_BLA_W_LP && nal_unit_type <= HEVCNALUType::HEVCNALUTYPE_CRA;
+        }
+      };
+    }
+  }
+}
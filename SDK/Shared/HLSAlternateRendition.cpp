@@ -218,15 +218,19 @@ Windows::Foundation::Collections::IVector<IHLSSubtitleLocator^>^ HLSSubtitleRend
 
 	auto pRenditionObj = _internalRenditionImpl->_controller->MediaSource->spRootPlaylist->Variants[_internalRenditionImpl->_bitratekey]->SubtitleRenditions->at(_internalRenditionImpl->_index);
 
-	if (pRenditionObj->spPlaylist == nullptr || pRenditionObj->spPlaylist->Segments.size() == 0)
+	if (pRenditionObj->spPlaylist == nullptr)
 		return nullptr;
 
-	auto count = (unsigned int) pRenditionObj->spPlaylist->Segments.size();
+	auto snapshot = pRenditionObj->spPlaylist->GetSegmentSnapshot();
+	if (snapshot->size() == 0)
+		return nullptr;
+
+	auto count = (unsigned int) snapshot->size();
 	auto retval = ref new Platform::Collections::Vector<IHLSSubtitleLocator^>(count);
 
-	std::transform(begin(pRenditionObj->spPlaylist->Segments), end(pRenditionObj->spPlaylist->Segments), begin(retval), [](shared_ptr<MediaSegment> seg)
+	std::transform(begin(*snapshot), end(*snapshot), begin(retval), [](shared_ptr<MediaSegment> seg)
 	{
-		return ref new HLSSubtitleLocator(seg->MediaUri, seg->SequenceNumber, (float) seg->StartPTSNormalized->ValueInTicks / 10000000, (float) seg->Duration / 10000000);
+		return ref new HLSSubtitleLocator(seg->GetMediaUri(), seg->SequenceNumber, (float) seg->StartPTSNormalized->ValueInTicks / 10000000, (float) seg->Duration / 10000000);
 	});
 
 	return retval;
@@ -251,7 +255,7 @@ Windows::Foundation::IAsyncOperation<unsigned int>^ HLSSubtitleRendition::Refres
 			pRenditionObj->DownloadRenditionPlaylistAsync().get();
 			pRenditionObj->spPlaylist->MergeAlternateRenditionPlaylist();
 		}
-		return (unsigned int) pRenditionObj->spPlaylist->Segments.size();
+		return (unsigned int) pRenditionObj->spPlaylist->GetSegmentSnapshot()->size();
 	});
 }
 
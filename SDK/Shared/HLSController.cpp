@@ -25,6 +25,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Playlist.h"
 #include "HLSResourceRequestEventArgs.h"
 #include "HLSInitialBitrateSelectedEventArgs.h"
+#include "HLSStartupMetrics.h"
+#include "HLSLockContentionMetrics.h"
 #include "HLSPlaylist.h" 
 #include "HLSController.h"
 #include "HLSVariantStream.h"
@@ -113,6 +115,23 @@ unsigned int HLSController::GetLastMeasuredBandwidth()
   else
     return 0;
 }
+
+///<summary>Returns the time spent in each startup phase - nullptr till the first sample has been delivered</summary>
+IHLSStartupMetrics^ HLSController::GetStartupMetrics()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  std::lock_guard<recursive_mutex> lock(this->MediaSource->LockStartupTimes);
+  if (this->MediaSource->StartupTimes.FirstSampleDelivered == 0)
+    return nullptr;
+  return ref new HLSStartupMetrics(this->MediaSource->StartupTimes);
+}
+
+///<summary>Returns how often the sample path locks were taken, and how often the taker had to wait, since the source was created</summary>
+IHLSLockContentionMetrics^ HLSController::GetLockContentionMetrics()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return ref new HLSLockContentionMetrics(this->MediaSource->LockContention);
+}
 Windows::Foundation::TimeSpan HLSController::MinimumBufferLength::get()
 {
 
@@ -126,6 +145,17 @@ void HLSController::MinimumBufferLength::set(Windows::Foundation::TimeSpan val)
   Configuration::GetCurrent()->SetLABLengthInTicks((unsigned long long)val.Duration);
 }
 
+unsigned long long HLSController::MaximumBufferSizeInBytes::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->MaximumBufferSizeInBytes;
+}
+void HLSController::MaximumBufferSizeInBytes::set(unsigned long long val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->MaximumBufferSizeInBytes = val;
+}
+
 Windows::Foundation::TimeSpan HLSController::PrefetchDuration::get()
 {
 
@@ -262,6 +292,61 @@ void HLSController::UpshiftBitrateInSteps::set(bool val)
   Configuration::GetCurrent()->UpshiftBitrateInSteps = val;
 }
 
+bool HLSController::EnableFastStart::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->EnableFastStart;
+}
+void HLSController::EnableFastStart::set(bool val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->EnableFastStart = val;
+}
+
+bool HLSController::EnableLowLatencyLive::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->EnableLowLatencyLive;
+}
+void HLSController::EnableLowLatencyLive::set(bool val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->EnableLowLatencyLive = val;
+}
+
+bool HLSController::EnableLiveCatchup::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->EnableLiveCatchup;
+}
+void HLSController::EnableLiveCatchup::set(bool val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->EnableLiveCatchup = val;
+}
+
+bool HLSController::DemuxAllElementaryStreams::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->DemuxAllElementaryStreams;
+}
+void HLSController::DemuxAllElementaryStreams::set(bool val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->DemuxAllElementaryStreams = val;
+}
+
+bool HLSController::SwitchBitrateOnSegmentBoundary::get()
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  return Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary;
+}
+void HLSController::SwitchBitrateOnSegmentBoundary::set(bool val)
+{
+  if (!IsValid)  throw ref new Platform::ObjectDisposedException();
+  Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary = val;
+}
+
 bool HLSController::ForceKeyFrameMatchOnSeek::get()
 {
   if (!IsValid)  throw ref new Platform::ObjectDisposedException();
@@ -148,6 +148,12 @@ namespace Microsoft {
           virtual void set(Windows::Foundation::TimeSpan val);
         }
 
+        property unsigned long long MaximumBufferSizeInBytes
+        {
+          virtual unsigned long long get();
+          virtual void set(unsigned long long val);
+        }
+
         property Windows::Foundation::TimeSpan MinimumLiveLatency
         {
           virtual Windows::Foundation::TimeSpan get();
@@ -214,6 +220,36 @@ namespace Microsoft {
           virtual void set(bool val);
         }
 
+        property bool EnableFastStart
+        {
+          virtual bool get();
+          virtual void set(bool val);
+        }
+
+        property bool EnableLowLatencyLive
+        {
+          virtual bool get();
+          virtual void set(bool val);
+        }
+
+        property bool EnableLiveCatchup
+        {
+          virtual bool get();
+          virtual void set(bool val);
+        }
+
+        property bool DemuxAllElementaryStreams
+        {
+          virtual bool get();
+          virtual void set(bool val);
+        }
+
+        property bool SwitchBitrateOnSegmentBoundary
+        {
+          virtual bool get();
+          virtual void set(bool val);
+        }
+
         property bool AllowSegmentSkipOnSegmentFailure
         {
           virtual bool get();
@@ -248,6 +284,8 @@ namespace Microsoft {
         virtual void Unlock();
         virtual void BatchPlaylists(Windows::Foundation::Collections::IVector<Platform::String^>^ BatchUrls);
         virtual unsigned int GetLastMeasuredBandwidth();
+        virtual IHLSStartupMetrics^ GetStartupMetrics();
+        virtual IHLSLockContentionMetrics^ GetLockContentionMetrics();
 
       };
     }
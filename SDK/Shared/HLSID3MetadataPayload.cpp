@@ -27,47 +27,28 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ID3TagParser.h"  
 #include "HLSID3MetadataPayload.h"
 #include "HLSID3TagFrame.h"
+#include "ID3MetadataTimeline.h"
 
 using namespace Microsoft::HLSClient;
 using namespace Microsoft::HLSClient::Private;
 
 HLSID3MetadataPayload::HLSID3MetadataPayload(unsigned long long timestamp, vector<tuple<const BYTE*, unsigned int>>& payloadchunks) :_timestamp(timestamp), _parsedFrames(nullptr)
 {
-  for (auto itr = payloadchunks.begin(); itr != payloadchunks.end(); itr++)
-  {
-    auto data = std::get<0>(*itr);
-    auto len = std::get<1>(*itr);
-    if (len == 0)
-      continue;
-
-    auto oldsize = _payload.size();
-    _payload.resize(_payload.size() + len);
-    memcpy_s(&(*(_payload.begin() + oldsize)), len, data, len);
-  }
-
   //validate for  ID3 and readjust
-  ULONG correctsize = 0;
-  ULONG startat = 0;
-  bool valid = ID3TagParser::AdjustPayloadToID3Tag(&(*(this->_payload.begin())), (ULONG)this->_payload.size(), startat, correctsize);
-  if (!valid)
+  if (!ID3TagParser::ExtractTag(payloadchunks, _payload))
     throw ref new Platform::InvalidArgumentException();
+}
 
-  if (startat > 0)
-  {
-    for (ULONG i = 0; i < startat; i++)
-      this->_payload.erase(this->_payload.begin());
-  }
-  if (correctsize > _payload.size())
-    throw ref new Platform::InvalidArgumentException();
-  else if (correctsize < _payload.size())
-    _payload.resize(correctsize);
+HLSID3MetadataPayload::HLSID3MetadataPayload(shared_ptr<ID3MetadataCue> cue) :_timestamp(cue->TimeInTicks), _payload(cue->Payload), _frames(cue->Frames), _parsedFrames(nullptr)
+{
 }
 
 Windows::Foundation::Collections::IVector<IHLSID3TagFrame^>^ HLSID3MetadataPayload::ParseFrames()
 {
   if (_parsedFrames == nullptr && _payload.size() > 0)
   {
-    auto frames = ID3TagParser::Parse(&(*(_payload.begin())), (ULONG) _payload.size());
+    //frames that were already parsed when the segment was indexed are not parsed again
+    auto frames = _frames.size() > 0 ? _frames : ID3TagParser::Parse(&(*(_payload.begin())), (ULONG) _payload.size());
     if (frames.size() > 0)
     { 
       _parsedFrames = ref new Platform::Collections::Vector<IHLSID3TagFrame^>((unsigned int)frames.size());
@@ -25,6 +25,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #include <vector>
 #include <tuple>
+#include <memory>
+#include <string>
 #include "Interfaces.h" 
 
 using namespace std;
@@ -34,6 +36,7 @@ namespace Microsoft {
   namespace HLSClient {
     namespace Private {
        
+      struct ID3MetadataCue;
 
       [Windows::Foundation::Metadata::Threading(Windows::Foundation::Metadata::ThreadingModel::Both)]
       [Windows::Foundation::Metadata::MarshalingBehavior(Windows::Foundation::Metadata::MarshalingType::Agile)]
@@ -42,9 +45,11 @@ namespace Microsoft {
       private:
         unsigned long long _timestamp;
         std::vector<BYTE> _payload;
+        std::vector<shared_ptr<tuple<string, std::vector<BYTE>>>> _frames;
         Windows::Foundation::Collections::IVector<IHLSID3TagFrame^>^ _parsedFrames;
       internal:
         HLSID3MetadataPayload(unsigned long long timestamp, std::vector<tuple<const BYTE*, unsigned int>>& payloadChunks);
+        HLSID3MetadataPayload(shared_ptr<ID3MetadataCue> cue);
       public:
      
 
@@ -0,0 +1,67 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+#include "pch.h"
+#include <collection.h>
+#include <ppltasks.h>
+#include "ContentDownloader.h"
+#include "HLSInbandCCPayload.h"
+#include "HLSInbandCCExtractor.h"
+
+using namespace Concurrency;
+using namespace Platform;
+using namespace Microsoft::HLSClient;
+using namespace Microsoft::HLSClient::Private;
+
+Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^ HLSInbandCCExtractor::ToPayloads(const std::vector<InbandCCExtractor::ccunit_t>& units, unsigned long long startpts)
+{
+  auto ret = ref new Platform::Collections::Vector<IHLSInbandCCPayload^>();
+  for (auto& unit : units)
+  {
+    auto ts = std::get<0>(unit);
+    ret->Append(ref new HLSInbandCCPayload(ts < startpts ? 0 : ts - startpts, std::get<1>(unit), std::get<2>(unit)));
+  }
+  return ret;
+}
+
+Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^ HLSInbandCCExtractor::Extract(const BYTE *tsdata, unsigned int size, unsigned long long startpts)
+{
+  std::vector<InbandCCExtractor::ccunit_t> units;
+  if (FAILED(InbandCCExtractor::ExtractFromTransportStream(tsdata, size, units)))
+    throw ref new Platform::InvalidArgumentException("Segment data is not a transport stream");
+  return ToPayloads(units, startpts);
+}
+
+Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^>^ HLSInbandCCExtractor::ExtractFromTransportStreamAsync(Windows::Storage::Streams::IBuffer^ segment)
+{
+  if (segment == nullptr)
+    throw ref new Platform::InvalidArgumentException("segment");
+
+  //copy on the calling thread - the caller may reuse the buffer once we return
+  auto data = make_shared<std::vector<BYTE>>(DefaultContentDownloader::BufferToVector(segment));
+
+  return create_async([data]()
+  {
+    return Extract(data->data(), (unsigned int) data->size(), 0);
+  });
+}
@@ -0,0 +1,55 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include "Interfaces.h"
+#include "InbandCCExtractor.h"
+
+namespace Microsoft {
+  namespace HLSClient {
+
+    ///<summary>Extracts in-band (CEA-608/708 in H.264/HEVC SEI) caption data from transport stream segments without playing them</summary>
+    ///<remarks>The payloads are the same user data envelopes IHLSSegment::GetInbandCCUnits() hands out during playback, so they can be fed
+    ///straight to a caption decoder or exporter. Segments that belong to an open presentation can be fetched and decrypted by the SDK 
+    ///through IHLSSegment::ExtractInbandCCUnitsAsync() instead.</remarks>
+    [Windows::Foundation::Metadata::Threading(Windows::Foundation::Metadata::ThreadingModel::Both)]
+    [Windows::Foundation::Metadata::MarshalingBehavior(Windows::Foundation::Metadata::MarshalingType::Agile)]
+    public ref class HLSInbandCCExtractor sealed
+    {
+    internal:
+      HLSInbandCCExtractor() {}
+      ///<summary>Wraps extracted caption units, shifting the timestamps back by startpts (clamped at 0)</summary>
+      static Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^ ToPayloads(const std::vector<Private::InbandCCExtractor::ccunit_t>& units, unsigned long long startpts);
+      ///<summary>Demuxes a (decrypted) segment and wraps its caption units - throws InvalidArgumentException if it is not a transport stream</summary>
+      static Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^ Extract(const BYTE *tsdata, unsigned int size, unsigned long long startpts);
+    public:
+      ///<summary>Demuxes a complete, unencrypted transport stream segment and returns its caption payloads in decode order</summary>
+      ///<param name='segment'>The segment data</param>
+      ///<returns>The caption payloads, timestamped with the (un-normalized) presentation timestamps of their video samples</returns>
+      static Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^>^ ExtractFromTransportStreamAsync(Windows::Storage::Streams::IBuffer^ segment);
+    };
+  }
+}
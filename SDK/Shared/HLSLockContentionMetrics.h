@@ -0,0 +1,84 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "Interfaces.h"
+#include "LockContention.h"
+
+using namespace Microsoft::HLSClient;
+
+namespace Microsoft{
+  namespace HLSClient{
+    namespace Private {
+
+      ///<summary>Snapshot of the sample path lock contention of a media source</summary>
+      [Windows::Foundation::Metadata::Threading(Windows::Foundation::Metadata::ThreadingModel::Both)]
+      [Windows::Foundation::Metadata::MarshalingBehavior(Windows::Foundation::Metadata::MarshalingType::Agile)]
+      public ref class HLSLockContentionMetrics sealed : public IHLSLockContentionMetrics
+      {
+      private:
+        unsigned long long _segmentacquisitions, _segmentcontentions;
+        unsigned long long _trackingacquisitions, _trackingcontentions;
+        unsigned long long _switchacquisitions, _switchcontentions;
+
+      internal:
+        HLSLockContentionMetrics(const SamplePathLockContention& contention) :
+          _segmentacquisitions(contention.LockSegment.Acquisitions.load()), _segmentcontentions(contention.LockSegment.Contentions.load()),
+          _trackingacquisitions(contention.LockSegmentTracking.Acquisitions.load()), _trackingcontentions(contention.LockSegmentTracking.Contentions.load()),
+          _switchacquisitions(contention.LockSwitch.Acquisitions.load()), _switchcontentions(contention.LockSwitch.Contentions.load())
+        {
+        }
+
+      public:
+        ///<summary>MediaSegment::LockSegment, taken on sample reads, EOS checks and IDR lookups</summary>
+        property unsigned long long SegmentLockAcquisitions
+        {
+          virtual unsigned long long get() { return _segmentacquisitions; }
+        }
+        property unsigned long long SegmentLockContentions
+        {
+          virtual unsigned long long get() { return _segmentcontentions; }
+        }
+        ///<summary>Playlist::LockSegmentTracking, taken to find the current segment for every sample</summary>
+        property unsigned long long SegmentTrackingLockAcquisitions
+        {
+          virtual unsigned long long get() { return _trackingacquisitions; }
+        }
+        property unsigned long long SegmentTrackingLockContentions
+        {
+          virtual unsigned long long get() { return _trackingcontentions; }
+        }
+        ///<summary>The stream LockSwitch, taken to check for pending bitrate and rendition switches on every sample</summary>
+        property unsigned long long StreamSwitchLockAcquisitions
+        {
+          virtual unsigned long long get() { return _switchacquisitions; }
+        }
+        property unsigned long long StreamSwitchLockContentions
+        {
+          virtual unsigned long long get() { return _switchcontentions; }
+        }
+      };
+    }
+  }
+}
@@ -46,8 +46,11 @@ curDirection(MFRATE_DIRECTION::MFRATE_FORWARD),
 spHeuristicsManager(nullptr), VIDEOSTREAMID(1),
 AUDIOSTREAMID(0), HandleInitialPauseForAutoPlay(false),
 LastPlayedVideoSegment(nullptr), LastPlayedAudioSegment(nullptr),
-LivePlaylistPositioned(false)
+LivePlaylistPositioned(false), LiveCatchupSeekSuggested(false), FirstSampleReported(false)
 {
+  spSharedTimer = make_shared<SharedTimer>();
+  spParsePool = make_shared<SegmentParsePool>();
+  spMemoryBudget = make_shared<SegmentMemoryBudget>();
 
   //  taskRegistry3.SetMediaSource(this);
   MFAllocateSerialWorkQueue(MFASYNC_CALLBACK_QUEUE_MULTITHREADED, &SerialWorkQueueID);
@@ -66,6 +69,8 @@ LivePlaylistPositioned(false)
   SupportedRates.push_back(make_shared<VariableRate>(4.0f, true, 0));
   SupportedRates.push_back(make_shared<VariableRate>(8.0f, true, 1));
   SupportedRates.push_back(make_shared<VariableRate>(12.0f, true, 2));
+  LiveCatchupRates.push_back(make_shared<VariableRate>(1.05f, false, 0, true));
+  LiveCatchupRates.push_back(make_shared<VariableRate>(1.1f, false, 0, true));
 
 
 }
@@ -75,6 +80,10 @@ CHLSMediaSource::~CHLSMediaSource()
   if (this->cpController != nullptr)
     this->cpController->Invalidate();
 
+  //in case we were never started (or failed) and Shutdown() did not get to the parse pool
+  if (spParsePool != nullptr)
+    spParsePool->Shutdown();
+
 
   if (StreamWorkQueueID != 0)
     MFUnlockWorkQueue(StreamWorkQueueID);
@@ -87,6 +96,9 @@ CHLSMediaSource::~CHLSMediaSource()
   if (spHeuristicsManager != nullptr)
     spHeuristicsManager->StopNotifier();
 
+  if (spSharedTimer != nullptr)
+    spSharedTimer->Shutdown();
+
   /*if (spRootPlaylist != nullptr)
   {
 
@@ -158,6 +170,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
   task_completion_event<HRESULT> tceProtectPlaylist;
   BlockPrematureRelease(tceProtectPlaylist);
 
+  ResetStartupTimes();
+
   cpControllerFactory = cpFactory;
   //reset the last suggested bandwidth - it will get recalculated later in the code
   spHeuristicsManager = make_shared<HeuristicsManager>(this);
@@ -203,6 +217,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
       if (!spRootPlaylist->IsValid || (spRootPlaylist->IsVariant == false && spRootPlaylist->Segments.size() == 0))
         throw E_FAIL;
 
+      MarkStartupPhase(&StartupPhaseTimes::MasterPlaylistReady);
+
       //variant playlist
       if (spRootPlaylist->IsVariant)
       {
@@ -227,7 +243,9 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
           spHeuristicsManager->FindClosestBitrate(spRootPlaylist->StartBitrate) :
           spHeuristicsManager->GetLastSuggestedBandwidth();
 
-        shared_ptr<StreamInfo> variantStreamInfo = spRootPlaylist->ActivateStream(targetBitrate, false, 0, true);
+        shared_ptr<StreamInfo> variantStreamInfo = Configuration::GetCurrent()->EnableFastStart ? FastStartActivateStream(targetBitrate) : nullptr;
+        if (nullptr == variantStreamInfo)
+          variantStreamInfo = spRootPlaylist->ActivateStream(targetBitrate, false, 0, true);
 
         if (nullptr == variantStreamInfo)
         {
@@ -237,7 +255,10 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
 
 
 
+        MarkStartupPhase(&StartupPhaseTimes::StartSegmentReady);
         spHeuristicsManager->SetLastSuggestedBandwidth(variantStreamInfo->Bandwidth);
+        if (variantStreamInfo->spPlaylist != nullptr)
+          spHeuristicsManager->SetSegmentDuration(variantStreamInfo->spPlaylist->DerivedTargetDuration);
 
         if (nullptr != cpController)
         {
@@ -288,6 +309,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
 
         //start network monitor
         spHeuristicsManager->StartNotifier();
+        //get the neighbouring variants ready for the first bitrate switch
+        WarmAdjacentVariants();
 
         if (variantStreamInfo->IsActive) //if this is the active variant
         {
@@ -327,6 +350,7 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
           if (FAILED(std::get<0>(ret)))
             throw E_FAIL;
         }
+        MarkStartupPhase(&StartupPhaseTimes::StartSegmentReady);
 
         //for event playlists we also get the first segment and in turn establish the proper sliding window start
         if (/*spRootPlaylist->PlaylistType == Microsoft::HLSClient::HLSPlaylistType::EVENT &&*/
@@ -370,6 +394,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
   task_completion_event<HRESULT> tceProtectPlaylist;
   BlockPrematureRelease(tceProtectPlaylist);
 
+  ResetStartupTimes();
+
 
   try
   {
@@ -398,6 +424,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
 
     if (!spRootPlaylist->IsValid || (spRootPlaylist->IsVariant == false && spRootPlaylist->Segments.size() == 0))
       throw E_FAIL;
+
+    MarkStartupPhase(&StartupPhaseTimes::MasterPlaylistReady);
     //variant playlist
     if (spRootPlaylist->IsVariant)
     {
@@ -422,7 +450,9 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
         spHeuristicsManager->FindClosestBitrate(spRootPlaylist->StartBitrate) :
         spHeuristicsManager->GetLastSuggestedBandwidth();
 
-      shared_ptr<StreamInfo> variantStreamInfo = spRootPlaylist->ActivateStream(targetBitrate, false, 0, true);
+      shared_ptr<StreamInfo> variantStreamInfo = Configuration::GetCurrent()->EnableFastStart ? FastStartActivateStream(targetBitrate) : nullptr;
+      if (nullptr == variantStreamInfo)
+        variantStreamInfo = spRootPlaylist->ActivateStream(targetBitrate, false, 0, true);
 
       if (nullptr == variantStreamInfo)
       {
@@ -431,7 +461,10 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
       }
 
 
+      MarkStartupPhase(&StartupPhaseTimes::StartSegmentReady);
       spHeuristicsManager->SetLastSuggestedBandwidth(variantStreamInfo->Bandwidth);
+      if (variantStreamInfo->spPlaylist != nullptr)
+        spHeuristicsManager->SetSegmentDuration(variantStreamInfo->spPlaylist->DerivedTargetDuration);
 
       if (nullptr != cpController)
       {
@@ -481,6 +514,8 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
       }
       //start network monitor
       spHeuristicsManager->StartNotifier();
+      //get the neighbouring variants ready for the first bitrate switch
+      WarmAdjacentVariants();
 
       if (variantStreamInfo->IsActive) //if this is the active variant
       {
@@ -520,6 +555,7 @@ HRESULT CHLSMediaSource::BeginOpen(IMFAsyncResult *pAsyncResult, Microsoft::HLSC
         if (FAILED(std::get<0>(ret)))
           throw E_FAIL;
       }
+      MarkStartupPhase(&StartupPhaseTimes::StartSegmentReady);
 
       //for event playlists we also get the first segment and in turn establish the proper sliding window start
       if (/*spRootPlaylist->PlaylistType == Microsoft::HLSClient::HLSPlaylistType::EVENT &&*/
@@ -582,6 +618,8 @@ void CHLSMediaSource::EndOpen()
   }
   if (spRootPlaylist == nullptr || GetCurrentState() == MSS_ERROR)
     cpAsyncResultForOpen->SetStatus(E_FAIL);
+
+  MarkStartupPhase(&StartupPhaseTimes::OpenCompleted);
   //LOG("MediaSource EndOpen()");
   //call the calling byte stream handler (HLSPlaylistHandler) back - HLS Media Source is now ready or failed
   MFInvokeCallback(cpAsyncResultForOpen.Get());
@@ -1004,7 +1042,7 @@ HRESULT CHLSMediaSource::StartBuffering(bool Record,bool CanInitiateDownSwitch)
     PROPVARIANT  pvt2;
     ::PropVariantInit(&pvt2);
     //queue the buffering started event
-    if (GetCurrentPlaybackRate()->Rate == 1.0)
+    if (IsNormalPlaybackRate())
       QueueEvent(MEBufferingStarted, GUID_NULL, S_OK, &pvt2);
     //change state flag
     preBufferingState = GetCurrentState();
@@ -1046,7 +1084,7 @@ HRESULT CHLSMediaSource::EndBuffering()
     PROPVARIANT pvt2;
     ::PropVariantInit(&pvt2);
     //queue the buffering stopped event
-    if (GetCurrentPlaybackRate()->Rate == 1.0)
+    if (IsNormalPlaybackRate())
       QueueEvent(MEBufferingStopped, GUID_NULL, S_OK, &pvt2);
     //reset state
     SetCurrentState(preBufferingState);
@@ -1102,6 +1140,10 @@ bool CHLSMediaSource::TryCancelPendingBitrateSwitch(bool Force)
     //set the monitor last suggested bandwidth accordingly
     spHeuristicsManager->SetLastSuggestedBandwidth(spRootPlaylist->ActiveVariant->Bandwidth);
 
+  //the source may have stopped building buffer for the switch
+  if (spRootPlaylist->ActiveVariant != nullptr && spRootPlaylist->ActiveVariant->spPlaylist != nullptr)
+    spRootPlaylist->ActiveVariant->spPlaylist->ResumeAfterSwitch();
+
   LOGIF(spRootPlaylist->ActiveVariant != nullptr, "Cancelled suggested bitrate change to " << targetBitrate << " from " << spRootPlaylist->ActiveVariant->Bandwidth);
 
   if ((videoswitch != nullptr || audioswitch != nullptr) && cpController != nullptr && cpController->GetPlaylist() != nullptr && (GetCurrentState() == MediaSourceState::MSS_STARTED || GetCurrentState() == MediaSourceState::MSS_BUFFERING || GetCurrentState() == MediaSourceState::MSS_SEEKING))
@@ -1185,7 +1227,7 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
   //check to see if the target bandwidth falls outside allowed range  and make sure we are playing at normal playback rate  
   if ((spRootPlaylist->MinAllowedBitrate != 0 && Bandwidth < spRootPlaylist->MinAllowedBitrate) ||
     (spRootPlaylist->MaxAllowedBitrate != UINT32_MAX && Bandwidth > spRootPlaylist->MaxAllowedBitrate) ||
-    GetCurrentPlaybackRate()->Rate != 1.0)
+    !IsNormalPlaybackRate())
   {
     //ignore the change
     if (spHeuristicsManager->GetLastSuggestedBandwidth() != curBitrate)  //reset the bandwidth
@@ -1263,6 +1305,9 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
     }
     //}
 
+    //a warmup may already be fetching this playlist - let it finish instead of downloading it again
+    targetVariant->WaitForPendingWarmup();
+
     if (targetVariant->spPlaylist == nullptr)
     {
       targetVariant = spRootPlaylist->DownloadVariantStreamPlaylist(targetVariant->Bandwidth,
@@ -1287,7 +1332,7 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
       if (spHeuristicsManager->GetLastSuggestedBandwidth() != curBitrate)  //reset the bandwidth
         //set the monitor last suggested bandwidth accordingly
         spHeuristicsManager->SetLastSuggestedBandwidth(curBitrate);
-      curPlaylist->PauseBufferBuilding = false;
+      curPlaylist->ResumeBufferBuilding();
       return;
     }
 
@@ -1308,7 +1353,7 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
         if (spHeuristicsManager->GetLastSuggestedBandwidth() != curBitrate)  //reset the bandwidth
           //set the monitor last suggested bandwidth accordingly
           spHeuristicsManager->SetLastSuggestedBandwidth(curBitrate);
-        curPlaylist->PauseBufferBuilding = false;
+        curPlaylist->ResumeBufferBuilding();
         return;
       }
     }
@@ -1325,6 +1370,10 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
       if (cpAudioStream != nullptr && cpAudioStream->Selected() && spRootPlaylist->ActiveVariant->GetActiveAudioRendition() == nullptr)
         //schedule a switch the audio stream
         cpAudioStream->ScheduleSwitch(targetVariant->spPlaylist.get(), PlaylistSwitchRequest::SwitchType::BITRATE);
+      //nothing was scheduled - do not leave the source paused for a switch that will never happen
+      if ((cpVideoStream == nullptr || cpVideoStream->GetPendingBitrateSwitch() == nullptr) &&
+        (cpAudioStream == nullptr || cpAudioStream->GetPendingBitrateSwitch() == nullptr))
+        curPlaylist->ResumeAfterSwitch();
 
       //ignore the change
       if (spHeuristicsManager->GetLastSuggestedBandwidth() != targetVariant->Bandwidth)  //reset the bandwidth
@@ -1338,7 +1387,7 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
         //set the monitor last suggested bandwidth accordingly
         spHeuristicsManager->SetLastSuggestedBandwidth(curBitrate);
 
-      curPlaylist->PauseBufferBuilding = false;
+      curPlaylist->ResumeBufferBuilding();
 
       if (cpController != nullptr && cpController->GetPlaylist() != nullptr && GetCurrentState() == MediaSourceState::MSS_STARTED)
       {
@@ -1362,6 +1411,171 @@ void CHLSMediaSource::BitrateSwitchSuggested(unsigned int Bandwidth, unsigned in
 
 }
 
+///<summary>Downloads (or refreshes if live) the playlists for the variants immediately above and below the active variant in the background</summary>
+void CHLSMediaSource::WarmAdjacentVariants()
+{
+  if (Configuration::GetCurrent()->WarmAdjacentVariantPlaylists == false ||
+    spRootPlaylist == nullptr || spRootPlaylist->IsVariant == false || spRootPlaylist->ActiveVariant == nullptr ||
+    spHeuristicsManager == nullptr || GetCurrentState() == MSS_ERROR || GetCurrentState() == MSS_UNINITIALIZED)
+    return;
+
+  auto curBitrate = spRootPlaylist->ActiveVariant->Bandwidth;
+  std::vector<unsigned int> adjacent;
+  adjacent.push_back(spHeuristicsManager->FindNextHigherBitrate(curBitrate));
+  adjacent.push_back(spHeuristicsManager->FindNextLowerBitrate(curBitrate));
+
+  for (auto br : adjacent)
+  {
+    if (br == curBitrate || spRootPlaylist->Variants.find(br) == spRootPlaylist->Variants.end())
+      continue;
+
+    auto si = spRootPlaylist->Variants[br];
+
+    protectionRegistry.Register(si->WarmPlaylistAsync().then([this, si](HRESULT hr)
+    {
+      if (FAILED(hr) || Configuration::GetCurrent()->PrefetchAdjacentVariantSegment == false ||
+        GetCurrentState() != MSS_STARTED || si->IsActive || si->spPlaylist == nullptr ||
+        spRootPlaylist->ActiveVariant == nullptr || spRootPlaylist->ActiveVariant->spPlaylist == nullptr)
+        return S_OK;
+
+      auto curPlaylist = spRootPlaylist->ActiveVariant->spPlaylist;
+      if (curPlaylist->MaxCurrentSegment() == nullptr || si->spPlaylist->IsLive != curPlaylist->IsLive)
+        return S_OK;
+
+      //prefetch the segment we would most likely switch into
+      auto targetseg = si->spPlaylist->GetBitrateSwitchTarget(curPlaylist.get(), true);
+      if (targetseg != nullptr && targetseg->GetCurrentState() != INMEMORYCACHE && targetseg->GetCurrentState() != DOWNLOADING)
+      {
+        LOG("WarmAdjacentVariants: Prefetching segment " << targetseg->GetSequenceNumber() << " on variant " << si->Bandwidth);
+        Playlist::StartStreamingAsync(si->spPlaylist.get(), targetseg->GetSequenceNumber(), false, false, true);
+      }
+      return S_OK;
+    }, task_continuation_context::use_arbitrary()));
+  }
+}
+
+///<summary>Fetches the start variant playlist and the active alternate audio rendition playlist in parallel, followed by their first segments</summary>
+///<param name='desiredbitrate'>The bitrate to start at</param>
+///<returns>The activated variant, or nullptr if the fast path failed and the caller should fall back to Playlist::ActivateStream()</returns>
+shared_ptr<StreamInfo> CHLSMediaSource::FastStartActivateStream(unsigned int desiredbitrate)
+{
+  auto targetBitrate = spHeuristicsManager->FindClosestBitrate(desiredbitrate);
+  auto itr = spRootPlaylist->Variants.find(targetBitrate);
+  if (itr == spRootPlaylist->Variants.end())
+    return nullptr;
+
+  auto streaminfo = itr->second;
+  auto altaudio = streaminfo->GetActiveAudioRendition();
+
+  //code downstream expects an active variant while we stream the start segments - we make it active for real once they are in
+  spRootPlaylist->ActiveVariant = streaminfo.get();
+
+  //variant playlist followed by the start segment (the segment download fetches the key if the segment is encrypted)
+  auto variantready = streaminfo->spPlaylist == nullptr ? streaminfo->DownloadPlaylistAsync() : task_from_result<HRESULT>(S_OK);
+  auto videochain = variantready.then([this, streaminfo](HRESULT hr) -> HRESULT
+  {
+    if (FAILED(hr) || streaminfo->spPlaylist == nullptr || streaminfo->spPlaylist->Segments.empty())
+      return E_FAIL;
+
+    auto StartSeg = streaminfo->spPlaylist->IsLive ?
+      streaminfo->spPlaylist->GetSegment(streaminfo->spPlaylist->FindLiveStartSegmentSequenceNumber()) :
+      streaminfo->spPlaylist->Segments.front();
+    if (StartSeg == nullptr)
+      return E_FAIL;
+
+    auto ret = Playlist::StartStreamingAsync(streaminfo->spPlaylist.get(), StartSeg->GetSequenceNumber(), false, true, true).get();
+    return std::get<0>(ret);
+  }, task_continuation_context::use_arbitrary());
+
+  //alternate audio playlist alongside the variant playlist, and its start segment alongside the variant start segment
+  task<HRESULT> audiochain = task_from_result<HRESULT>(S_OK);
+  if (altaudio != nullptr && altaudio->spPlaylist == nullptr && altaudio->PlaylistUri.empty() == false)
+  {
+    audiochain = (variantready && altaudio->DownloadRenditionPlaylistAsync()).then([this, streaminfo, altaudio](std::vector<HRESULT> results) -> HRESULT
+    {
+      if (std::any_of(results.begin(), results.end(), [](HRESULT hr) { return FAILED(hr); }) ||
+        altaudio->spPlaylist == nullptr || streaminfo->spPlaylist == nullptr || streaminfo->spPlaylist->Segments.empty())
+        return E_FAIL;
+
+      auto AltStartSegSeq = altaudio->spPlaylist->FindAltRenditionMatchingSegment(streaminfo->spPlaylist.get(),
+        streaminfo->spPlaylist->IsLive ? streaminfo->spPlaylist->FindLiveStartSegmentSequenceNumber() : streaminfo->spPlaylist->Segments.front()->GetSequenceNumber());
+
+      auto ret = Playlist::StartStreamingAsync(altaudio->spPlaylist.get(), AltStartSegSeq, false, true, true).get();
+      return std::get<0>(ret);
+    }, task_continuation_context::use_arbitrary());
+  }
+
+  HRESULT hr = E_FAIL;
+  try
+  {
+    hr = videochain.get();
+  }
+  catch (...)
+  {
+    hr = E_FAIL;
+  }
+
+  //an alternate audio failure is handled by the regular open path (which retries and falls back to the main track)
+  try
+  {
+    audiochain.wait();
+  }
+  catch (...)
+  {
+  }
+
+  if (FAILED(hr))
+  {
+    LOG("FastStartActivateStream: Fast start failed for bitrate " << targetBitrate << " - falling back");
+    spRootPlaylist->ActiveVariant = nullptr;
+    //let the regular path download and test the variant from scratch
+    streaminfo->spPlaylist = nullptr;
+    return nullptr;
+  }
+
+  streaminfo->MakeActive();
+  return streaminfo;
+}
+
+///<summary>Records the delivery of the first sample after open and logs the time to first frame broken down by startup phase</summary>
+void CHLSMediaSource::ReportFirstSampleDelivered()
+{
+  if (FirstSampleReported)
+    return;
+
+  std::lock_guard<recursive_mutex> lock(LockStartupTimes);
+  if (StartupTimes.FirstSampleDelivered != 0 || StartupTimes.OpenCompleted == 0)
+    return;
+
+  StartupTimes.FirstSampleDelivered = ::GetTickCount64();
+  FirstSampleReported = true;
+
+  //single bitrate playlists do not have a separate media playlist phase
+  auto mediaPlaylistReady = StartupTimes.MediaPlaylistReady != 0 ? StartupTimes.MediaPlaylistReady : StartupTimes.MasterPlaylistReady;
+
+  LOG("Time to first frame : " << (StartupTimes.FirstSampleDelivered - StartupTimes.OpenStarted) << " ms (Master playlist : "
+    << (StartupTimes.MasterPlaylistReady - StartupTimes.OpenStarted) << " ms, Media playlist : "
+    << (mediaPlaylistReady - StartupTimes.MasterPlaylistReady) << " ms, Start segment : "
+    << (StartupTimes.StartSegmentReady - mediaPlaylistReady) << " ms, Open completion : "
+    << (StartupTimes.OpenCompleted - StartupTimes.StartSegmentReady) << " ms, First sample : "
+    << (StartupTimes.FirstSampleDelivered - StartupTimes.OpenCompleted) << " ms)");
+}
+
+void CHLSMediaSource::MarkStartupPhase(ULONGLONG StartupPhaseTimes::*Phase)
+{
+  std::lock_guard<recursive_mutex> lock(LockStartupTimes);
+  if (StartupTimes.*Phase == 0)
+    StartupTimes.*Phase = ::GetTickCount64();
+}
+
+void CHLSMediaSource::ResetStartupTimes()
+{
+  std::lock_guard<recursive_mutex> lock(LockStartupTimes);
+  StartupTimes = StartupPhaseTimes();
+  StartupTimes.OpenStarted = ::GetTickCount64();
+  FirstSampleReported = false;
+}
+
 ///<summary>Handles a change request from the player to an alternate audio or video rendition (subtitle is handled at the player)</summary>
 ///<param name='RenditionType'>AUDIO or VIDEO</param>
 ///<param name='targetRendition'>The target rendition instance</param>
@@ -1995,7 +2209,7 @@ HRESULT CHLSMediaSource::StartPlaylistInitial(Playlist *pPlaylist, std::shared_p
     {
       auto vidpid = StartSeg->GetPIDForMediaType(VIDEO);
       auto firstsample = StartSeg->PeekNextSample(vidpid, MFRATE_FORWARD);
-      cpVideoStream->NotifyStreamStarted(StartSeg->Discontinous && firstsample->DiscontinousTS != nullptr ? firstsample->DiscontinousTS : firstsample->SamplePTS);
+      cpVideoStream->NotifyStreamStarted(StartSeg->Discontinous && firstsample->HasDiscontinousTS() ? firstsample->GetDiscontinousTS() : firstsample->SamplePTS);
     }
     else
     {
@@ -2013,7 +2227,7 @@ HRESULT CHLSMediaSource::StartPlaylistInitial(Playlist *pPlaylist, std::shared_p
     {
       auto audpid = StartSeg->GetPIDForMediaType(AUDIO);
       auto firstsample = StartSeg->PeekNextSample(audpid, MFRATE_FORWARD);
-      cpAudioStream->NotifyStreamStarted(StartSeg->Discontinous && firstsample->DiscontinousTS != nullptr ? firstsample->DiscontinousTS : firstsample->SamplePTS);
+      cpAudioStream->NotifyStreamStarted(StartSeg->Discontinous && firstsample->HasDiscontinousTS() ? firstsample->GetDiscontinousTS() : firstsample->SamplePTS);
     }
     else
     {
@@ -3460,6 +3674,9 @@ IFACEMETHODIMP CHLSMediaSource::Shutdown()
           catch (...)
           {
           }
+          //queued parse work runs against this source - fail it, and wait for what is already parsing
+          if (spParsePool != nullptr)
+            spParsePool->Shutdown();
           try
           {
             //LOG("Waiting for protection registry...");
@@ -3485,6 +3702,10 @@ IFACEMETHODIMP CHLSMediaSource::Shutdown()
     }
   }
 
+  //no more playlist refreshes or stream ticks once we are shut down
+  if (spSharedTimer != nullptr)
+    spSharedTimer->Shutdown();
+
   //MFUnlockPlatform();
   return S_OK;
 
@@ -3585,6 +3806,68 @@ size_t CHLSMediaSource::GetPlaybackRateDistanceFromNormal()
     return 0;
 }
 
+bool CHLSMediaSource::IsNormalPlaybackRate()
+{
+  return curPlaybackRate->Rate == 1.0 || curPlaybackRate->LiveCatchup;
+}
+
+void CHLSMediaSource::CheckLiveCatchup(Playlist *pPlaylist)
+{
+  if (!Configuration::GetCurrent()->EnableLiveCatchup || pPlaylist == nullptr || !pPlaylist->IsLive || pPlaylist->IsVariant)
+    return;
+  //leave rates selected by the app (trick play, slow motion, pause) alone
+  if (GetCurrentState() != MSS_STARTED || curDirection != MFRATE_DIRECTION::MFRATE_FORWARD || !IsNormalPlaybackRate())
+    return;
+
+  auto distance = pPlaylist->FindDistanceFromLivePosition();
+  auto td = pPlaylist->DerivedTargetDuration;
+  auto seekthreshold = Configuration::GetCurrent()->LiveCatchupSeekThreshold > 0 ?
+    Configuration::GetCurrent()->LiveCatchupSeekThreshold : 3 * Configuration::GetCurrent()->MinimumLiveLatency;
+
+  if (seekthreshold > 0 && distance > seekthreshold)
+  {
+    //too far behind to catch up by speeding up - ask the app to seek to the live position
+    if (!LiveCatchupSeekSuggested)
+    {
+      LiveCatchupSeekSuggested = true;
+      LOG("CheckLiveCatchup: " << distance << " ticks behind live position - suggesting seek");
+      protectionRegistry.Register(task<HRESULT>([this, pPlaylist]()
+      {
+        if (cpController != nullptr && cpController->GetPlaylist() != nullptr)
+          cpController->GetPlaylist()->RaiseLiveCatchupSeekSuggested(pPlaylist);
+        return S_OK;
+      }, task_options(task_continuation_context::use_arbitrary())));
+    }
+  }
+  else
+    LiveCatchupSeekSuggested = false;
+
+  //pick the catchup rate - keep catching up until we are within a quarter target duration to avoid flipping rates at every refresh
+  float targetrate = 1.0f;
+  if (distance > 2 * td)
+    targetrate = 1.1f;
+  else if (distance > td / 2 || (curPlaybackRate->LiveCatchup && distance > td / 4))
+    targetrate = 1.05f;
+
+  if (targetrate != curPlaybackRate->Rate)
+  {
+    LOG("CheckLiveCatchup: " << distance << " ticks behind live position - changing rate from " << curPlaybackRate->Rate << " to " << targetrate);
+    SetLiveCatchupRate(targetrate);
+  }
+}
+
+HRESULT CHLSMediaSource::SetLiveCatchupRate(float flRate)
+{
+  auto& rates = flRate == 1.0f ? SupportedRates : LiveCatchupRates;
+  auto found = std::find_if(rates.begin(), rates.end(), [flRate](shared_ptr<VariableRate> val) { return val->Rate == flRate && !val->Thinned; });
+  if (found == rates.end())
+    return MF_E_UNSUPPORTED_RATE;
+
+  //catchup and normal rates are both normal playback - the previous rate stays whatever the app last moved away from
+  curPlaybackRate = *found;
+  return NotifyRateChanged(curPlaybackRate->Rate);
+}
+
 ///<summary>GetRate (see IMFRateControl on MSDN)</summary>
 IFACEMETHODIMP CHLSMediaSource::GetRate(BOOL *pfThin, float *pflRate)
 {
@@ -3611,10 +3894,23 @@ IFACEMETHODIMP CHLSMediaSource::SetRate(BOOL fThin, float flRate)
     return val->Rate == flRate && val->Thinned == thinval;
   });
   if (found == SupportedRates.end())
-    return MF_E_UNSUPPORTED_RATE;
+  {
+    //the pipeline may echo back a live catchup rate we set ourselves
+    found = std::find_if(LiveCatchupRates.begin(), LiveCatchupRates.end(), [flRate, thinval](shared_ptr<VariableRate> val)
+    {
+      return val->Rate == flRate && val->Thinned == thinval;
+    });
+    if (found == LiveCatchupRates.end())
+      return MF_E_UNSUPPORTED_RATE;
+    curPlaybackRate = *found;
+    return NotifyRateChanged(curPlaybackRate->Rate);
+  }
 
+  //a live catchup rate stands in for normal playback - record that as the previous rate
   if (curPlaybackRate != nullptr)
-    prevPlaybackRate = curPlaybackRate;
+    prevPlaybackRate = curPlaybackRate->LiveCatchup ?
+    *std::find_if(SupportedRates.begin(), SupportedRates.end(), [](shared_ptr<VariableRate> val) { return val->Rate == 1.0f && !val->Thinned; }) :
+    curPlaybackRate;
   curPlaybackRate = *found;
   /*if((curDirection == MFRATE_DIRECTION::MFRATE_FORWARD && flRate < 0 || curDirection == MFRATE_DIRECTION::MFRATE_REVERSE && flRate >= 0))
   {
@@ -3631,7 +3927,7 @@ IFACEMETHODIMP CHLSMediaSource::SetRate(BOOL fThin, float flRate)
       cpAudioStream->NotifyStreamThinning(false);
   }
 
-  if (curPlaybackRate->Rate != 1)
+  if (!IsNormalPlaybackRate())
   {
     //cancel any pending bandwidth changes 
     TryCancelPendingBitrateSwitch(true);
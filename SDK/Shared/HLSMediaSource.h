@@ -32,12 +32,16 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <map>
 #include <mutex>
+#include <atomic>
 #include "PlaylistOM.h"   
 #include "AdaptiveHeuristics.h"  
 #include "ContentDownloadRegistry.h"
 #include "MFAudioStream.h"
 #include "MFVideoStream.h" 
 #include "TaskRegistry.h"    
+#include "SegmentParsePool.h"
+#include "LockContention.h"
+#include "SegmentMemoryBudget.h"
 
 using namespace Microsoft::WRL;
 using namespace std;
@@ -95,6 +99,23 @@ namespace Microsoft {
       //forward declare
       ref class HLSController;
 
+      ///<summary>Tick count (GetTickCount64) at the end of each startup phase - used to report time to first frame</summary>
+      struct StartupPhaseTimes
+      {
+        ULONGLONG OpenStarted;
+        ULONGLONG MasterPlaylistReady;
+        ULONGLONG MediaPlaylistReady;
+        ULONGLONG StartSegmentReady;
+        ULONGLONG OpenCompleted;
+        ULONGLONG FirstSampleDelivered;
+
+        StartupPhaseTimes() :
+          OpenStarted(0), MasterPlaylistReady(0), MediaPlaylistReady(0),
+          StartSegmentReady(0), OpenCompleted(0), FirstSampleDelivered(0)
+        {
+        }
+      };
+
 
       class CHLSMediaSource :
         public RuntimeClass<RuntimeClassFlags<RuntimeClassType::ClassicCom>,
@@ -152,6 +173,8 @@ namespace Microsoft {
         ////quality level
         //MF_QUALITY_LEVEL curQualityLevel; 
         std::vector<shared_ptr<VariableRate>> SupportedRates;
+        //rates used internally to catch up with the live edge - not advertised through IMFRateSupport
+        std::vector<shared_ptr<VariableRate>> LiveCatchupRates;
 
        
         bool PlayerWindowVisible;
@@ -159,15 +182,35 @@ namespace Microsoft {
         std::vector<unsigned int> bufferinghistory;
         bool LivePlaylistPositioned;
         shared_ptr<StopWatch> swStopOrPause;
+        //set once we have asked the app to seek back to the live edge - cleared when we are back within the seek threshold
+        bool LiveCatchupSeekSuggested;
+
+        ///<summary>Fetches the start variant playlist and the active alternate audio rendition playlist in parallel, followed by their first segments</summary>
+        ///<param name='desiredbitrate'>The bitrate to start at</param>
+        ///<returns>The activated variant, or nullptr if the fast path failed and the caller should fall back to Playlist::ActivateStream()</returns>
+        shared_ptr<StreamInfo> FastStartActivateStream(unsigned int desiredbitrate);
       public: 
 
         
         TaskRegistry<HRESULT> protectionRegistry;
+        //startup phase timestamps - read and written under LockStartupTimes
+        StartupPhaseTimes StartupTimes;
+        recursive_mutex LockStartupTimes;
+        //lets the sample path skip LockStartupTimes once time to first frame has been reported
+        std::atomic<bool> FirstSampleReported;
+        //contention on the sample path locks of all our segments, playlists and streams - queried through the controller
+        SamplePathLockContention LockContention;
         const unsigned int VIDEOSTREAMID, AUDIOSTREAMID;
         //PD
         ComPtr<IMFPresentationDescriptor> cpPresentationDescriptor;
         shared_ptr<ContentDownloadRegistry> spDownloadRegistry;
         shared_ptr<HeuristicsManager> spHeuristicsManager;
+        //single timer that the playlist refresh, stream tick and bitrate notifier stopwatches are scheduled on
+        shared_ptr<SharedTimer> spSharedTimer;
+        //decrypts and parses downloaded segments - shared by all the playlists of this source
+        shared_ptr<SegmentParsePool> spParsePool;
+        //bytes of segment data held in memory - shared by all the playlists of this source
+        shared_ptr<SegmentMemoryBudget> spMemoryBudget;
         //controller API
         HLSController^ cpController;
         HLSControllerFactory^ cpControllerFactory;
@@ -187,6 +230,17 @@ namespace Microsoft {
 
         size_t GetPlaybackRateDistanceFromNormal();
 
+        ///<summary>Checks if we are playing at normal speed (1x, or one of the live catchup rates)</summary>
+        bool IsNormalPlaybackRate();
+
+        ///<summary>Adjusts the playback rate (or suggests a seek) to bring a live presentation that fell behind back to the live start position</summary>
+        ///<param name='pPlaylist'>The active media playlist</param>
+        void CheckLiveCatchup(Playlist *pPlaylist);
+
+        ///<summary>Switches between normal playback and a live catchup rate without affecting the rate the app selected</summary>
+        ///<param name='flRate'>1.0 or one of the live catchup rates</param>
+        HRESULT SetLiveCatchupRate(float flRate);
+
         MediaSourceState GetCurrentState() {
 
           return currentSourceState;
@@ -241,6 +295,18 @@ namespace Microsoft {
         ///<summary>Cancels any pending bitrate changes</summary>
         bool TryCancelPendingBitrateSwitch(bool Force = false);
 
+        ///<summary>Downloads (or refreshes if live) the playlists for the variants immediately above and below the active variant in the background, so that a bitrate switch does not have to wait on a playlist download</summary>
+        void WarmAdjacentVariants();
+
+        ///<summary>Records the delivery of the first sample after open and logs the time to first frame broken down by startup phase</summary>
+        void ReportFirstSampleDelivered();
+
+        ///<summary>Stamps the end of a startup phase - a phase that has already been stamped keeps its first time</summary>
+        void MarkStartupPhase(ULONGLONG StartupPhaseTimes::*Phase);
+
+        ///<summary>Clears the startup phase times and stamps the start of open</summary>
+        void ResetStartupTimes();
+
         ///<summary>Cancels any pending rendition changes</summary>
         void CancelPendingRenditionChange();
         ///<summary>Handles a change request from the player to an alternate audio or video rendition (subtitle is handled at the player)</summary>
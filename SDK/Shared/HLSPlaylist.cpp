@@ -29,6 +29,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "HLSPlaylist.h"
 #include "HLSVariantStream.h"
 #include "HLSSegment.h"
+#include "HLSID3MetadataPayload.h"
 #include "HLSSlidingWindow.h"
 #include "HLSBitrateSwitchEventArgs.h"
 #include "HLSSegmentSwitchEventArgs.h"
@@ -206,11 +207,11 @@ unsigned int HLSPlaylist::SegmentCount::get()
       throw ref new NotImplementedException();
     if (_controller->MediaSource->spRootPlaylist->Variants[*_bitratekey]->spPlaylist == nullptr)
       throw ref new NullReferenceException();
-    return (unsigned int)_controller->MediaSource->spRootPlaylist->Variants[*_bitratekey]->spPlaylist->Segments.size();
+    return (unsigned int)_controller->MediaSource->spRootPlaylist->Variants[*_bitratekey]->spPlaylist->GetSegmentSnapshot()->size();
   }
   else
   {
-    return (unsigned int)_controller->MediaSource->spRootPlaylist->Segments.size();
+    return (unsigned int)_controller->MediaSource->spRootPlaylist->GetSegmentSnapshot()->size();
   }
 }
 
@@ -305,6 +306,25 @@ Windows::Foundation::Collections::IVector<Windows::Foundation::TimeSpan>^ HLSPla
   return retval;
 }
 
+Windows::Foundation::Collections::IVector<IHLSID3MetadataPayload^>^ HLSPlaylist::GetMetadataInRange(Windows::Foundation::TimeSpan From, Windows::Foundation::TimeSpan To)
+{
+  if (_controller == nullptr || !_controller->IsValid)  throw ref new Platform::ObjectDisposedException();
+  if (_controller->MediaSource->spRootPlaylist == nullptr)
+    return nullptr;
+
+  //the timeline is kept on the root playlist for all variants
+  auto cues = _controller->MediaSource->spRootPlaylist->MetadataTimeline.GetCuesInRange((unsigned long long)From.Duration, (unsigned long long)To.Duration);
+  if (cues.size() == 0)
+    return nullptr;
+
+  auto retval = ref new Platform::Collections::Vector<IHLSID3MetadataPayload^>((unsigned int)cues.size());
+  std::transform(begin(cues), end(cues), begin(retval), [](shared_ptr<ID3MetadataCue> cue)
+  {
+    return ref new HLSID3MetadataPayload(cue);
+  });
+  return retval;
+}
+
 Windows::Foundation::Collections::IVector<IHLSVariantStream^>^ HLSPlaylist::GetVariantStreams()
 {
 
@@ -545,4 +565,23 @@ void HLSPlaylist::RaiseSlidingWindowChanged(Playlist *from)
   catch (...)
   {
   }
+}
+
+void HLSPlaylist::RaiseLiveCatchupSeekSuggested(Playlist *from)
+{
+  if (_controller == nullptr || !_controller->IsValid)  return;
+  if (_controller->MediaSource->GetCurrentState() != MSS_STARTED) return;
+  if (from == nullptr) return;
+  try
+  {
+    auto _start = from->GetSlidingWindowStart();
+    auto _end = from->GetSlidingWindowEnd();
+    auto _livepos = from->FindApproximateLivePosition();
+    if (_start == nullptr || _end == nullptr || _livepos == nullptr) return;
+    //the app seeks to LivePosition - which lands in Playlist::SetCurrentPositionLive()
+    _LiveCatchupSeekSuggested(this, ref new HLSSlidingWindow(_start->ValueInTicks, _end->ValueInTicks, _livepos->ValueInTicks));
+  }
+  catch (...)
+  {
+  }
 }
\ No newline at end of file
@@ -59,6 +59,7 @@ namespace Microsoft {
         event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSegmentSwitchEventArgs^>^ _SegmentSwitched;
         event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSegment^>^ _SegmentDataLoaded;
         event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ _SlidingWindowChanged;
+        event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ _LiveCatchupSeekSuggested;
       internal:
 
         HLSPlaylist(HLSController^ controller, bool IsVariantChild, unsigned int bitratekey);
@@ -75,6 +76,8 @@ namespace Microsoft {
         void RaiseStreamSelectionChanged(TrackType from, TrackType to);
         ///<summary>Raise sliding window changed event</summary> 
         void RaiseSlidingWindowChanged(Playlist *from);
+        ///<summary>Raise live catchup seek suggested event</summary> 
+        void RaiseLiveCatchupSeekSuggested(Playlist *from);
 
       public:
         virtual event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSBitrateSwitchEventArgs^>^ BitrateSwitchSuggested
@@ -183,6 +186,17 @@ namespace Microsoft {
             return _SlidingWindowChanged(sender, args);
           }*/
         }
+        virtual event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ LiveCatchupSeekSuggested
+        {
+          Windows::Foundation::EventRegistrationToken add(Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ handler)
+          {
+            return _LiveCatchupSeekSuggested += handler;
+          }
+          void remove(Windows::Foundation::EventRegistrationToken token)
+          {
+            _LiveCatchupSeekSuggested -= token;
+          }
+        }
 
 
 
@@ -256,6 +270,8 @@ namespace Microsoft {
         virtual Windows::Foundation::Collections::IMap<TrackType, unsigned short>^ GetPIDFilter();
         virtual void ResetBitrateLock();
         virtual Windows::Foundation::Collections::IVector<Windows::Foundation::TimeSpan>^ GetPlaylistBatchItemDurations();
+        ///<summary>Returns the timed metadata of the loaded segments with a timestamp in [From, To], without rescanning the segments</summary>
+        virtual Windows::Foundation::Collections::IVector<IHLSID3MetadataPayload^>^ GetMetadataInRange(Windows::Foundation::TimeSpan From, Windows::Foundation::TimeSpan To);
 
 
 
@@ -24,13 +24,21 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <memory>
 #include <mutex>
 #include <deque>
+#include <sstream>
 #include <collection.h>
 #include "MediaSegment.h" 
 #include "HLSSegment.h"
 #include "HLSController.h"
 #include "HLSPlaylist.h"
 #include "HLSInbandCCPayload.h"
+#include "HLSInbandCCExtractor.h"
 #include "HLSID3MetadataStream.h"
+#include "Playlist.h"
+#include "HLSMediaSource.h"
+#include "EncryptionKey.h"
+#include "AESCrypto.h"
+#include "ContentDownloader.h"
+#include "Cookie.h"
 
 using namespace Platform;
 using namespace Microsoft::HLSClient;
@@ -73,17 +81,7 @@ std::shared_ptr<MediaSegment> HLSSegment::FindMatch(HLSController^ controller, u
   if (targetPlaylist == nullptr)
     return retval;
 
-  std::unique_lock<std::recursive_mutex> listlock(targetPlaylist->LockSegmentList,std::defer_lock);
-  if (targetPlaylist->IsLive) listlock.lock();
-
-  auto found = std::find_if(targetPlaylist->Segments.begin(), targetPlaylist->Segments.end(), [seqNum](std::shared_ptr<MediaSegment> mseg)
-  {
-    return mseg->SequenceNumber == seqNum;
-  });
-  if (found != targetPlaylist->Segments.end())
-    retval = *found;
-
-  return retval;
+  return targetPlaylist->GetSegment(seqNum);
 }
 
 std::shared_ptr<MediaSegment> HLSSegment::FindMatch(HLSController^ controller, Rendition *pRendition, unsigned int seqNum)
@@ -99,17 +97,7 @@ std::shared_ptr<MediaSegment> HLSSegment::FindMatch(HLSController^ controller, R
     return retval;
 
   
-  std::unique_lock<std::recursive_mutex> listlock(pRendition->spPlaylist->LockSegmentList, std::defer_lock);
-  if (pRendition->spPlaylist->IsLive) listlock.lock(); 
-
-  auto found = std::find_if(pRendition->spPlaylist->Segments.begin(), pRendition->spPlaylist->Segments.end(), [seqNum](std::shared_ptr<MediaSegment> mseg)
-  {
-    return mseg->SequenceNumber == seqNum;
-  });
-  if (found != pRendition->spPlaylist->Segments.end())
-    retval = *found;
-
-  return retval;
+  return pRendition->spPlaylist->GetSegment(seqNum);
 }
 
 HLSSegment::HLSSegment(HLSController^ controller, unsigned int bitrate, std::shared_ptr<MediaSegment> found) : _controller(controller)
@@ -130,7 +118,7 @@ HLSSegment::HLSSegment(HLSController^ controller, unsigned int bitrate, std::sha
   else if (found->HasMediaType(ContentType::AUDIO))
     _mediaType = TrackType::VIDEO;
 
-  _url = found->MediaUri;
+  _url = found->GetMediaUri();
   _segmentState = (found->GetCurrentState() == INMEMORYCACHE) ? SegmentState::LOADED : SegmentState::NOTLOADED;
 
   if (controller->MediaSource->spRootPlaylist->IsVariant)
@@ -187,8 +175,8 @@ void HLSSegment::LoadCC(shared_ptr<MediaSegment> found)
     std::transform(begin(found->CCSamples), end(found->CCSamples), begin(_ccpayloads), [found](shared_ptr<SampleData> sd)
     {
       return ref new HLSInbandCCPayload(found->pParentPlaylist->IsLive ? 
-        (found->Discontinous == false ? sd->SamplePTS->ValueInTicks : (sd->DiscontinousTS != nullptr ? sd->DiscontinousTS->ValueInTicks : sd->SamplePTS->ValueInTicks)) :
-        (found->Discontinous == false ? found->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks : (sd->DiscontinousTS != nullptr ? found->TSAbsoluteToRelative(sd->DiscontinousTS)->ValueInTicks : found->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks)),
+        (found->Discontinous == false ? sd->SamplePTS->ValueInTicks : (sd->HasDiscontinousTS() ? sd->GetDiscontinousTSValue() : sd->SamplePTS->ValueInTicks)) :
+        (found->Discontinous == false ? found->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks : (sd->HasDiscontinousTS() ? found->TSAbsoluteToRelative(sd->GetDiscontinousTSValue())->ValueInTicks : found->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks)),
         std::get<0>(*(sd->spInBandCC.get())), std::get<1>(*(sd->spInBandCC.get())));
     });
   }
@@ -220,8 +208,8 @@ void HLSSegment::LoadMetadata(shared_ptr<MediaSegment> found)
       {
         try{
           auto pld = ref new HLSID3MetadataPayload(
-            found->pParentPlaylist->IsLive ? (found->Discontinous == false ? (*itr)->SamplePTS->ValueInTicks : ((*itr)->DiscontinousTS != nullptr ? (*itr)->DiscontinousTS->ValueInTicks : (*itr)->SamplePTS->ValueInTicks)) :
-            (found->Discontinous == false ? found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks : ((*itr)->DiscontinousTS != nullptr ? found->TSAbsoluteToRelative((*itr)->DiscontinousTS)->ValueInTicks : found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks)),
+            found->pParentPlaylist->IsLive ? (found->Discontinous == false ? (*itr)->SamplePTS->ValueInTicks : ((*itr)->HasDiscontinousTS() ? (*itr)->GetDiscontinousTSValue() : (*itr)->SamplePTS->ValueInTicks)) :
+            (found->Discontinous == false ? found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks : ((*itr)->HasDiscontinousTS() ? found->TSAbsoluteToRelative((*itr)->GetDiscontinousTSValue())->ValueInTicks : found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks)),
             (*itr)->elemData);
           unreadunits.push_back(pld);
         }
@@ -241,8 +229,8 @@ void HLSSegment::LoadMetadata(shared_ptr<MediaSegment> found)
       {
         try{
           auto pld = ref new HLSID3MetadataPayload(
-            found->pParentPlaylist->IsLive ? (found->Discontinous == false ? (*itr)->SamplePTS->ValueInTicks : ((*itr)->DiscontinousTS != nullptr ? (*itr)->DiscontinousTS->ValueInTicks : (*itr)->SamplePTS->ValueInTicks)) :
-            (found->Discontinous == false ? found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks : ((*itr)->DiscontinousTS != nullptr ? found->TSAbsoluteToRelative((*itr)->DiscontinousTS)->ValueInTicks : found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks)),
+            found->pParentPlaylist->IsLive ? (found->Discontinous == false ? (*itr)->SamplePTS->ValueInTicks : ((*itr)->HasDiscontinousTS() ? (*itr)->GetDiscontinousTSValue() : (*itr)->SamplePTS->ValueInTicks)) :
+            (found->Discontinous == false ? found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks : ((*itr)->HasDiscontinousTS() ? found->TSAbsoluteToRelative((*itr)->GetDiscontinousTSValue())->ValueInTicks : found->TSAbsoluteToRelative((*itr)->SamplePTS)->ValueInTicks)),
             (*itr)->elemData);
           readunits.push_back(pld);
         }
@@ -295,6 +283,88 @@ IVector<IHLSInbandCCPayload^>^ HLSSegment::GetInbandCCUnits()
   return _ccpayloads;
 }
 
+Windows::Foundation::IAsyncOperation<IVector<IHLSInbandCCPayload^>^>^ HLSSegment::ExtractInbandCCUnitsAsync()
+{
+  if (_controller == nullptr || !_controller->IsValid)  throw ref new Platform::ObjectDisposedException();
+
+  auto found = HLSSegment::FindMatch(_controller, this->_forBitrate, this->_sequenceNumber);
+  if (found == nullptr)
+    throw ref new Platform::ObjectDisposedException();
+
+  auto ms = found->pParentPlaylist->cpMediaSource;
+  //same normalization GetInbandCCUnits() applies - VOD timestamps start at 0, live ones are left alone
+  unsigned long long startpts = (!found->pParentPlaylist->IsLive && found->pParentPlaylist->StartPTSOriginal != nullptr) ? found->pParentPlaylist->StartPTSOriginal->ValueInTicks : 0;
+
+  std::vector<shared_ptr<Cookie>> cookies;
+  std::map<std::wstring, std::wstring> headers;
+  Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
+  wstring url = found->GetMediaUri();
+  if (found->IsHttpByteRange)
+  {
+    wostringstream byterange;
+    byterange << "bytes=" << found->ByteRangeOffset << "-" << found->ByteRangeOffset + found->LengthInBytes - 1;
+    headers.insert(std::pair<wstring, wstring>(L"Range", byterange.str()));
+  }
+  ms->cpController->RaisePrepareResourceRequest(ResourceType::SEGMENT, url, cookies, headers, &external);
+
+  //a downloader of our own (and no heuristics manager) - this must not show up in the bandwidth measurements or the segment state
+  DefaultContentDownloader^ downloader = ref new DefaultContentDownloader();
+  downloader->Initialize(ref new Platform::String(url.data()));
+  if (external == nullptr)
+    downloader->SetParameters(nullptr, L"GET", cookies, headers);
+  else
+    downloader->SetParameters(nullptr, external);
+
+  task_completion_event<shared_ptr<std::vector<BYTE>>> tceDownloaded;
+  downloader->Completed += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^>(
+    [tceDownloaded](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
+  {
+    if (args->Content != nullptr && args->IsSuccessStatusCode)
+      tceDownloaded.set(make_shared<std::vector<BYTE>>(DefaultContentDownloader::BufferToVector(args->Content)));
+    else
+      tceDownloaded.set(nullptr);
+  });
+  downloader->Error += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^>(
+    [tceDownloaded](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
+  {
+    tceDownloaded.set(nullptr);
+  });
+  downloader->DownloadAsync();
+
+  auto encKey = found->EncKey;
+  auto seqnum = found->SequenceNumber;
+
+  return create_async([tceDownloaded, encKey, seqnum, startpts, downloader]()
+  {
+    return task<shared_ptr<std::vector<BYTE>>>(tceDownloaded).then([encKey, seqnum, startpts](shared_ptr<std::vector<BYTE>> data)
+    {
+      if (data == nullptr || data->empty())
+        throw ref new Platform::COMException(E_FAIL, "Segment download failed");
+
+      //SAMPLE-AES leaves the SEI NAL units in the clear - only whole segment AES-128 needs decrypting
+      if (encKey != nullptr && encKey->Method == AES_128)
+      {
+        if (encKey->cpCryptoKey == nullptr && FAILED(encKey->DownloadKeyAsync().get()))
+          throw ref new Platform::COMException(E_FAIL, "Key download failed");
+
+        Platform::Array<BYTE>^ decdata = nullptr;
+        if (!encKey->InitializationVector.empty())
+          decdata = AESCrypto::GetCurrent()->Decrypt(encKey->cpCryptoKey, data->data(), (unsigned int) data->size(), encKey->InitializationVector);
+        else
+        {
+          auto iv = encKey->ToInitializationVector(seqnum);
+          decdata = AESCrypto::GetCurrent()->Decrypt(encKey->cpCryptoKey, data->data(), (unsigned int) data->size(), &(*(iv->begin())), static_cast<unsigned int>(iv->size()));
+        }
+        if (decdata == nullptr)
+          throw ref new Platform::COMException(E_FAIL, "Segment decryption failed");
+        data->assign(decdata->begin(), decdata->end());
+      }
+
+      return HLSInbandCCExtractor::Extract(data->data(), (unsigned int) data->size(), startpts);
+    }, task_continuation_context::use_arbitrary());
+  });
+}
+
 IVector<IHLSID3MetadataStream^>^ HLSSegment::GetMetadataStreams()
 {
   if (_controller == nullptr || !_controller->IsValid)  throw ref new Platform::ObjectDisposedException();
@@ -123,6 +123,11 @@ namespace Microsoft {
 
         virtual IVector<IHLSInbandCCPayload^>^ GetInbandCCUnits();
 
+        ///<summary>Downloads (and decrypts) the segment on its own and demuxes the in-band caption data out of it</summary>
+        ///<remarks>Unlike GetInbandCCUnits() this does not need the segment to have been loaded for playback, and it leaves the
+        ///segment the media source plays from alone. Only transport stream segments carry SEI captions the SDK can extract.</remarks>
+        virtual Windows::Foundation::IAsyncOperation<IVector<IHLSInbandCCPayload^>^>^ ExtractInbandCCUnitsAsync();
+
         virtual IVector<IHLSID3MetadataStream^>^ GetMetadataStreams();
 
         virtual IVector<Platform::String^>^ GetUnprocessedTags(UnprocessedTagPlacement placement);
@@ -0,0 +1,89 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+#pragma once
+
+#include "Interfaces.h"
+#include "HLSMediaSource.h"
+
+using namespace Microsoft::HLSClient;
+
+namespace Microsoft{
+  namespace HLSClient{
+    namespace Private {
+
+      [Windows::Foundation::Metadata::Threading(Windows::Foundation::Metadata::ThreadingModel::Both)]
+      [Windows::Foundation::Metadata::MarshalingBehavior(Windows::Foundation::Metadata::MarshalingType::Agile)]
+      public ref class HLSStartupMetrics sealed : public IHLSStartupMetrics
+      {
+      private:
+        Windows::Foundation::TimeSpan _masterplaylist, _mediaplaylist, _startsegment, _opencompletion, _firstsample, _timetofirstframe;
+
+        static Windows::Foundation::TimeSpan FromMilliseconds(ULONGLONG ms)
+        {
+          return Windows::Foundation::TimeSpan{ (long long) ms * 10000 };
+        }
+
+      internal:
+        HLSStartupMetrics(const StartupPhaseTimes& times)
+        {
+          //single bitrate playlists do not have a separate media playlist phase
+          auto mediaPlaylistReady = times.MediaPlaylistReady != 0 ? times.MediaPlaylistReady : times.MasterPlaylistReady;
+
+          _masterplaylist = FromMilliseconds(times.MasterPlaylistReady - times.OpenStarted);
+          _mediaplaylist = FromMilliseconds(mediaPlaylistReady - times.MasterPlaylistReady);
+          _startsegment = FromMilliseconds(times.StartSegmentReady - mediaPlaylistReady);
+          _opencompletion = FromMilliseconds(times.OpenCompleted - times.StartSegmentReady);
+          _firstsample = FromMilliseconds(times.FirstSampleDelivered - times.OpenCompleted);
+          _timetofirstframe = FromMilliseconds(times.FirstSampleDelivered - times.OpenStarted);
+        }
+
+      public:
+        property Windows::Foundation::TimeSpan MasterPlaylist
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _masterplaylist; }
+        }
+        property Windows::Foundation::TimeSpan MediaPlaylist
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _mediaplaylist; }
+        }
+        property Windows::Foundation::TimeSpan StartSegment
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _startsegment; }
+        }
+        property Windows::Foundation::TimeSpan OpenCompletion
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _opencompletion; }
+        }
+        property Windows::Foundation::TimeSpan FirstSample
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _firstsample; }
+        }
+        property Windows::Foundation::TimeSpan TimeToFirstFrame
+        {
+          virtual Windows::Foundation::TimeSpan get() { return _timetofirstframe; }
+        }
+      };
+    }
+  }
+}
@@ -0,0 +1,177 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include "ID3TagParser.h"
+#include "MediaSegment.h"
+#include "Playlist.h"
+#include "ID3MetadataTimeline.h"
+
+using namespace std;
+using namespace Microsoft::HLSClient::Private;
+
+///<remarks>The segment lock and the timeline lock are never held together - callers of RetimeSegment hold the segment lock</remarks>
+void ID3MetadataTimeline::IndexSegment(MediaSegment *pSegment)
+{
+  auto SeqNum = pSegment->GetSequenceNumber();
+  {
+    std::lock_guard<recursive_mutex> lock(_lockthis);
+    if (_indexedsegments.find(SeqNum) != _indexedsegments.end())
+      return;
+  }
+
+  std::vector<shared_ptr<ID3MetadataCue>> cues;
+  {
+    std::lock_guard<recursive_mutex> lockseg(pSegment->LockSegment);
+    if (pSegment->MetadataStreams.size() == 0)
+      return;
+
+    for (auto pid : pSegment->MetadataStreams)
+    {
+      if (pSegment->UnreadQueues.find(pid) == pSegment->UnreadQueues.end())
+        continue;
+
+      for (auto sd : pSegment->UnreadQueues[pid])
+      {
+        auto cue = make_shared<ID3MetadataCue>();
+        if (!ID3TagParser::ExtractTag(sd->elemData, cue->Payload))
+          continue;
+
+        cue->RawPTS = sd->SamplePTS->ValueInTicks;
+        cue->TimeInTicks = GetCueTime(pSegment, pid, cue->RawPTS);
+        cue->SequenceNumber = SeqNum;
+        cue->PID = pid;
+        cues.push_back(cue);
+      }
+    }
+  }
+
+  for (auto cue : cues)
+    cue->Frames = ID3TagParser::Parse(&(*(cue->Payload.begin())), (ULONG) cue->Payload.size());
+
+  std::lock_guard<recursive_mutex> lock(_lockthis);
+  //another variant's segment with the same sequence number may have been indexed while we parsed
+  if (_indexedsegments.find(SeqNum) != _indexedsegments.end())
+    return;
+  _indexedsegments.insert(SeqNum);
+  for (auto cue : cues)
+    _cues.emplace(cue->TimeInTicks, cue);
+}
+
+///<remarks>A discontinuous segment is indexed when it finishes downloading, which is usually before the segment ahead of it 
+///has played and its discontinuity offsets are known</remarks>
+void ID3MetadataTimeline::RetimeSegment(MediaSegment *pSegment)
+{
+  auto SeqNum = pSegment->GetSequenceNumber();
+
+  //PID and raw timestamp of each indexed cue of the segment
+  std::vector<pair<unsigned short, unsigned long long>> raw;
+  {
+    std::lock_guard<recursive_mutex> lock(_lockthis);
+    if (_indexedsegments.find(SeqNum) == _indexedsegments.end())
+      return;
+    for (auto& itm : _cues)
+    {
+      if (itm.second->SequenceNumber == SeqNum)
+        raw.push_back(make_pair(itm.second->PID, itm.second->RawPTS));
+    }
+  }
+  if (raw.empty())
+    return;
+
+  std::map<pair<unsigned short, unsigned long long>, unsigned long long> times;
+  {
+    std::lock_guard<recursive_mutex> lockseg(pSegment->LockSegment);
+    for (auto& r : raw)
+      times[r] = GetCueTime(pSegment, r.first, r.second);
+  }
+
+  std::lock_guard<recursive_mutex> lock(_lockthis);
+  std::vector<shared_ptr<ID3MetadataCue>> retimed;
+  for (auto itr = _cues.begin(); itr != _cues.end();)
+  {
+    auto found = itr->second->SequenceNumber == SeqNum ? times.find(make_pair(itr->second->PID, itr->second->RawPTS)) : times.end();
+    if (found != times.end() && found->second != itr->second->TimeInTicks)
+    {
+      itr->second->TimeInTicks = found->second;
+      retimed.push_back(itr->second);
+      itr = _cues.erase(itr);
+    }
+    else
+      itr++;
+  }
+
+  for (auto cue : retimed)
+    _cues.emplace(cue->TimeInTicks, cue);
+}
+
+///<summary>Same timestamp as HLSSegment::LoadMetadata() reports for the payload</summary>
+unsigned long long ID3MetadataTimeline::GetCueTime(MediaSegment *pSegment, unsigned short PID, unsigned long long RawPTS)
+{
+  auto pts = RawPTS;
+  if (pSegment->Discontinous)
+  {
+    auto itr = pSegment->DiscontinuityOffsets.find(PID);
+    if (itr != pSegment->DiscontinuityOffsets.end() && itr->second->IsSet)
+      pts = (unsigned long long) ((long long) RawPTS + itr->second->Offset);
+  }
+  return pSegment->pParentPlaylist->IsLive ? pts : pSegment->TSAbsoluteToRelative(pts)->ValueInTicks;
+}
+
+void ID3MetadataTimeline::RemoveBefore(unsigned int SequenceNumber)
+{
+  std::lock_guard<recursive_mutex> lock(_lockthis);
+
+  if (_indexedsegments.size() == 0 || *(_indexedsegments.begin()) >= SequenceNumber)
+    return;
+
+  for (auto itr = _cues.begin(); itr != _cues.end();)
+  {
+    if (itr->second->SequenceNumber < SequenceNumber)
+      itr = _cues.erase(itr);
+    else
+      itr++;
+  }
+
+  _indexedsegments.erase(_indexedsegments.begin(), _indexedsegments.lower_bound(SequenceNumber));
+}
+
+std::vector<shared_ptr<ID3MetadataCue>> ID3MetadataTimeline::GetCuesInRange(unsigned long long From, unsigned long long To)
+{
+  std::lock_guard<recursive_mutex> lock(_lockthis);
+
+  std::vector<shared_ptr<ID3MetadataCue>> ret;
+  if (To < From)
+    return ret;
+
+  for (auto itr = _cues.lower_bound(From); itr != _cues.end() && itr->first <= To; itr++)
+    ret.push_back(itr->second);
+
+  return ret;
+}
+
+void ID3MetadataTimeline::Clear()
+{
+  std::lock_guard<recursive_mutex> lock(_lockthis);
+  _cues.clear();
+  _indexedsegments.clear();
+}
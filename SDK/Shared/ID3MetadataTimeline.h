@@ -0,0 +1,80 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include "pch.h"
+#include <map>
+#include <set>
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <string>
+#include <mutex>
+#include <wtypes.h>
+
+using namespace std;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      class MediaSegment;
+
+      ///<summary>A timed ID3 tag, with its frames parsed once when the segment carrying it was loaded</summary>
+      struct ID3MetadataCue
+      {
+        ///<summary>Presentation time on the same timeline as the payloads surfaced through IHLSSegment</summary>
+        unsigned long long TimeInTicks;
+        ///<summary>Timestamp as carried in the segment, before any discontinuity remapping</summary>
+        unsigned long long RawPTS;
+        unsigned int SequenceNumber;
+        unsigned short PID;
+        std::vector<BYTE> Payload;
+        std::vector<shared_ptr<tuple<string, std::vector<BYTE>>>> Frames;
+      };
+
+      ///<summary>Index of the timed metadata of a presentation, ordered by presentation time</summary>
+      ///<remarks>Segments are indexed when they finish loading, so range queries (ad insertion, chaptering) can look ahead without
+      ///rescanning segments. The same metadata is carried by every variant, so each sequence number is indexed once.</remarks>
+      class ID3MetadataTimeline
+      {
+      private:
+        std::multimap<unsigned long long, shared_ptr<ID3MetadataCue>> _cues;
+        std::set<unsigned int> _indexedsegments;
+        std::recursive_mutex _lockthis;
+        ///<remarks>Caller holds the segment's LockSegment</remarks>
+        unsigned long long GetCueTime(MediaSegment *pSegment, unsigned short PID, unsigned long long RawPTS);
+      public:
+        ///<summary>Parses the ID3 tags of a segment that was just loaded and adds them to the timeline</summary>
+        void IndexSegment(MediaSegment *pSegment);
+        ///<summary>Moves the cues of an indexed segment to the presentation times its discontinuity offsets now map them to</summary>
+        void RetimeSegment(MediaSegment *pSegment);
+        ///<summary>Removes the cues of segments older than the supplied sequence number (for live sliding windows)</summary>
+        void RemoveBefore(unsigned int SequenceNumber);
+        ///<summary>Returns the cues with a presentation time in [From, To], in time order</summary>
+        std::vector<shared_ptr<ID3MetadataCue>> GetCuesInRange(unsigned long long From, unsigned long long To);
+        void Clear();
+      };
+    }
+  }
+}
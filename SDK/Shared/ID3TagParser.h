@@ -26,6 +26,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "pch.h"
 #include <vector>
 #include <memory>
+#include <tuple>
+#include <string>
 #include <wtypes.h>
 #include "BitOp.h"
 
@@ -42,19 +44,9 @@ namespace Microsoft {
 
         static  bool IsID3Tag(BYTE* data, ULONG size, ULONG& readctr, BYTE& flags, unsigned int& tagsize, unsigned short& majorversion)
         {
-
-          //read 3 bytes at a time and carry on until you find "ID3"
-          for (; readctr < size; readctr++)
-          {
-            BYTE tagid[4];
-            ZeroMemory(tagid, 4);
-            memcpy_s(tagid, 3, data + readctr, 3);
-            if (string((char *) tagid) == "ID3")
-            {
-              readctr += 3;
-              break;
-            }
-          }
+          if (!FindTagHeader(data, size, readctr))
+            return false;
+          readctr += 3;
 
           if (readctr + 2 >= size) //2 bytes left to read for version ? 
             return false;
@@ -95,13 +87,21 @@ namespace Microsoft {
         static void StripExtendedHeader(BYTE* data, ULONG size, ULONG& readctr)
         {
           //read extened header size 
-          auto exthdrsize = BitOp::ToInteger<unsigned int>(data, 4);
-          readctr += exthdrsize;
+          if (readctr + 4 > size)
+          {
+            readctr = size;
+            return;
+          }
+          auto exthdrsize = BitOp::ToInteger<unsigned int>(data + readctr, 4);
+          readctr = exthdrsize > size - readctr ? size : readctr + exthdrsize;
         }
 
-        static bool ExtractFrame(BYTE* data, ULONG size, ULONG& readctr, string& FrameID, unsigned int& FrameSize, BYTE& FrameFlags, std::vector<BYTE>& framedata, unsigned short majorversion)
+        static bool ExtractFrame(BYTE* data, ULONG size, ULONG& readctr, string& FrameID, unsigned int& FrameSize, BYTE& FrameFlags, std::vector<BYTE>& framedata, unsigned short /*majorversion*/)
         {
 
+          //need a complete frame header, and a zero byte here means we reached the padding
+          if (readctr + 10 > size || data[readctr] == 0)
+            return false;
           //frame header begins with frame id string = 4 bytes
           BYTE tagid[5];
           ZeroMemory(tagid, 5);
@@ -125,35 +125,48 @@ namespace Microsoft {
           //}
 
           readctr += 4;
-          //skip the flags
+          //status flags, then format flags (compression, encryption, unsynchronisation)
+          FrameFlags = data[readctr + 1];
           readctr += 2;
 
-          //look for a null character
+          if (FrameSize > size - readctr)
+            return false;
 
           framedata.resize(FrameSize);
-          memcpy_s(&(*(framedata.begin())), FrameSize, data + readctr, FrameSize);
+          if (FrameSize > 0)
+            memcpy_s(&(*(framedata.begin())), FrameSize, data + readctr, FrameSize);
           readctr += FrameSize;
           return true;
         }
 
       public:
-
-        static bool AdjustPayloadToID3Tag(BYTE* data, ULONG size, ULONG& startat, ULONG& correctpayloadsize)
+        ///<summary>Moves readctr to the next ID3v2 tag header at or after it</summary>
+        ///<remarks>Uses memchr to jump between candidate 'I' bytes instead of copying every 3 byte window into a string, and checks the
+        ///version and synchsafe size bytes so that an "ID3" sequence inside media data is not mistaken for a tag</remarks>
+        static bool FindTagHeader(const BYTE* data, ULONG size, ULONG& readctr)
         {
-          ULONG readctr = 0;
-          //read 3 bytes at a time and carry on until you find "ID3"
-          for (; readctr < size; readctr++, startat++)
+          while (readctr + 10 <= size)
           {
-            BYTE tagid[4];
-            ZeroMemory(tagid, 4);
-            memcpy_s(tagid, 3, data + readctr, 3);
-            if (string((char *) tagid) == "ID3")
-            {
-              readctr += 3;
+            auto candidate = (const BYTE*) memchr(data + readctr, 'I', size - readctr - 9);
+            if (candidate == nullptr)
               break;
-            }
+            readctr = (ULONG) (candidate - data);
+            if (candidate[1] == 'D' && candidate[2] == '3' && candidate[3] != 0xFF && candidate[4] != 0xFF &&
+              (candidate[6] | candidate[7] | candidate[8] | candidate[9]) < 0x80)
+              return true;
+            readctr++;
           }
+          readctr = size;
+          return false;
+        }
 
+        static bool AdjustPayloadToID3Tag(BYTE* data, ULONG size, ULONG& startat, ULONG& correctpayloadsize)
+        {
+          ULONG readctr = 0;
+          if (!FindTagHeader(data, size, readctr))
+            return false;
+          startat += readctr;
+          readctr += 3;
 
           if (readctr + 2 >= size) //2 bytes left to read for version ? 
             return false;
@@ -197,6 +210,32 @@ namespace Microsoft {
 
           return (readctr >= size) ? false : true;
         }
+        ///<summary>Joins the PES payload chunks of a metadata sample and trims the result to the ID3 tag it carries</summary>
+        ///<returns>False if the chunks do not contain a complete tag</returns>
+        static bool ExtractTag(const std::vector<tuple<const BYTE*, unsigned int>>& payloadchunks, std::vector<BYTE>& tag)
+        {
+          tag.clear();
+          for (auto itr = payloadchunks.begin(); itr != payloadchunks.end(); itr++)
+          {
+            auto data = std::get<0>(*itr);
+            auto len = std::get<1>(*itr);
+            if (len == 0)
+              continue;
+            tag.insert(tag.end(), data, data + len);
+          }
+
+          ULONG correctsize = 0;
+          ULONG startat = 0;
+          if (tag.size() == 0 || !AdjustPayloadToID3Tag(&(*(tag.begin())), (ULONG) tag.size(), startat, correctsize))
+            return false;
+
+          tag.erase(tag.begin(), tag.begin() + startat);
+          if (correctsize > tag.size())
+            return false;
+          tag.resize(correctsize);
+          return true;
+        }
+
         static vector<shared_ptr<tuple<string, std::vector<BYTE>>>> Parse(BYTE* data, ULONG size)
         {
           ULONG readctr = 0;
@@ -207,18 +246,22 @@ namespace Microsoft {
           if (!IsID3Tag(data, size, readctr, hdrflags, tagsize, majorversion))
             return ret;
 
+          //the tag size does not include the 10 byte header we just read
+          ULONG tagend = __min(size, readctr + tagsize);
+
           if ((hdrflags & 0x40) == 0x40) //we have extended header
             StripExtendedHeader(data, size, readctr);
 
-          while (readctr < tagsize - 1)
+          while (readctr < tagend)
           {
             unsigned int framesize = 0;
             BYTE frameflags = 0;
             string frameid;
             std::vector<BYTE> framedata;
-            auto gotframe = ExtractFrame(data, size, readctr, frameid, framesize, frameflags, framedata, majorversion);
-            if (gotframe)
-              ret.push_back(make_shared<tuple<string, vector<BYTE>>>(frameid, framedata));
+            auto gotframe = ExtractFrame(data, tagend, readctr, frameid, framesize, frameflags, framedata, majorversion);
+            if (!gotframe)
+              break;
+            ret.push_back(make_shared<tuple<string, vector<BYTE>>>(frameid, framedata));
 
           }
 
@@ -227,6 +270,45 @@ namespace Microsoft {
           return ret;
 
         }
+
+        ///<summary>Finds the PRIV frame that carries the initial timestamp of packed audio</summary>
+        ///<returns>Offset of the 8 octet timestamp, or size if there is none</returns>
+        ///<remarks>Walks the frames of each tag we find instead of matching strings at every offset</remarks>
+        static ULONG FindTransportStreamTimestamp(const BYTE* data, ULONG size)
+        {
+          static const char PRIVOwner[] = "com.apple.streaming.transportStreamTimestamp";
+          ULONG idx = 0;
+
+          while (FindTagHeader(data, size, idx))
+          {
+            BYTE flags = data[idx + 5];
+            //tag size is synchsafe and does not include the 10 byte header
+            ULONG tagsize = (data[idx + 6] << 21) | (data[idx + 7] << 14) | (data[idx + 8] << 7) | data[idx + 9];
+            ULONG tagend = __min(size, idx + 10 + tagsize);
+            ULONG framectr = idx + 10;
+
+            if ((flags & 0x40) == 0x40 && framectr + 4 <= tagend) //skip the extended header
+              framectr += BitOp::ToInteger<unsigned int>(data + framectr, 4);
+
+            //each frame has a 10 byte header - 4 byte id, 4 byte size and 2 bytes of flags - a zero byte means we reached the padding
+            while (framectr + 10 <= tagend && data[framectr] != 0)
+            {
+              ULONG framesize = (data[framectr + 4] << 21) | (data[framectr + 5] << 14) | (data[framectr + 6] << 7) | data[framectr + 7];
+              ULONG framedata = framectr + 10;
+              if (framesize > tagend - framedata)
+                break;
+              //PRIV frame data = owner identifier (null terminated) followed by the private data - an 8 octet timestamp for us
+              if (memcmp(data + framectr, "PRIV", 4) == 0 && framesize >= sizeof(PRIVOwner) + 8 &&
+                memcmp(data + framedata, PRIVOwner, sizeof(PRIVOwner)) == 0)
+                return framedata + sizeof(PRIVOwner);
+
+              framectr = framedata + framesize;
+            }
+            //not in this tag - look past it
+            idx = __max(idx + 1, tagend);
+          }
+          return size;
+        }
       };
     }
   }
@@ -20,38 +20,37 @@ FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TOR
 WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/
-#pragma once
-
-#include <mutex>
-#include <map>
-#include <vector>
 
 #include "pch.h"
-#include "Timestamp.h"
-
-namespace Microsoft { namespace CC608 {
-
-  // stores incoming raw caption data--external components add data to the queue, and the 
-  // processing thread gets the data as needed
-  class CaptionDataQueue
-  {
-  typedef std::map<Timestamp, std::vector<byte_t>> captiondataqueuemap_t;
+#include <map>
+#include <deque>
+#include "TransportStreamParser.h"
+#include "InbandCCExtractor.h"
 
-  public:
-    CaptionDataQueue(void);
-    ~CaptionDataQueue(void);
+using namespace Microsoft::HLSClient::Private;
 
-    void AddCaptionData(const Timestamp ts, const std::vector<byte_t>& captionByteData);
-    void AddCaptionData(const std::vector<std::pair<Timestamp, std::vector<byte_t>>>& data);
+HRESULT InbandCCExtractor::ExtractFromTransportStream(const BYTE *tsdata, ULONG size, std::vector<ccunit_t>& units)
+{
+  if (tsdata == nullptr || size < 188 || !TransportStreamParser::IsTransportStream(tsdata))
+    return E_INVALIDARG;
 
-    std::vector<byte_t> GetSortedCaptionData(const Timestamp startTs, const Timestamp endTs);
+  TransportStreamParser parser;
+  std::map<ContentType, unsigned short> mediatypepidmap;
+  std::vector<unsigned short> metadatastreams;
+  std::map<unsigned short, std::deque<std::shared_ptr<SampleData>>> unreadqueues;
+  std::vector<std::shared_ptr<Timestamp>> timeline;
+  std::vector<std::shared_ptr<SampleData>> ccsamples;
 
-    // clears the data in the queue (used when seeking in a stream or when switching media sources)
-    void Clear();
+  parser.Parse(tsdata, size, mediatypepidmap, std::map<ContentType, unsigned short>(), metadatastreams, unreadqueues, timeline, ccsamples);
 
-  private:
-    std::mutex _mtx;
-    captiondataqueuemap_t _map;
-  };
+  //the samples point into tsdata, but the caption payloads are copies - they outlive the segment buffer
+  units.reserve(units.size() + ccsamples.size());
+  for (auto sd : ccsamples)
+  {
+    if (sd->spInBandCC == nullptr || sd->SamplePTS == nullptr)
+      continue;
+    units.push_back(ccunit_t(sd->SamplePTS->ValueInTicks, std::get<0>(*(sd->spInBandCC)), std::get<1>(*(sd->spInBandCC))));
+  }
 
-}}
\ No newline at end of file
+  return S_OK;
+}
@@ -0,0 +1,53 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+
+#pragma once
+#include <memory>
+#include <tuple>
+#include <vector>
+#include <wtypes.h>
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      ///<summary>Pulls the in-band caption data out of a segment without involving the playback pipeline</summary>
+      ///<remarks>The segment is demuxed with its own TransportStreamParser (and AVCParser/HEVCParser for the SEI messages), 
+      ///so nothing is shared with the MediaSegment instances the media source plays from. Each unit is the ITU-T T.35 SEI payload 
+      ///of one video sample (the "GA94" user data envelope the caption decoders take) and the sample PTS in ticks, in decode order.</remarks>
+      class InbandCCExtractor
+      {
+      public:
+        ///<summary>Timestamp (ticks), payload, payload length</summary>
+        typedef std::tuple<unsigned long long, std::shared_ptr<BYTE>, unsigned int> ccunit_t;
+
+        ///<summary>Demuxes a (decrypted) transport stream segment and collects its caption units</summary>
+        ///<param name='tsdata'>Segment data</param>
+        ///<param name='size'>Segment length in bytes</param>
+        ///<param name='units'>Receives the caption units</param>
+        ///<returns>E_INVALIDARG if the data is not a transport stream, S_OK otherwise (including segments without captions)</returns>
+        static HRESULT ExtractFromTransportStream(const BYTE *tsdata, ULONG size, std::vector<ccunit_t>& units);
+      };
+    }
+  }
+}
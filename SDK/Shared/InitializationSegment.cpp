@@ -0,0 +1,208 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <sstream>
+#include <ppltasks.h>
+#include "Cookie.h"
+#include "PlaylistHelpers.h"
+#include "Playlist.h"
+#include "HLSMediaSource.h" 
+#include "FileLogger.h"
+#include "HLSController.h"
+#include "ContentDownloader.h"
+#include "AESCrypto.h"
+#include "EncryptionKey.h"
+#include "InitializationSegment.h"
+
+using namespace std;
+using namespace Concurrency;
+using namespace Microsoft::HLSClient::Private;
+
+///<summary>InitializationSegment constructor</summary>
+///<param name='tagWithAttributes'>EXT-X-MAP tag string with attributes</param>
+///<param name='pParent'>Parent (variant - not master) playlist</param>
+InitializationSegment::InitializationSegment(std::wstring& tagWithAttributes, Playlist * pParent) :
+Uri(L""), IsHttpByteRange(false), ByteRangeOffset(0), LengthInBytes(0), pParentPlaylist(pParent), IsLoaded(false)
+{
+  attriblist = Helpers::ReadAttributeList(tagWithAttributes);
+
+  Helpers::ReadNamedAttributeValue(attriblist, L"URI", Uri);
+  //if Uri is not absolute, merge with base URI on the parent playlist to make absolute
+  if (!Uri.empty() && !Helpers::IsAbsoluteUri(Uri))
+    Uri = Helpers::JoinUri(pParent->BaseUri, Uri);
+
+  //BYTERANGE="<n>[@<o>]" - offset defaults to 0 for EXT-X-MAP
+  std::wstring byterange;
+  if (Helpers::ReadNamedAttributeValue(attriblist, L"BYTERANGE", byterange) && !byterange.empty())
+  {
+    Helpers::ReadAttributeValueFromPosition(byterange, 0, LengthInBytes, '@');
+    Helpers::ReadAttributeValueFromPosition(byterange, 1, ByteRangeOffset, '@');
+    IsHttpByteRange = LengthInBytes > 0;
+  }
+}
+
+///<summary>Downloads and parses the initialization section</summary>
+///<returns>Task to wait on</returns>
+task<HRESULT> InitializationSegment::DownloadAsync(task_completion_event<HRESULT> tceDownloadCompleted)
+{
+  CHLSMediaSource * ms = this->pParentPlaylist->cpMediaSource;
+
+  if (Uri.empty() || ms->GetCurrentState() == MSS_ERROR || ms->GetCurrentState() == MSS_UNINITIALIZED)
+  {
+    tceDownloadCompleted.set(E_FAIL);
+    return task<HRESULT>(tceDownloadCompleted);
+  }
+
+  std::map<wstring, wstring> headers;
+  std::vector<shared_ptr<Cookie>> cookies;
+  Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
+  wstring url = Uri;
+  if (IsHttpByteRange)
+  {
+    wostringstream byterange;
+    byterange << "bytes=" << ByteRangeOffset << "-" << ByteRangeOffset + LengthInBytes - 1;
+    //set HTTP Range header
+    headers.insert(std::pair<wstring, wstring>(L"Range", byterange.str()));
+  }
+  ms->cpController->RaisePrepareResourceRequest(ResourceType::SEGMENT, url, cookies, headers, &external);
+
+  DefaultContentDownloader^ downloader = ref new DefaultContentDownloader();
+
+  if (external == nullptr)
+  {
+    downloader->Initialize(ref new Platform::String(url.data()));
+    downloader->SetParameters(nullptr, L"GET", cookies, headers);
+  }
+  else
+  {
+    downloader->Initialize(ref new Platform::String(url.data()));
+    downloader->SetParameters(nullptr, external);
+  }
+
+  downloader->Completed += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^>(
+    [this, tceDownloadCompleted, ms](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
+  {
+    if ((ms->GetCurrentState() == MSS_ERROR || ms->GetCurrentState() == MSS_UNINITIALIZED))
+    {
+      tceDownloadCompleted.set(E_FAIL);
+    }
+    else
+    {
+      if (args->Content != nullptr && args->IsSuccessStatusCode)
+      {
+        std::vector<BYTE> MemoryCache = DefaultContentDownloader::BufferToVector(args->Content);
+        if (MemoryCache.size() == 0)
+          tceDownloadCompleted.set(E_FAIL);
+        else
+          this->OnDownloadCompleted(MemoryCache, tceDownloadCompleted);
+      }
+      else
+        tceDownloadCompleted.set(E_FAIL);
+    }
+  });
+  downloader->Error += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^>(
+    [this, tceDownloadCompleted](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
+  {
+    tceDownloadCompleted.set(E_FAIL);
+  });
+
+  downloader->DownloadAsync();
+  //return a task wrapped around the TCE that was passed in - will be signalled once download completes
+  return task<HRESULT>(tceDownloadCompleted);
+}
+
+HRESULT InitializationSegment::OnDownloadCompleted(std::vector<BYTE> memorycache, task_completion_event<HRESULT> tceDownloadCompleted)
+{
+  if (FAILED(Decrypt(memorycache)))
+  {
+    tceDownloadCompleted.set(E_FAIL);
+    return E_FAIL;
+  }
+
+  std::map<unsigned int, shared_ptr<FMP4TrackInfo>> tracks;
+  if (!FMP4Parser::ParseInitSegment(&(*(memorycache.begin())), (ULONG) memorycache.size(), tracks))
+  {
+    LOG(L"InitializationSegment::OnDownloadCompleted() - No audio or video track found :" << this->Uri);
+    tceDownloadCompleted.set(E_FAIL);
+    return E_FAIL;
+  }
+
+  //no lock here - Load() holds LockInit while it waits on us
+  Tracks = std::move(tracks);
+  IsLoaded = true;
+
+  tceDownloadCompleted.set(S_OK);
+  return S_OK;
+}
+
+bool InitializationSegment::IsEncryptedWith(shared_ptr<EncryptionKey> key)
+{
+  bool encrypted = EncKey != nullptr && EncKey->Method == AES_128;
+  bool otherencrypted = key != nullptr && key->Method == AES_128;
+  if (!encrypted || !otherencrypted)
+    return encrypted == otherencrypted;
+  return EncKey->IsEqual(key);
+}
+
+///<summary>Decrypts the section in place if an AES-128 key applies to it</summary>
+///<remarks>A SAMPLE-AES key only covers the media samples - the section itself is in the clear. For AES-128 the spec makes the IV 
+///attribute mandatory, since there is no sequence number to derive one from - without it we fail rather than hand the parser 
+///cipher text.</remarks>
+HRESULT InitializationSegment::Decrypt(std::vector<BYTE>& memorycache)
+{
+  if (EncKey == nullptr || EncKey->Method != AES_128)
+    return S_OK;
+
+  if (EncKey->InitializationVector.empty())
+  {
+    LOG(L"InitializationSegment::Decrypt() - AES-128 key without an IV :" << this->Uri);
+    return E_FAIL;
+  }
+
+  try
+  {
+    if (EncKey->cpCryptoKey == nullptr)
+    {
+      //the same key as the media segments - use it if we have it, else download it
+      auto LastCachedKey = pParentPlaylist->cpMediaSource->spRootPlaylist->LastCachedKey;
+      if (LastCachedKey != nullptr && LastCachedKey->cpCryptoKey != nullptr && EncKey->IsEqualKeyOnly(LastCachedKey))
+        EncKey->cpCryptoKey = LastCachedKey->cpCryptoKey;
+      else if (FAILED(EncKey->DownloadKeyAsync().get()))
+        return E_FAIL;
+    }
+    if (EncKey->cpCryptoKey == nullptr)
+      return E_FAIL;
+
+    auto decdata = AESCrypto::GetCurrent()->Decrypt(EncKey->cpCryptoKey, &(*(memorycache.begin())), (unsigned int) memorycache.size(), EncKey->InitializationVector);
+    if (decdata == nullptr || decdata->Length == 0)
+      return E_FAIL;
+    memorycache.assign(decdata->Data, decdata->Data + decdata->Length);
+  }
+  catch (...)
+  {
+    LOG(L"InitializationSegment::Decrypt() - Decryption failed :" << this->Uri);
+    return E_FAIL;
+  }
+
+  return S_OK;
+}
@@ -0,0 +1,106 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once 
+#include "pch.h"
+#include <memory>
+#include <string>
+#include <mutex>
+#include <map>
+#include <vector>
+#include <wtypes.h>
+#include <ppltasks.h>
+#include "FMP4Parser.h"
+
+using namespace std;
+using namespace Concurrency;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      class Playlist;
+      class EncryptionKey;
+
+      ///<summary>Type represents the media initialization section (EXT-X-MAP) that fragmented MP4 segments need before they can be parsed</summary>
+      class InitializationSegment
+      {
+      private:
+        std::recursive_mutex LockInit;
+        HRESULT Decrypt(std::vector<BYTE>& memorycache);
+      public:
+        std::wstring attriblist;
+        std::wstring Uri;
+        bool IsHttpByteRange;
+        unsigned long long ByteRangeOffset;
+        unsigned int LengthInBytes;
+        Playlist * pParentPlaylist;
+        ///<summary>The EXT-X-KEY in effect at the EXT-X-MAP tag, if any - an AES-128 key applies to the section as well</summary>
+        shared_ptr<EncryptionKey> EncKey;
+        ///<summary>Audio and video tracks from the moov box - keyed by track ID</summary>
+        std::map<unsigned int, shared_ptr<FMP4TrackInfo>> Tracks;
+        ///<summary>True once the section has been downloaded and parsed</summary>
+        bool IsLoaded;
+
+        ///<summary>InitializationSegment constructor</summary>
+        ///<param name='tagWithAttributes'>EXT-X-MAP tag string with attributes</param>
+        ///<param name='pParent'>Parent (variant - not master) playlist</param>
+        InitializationSegment(std::wstring& tagWithAttributes, Playlist * pParent);
+
+        ///<summary>Downloads and parses the initialization section</summary>
+        ///<returns>Task to wait on</returns>
+        task<HRESULT> DownloadAsync(task_completion_event<HRESULT> tceDownloadCompleted = task_completion_event<HRESULT>());
+
+        HRESULT OnDownloadCompleted(std::vector<BYTE> memorycache, task_completion_event<HRESULT> tceDownloadCompleted);
+
+        ///<summary>Downloads the section if it has not been loaded yet - blocks till the download completes</summary>
+        HRESULT Load()
+        {
+          std::lock_guard<std::recursive_mutex> lock(LockInit);
+          if (IsLoaded) return S_OK;
+          return DownloadAsync().get();
+        }
+
+        ///<summary>Returns the first track of a media type, or nullptr if there is none</summary>
+        shared_ptr<FMP4TrackInfo> GetTrack(ContentType type)
+        {
+          for (auto itm : Tracks)
+          {
+            if (itm.second->Type == type)
+              return itm.second;
+          }
+          return nullptr;
+        }
+
+        ///<summary>True if the section is AES-128 encrypted with the same key and IV (or neither section is)</summary>
+        bool IsEncryptedWith(shared_ptr<EncryptionKey> key);
+
+        bool IsEqual(shared_ptr<InitializationSegment> other)
+        {
+          if (other == nullptr) return false;
+          return Uri == other->Uri && IsHttpByteRange == other->IsHttpByteRange &&
+            ByteRangeOffset == other->ByteRangeOffset && LengthInBytes == other->LengthInBytes && IsEncryptedWith(other->EncKey);
+        }
+      };
+    }
+  }
+}
@@ -56,6 +56,8 @@ namespace Microsoft {
     interface class  IHLSSlidingWindow;
     interface class  IHLSContentDownloader;
     interface class  IHLSInitialBitrateSelectedEventArgs;
+    interface class  IHLSStartupMetrics;
+    interface class  IHLSLockContentionMetrics;
 
     public enum class ResourceType : int
     {
@@ -145,6 +147,26 @@ namespace Microsoft {
       void Submit();
     };
 
+    public interface class IHLSStartupMetrics
+    {
+      property Windows::Foundation::TimeSpan MasterPlaylist { Windows::Foundation::TimeSpan get(); };
+      property Windows::Foundation::TimeSpan MediaPlaylist { Windows::Foundation::TimeSpan get(); };
+      property Windows::Foundation::TimeSpan StartSegment { Windows::Foundation::TimeSpan get(); };
+      property Windows::Foundation::TimeSpan OpenCompletion { Windows::Foundation::TimeSpan get(); };
+      property Windows::Foundation::TimeSpan FirstSample { Windows::Foundation::TimeSpan get(); };
+      property Windows::Foundation::TimeSpan TimeToFirstFrame { Windows::Foundation::TimeSpan get(); };
+    };
+
+    public interface class IHLSLockContentionMetrics
+    {
+      property unsigned long long SegmentLockAcquisitions { unsigned long long get(); };
+      property unsigned long long SegmentLockContentions { unsigned long long get(); };
+      property unsigned long long SegmentTrackingLockAcquisitions { unsigned long long get(); };
+      property unsigned long long SegmentTrackingLockContentions { unsigned long long get(); };
+      property unsigned long long StreamSwitchLockAcquisitions { unsigned long long get(); };
+      property unsigned long long StreamSwitchLockContentions { unsigned long long get(); };
+    };
+
     public interface class IHLSInbandCCPayload
     {
       property Windows::Foundation::TimeSpan Timestamp { Windows::Foundation::TimeSpan get(); };
@@ -182,6 +204,7 @@ namespace Microsoft {
       property unsigned int SequenceNumber {unsigned int get(); };
       property SegmentState LoadState { SegmentState get(); }
       Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^ GetInbandCCUnits();
+      Windows::Foundation::IAsyncOperation<Windows::Foundation::Collections::IVector<IHLSInbandCCPayload^>^>^ ExtractInbandCCUnitsAsync();
       Windows::Foundation::Collections::IVector<IHLSID3MetadataStream^>^ GetMetadataStreams();
       Windows::Foundation::Collections::IVector<Platform::String^>^ GetUnprocessedTags(UnprocessedTagPlacement placement);
       Windows::Foundation::IAsyncAction^ SetPIDFilter(Windows::Foundation::Collections::IMap<TrackType, unsigned short>^ pidfilter);
@@ -273,6 +296,7 @@ namespace Microsoft {
       Windows::Foundation::Collections::IMap<TrackType, unsigned short>^ GetPIDFilter();
       void ResetBitrateLock();
       Windows::Foundation::Collections::IVector<Windows::Foundation::TimeSpan>^ GetPlaylistBatchItemDurations();
+      Windows::Foundation::Collections::IVector<IHLSID3MetadataPayload^>^ GetMetadataInRange(Windows::Foundation::TimeSpan From, Windows::Foundation::TimeSpan To);
 
       event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSBitrateSwitchEventArgs^>^ BitrateSwitchSuggested
       {
@@ -316,6 +340,12 @@ namespace Microsoft {
         void remove(Windows::Foundation::EventRegistrationToken token);
         //void raise(IHLSPlaylist^ sender, IHLSSlidingWindow^ args);
       };
+      event Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ LiveCatchupSeekSuggested
+      {
+        Windows::Foundation::EventRegistrationToken add(Windows::Foundation::TypedEventHandler<IHLSPlaylist^, IHLSSlidingWindow^>^ handler);
+        void remove(Windows::Foundation::EventRegistrationToken token);
+        //void raise(IHLSPlaylist^ sender, IHLSSlidingWindow^ args);
+      };
     };
  
 
@@ -325,6 +355,7 @@ namespace Microsoft {
       property Platform::String^ ID {Platform::String^ get(); };
       property IHLSPlaylist^ Playlist { IHLSPlaylist^ get(); };
       property Windows::Foundation::TimeSpan MinimumBufferLength; 
+      property unsigned long long MaximumBufferSizeInBytes;
       property Windows::Foundation::TimeSpan BitrateChangeNotificationInterval;
       property Windows::Foundation::TimeSpan MinimumLiveLatency;
       property bool EnableAdaptiveBitrateMonitor; 
@@ -339,6 +370,11 @@ namespace Microsoft {
       property bool AutoAdjustScrubbingBitrate;
       property bool AutoAdjustTrickPlayBitrate;
       property bool UpshiftBitrateInSteps;
+      property bool EnableFastStart;
+      property bool EnableLowLatencyLive;
+      property bool EnableLiveCatchup;
+      property bool DemuxAllElementaryStreams;
+      property bool SwitchBitrateOnSegmentBoundary;
       property SegmentMatchCriterion MatchSegmentsUsing;
       property Windows::Foundation::TimeSpan PrefetchDuration;
       property TrackType TrackTypeFilter;
@@ -360,6 +396,8 @@ namespace Microsoft {
       void Unlock();
       void BatchPlaylists(Windows::Foundation::Collections::IVector<Platform::String^>^ BatchUrls);
       unsigned int GetLastMeasuredBandwidth();
+      IHLSStartupMetrics^ GetStartupMetrics();
+      IHLSLockContentionMetrics^ GetLockContentionMetrics();
     };
 
     public interface class IHLSControllerFactory
@@ -0,0 +1,82 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      ///<summary>Counts how often a lock was taken, and how often the taker had to wait for another thread to let go of it</summary>
+      class LockContentionCounter
+      {
+      public:
+        std::atomic<unsigned long long> Acquisitions;
+        std::atomic<unsigned long long> Contentions;
+
+        LockContentionCounter() : Acquisitions(0), Contentions(0) {}
+      };
+
+      ///<summary>Contention on the sample path locks of a media source, summed over all of its segments, playlists and streams</summary>
+      struct SamplePathLockContention
+      {
+        LockContentionCounter LockSegment;
+        LockContentionCounter LockSegmentTracking;
+        LockContentionCounter LockSwitch;
+      };
+
+      ///<summary>Scoped lock that records contention on the counter it is given</summary>
+      ///<remarks>Tries the lock first and only counts a contention if that fails and we have to block. Used on the locks the sample
+      ///request path still takes, so that we can see which of them convoy the video and audio streams - per lock instance in the logs, 
+      ///and summed per media source (the total) through the controller.</remarks>
+      template<typename TMutex>
+      class CountedLockGuard
+      {
+      private:
+        TMutex& _mtx;
+      public:
+        CountedLockGuard(TMutex& mtx, LockContentionCounter& counter, LockContentionCounter* total = nullptr) : _mtx(mtx)
+        {
+          counter.Acquisitions++;
+          if (total != nullptr)
+            total->Acquisitions++;
+          if (!_mtx.try_lock())
+          {
+            counter.Contentions++;
+            if (total != nullptr)
+              total->Contentions++;
+            _mtx.lock();
+          }
+        }
+        ~CountedLockGuard()
+        {
+          _mtx.unlock();
+        }
+        CountedLockGuard(const CountedLockGuard&) = delete;
+        CountedLockGuard& operator=(const CountedLockGuard&) = delete;
+      };
+    }
+  }
+}
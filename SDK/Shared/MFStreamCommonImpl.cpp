@@ -240,7 +240,7 @@ HRESULT CMFStreamCommonImpl::CompleteAsyncSampleRequest(IMFAsyncResult *pResult,
       if (pSample != nullptr)
       { 
         NotifySample(pSample.Get());
-
+        cpMediaSource->ReportFirstSampleDelivered();
       }
       else
         NotifySample(nullptr);
@@ -347,6 +347,11 @@ StreamTickBase(nullptr), ApproximateFrameDistance(0)
   MFCreateEventQueue(&cpEventQueue);
 }
 
+LockContentionCounter* CMFStreamCommonImpl::GetLockSwitchContentionTotal()
+{
+  return &(cpMediaSource->LockContention.LockSwitch);
+}
+
 ///<summary>Send start notification</summary>
 ///<param name='startAt'>Position to start at</param>
 HRESULT CMFStreamCommonImpl::NotifyStreamStarted(std::shared_ptr<Timestamp> startAt)
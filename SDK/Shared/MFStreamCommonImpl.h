@@ -31,6 +31,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "StopWatch.h"
 #include "TSConstants.h"
 #include "MediaSegment.h" 
+#include "LockContention.h"
 
 using namespace Microsoft::WRL;
 
@@ -96,6 +97,10 @@ namespace Microsoft {
       public:
         //critsecs for queue operations
         recursive_mutex LockStream, LockEvent, LockSwitch;
+        ///<summary>Contention on LockSwitch from the sample request path - the video and audio sample requests both check for pending switches on every sample</summary>
+        LockContentionCounter LockSwitchContention;
+        ///<summary>The media source total LockSwitchContention adds to</summary>
+        LockContentionCounter* GetLockSwitchContentionTotal();
         shared_ptr<Timestamp> StreamTickBase;
         unsigned long long ApproximateFrameDistance;
         ComPtr<IMFMediaType> cpMediaType;
@@ -194,6 +199,7 @@ namespace Microsoft {
         {
           if (cpEventQueue != nullptr)
             cpEventQueue->Shutdown();
+          LOGIF(LockSwitchContention.Contentions > 0, "Stream LockSwitch contended " << LockSwitchContention.Contentions.load() << " of " << LockSwitchContention.Acquisitions.load() << " times on the sample path");
 
         }
 
@@ -245,12 +251,12 @@ namespace Microsoft {
 
         shared_ptr<PlaylistSwitchRequest> GetPendingBitrateSwitch()
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSwitch);
+          CountedLockGuard<std::recursive_mutex> lock(LockSwitch, LockSwitchContention, GetLockSwitchContentionTotal());
           return pendingBitrateSwitch;
         }
         shared_ptr<PlaylistSwitchRequest> GetPendingRenditionSwitch()
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSwitch);
+          CountedLockGuard<std::recursive_mutex> lock(LockSwitch, LockSwitchContention, GetLockSwitchContentionTotal());
           return pendingRenditionSwitch;
         }
 
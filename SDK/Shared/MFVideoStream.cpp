@@ -102,7 +102,16 @@ HRESULT CMFVideoStream::ConstructStreamDescriptor(unsigned int id)
   if (FAILED(hr = cpMediaType->SetGUID(MF_MT_MAJOR_TYPE, MFMediaType_Video))) return hr;
   //sub type
 
-  if (FAILED(hr = cpMediaType->SetGUID(MF_MT_SUBTYPE, pPlaylist->pParentStream != nullptr && IsEqualGUID(pPlaylist->pParentStream->VideoMediaType, GUID_NULL) == false ? pPlaylist->pParentStream->VideoMediaType : MFVideoFormat_H264))) return hr;
+  //if the playlist does not tell us the codec - go by what the PMT in the first segment said
+  auto vidseg = pPlaylist->GetCurrentSegmentTracker(VIDEO);
+  GUID subtype = pPlaylist->pParentStream != nullptr && IsEqualGUID(pPlaylist->pParentStream->VideoMediaType, GUID_NULL) == false ? pPlaylist->pParentStream->VideoMediaType :
+    (vidseg != nullptr && vidseg->IsHEVC ? MFVideoFormat_HEVC : MFVideoFormat_H264);
+  if (FAILED(hr = cpMediaType->SetGUID(MF_MT_SUBTYPE, subtype))) return hr;
+  //HEVC decoder can start from the parameter sets in the media type
+  if (IsEqualGUID(subtype, MFVideoFormat_HEVC) && vidseg != nullptr && vidseg->VideoParameterSets.empty() == false)
+  {
+    if (FAILED(hr = cpMediaType->SetBlob(MF_MT_MPEG_SEQUENCE_HEADER, &(*(vidseg->VideoParameterSets.begin())), (UINT32) vidseg->VideoParameterSets.size()))) return hr;
+  }
   //interlace mode
   if (FAILED(hr = cpMediaType->SetUINT32(MF_MT_INTERLACE_MODE, MFVideoInterlaceMode::MFVideoInterlace_Progressive))) return hr;
   //average bitrate
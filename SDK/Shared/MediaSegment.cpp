@@ -39,9 +39,13 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "ContentDownloader.h"
 #include "ContentDownloadRegistry.h"
 #include "AVCParser.h"
+#include "ID3TagParser.h"
 #include "Cookie.h"
 #include "FileLogger.h" 
 #include "EncryptionKey.h"
+#include "InitializationSegment.h"
+#include "FMP4Parser.h"
+#include "SegmentMemoryBudget.h"
 
 using namespace Microsoft::WRL;
 using namespace Windows::Security::Cryptography::Core;
@@ -87,7 +91,14 @@ MediaSegment::~MediaSegment()
   Timeline.clear();
   if (buffer != nullptr)
     buffer.reset(nullptr);
+  ReleaseMemoryBudget();
   spDownloadRegistry->CancelAll();
+  LOGIF(LockSegmentContention.Contentions > 0, "Segment " << SequenceNumber << " : LockSegment contended " << LockSegmentContention.Contentions.load() << " of " << LockSegmentContention.Acquisitions.load() << " times on the sample path");
+}
+
+LockContentionCounter* MediaSegment::GetLockSegmentContentionTotal()
+{
+  return pParentPlaylist != nullptr && pParentPlaylist->cpMediaSource != nullptr ? &(pParentPlaylist->cpMediaSource->LockContention.LockSegment) : nullptr;
 }
 
 void MediaSegment::CancelDownloads(bool WaitForRunningTasks)
@@ -102,10 +113,13 @@ void MediaSegment::Scavenge(bool Force)
   ResetFailedCloaking();
   if (GetCurrentState() == INMEMORYCACHE)
   {
-    LOG("Scavenging segment " << SequenceNumber << "," << MediaUri);
+    LOG("Scavenging segment " << SequenceNumber << "," << GetMediaUri());
     CCSamples.clear();
     UnreadQueues.clear();
     ReadQueues.clear();
+    MediaTypeCoverage.clear();
+    DiscontinuityOffsets.clear();
+    DemuxedPIDs.clear();
     //keep the timeline around for sliding window playlists so that we can update the sliding window - the memory will be reclaimed when the segment gets dropped 
     if ((pParentPlaylist->IsLive && pParentPlaylist->PlaylistType == Microsoft::HLSClient::HLSPlaylistType::EVENT) || pParentPlaylist->IsLive == false)
       Timeline.clear();
@@ -125,11 +139,37 @@ void MediaSegment::Scavenge(bool Force)
     backbuffer.clear();
     if (buffer != nullptr)
       buffer.reset(nullptr);
+    FramingData.clear();
+    ReleaseMemoryBudget();
     SetCloaking(nullptr);
     SetCurrentState(LENGTHONLY);
   }
 }
 
+///<summary>Charges the segment data to a media source memory budget - replaces any earlier charge</summary>
+void MediaSegment::ChargeMemoryBudget(shared_ptr<SegmentMemoryBudget> spBudget)
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  ReleaseMemoryBudget();
+  if (spBudget == nullptr || buffer == nullptr)
+    return;
+  ChargedBytes = LengthInBytes + FramingData.size();
+  spChargedBudget = spBudget;
+  spChargedBudget->Charge(ChargedBytes);
+}
+
+///<summary>Gives the bytes charged for the segment data back to the budget</summary>
+void MediaSegment::ReleaseMemoryBudget()
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  if (spChargedBudget != nullptr)
+  {
+    spChargedBudget->Release(ChargedBytes);
+    spChargedBudget.reset();
+  }
+  ChargedBytes = 0;
+}
+
 unsigned int MediaSegment::SampleReadCount()
 {
   if (GetCurrentState() != INMEMORYCACHE)
@@ -157,6 +197,7 @@ MediaSegment::MediaSegment(std::wstring& tagWithAttributes, Playlist *parentplay
   , ByteRangeOffset(0)
   , State(MediaSegmentState::UNAVAILABLE),
   EncKey(nullptr),
+  spInitSegment(nullptr),
   StartPTSNormalized(nullptr),
   EndPTSNormalized(nullptr),
   chainAssociationCount(0),
@@ -165,6 +206,9 @@ MediaSegment::MediaSegment(std::wstring& tagWithAttributes, Playlist *parentplay
   Discontinous(false),
   StartsDiscontinuity(false),
   IsTransportStream(true),
+  IsHEVC(false),
+  ChargedBytes(0),
+  spChargedBudget(nullptr),
   ProgramDateTime(nullptr),
   spPIDFilter(nullptr),
   buffer(nullptr)
@@ -190,9 +234,9 @@ void MediaSegment::SetUri(std::wstring& mediauri)
 {
   //if supplied segment URI is not absolute, merge with base URI on the parent playlist to make absolute
   if (Helpers::IsAbsoluteUri(mediauri))
-    MediaUri = mediauri;
+    SetMediaUri(mediauri);
   else
-    MediaUri = Helpers::JoinUri(this->pParentPlaylist->BaseUri, mediauri);
+    SetMediaUri(Helpers::JoinUri(this->pParentPlaylist->BaseUri, mediauri));
 }
 void MediaSegment::SetByteRangeInfo(const std::wstring& byterangeinfo)
 {
@@ -217,8 +261,7 @@ void MediaSegment::SetByteRangeInfo(const std::wstring& byterangeinfo)
 ///<param name='state'>The new state</param>
 void MediaSegment::SetCurrentState(MediaSegmentState state)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
-  State = state;
+  State.store(state);
 }
 
 unsigned long long MediaSegment::GetApproximateFrameDistance(ContentType type, unsigned short tgtPID)
@@ -245,6 +288,11 @@ HRESULT MediaSegment::AttemptBitrateShiftOnStreamThinning(
   if (ms->spRootPlaylist->IsVariant == false) return E_FAIL;
   if (ms->spRootPlaylist->ActiveVariant->Bandwidth == (*(ms->spRootPlaylist->Variants.begin())).first)
     return E_FAIL;//already at lowest
+  //a switch on a segment boundary is pending - fetching a copy from another bitrate alongside it would put a second download in flight
+  if (Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary &&
+    ((ms->cpVideoStream != nullptr && ms->cpVideoStream->GetPendingBitrateSwitch() != nullptr) ||
+    (ms->cpAudioStream != nullptr && ms->cpAudioStream->GetPendingBitrateSwitch() != nullptr)))
+    return E_FAIL;
   shared_ptr<MediaSegment> targetseg = nullptr;
 
   std::lock_guard<std::recursive_mutex> lock(LockSegment);
@@ -285,7 +333,7 @@ HRESULT MediaSegment::AttemptBitrateShiftOnStreamThinning(
   std::map<std::wstring, std::wstring> headers;
   Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
   bool MeasureDownload = (pParentPlaylist->pParentStream != nullptr /*&& pParentPlaylist->pParentStream->IsActive*/) || (pParentPlaylist->pParentRendition != nullptr && pParentPlaylist->pParentRendition->Type == Rendition::TYPEVIDEO);
-  wstring url = targetseg->MediaUri;
+  wstring url = targetseg->GetMediaUri();
   if (targetseg->IsHttpByteRange)
   {
     wostringstream byterange;
@@ -392,7 +440,7 @@ HRESULT MediaSegment::AttemptBitrateShiftOnDownloadFailure(
   Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
   bool MeasureDownload = (pParentPlaylist->pParentStream != nullptr /*&& pParentPlaylist->pParentStream->IsActive*/) ||
     (pParentPlaylist->pParentRendition != nullptr && pParentPlaylist->pParentRendition->Type == Rendition::TYPEVIDEO);
-  wstring url = targetseg->MediaUri;
+  wstring url = targetseg->GetMediaUri();
   if (targetseg->IsHttpByteRange)
   {
     wostringstream byterange;
@@ -449,6 +497,7 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
     Timeline.clear();
     MediaTypePIDMap.clear();
     buffer.reset(nullptr);
+    ReleaseMemoryBudget();
     LengthInBytes = 0;
   }
   //set the state
@@ -456,10 +505,14 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
 
   this->ResetFailedCloaking();
 
+  //the mirror this segment uri was resolved against - feeds the mirror health score
+  auto mirror = pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->GetActiveMirror() : 0;
+  ULONGLONG started = ::GetTickCount64();
+
   DefaultContentDownloader^ downloader = ref new DefaultContentDownloader();
 
   downloader->Completed += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^>(
-    [this, tceSegmentDownloadCompleted, ms](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
+    [this, tceSegmentDownloadCompleted, ms, mirror, started](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
   {
     DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
 
@@ -485,7 +538,30 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
         if (LengthInBytes == 0)
           tceSegmentDownloadCompleted.set(E_FAIL);
         else
-          this->OnSegmentDownloadCompleted(ms, downloader, args, tceSegmentDownloadCompleted);
+        {
+          if (pParentPlaylist->pParentStream != nullptr && GetCloaking() == nullptr)
+            pParentPlaylist->pParentStream->RecordMirrorHealth(mirror, true, ::GetTickCount64() - started, LengthInBytes);
+
+          //decrypt and parse on the parse pool - this frees the network completion callback, and lets prefetched segments parse in parallel
+          auto rate = ms->GetCurrentPlaybackRate();
+          auto tce = tceSegmentDownloadCompleted;
+          std::weak_ptr<MediaSegment> wpThis = shared_from_this();
+          ms->spParsePool->Enqueue(Duration, Configuration::GetCurrent()->GetRateAdjustedLABThreshold(rate != nullptr ? rate->Rate : 1.0f),
+            [wpThis, ms, downloader, args, tce]()
+          {
+            //the segment may have been dropped (live window, scavenging) while the work was queued. The source is alive - 
+            //the pool does not start work once the source has shut it down, and the source waits for the running work
+            auto spThis = wpThis.lock();
+            if (spThis == nullptr)
+              tce.set(E_FAIL);
+            else
+              spThis->OnSegmentDownloadCompleted(ms, downloader, args, tce);
+          },
+            [tce](HRESULT hr)
+          {
+            tce.set(hr);
+          });
+        }
       }
       else
         tceSegmentDownloadCompleted.set(E_FAIL);
@@ -495,7 +571,7 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
   });
 
   downloader->Error += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^>(
-    [this, ms, tceSegmentDownloadCompleted](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
+    [this, ms, tceSegmentDownloadCompleted, mirror](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
   {
 
     spDownloadRegistry->CancelAll();
@@ -517,6 +593,9 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
 
     DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
 
+    if (pParentPlaylist->pParentStream != nullptr && GetCloaking() == nullptr)
+      pParentPlaylist->pParentStream->RecordMirrorHealth(mirror, false);
+
     if ((ms->GetCurrentState() != MSS_ERROR && ms->GetCurrentState() != MSS_UNINITIALIZED) &&
       ms->spRootPlaylist->IsVariant && this->pParentPlaylist->pParentRendition == nullptr) //not an alternate rendition playlist
     {
@@ -562,7 +641,7 @@ task<HRESULT> MediaSegment::DownloadSegmentDataAsync(task_completion_event<HRESU
     std::map<std::wstring, std::wstring> headers;
     Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
     bool MeasureDownload = (pParentPlaylist->pParentStream != nullptr /*&& pParentPlaylist->pParentStream->IsActive*/) || (pParentPlaylist->pParentRendition != nullptr && pParentPlaylist->pParentRendition->Type == Rendition::TYPEVIDEO);
-    wstring url = MediaUri;
+    wstring url = GetMediaUri();
     if (IsHttpByteRange)
     {
       wostringstream byterange;
@@ -615,13 +694,14 @@ HRESULT MediaSegment::OnSegmentDownloadCompleted(
 	/*if(pdownloader != nullptr)
 		CHKTASK(pdownloader->CancellationToken());*/
     //in case of a redirect
-    MediaUri = args->ContentUri->AbsoluteUri->Data();
+    SetMediaUri(args->ContentUri->AbsoluteUri->Data());
 
     if (backbuffer.find(downloaderid) == backbuffer.end())
       throw E_FAIL;
     auto tsdata = backbuffer[downloaderid];
 
     auto encKey = this->GetCloaking() != nullptr ? this->GetCloaking()->EncKey : this->EncKey;
+    auto initSeg = this->GetCloaking() != nullptr ? this->GetCloaking()->spInitSegment : this->spInitSegment;
 
     //decrypt - if needed
     if (encKey != nullptr && encKey->Method != NOENCRYPTION && LengthInBytes > 0)
@@ -733,14 +813,37 @@ HRESULT MediaSegment::OnSegmentDownloadCompleted(
       if ((IsTransportStream = TransportStreamParser::IsTransportStream(tsdata->buffer.get())))
       {
          
-        TransportStreamParser tsparser;
+        TransportStreamParser tsparser(Configuration::GetCurrent()->DemuxAllElementaryStreams);
 
         //parse TS 
 
         tsparser.Parse(tsdata->buffer.get(), LengthInBytes, tsdata->MediaTypePIDMap, GetPIDFilter(),
           tsdata->MetadataStreams, tsdata->UnreadQueues, tsdata->Timeline, tsdata->CCSamples);
+        tsdata->DemuxedPIDs = std::move(tsparser.ElementaryStreams);
+        tsdata->HEVCParameterSets = tsparser.TakeHEVCParameterSets();
+
+        //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
+      }
+      //fragmented MP4 (CMAF) - needs the tracks from the EXT-X-MAP initialization section
+      else if (initSeg != nullptr && FMP4Parser::IsFragmentedMP4(tsdata->buffer.get(), LengthInBytes))
+      {
+        //usually loaded before the segment download started - unless we are cloaking with a segment from another playlist
+        if (FAILED(initSeg->Load()))
+        {
+          LOG("ERROR: DownloadSegmentDataAsync::ResponseReceived() - Could not load initialization section(seq=" << SequenceNumber << ") [" << initSeg->Uri << "]");
+          tceSegmentDownloadCompleted.set(E_FAIL);
+          throw E_FAIL;
+        }
 
-        //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+        FMP4Parser fmp4parser;
+        //samples point into the segment buffer - nothing is copied
+        fmp4parser.Parse(tsdata->buffer.get(), LengthInBytes, initSeg->Tracks, tsdata->MediaTypePIDMap, GetPIDFilter(),
+          tsdata->UnreadQueues, tsdata->Timeline, tsdata->CCSamples, tsdata->DemuxedPIDs, tsdata->FramingData);
+        for (auto itm : initSeg->Tracks)
+        {
+          if (itm.second->Type == VIDEO && itm.second->IsHEVC)
+            tsdata->HEVCParameterSets[(unsigned short) itm.first] = itm.second->ParameterSets;
+        }
       }
       //treat as elementary audio stream
       else if (MediaSegment::ExtractInitialTimestampFromID3PRIV(tsdata->buffer.get(), LengthInBytes) != nullptr)
@@ -750,11 +853,11 @@ HRESULT MediaSegment::OnSegmentDownloadCompleted(
         BuildAudioElementaryStreamSamples(tsdata);
         if (pParentPlaylist->IsLive && nullptr != pParentPlaylist->cpMediaSource->cpVideoStream && pParentPlaylist->cpMediaSource->cpVideoStream->Selected())
           this->Discontinous = true;
-        //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed Audio(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+        //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed Audio(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
       }
       else
       {
-        LOG("ERROR: DownloadSegmentDataAsync::ResponseReceived() - Unknown content type(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+        LOG("ERROR: DownloadSegmentDataAsync::ResponseReceived() - Unknown content type(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
         tceSegmentDownloadCompleted.set(E_FAIL);
         throw E_FAIL;
       }
@@ -770,16 +873,38 @@ HRESULT MediaSegment::OnSegmentDownloadCompleted(
         this->CCSamples = std::move(tsdata->CCSamples);
         this->UnreadQueues = std::move(tsdata->UnreadQueues);
         this->MetadataStreams = std::move(tsdata->MetadataStreams);
+        this->DemuxedPIDs = std::move(tsdata->DemuxedPIDs);
+        this->HEVCParameterSets = std::move(tsdata->HEVCParameterSets);
+        this->FramingData = std::move(tsdata->FramingData);
         this->ReadQueues.clear();
+        SelectVideoFormat();
+        SetMediaTypeCoverage();
+        AttachDiscontinuityOffsets();
 
         tsdata->buffer.swap(this->buffer);
         tsdata.reset();
         this->backbuffer.erase(downloaderid);
+        ChargeMemoryBudget(ms->spMemoryBudget);
       }
       //set state 
       SetCurrentState(MediaSegmentState::INMEMORYCACHE);
       SetPTSBoundaries();
 
+      //index the timed metadata once, while we are still on the download thread
+      if (this->MetadataStreams.size() > 0 && ms->spRootPlaylist != nullptr)
+      {
+        if (pParentPlaylist->IsLive)
+        {
+          auto snapshot = pParentPlaylist->GetSegmentSnapshot();
+          if (snapshot->size() > 0)
+            ms->spRootPlaylist->MetadataTimeline.RemoveBefore(snapshot->front()->GetSequenceNumber());
+        }
+        ms->spRootPlaylist->MetadataTimeline.IndexSegment(this);
+      }
+
+      //over the memory budget - make room by scavenging segments we can do without
+      ms->spMemoryBudget->Enforce(ms->spRootPlaylist.get());
+
       tceSegmentDownloadCompleted.set(S_OK);
 
       if (ms->cpController != nullptr && ms->cpController->GetPlaylist() != nullptr)
@@ -842,10 +967,13 @@ void MediaSegment::ApplyPIDFilter(std::map<ContentType, unsigned short> filter,
   }
   if (Force)
   {
+    //all the PIDs were demuxed when we parsed - just switch to the ones the filter asks for
+    if (SelectDemuxedPIDs(filter))
+      return;
 
     if ((IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
     {
-      TransportStreamParser tsparser;
+      TransportStreamParser tsparser(Configuration::GetCurrent()->DemuxAllElementaryStreams);
       MediaTypePIDMap.clear();
       MetadataStreams.clear();
       UnreadQueues.clear();
@@ -854,15 +982,93 @@ void MediaSegment::ApplyPIDFilter(std::map<ContentType, unsigned short> filter,
       //parse TS
       tsparser.Parse(buffer.get(), LengthInBytes, MediaTypePIDMap, filter,
         MetadataStreams, UnreadQueues, Timeline, CCSamples);
+      DemuxedPIDs = std::move(tsparser.ElementaryStreams);
+      HEVCParameterSets = tsparser.TakeHEVCParameterSets();
+      SelectVideoFormat();
+      SetMediaTypeCoverage();
+      AttachDiscontinuityOffsets();
 
 
-      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
     }
     //}
   }
 
 }
 
+///<summary>Points the segment at the audio and video PIDs a filter asks for, using the samples that were demuxed for every PID when the segment was parsed</summary>
+///<remarks>Picks the lowest PID of a media type that the filter does not name, same as the parser does</remarks>
+///<returns>False if the segment has to be parsed again to apply the filter</returns>
+bool MediaSegment::SelectDemuxedPIDs(const std::map<ContentType, unsigned short>& pidfilter)
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+
+  //metadata PIDs are picked by the filter at parse time
+  if (DemuxedPIDs.empty() || pidfilter.find(METADATA) != pidfilter.end())
+    return false;
+
+  std::map<ContentType, unsigned short> pidmap;
+  for (auto itm : DemuxedPIDs)
+  {
+    auto foundinfilter = pidfilter.find(itm.second);
+    if (foundinfilter != pidfilter.end() && foundinfilter->second == itm.first)
+      pidmap[itm.second] = itm.first;
+    else if (pidmap.find(itm.second) == pidmap.end() &&
+      (foundinfilter == pidfilter.end() || DemuxedPIDs.find(foundinfilter->second) == DemuxedPIDs.end() || DemuxedPIDs[foundinfilter->second] != itm.second))
+      pidmap[itm.second] = itm.first; //lowest PID for this type
+  }
+
+  if (pidmap == MediaTypePIDMap)
+    return true;
+
+  //start the segment over - same as we would after parsing it again
+  for (auto& itm : ReadQueues)
+  {
+    UnreadQueues[itm.first].insert(UnreadQueues[itm.first].begin(), itm.second.begin(), itm.second.end());
+    itm.second.clear();
+  }
+  ReadQueues.clear();
+
+  MediaTypePIDMap = pidmap;
+  SelectVideoFormat();
+
+  CCSamples.clear();
+  if (HasMediaType(VIDEO))
+  {
+    for (auto sd : UnreadQueues[GetPIDForMediaType(VIDEO)])
+    {
+      if (sd->spInBandCC != nullptr)
+        CCSamples.push_back(sd);
+    }
+  }
+
+  //the parser only put the timestamps of the PIDs it picked on the timeline - in timestamp order, same as the fMP4 parser
+  Timeline.clear();
+  for (auto& itm : MediaTypePIDMap)
+  {
+    for (auto sd : UnreadQueues[itm.second])
+    {
+      if (sd->SamplePTS != nullptr)
+        Timeline.push_back(sd->SamplePTS);
+    }
+  }
+  for (auto pid : MetadataStreams)
+  {
+    for (auto sd : UnreadQueues[pid])
+    {
+      if (sd->SamplePTS != nullptr)
+        Timeline.push_back(sd->SamplePTS);
+    }
+  }
+  std::sort(Timeline.begin(), Timeline.end(), [](const std::shared_ptr<Timestamp>& a, const std::shared_ptr<Timestamp>& b) { return a->ValueInTicks < b->ValueInTicks; });
+
+  SetMediaTypeCoverage();
+  AttachDiscontinuityOffsets();
+
+  LOG("SelectDemuxedPIDs() - Switched PIDs without parsing for Seq " << SequenceNumber);
+  return true;
+}
+
 bool MediaSegment::SetPIDFilter(shared_ptr<std::map<ContentType, unsigned short>> pidfilter)
 {
 
@@ -874,9 +1080,10 @@ bool MediaSegment::SetPIDFilter(shared_ptr<std::map<ContentType, unsigned short>
 
     //std::lock_guard<std::recursive_mutex> lock(pParentPlaylist->LockSegmentTracking);
 
-    if ((IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
+    //if all the PIDs were demuxed when we parsed we just switch to the ones the filter asks for - otherwise we parse again
+    if (!SelectDemuxedPIDs(pidfilter == nullptr ? std::map<ContentType, unsigned short>() : *pidfilter) && (IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
     {
-      TransportStreamParser tsparser;
+      TransportStreamParser tsparser(Configuration::GetCurrent()->DemuxAllElementaryStreams);
       MediaTypePIDMap.clear();
       MetadataStreams.clear();
       UnreadQueues.clear();
@@ -890,9 +1097,14 @@ bool MediaSegment::SetPIDFilter(shared_ptr<std::map<ContentType, unsigned short>
         MetadataStreams,
         UnreadQueues,
         Timeline, CCSamples);
+      DemuxedPIDs = std::move(tsparser.ElementaryStreams);
+      HEVCParameterSets = tsparser.TakeHEVCParameterSets();
+      SelectVideoFormat();
+      SetMediaTypeCoverage();
+      AttachDiscontinuityOffsets();
 
 
-      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
     }
   }
 
@@ -913,9 +1125,10 @@ bool MediaSegment::ResetPIDFilter(ContentType forType)
     this->spPIDFilter->erase(forType);
     //std::lock_guard<std::recursive_mutex> lock(pParentPlaylist->LockSegmentTracking);
 
-    if ((IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
+    //if all the PIDs were demuxed when we parsed we just switch to the ones the filter asks for - otherwise we parse again
+    if (!SelectDemuxedPIDs(*(this->spPIDFilter)) && (IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
     {
-      TransportStreamParser tsparser;
+      TransportStreamParser tsparser(Configuration::GetCurrent()->DemuxAllElementaryStreams);
       MediaTypePIDMap.clear();
       MetadataStreams.clear();
       UnreadQueues.clear();
@@ -929,9 +1142,14 @@ bool MediaSegment::ResetPIDFilter(ContentType forType)
         MetadataStreams,
         UnreadQueues,
         Timeline, CCSamples);
+      DemuxedPIDs = std::move(tsparser.ElementaryStreams);
+      HEVCParameterSets = tsparser.TakeHEVCParameterSets();
+      SelectVideoFormat();
+      SetMediaTypeCoverage();
+      AttachDiscontinuityOffsets();
 
 
-      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
     }
   }
   else
@@ -951,9 +1169,10 @@ bool MediaSegment::ResetPIDFilter()
     this->spPIDFilter.reset();
     //std::lock_guard<std::recursive_mutex> lock(pParentPlaylist->LockSegmentTracking);
 
-    if ((IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
+    //if all the PIDs were demuxed when we parsed we just switch to the ones the filter asks for - otherwise we parse again
+    if (!SelectDemuxedPIDs(std::map<ContentType, unsigned short>()) && (IsTransportStream = TransportStreamParser::IsTransportStream(buffer.get())))
     {
-      TransportStreamParser tsparser;
+      TransportStreamParser tsparser(Configuration::GetCurrent()->DemuxAllElementaryStreams);
       MediaTypePIDMap.clear();
       MetadataStreams.clear();
       UnreadQueues.clear();
@@ -967,7 +1186,12 @@ bool MediaSegment::ResetPIDFilter()
         MetadataStreams,
         UnreadQueues,
         Timeline, CCSamples);
-      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << MediaUri << "]");
+      DemuxedPIDs = std::move(tsparser.ElementaryStreams);
+      HEVCParameterSets = tsparser.TakeHEVCParameterSets();
+      SelectVideoFormat();
+      SetMediaTypeCoverage();
+      AttachDiscontinuityOffsets();
+      //LOG("DownloadSegmentDataAsync::ResponseReceived() - Parsed TS(seq=" << SequenceNumber << ",speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ") [" << GetMediaUri() << "]");
     }
   }
   else
@@ -987,8 +1211,8 @@ shared_ptr<Timestamp> MediaSegment::GetFirstMinPTS()
       auto nextsample = this->PeekNextSample(mapitm.second, MFRATE_DIRECTION::MFRATE_FORWARD);
       if (nextsample != nullptr)
       {
-        retval = (retval == nullptr) ? (this->Discontinous ? nextsample->DiscontinousTS : nextsample->SamplePTS) :
-          make_shared<Timestamp>(__min(retval->ValueInTicks, (this->Discontinous ? nextsample->DiscontinousTS : nextsample->SamplePTS)->ValueInTicks));
+        retval = (retval == nullptr) ? (this->Discontinous ? nextsample->GetDiscontinousTS() : nextsample->SamplePTS) :
+          make_shared<Timestamp>(__min(retval->ValueInTicks, (this->Discontinous ? nextsample->GetDiscontinousTS() : nextsample->SamplePTS)->ValueInTicks));
       }
     }
   }
@@ -1340,11 +1564,11 @@ shared_ptr<SampleData> MediaSegment::GetLastSample(bool IgnoreUnread)
   shared_ptr<SampleData> retval = nullptr;
   for (auto itm : MediaTypePIDMap)
   {
-    shared_ptr<Timestamp> ptssaved = (retval != nullptr) ? (retval->DiscontinousTS != nullptr ? retval->DiscontinousTS : retval->SamplePTS) : nullptr;
+    shared_ptr<Timestamp> ptssaved = (retval != nullptr) ? (retval->HasDiscontinousTS() ? retval->GetDiscontinousTS() : retval->SamplePTS) : nullptr;
 
     auto sd = GetLastSample(itm.first, IgnoreUnread);
 
-    shared_ptr<Timestamp> ptsnew = (sd != nullptr) ? (sd->DiscontinousTS != nullptr ? sd->DiscontinousTS : sd->SamplePTS) : nullptr;;
+    shared_ptr<Timestamp> ptsnew = (sd != nullptr) ? (sd->HasDiscontinousTS() ? sd->GetDiscontinousTS() : sd->SamplePTS) : nullptr;;
 
     if (ptsnew == nullptr) continue;
     else
@@ -1387,115 +1611,24 @@ void MediaSegment::UpdateSampleDiscontinuityTimestamps(shared_ptr<SampleData> la
   if (!Discontinous) return;
   if (IsReadEOS()) return;
 
+  if (lastvidsamplefromprevseg == nullptr && lastaudsamplefromprevseg == nullptr) return;
+
   if (HasMediaType(AUDIO) && pParentPlaylist->cpMediaSource->cpAudioStream != nullptr && pParentPlaylist->cpMediaSource->cpAudioStream->Selected()) 
     assert(pParentPlaylist->cpMediaSource->cpAudioStream->ApproximateFrameDistance != 0); 
   
   if (HasMediaType(VIDEO) && pParentPlaylist->cpMediaSource->cpVideoStream != nullptr && pParentPlaylist->cpMediaSource->cpVideoStream->Selected()) 
     assert(pParentPlaylist->cpMediaSource->cpVideoStream->ApproximateFrameDistance != 0); 
 
+  auto firstsample = GetFirstUnreadSample();
+  if (firstsample == nullptr) return;
 
-  //Logic : We look at the earliest sample in the segment. 
-  //If it is a video sample - we mark its discts = discts of last video sample + appxframedist_video
-  //else if it is an audio sample - we mark its discts = discts of last audio sample + appxframedist_audio
-  //from there on in each sample discts = first sample samplets - this sample samplets + first sample discts
-  shared_ptr<SampleData> firstaudsample = nullptr;
-  shared_ptr<SampleData> firstvidsample = nullptr;
-  unsigned short audpid = 0;
-  unsigned short vidpid = 0;
-
-
-
-  if (HasMediaType(AUDIO))
-  {
-    audpid = GetPIDForMediaType(AUDIO);
-    if (UnreadQueues.find(audpid) != UnreadQueues.end() && UnreadQueues[audpid].size() > 0)
-      firstaudsample = UnreadQueues[audpid].front();
-  }
-  if (HasMediaType(VIDEO))
-  {
-    vidpid = GetPIDForMediaType(VIDEO);
-    if (UnreadQueues.find(vidpid) != UnreadQueues.end() && UnreadQueues[vidpid].size() > 0)
-      firstvidsample = UnreadQueues[vidpid].front();
-  }
-
-
-  if (firstvidsample != nullptr &&
-    (firstaudsample == nullptr || firstvidsample->SamplePTS->ValueInTicks <= firstaudsample->SamplePTS->ValueInTicks))
-  {
-
-    auto lastts = (lastvidsamplefromprevseg != nullptr ?
-      (lastvidsamplefromprevseg->DiscontinousTS != nullptr ? lastvidsamplefromprevseg->DiscontinousTS->ValueInTicks : lastvidsamplefromprevseg->SamplePTS->ValueInTicks) :
-      (lastaudsamplefromprevseg->DiscontinousTS != nullptr ? lastaudsamplefromprevseg->DiscontinousTS->ValueInTicks : lastaudsamplefromprevseg->SamplePTS->ValueInTicks));
-
-    firstvidsample->DiscontinousTS = make_shared<Timestamp>(lastts + pParentPlaylist->cpMediaSource->cpVideoStream->ApproximateFrameDistance);
-
-    for (auto itr = UnreadQueues[vidpid].begin() + 1; itr != UnreadQueues[vidpid].end(); itr++)
-    {
-      auto sd = *itr;
-      sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-    }
-
-    if (HasMediaType(AUDIO) && UnreadQueues.find(audpid) != UnreadQueues.end() && UnreadQueues[audpid].size() > 0)
-    {
-      for (auto itr = UnreadQueues[audpid].begin(); itr != UnreadQueues[audpid].end(); itr++)
-      {
-        auto sd = *itr;
-        sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-      }
-    }
-    for (auto itm : MetadataStreams)
-    {
-      if (UnreadQueues.find(itm) != UnreadQueues.end())
-      {
-
-        for (auto sd : UnreadQueues[itm])
-        {
-          if (sd->DiscontinousTS == nullptr)
-          {
-            sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-          }
-        }
-      }
-    }
-  }
-  else if (firstaudsample != nullptr &&
-    (firstvidsample == nullptr || firstaudsample->SamplePTS->ValueInTicks <= firstvidsample->SamplePTS->ValueInTicks))
-  {
-    auto lastts = (lastaudsamplefromprevseg != nullptr ?
-      (lastaudsamplefromprevseg->DiscontinousTS != nullptr ? lastaudsamplefromprevseg->DiscontinousTS->ValueInTicks : lastaudsamplefromprevseg->SamplePTS->ValueInTicks) :
-      (lastvidsamplefromprevseg->DiscontinousTS != nullptr ? lastvidsamplefromprevseg->DiscontinousTS->ValueInTicks : lastvidsamplefromprevseg->SamplePTS->ValueInTicks));
-
-    firstaudsample->DiscontinousTS = make_shared<Timestamp>(lastts + pParentPlaylist->cpMediaSource->cpAudioStream->ApproximateFrameDistance);
-
-    for (auto itr = UnreadQueues[audpid].begin() + 1; itr != UnreadQueues[audpid].end(); itr++)
-    {
-      auto sd = *itr;
-      sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-    }
-    if (HasMediaType(VIDEO) && UnreadQueues.find(vidpid) != UnreadQueues.end() && UnreadQueues[vidpid].size() > 0)
-    {
-      for (auto itr = UnreadQueues[vidpid].begin(); itr != UnreadQueues[vidpid].end(); itr++)
-      {
-        auto sd = *itr;
-        sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-      }
-    }
-    for (auto itm : MetadataStreams)
-    {
-      if (UnreadQueues.find(itm) != UnreadQueues.end())
-      {
-
-        for (auto sd : UnreadQueues[itm])
-        {
-          if (sd->DiscontinousTS == nullptr)
-          {
-            sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-          }
-        }
-      }
-    }
-  }
+  //anchor on the last sample of the same type in the previous segment if we have one
+  auto prev = (std::get<0>(*firstsample) == VIDEO ?
+    (lastvidsamplefromprevseg != nullptr ? lastvidsamplefromprevseg : lastaudsamplefromprevseg) :
+    (lastaudsamplefromprevseg != nullptr ? lastaudsamplefromprevseg : lastvidsamplefromprevseg));
+  auto lastts = prev->HasDiscontinousTS() ? prev->GetDiscontinousTSValue() : prev->SamplePTS->ValueInTicks;
 
+  SetDiscontinuityOffsets(std::get<0>(*firstsample), std::get<1>(*firstsample), lastts);
 
   LOG("UpdateSampleDiscontinuityTimestampsLive() - Done for Seq " << SequenceNumber);
 
@@ -1509,154 +1642,112 @@ void MediaSegment::UpdateSampleDiscontinuityTimestamps(unsigned long long lastts
   assert(pParentPlaylist->cpMediaSource->cpVideoStream->ApproximateFrameDistance != 0 &&
     pParentPlaylist->cpMediaSource->cpAudioStream->ApproximateFrameDistance != 0);
 
-  //Logic : We look at the earliest sample in the segment. 
-  //If it is a video sample - we mark its discts = discts of last video sample + appxframedist_video
-  //else if it is an audio sample - we mark its discts = discts of last audio sample + appxframedist_audio
-  //from there on in each sample discts = first sample samplets - this sample samplets + first sample discts
-  shared_ptr<SampleData> firstaudsample = nullptr;
-  shared_ptr<SampleData> firstvidsample = nullptr;
-  unsigned short audpid = 0;
-  unsigned short vidpid = 0;
+  auto firstsample = GetFirstUnreadSample();
+  if (firstsample == nullptr) return;
 
+  SetDiscontinuityOffsets(std::get<0>(*firstsample), std::get<1>(*firstsample), lastts);
 
+  LOG("UpdateSampleDiscontinuityTimestampsLive() - Done for Seq " << SequenceNumber);
+
+}
+
+///<summary>Returns the earliest unread audio or video sample in the segment along with its type</summary>
+shared_ptr<std::tuple<ContentType, shared_ptr<SampleData>>> MediaSegment::GetFirstUnreadSample()
+{
+  shared_ptr<SampleData> firstaudsample = nullptr;
+  shared_ptr<SampleData> firstvidsample = nullptr;
 
   if (HasMediaType(AUDIO))
   {
-    audpid = GetPIDForMediaType(AUDIO);
+    auto audpid = GetPIDForMediaType(AUDIO);
     if (UnreadQueues.find(audpid) != UnreadQueues.end() && UnreadQueues[audpid].size() > 0)
       firstaudsample = UnreadQueues[audpid].front();
   }
   if (HasMediaType(VIDEO))
   {
-    vidpid = GetPIDForMediaType(VIDEO);
+    auto vidpid = GetPIDForMediaType(VIDEO);
     if (UnreadQueues.find(vidpid) != UnreadQueues.end() && UnreadQueues[vidpid].size() > 0)
       firstvidsample = UnreadQueues[vidpid].front();
   }
 
-
   if (firstvidsample != nullptr &&
     (firstaudsample == nullptr || firstvidsample->SamplePTS->ValueInTicks <= firstaudsample->SamplePTS->ValueInTicks))
+    return make_shared<std::tuple<ContentType, shared_ptr<SampleData>>>(VIDEO, firstvidsample);
+  else if (firstaudsample != nullptr)
+    return make_shared<std::tuple<ContentType, shared_ptr<SampleData>>>(AUDIO, firstaudsample);
+  else
+    return nullptr;
+}
+
+///<summary>Maps the segment timestamps onto the presentation timeline</summary>
+///<remarks>The first sample lands one frame after lastts, and every other sample keeps its distance from the first sample. Since that 
+///is the same shift for every sample, we store it once per PID rather than stamping a timestamp on each sample. Metadata keeps 
+///the offset it was first given.</remarks>
+void MediaSegment::SetDiscontinuityOffsets(ContentType FirstSampleType, shared_ptr<SampleData> FirstSample, unsigned long long lastts)
+{
   {
+    std::lock_guard<std::recursive_mutex> lock(LockSegment);
 
-    firstvidsample->DiscontinousTS = make_shared<Timestamp>(lastts + pParentPlaylist->cpMediaSource->cpVideoStream->ApproximateFrameDistance);
+    auto framedist = (FirstSampleType == VIDEO ? pParentPlaylist->cpMediaSource->cpVideoStream->ApproximateFrameDistance :
+      pParentPlaylist->cpMediaSource->cpAudioStream->ApproximateFrameDistance);
 
-    for (auto itr = UnreadQueues[vidpid].begin() + 1; itr != UnreadQueues[vidpid].end(); itr++)
-    {
-      auto sd = *itr;
-      sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-    }
+    long long offset = (long long) (lastts + framedist) - (long long) FirstSample->SamplePTS->ValueInTicks;
 
-    if (HasMediaType(AUDIO) && UnreadQueues.find(audpid) != UnreadQueues.end() && UnreadQueues[audpid].size() > 0)
+    for (auto type : { VIDEO, AUDIO })
     {
-      for (auto itr = UnreadQueues[audpid].begin(); itr != UnreadQueues[audpid].end(); itr++)
-      {
-        auto sd = *itr;
-        sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-      }
+      if (!HasMediaType(type)) continue;
+      auto itr = DiscontinuityOffsets.find(GetPIDForMediaType(type));
+      if (itr == DiscontinuityOffsets.end()) continue;
+      itr->second->Offset = offset;
+      itr->second->IsSet = true;
     }
+
     for (auto itm : MetadataStreams)
     {
-      if (UnreadQueues.find(itm) != UnreadQueues.end())
-      {
-
-        for (auto sd : UnreadQueues[itm])
-        {
-          if (sd->DiscontinousTS == nullptr)
-          {
-            sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstvidsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstvidsample->SamplePTS->ValueInTicks)));
-          }
-        }
-      }
+      auto itr = DiscontinuityOffsets.find(itm);
+      if (itr == DiscontinuityOffsets.end() || itr->second->IsSet) continue;
+      itr->second->Offset = offset;
+      itr->second->IsSet = true;
     }
   }
-  else if (firstaudsample != nullptr &&
-    (firstvidsample == nullptr || firstaudsample->SamplePTS->ValueInTicks <= firstvidsample->SamplePTS->ValueInTicks))
-  {
 
-    firstaudsample->DiscontinousTS = make_shared<Timestamp>(lastts + pParentPlaylist->cpMediaSource->cpAudioStream->ApproximateFrameDistance);
+  //the timed metadata was indexed on download with the unmapped timestamps - the timeline never holds its lock and a segment lock together
+  auto spRootPlaylist = pParentPlaylist->cpMediaSource->spRootPlaylist;
+  if (MetadataStreams.size() > 0 && spRootPlaylist != nullptr)
+    spRootPlaylist->MetadataTimeline.RetimeSegment(this);
+}
 
-    for (auto itr = UnreadQueues[audpid].begin() + 1; itr != UnreadQueues[audpid].end(); itr++)
-    {
-      auto sd = *itr;
-      sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-    }
-    if (HasMediaType(VIDEO) && UnreadQueues.find(vidpid) != UnreadQueues.end() && UnreadQueues[vidpid].size() > 0)
-    {
-      for (auto itr = UnreadQueues[vidpid].begin(); itr != UnreadQueues[vidpid].end(); itr++)
-      {
-        auto sd = *itr;
-        sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-      }
-    }
-    for (auto itm : MetadataStreams)
-    {
-      if (UnreadQueues.find(itm) != UnreadQueues.end())
-      {
+///<summary>Gives each PID a fresh discontinuity offset shared by all of its samples</summary>
+void MediaSegment::AttachDiscontinuityOffsets()
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
 
-        for (auto sd : UnreadQueues[itm])
-        {
-          if (sd->DiscontinousTS == nullptr)
-          {
-            sd->DiscontinousTS = make_shared<Timestamp>((unsigned long long)(firstaudsample->DiscontinousTS->ValueInTicks + ((long long) sd->SamplePTS->ValueInTicks - (long long) firstaudsample->SamplePTS->ValueInTicks)));
-          }
-        }
-      }
-    }
+  DiscontinuityOffsets.clear();
+  for (auto& itm : UnreadQueues)
+  {
+    auto spOffset = make_shared<DiscontinuityOffset>();
+    DiscontinuityOffsets[itm.first] = spOffset;
+    DiscontinuityOffset::Attach(spOffset, itm.second.begin(), itm.second.end());
   }
+}
 
+///<summary>Points the unread samples on a PID at this segment's offset for that PID</summary>
+///<remarks>Samples moved in from another segment (on a bitrate switch) still carry the offset of the segment they came from</remarks>
+void MediaSegment::ShareDiscontinuityOffset(unsigned short PID)
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
 
-  LOG("UpdateSampleDiscontinuityTimestampsLive() - Done for Seq " << SequenceNumber);
-
+  auto itr = DiscontinuityOffsets.find(PID);
+  if (itr == DiscontinuityOffsets.end())
+    itr = DiscontinuityOffsets.emplace(PID, make_shared<DiscontinuityOffset>()).first;
+  DiscontinuityOffset::Attach(itr->second, UnreadQueues[PID].begin(), UnreadQueues[PID].end());
 }
 
 
 
 ULONG MediaSegment::HasAACTimestampTag(const BYTE *tsdata, ULONG size)
 {
-  ULONG idx = 0;
-  //read 3 bytes at a time and carry on until you find "ID3"
-  for (; idx < size; idx++)
-  {
-    BYTE tagid[4];
-    ZeroMemory(tagid, 4);
-    memcpy_s(tagid, 3, tsdata + idx, 3);
-    if (string((char *) tagid) == "ID3")
-    {
-      idx += 3;
-      break;
-    }
-  }
-  if (idx >= size)
-    return size;
-
-  for (; idx < size; idx++)
-  {
-    BYTE tagid[5];
-    ZeroMemory(tagid, 5);
-    memcpy_s(tagid, 4, tsdata + idx, 4);
-    auto s = string((char *) tagid);
-    if (string((char *) tagid) == "PRIV")
-    {
-      idx += 4;
-      break;
-    }
-  }
-  if (idx >= size)
-    return size;
-
-
-  for (; idx < size; idx++)
-  {
-    BYTE tagid[45];
-    ZeroMemory(tagid, 45);
-    memcpy_s(tagid, 45, tsdata + idx, 45);
-    if (string((char *) tagid) == "com.apple.streaming.transportStreamTimestamp")
-    {
-      idx += 45;
-      break;
-    }
-  }
-  return idx;
+  return ID3TagParser::FindTransportStreamTimestamp(tsdata, size);
 }
 
 shared_ptr<Timestamp> MediaSegment::ExtractInitialTimestampFromID3PRIV(const BYTE *tsdata, ULONG size)
@@ -1722,6 +1813,9 @@ HRESULT MediaSegment::BuildAudioElementaryStreamSamples()
 {
   HRESULT hr = S_OK;
 
+  //fMP4 segments carry their own timestamps - they are never treated as elementary audio
+  if (spInitSegment != nullptr)
+    return hr;
 
 
 
@@ -1768,6 +1862,8 @@ HRESULT MediaSegment::BuildAudioElementaryStreamSamples()
     if (remainder < samplelen) break;
   }
 
+  SetMediaTypeCoverage();
+  AttachDiscontinuityOffsets();
   return S_OK;
 }
 
@@ -2402,16 +2498,54 @@ void MediaSegment::RewindUnreadQueue(unsigned short PID, shared_ptr<Timestamp> t
 
 bool MediaSegment::HasMediaType(ContentType type)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   return (this->MediaTypePIDMap.find(type) != this->MediaTypePIDMap.end());
 }
 
+///<summary>Picks the codec and the HEVC parameter sets for the video PID the segment is playing</summary>
+void MediaSegment::SelectVideoFormat()
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+
+  auto found = HasMediaType(VIDEO) ? HEVCParameterSets.find(GetPIDForMediaType(VIDEO)) : HEVCParameterSets.end();
+  IsHEVC = found != HEVCParameterSets.end();
+  VideoParameterSets = IsHEVC ? found->second : std::vector<BYTE>();
+}
+
+///<summary>Records the first and last sample of each media type - called once the parsed samples are in place</summary>
+void MediaSegment::SetMediaTypeCoverage()
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  MediaTypeCoverage.clear();
+  for (auto itm : MediaTypePIDMap)
+  {
+    auto itr = UnreadQueues.find(itm.second);
+    if (itr == UnreadQueues.end() || itr->second.empty())
+      continue;
+    MediaTypeCoverage[itm.first] = std::make_tuple(itr->second.front(), itr->second.back());
+  }
+}
+
+bool MediaSegment::GetMediaTypeCoverage(ContentType type, unsigned long long& Start, unsigned long long& End)
+{
+  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  auto itr = MediaTypeCoverage.find(type);
+  if (itr == MediaTypeCoverage.end())
+    return false;
+
+  auto first = std::get<0>(itr->second);
+  auto last = std::get<1>(itr->second);
+  Start = Discontinous && first->HasDiscontinousTS() ? first->GetDiscontinousTSValue() : first->SamplePTS->ValueInTicks;
+  End = Discontinous && last->HasDiscontinousTS() ? last->GetDiscontinousTSValue() : last->SamplePTS->ValueInTicks;
+  return true;
+}
+
 ///<summary>Gets the MPEG2 TS PID for a given media type</summary>
 ///<param name='type'>The media type to look for</param>
 ///<returns>Program ID</returns>
 unsigned short MediaSegment::GetPIDForMediaType(ContentType type)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   return this->MediaTypePIDMap.at(type);
 }
 
@@ -2666,7 +2800,7 @@ std::map<ContentType, unsigned long long> MediaSegment::SetCurrentPosition(unsig
       if (this->Discontinous && pParentPlaylist->IsLive == false)
       {
         //mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToDiscontinousRelative(nextsample->SamplePTS->ValueInTicks) : TSAbsoluteToDiscontinousAbsolute(nextsample->SamplePTS->ValueInTicks)));
-        mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->DiscontinousTS)->ValueInTicks : nextsample->DiscontinousTS->ValueInTicks));
+        mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->GetDiscontinousTSValue())->ValueInTicks : nextsample->GetDiscontinousTSValue()));
       }
       else
         mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->SamplePTS)->ValueInTicks : nextsample->SamplePTS->ValueInTicks));
@@ -2710,7 +2844,7 @@ std::map<ContentType, unsigned long long> MediaSegment::SetCurrentPosition(unsig
       if (this->Discontinous && pParentPlaylist->IsLive == false)
       {
         //mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToDiscontinousRelative(nextsample->SamplePTS->ValueInTicks) : TSAbsoluteToDiscontinousAbsolute(nextsample->SamplePTS->ValueInTicks)));
-        mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->DiscontinousTS)->ValueInTicks : nextsample->DiscontinousTS->ValueInTicks));
+        mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->GetDiscontinousTSValue())->ValueInTicks : nextsample->GetDiscontinousTSValue()));
       }
       else
         mapret.emplace(std::pair<ContentType, unsigned long long>(itr.first, !IsPositionAbsolute ? TSAbsoluteToRelative(nextsample->SamplePTS)->ValueInTicks : nextsample->SamplePTS->ValueInTicks));
@@ -2956,7 +3090,7 @@ bool MediaSegment::IncludesTimePoint(unsigned long long TimePoint, MFRATE_DIRECT
 shared_ptr<SampleData> MediaSegment::FindNearestIDRSample(unsigned long long Timepoint,
   unsigned short PID, MFRATE_DIRECTION Direction, bool IsTimepointDiscontinous, unsigned short differenceType)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   shared_ptr<SampleData> ret = nullptr;
 
   if ((Direction == MFRATE_FORWARD && UnreadQueues.find(PID) == UnreadQueues.end()) ||
@@ -2966,17 +3100,18 @@ shared_ptr<SampleData> MediaSegment::FindNearestIDRSample(unsigned long long Tim
   }
   else
   {
-    auto queue = (Direction == MFRATE_FORWARD ? UnreadQueues[PID] : ReadQueues[PID]);
+    //by reference - this runs under LockSegment and copying the queue just to scan it holds the lock longer
+    auto& queue = (Direction == MFRATE_FORWARD ? UnreadQueues[PID] : ReadQueues[PID]);
 
     std::vector<tuple<unsigned long long, shared_ptr<SampleData>, bool>> diffs;
     diffs.resize(queue.size());
     std::transform(queue.begin(), queue.end(), diffs.begin(), [this, Timepoint, IsTimepointDiscontinous, differenceType](std::shared_ptr<SampleData> sd)
     {
       return tuple<unsigned long long, shared_ptr<SampleData>, bool>(
-        (unsigned long long)abs((long long) ((IsTimepointDiscontinous && sd->DiscontinousTS != nullptr ? sd->DiscontinousTS->ValueInTicks : sd->SamplePTS->ValueInTicks) - Timepoint)), sd,
+        (unsigned long long)abs((long long) ((IsTimepointDiscontinous && sd->HasDiscontinousTS() ? sd->GetDiscontinousTSValue() : sd->SamplePTS->ValueInTicks) - Timepoint)), sd,
         differenceType == 0 ? true :
-        (differenceType > 0 ? (IsTimepointDiscontinous && sd->DiscontinousTS != nullptr ? sd->DiscontinousTS->ValueInTicks : sd->SamplePTS->ValueInTicks) > Timepoint :
-      (IsTimepointDiscontinous && sd->DiscontinousTS != nullptr ? sd->DiscontinousTS->ValueInTicks : sd->SamplePTS->ValueInTicks) < Timepoint));
+        (differenceType > 0 ? (IsTimepointDiscontinous && sd->HasDiscontinousTS() ? sd->GetDiscontinousTSValue() : sd->SamplePTS->ValueInTicks) > Timepoint :
+      (IsTimepointDiscontinous && sd->HasDiscontinousTS() ? sd->GetDiscontinousTSValue() : sd->SamplePTS->ValueInTicks) < Timepoint));
     });
     std::sort(diffs.begin(), diffs.end(), [this](tuple<unsigned long long, shared_ptr<SampleData>, bool> v1, tuple<unsigned long long, shared_ptr<SampleData>, bool> v2)
     {
@@ -3053,7 +3188,7 @@ shared_ptr<Timestamp> MediaSegment::PositionQueueAtNextIDR(unsigned short PID, M
 
 shared_ptr<SampleData> MediaSegment::PeekNextIDR(MFRATE_DIRECTION Direction, unsigned short IDRSkipCount)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   std::shared_ptr<SampleData> ret = nullptr;
 
   if (HasMediaType(ContentType::VIDEO) == false) return nullptr;
@@ -3103,7 +3238,7 @@ shared_ptr<SampleData> MediaSegment::PeekNextIDR(MFRATE_DIRECTION Direction, uns
 ///<returns>MF Sample</returns>
 void MediaSegment::GetNextSample(unsigned short PID, MFRATE_DIRECTION Direction, IMFSample **ppSample)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   std::shared_ptr<SampleData> sd = nullptr;
   //if unread queue is empty - return nullptr 
   sd = UnreadQueues[PID].empty() == false ? (Direction == MFRATE_DIRECTION::MFRATE_FORWARD ? UnreadQueues[PID].front() : UnreadQueues[PID].back()) : nullptr;
@@ -3170,15 +3305,15 @@ void MediaSegment::GetNextSample(unsigned short PID, MFRATE_DIRECTION Direction,
     {
       if (pParentPlaylist->IsLive)
       {
-        if (Discontinous && sd->DiscontinousTS != nullptr)
-          ts = sd->DiscontinousTS->ValueInTicks;
+        if (Discontinous && sd->HasDiscontinousTS())
+          ts = sd->GetDiscontinousTSValue();
         else
           ts = sd->SamplePTS->ValueInTicks;
       }
       else
       {
-        if (Discontinous && sd->DiscontinousTS != nullptr)
-          ts = TSAbsoluteToRelative(sd->DiscontinousTS)->ValueInTicks;
+        if (Discontinous && sd->HasDiscontinousTS())
+          ts = TSAbsoluteToRelative(sd->GetDiscontinousTSValue())->ValueInTicks;
         else
           ts = TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks;
       }
@@ -3197,10 +3332,10 @@ void MediaSegment::GetNextSample(unsigned short PID, MFRATE_DIRECTION Direction,
       //only log this for the first sample and last sample in the segment for now
 
       LOGIF(MediaTypePIDMap.find(ContentType::AUDIO) != MediaTypePIDMap.end() && MediaTypePIDMap[ContentType::AUDIO] == PID,
-        "AUDIO Sample(ts=" << ts << ", Index = " << sd->Index << ",Seg =" << SequenceNumber << ",PID=" << PID << ",Speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ",real ts=" << sd->SamplePTS->ValueInTicks << ",start PTS=" << (pParentPlaylist->StartPTSOriginal != nullptr ? pParentPlaylist->StartPTSOriginal->ValueInTicks : 0) << ",Discontinous : " << (Discontinous ? L"TRUE" : L"FALSE") << ", " << this->MediaUri << ")");
+        "AUDIO Sample(ts=" << ts << ", Index = " << sd->Index << ",Seg =" << SequenceNumber << ",PID=" << PID << ",Speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ",real ts=" << sd->SamplePTS->ValueInTicks << ",start PTS=" << (pParentPlaylist->StartPTSOriginal != nullptr ? pParentPlaylist->StartPTSOriginal->ValueInTicks : 0) << ",Discontinous : " << (Discontinous ? L"TRUE" : L"FALSE") << ", " << this->GetMediaUri() << ")");
 
       LOGIF(MediaTypePIDMap.find(ContentType::VIDEO) != MediaTypePIDMap.end() && MediaTypePIDMap[ContentType::VIDEO] == PID,
-        "VIDEO Sample(ts=" << ts << ", Index = " << sd->Index << ",Seg =" << SequenceNumber << ",IDR = " << (sd->IsSampleIDR ? "Yes" : "No") << ",PID=" << PID << ",Speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ",real ts=" << sd->SamplePTS->ValueInTicks << ",start PTS=" << (pParentPlaylist->StartPTSOriginal != nullptr ? pParentPlaylist->StartPTSOriginal->ValueInTicks : 0) << ",Discontinous : " << (Discontinous ? L"TRUE" : L"FALSE") << ", " << this->MediaUri << ")");
+        "VIDEO Sample(ts=" << ts << ", Index = " << sd->Index << ",Seg =" << SequenceNumber << ",IDR = " << (sd->IsSampleIDR ? "Yes" : "No") << ",PID=" << PID << ",Speed=" << (pParentPlaylist->pParentStream != nullptr ? pParentPlaylist->pParentStream->Bandwidth : 0) << ",real ts=" << sd->SamplePTS->ValueInTicks << ",start PTS=" << (pParentPlaylist->StartPTSOriginal != nullptr ? pParentPlaylist->StartPTSOriginal->ValueInTicks : 0) << ",Discontinous : " << (Discontinous ? L"TRUE" : L"FALSE") << ", " << this->GetMediaUri() << ")");
 
 
       (*ppSample)->SetSampleTime(ts);
@@ -3226,7 +3361,7 @@ void MediaSegment::GetNextSample(unsigned short PID, MFRATE_DIRECTION Direction,
 ///<returns>True or False</returns>
 bool MediaSegment::IsReadEOS()
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   bool ret = true;
 
   //for each stream in the segment 
@@ -3247,7 +3382,7 @@ bool MediaSegment::IsReadEOS()
 
 bool MediaSegment::HasUnreadCCData()
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   if (HasMediaType(ContentType::VIDEO))
   {
     auto vidpid = GetPIDForMediaType(ContentType::VIDEO);
@@ -3284,7 +3419,7 @@ bool MediaSegment::CanScavenge()
 ///<returns>True or False</returns>
 bool MediaSegment::IsReadEOS(unsigned short PID)
 {
-  std::lock_guard<std::recursive_mutex> lock(LockSegment);
+  CountedLockGuard<std::recursive_mutex> lock(LockSegment, LockSegmentContention, GetLockSegmentContentionTotal());
   //is the sample queue for the PID empty ?
   return this->IsEmptySampleQueue(PID);
 }
@@ -3302,6 +3437,5 @@ bool MediaSegment::IsReadEOS(unsigned short PID)
 ///<returns>Current segment state</returns>
 MediaSegmentState MediaSegment::GetCurrentState()
 {
-  //std::lock_guard<std::recursive_mutex> lock(LockSegment);
-  return State;
+  return State.load();
 }
@@ -28,6 +28,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <map> 
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <algorithm>
 #include <memory> 
 #include <ppltasks.h>
@@ -36,6 +37,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "TSConstants.h" 
 #include "TransportStreamParser.h" 
 #include "ContentDownloader.h" 
+#include "LockContention.h"
 
 
 using namespace std;
@@ -49,6 +51,8 @@ namespace Microsoft {
 
       class Playlist;
       class EncryptionKey;
+      class InitializationSegment;
+      class SegmentMemoryBudget;
       class SampleData;
       class ContentDownloadRegistry;
       class CHLSMediaSource;
@@ -93,6 +97,11 @@ namespace Microsoft {
         std::vector<unsigned short> MetadataStreams; 
         ///<summary>All the timestamps in the segment</summary>
         std::vector<std::shared_ptr<Timestamp>> Timeline;
+        ///<summary>Media type of every audio and video PID that was demuxed</summary>
+        std::map<unsigned short, ContentType> DemuxedPIDs;
+        ///<summary>HEVC parameter sets of each HEVC video PID</summary>
+        std::map<unsigned short, std::vector<BYTE>> HEVCParameterSets;
+        std::vector<BYTE> FramingData;
 
         SegmentTSData() {}
 
@@ -105,20 +114,31 @@ namespace Microsoft {
           MediaTypePIDMap = std::move(moveFrom.MediaTypePIDMap);
           MetadataStreams = std::move(moveFrom.MetadataStreams);
           Timeline = std::move(moveFrom.Timeline); 
+          DemuxedPIDs = std::move(moveFrom.DemuxedPIDs);
+          HEVCParameterSets = std::move(moveFrom.HEVCParameterSets);
+          FramingData = std::move(moveFrom.FramingData);
         }
       };
       ///<summary>Type represents a media segment</summary>
       ///<remarks>The type encapsulates all the necessary data and metadata, including elementary stream data, TS segment data and samples as well as methods to manipulate them</remarks>
-      class MediaSegment  // : public CDownloadTarget
+      class MediaSegment : public std::enable_shared_from_this<MediaSegment> // : public CDownloadTarget
       {
         friend class Playlist;
       private:
-        //current state the segment instance is in
-        MediaSegmentState State; 
+        //current state the segment instance is in - read on the sample path without taking LockSegment
+        std::atomic<MediaSegmentState> State; 
 
         std::map<wstring, shared_ptr<SegmentTSData>> backbuffer;
         /*shared_ptr<SegmentTSData> buffer;*/
         unique_ptr<BYTE[]> buffer;
+        ///<summary>ADTS headers written for audio samples parsed out of fMP4 - the samples point into it, just like they point into buffer</summary>
+        std::vector<BYTE> FramingData;
+        ///<summary>Budget the segment data is charged to, and how much - held on to so that we can give it back after the media source is gone</summary>
+        shared_ptr<SegmentMemoryBudget> spChargedBudget;
+        unsigned long long ChargedBytes;
+
+        void ChargeMemoryBudget(shared_ptr<SegmentMemoryBudget> spBudget);
+        void ReleaseMemoryBudget();
 
         volatile short chainAssociationCount;
         
@@ -131,11 +151,16 @@ namespace Microsoft {
        
         shared_ptr<std::map<ContentType, unsigned short>> spPIDFilter;
         void ApplyPIDFilter(std::map<ContentType, unsigned short> pidfilter, bool Force = false);
+        bool SelectDemuxedPIDs(const std::map<ContentType, unsigned short>& pidfilter);
 
       public:
         //instance lock
         //  CriticalSection csRoot;
         std::recursive_mutex LockSegment;
+        ///<summary>Contention on LockSegment from the sample request path (sample reads, EOS checks, IDR lookups) - logged when the segment goes away</summary>
+        LockContentionCounter LockSegmentContention;
+        ///<summary>The media source total LockSegmentContention adds to - nullptr if the playlist is not attached to a source</summary>
+        LockContentionCounter* GetLockSegmentContentionTotal();
         shared_ptr<ContentDownloadRegistry> spDownloadRegistry;
         //pointer to the parent playlist
         Playlist *pParentPlaylist;
@@ -156,13 +181,21 @@ namespace Microsoft {
         std::vector<unsigned short> MetadataStreams; 
         ///<summary>All the timestamps in the segment</summary>
         std::vector<std::shared_ptr<Timestamp>> Timeline; 
+        ///<summary>First and last sample of each media type in the segment - recorded once when the segment is parsed</summary>
+        std::map<ContentType, std::tuple<shared_ptr<SampleData>, shared_ptr<SampleData>>> MediaTypeCoverage;
+        ///<summary>Discontinuity offset for each PID - shared by all the samples on that PID</summary>
+        std::map<unsigned short, shared_ptr<DiscontinuityOffset>> DiscontinuityOffsets;
+        ///<summary>Media type of every audio and video PID in the segment - only filled in when all elementary streams are demuxed</summary>
+        std::map<unsigned short, ContentType> DemuxedPIDs;
+        ///<summary>HEVC VPS, SPS and PPS of each HEVC video PID in the segment - a video PID that is not listed carries AVC</summary>
+        std::map<unsigned short, std::vector<BYTE>> HEVCParameterSets;
 
      
 
         std::map<UnresolvedTagPlacement, std::vector<std::wstring>> UnresolvedTags;
      
-        ///<summary>Absolute URI for the TS file</summary>
-        std::wstring MediaUri;
+        ///<summary>Absolute URI for the TS file - only accessed through GetMediaUri()/SetMediaUri() which swap it atomically (a mirror switch repoints it while downloads may be reading it)</summary>
+        shared_ptr<const std::wstring> spMediaUri;
         ///<summary>Duration in ticks</summary>
         unsigned long long Duration;
         ///<summary>Cumulative (from the start of the presentation) duration in ticks</summary>
@@ -178,10 +211,17 @@ namespace Microsoft {
         unsigned int LengthInBytes;
         ///<summary>Encryption key needed for this segment</summary>
         shared_ptr<EncryptionKey> EncKey;
+        ///<summary>EXT-X-MAP initialization section for fMP4 segments - nullptr for transport streams</summary>
+        shared_ptr<InitializationSegment> spInitSegment;
+        ///<summary>Segment this one is cloaking with - only accessed through GetCloaking()/SetCloaking() which swap it atomically</summary>
         shared_ptr<MediaSegment> spCloaking;
         bool Discontinous;
         bool StartsDiscontinuity; 
         bool IsTransportStream;
+        ///<summary>True if the video in the segment is HEVC (per the PMT stream type)</summary>
+        bool IsHEVC;
+        ///<summary>HEVC VPS, SPS and PPS (Annex B) of the video PID the segment is playing - used to build the video media type</summary>
+        std::vector<BYTE> VideoParameterSets;
         //Sequence number
         unsigned int SequenceNumber;
 
@@ -223,10 +263,16 @@ namespace Microsoft {
         ///<summary>Sets the current state on a media segment</summary>
         ///<param name='state'>The new state</param>
         void SetCurrentState(MediaSegmentState state);
+        void SetMediaTypeCoverage();
+        void SelectVideoFormat();
         
         void UpdateSampleDiscontinuityTimestamps(shared_ptr<MediaSegment> prevplayedseg,bool IgnoreUnreadSamples = false);
         void UpdateSampleDiscontinuityTimestamps(shared_ptr<SampleData> lastvidsample, shared_ptr<SampleData> lastaudsample);
         void UpdateSampleDiscontinuityTimestamps(unsigned long long lastts);
+        shared_ptr<std::tuple<ContentType, shared_ptr<SampleData>>> GetFirstUnreadSample();
+        void SetDiscontinuityOffsets(ContentType FirstSampleType, shared_ptr<SampleData> FirstSample, unsigned long long lastts);
+        void AttachDiscontinuityOffsets();
+        void ShareDiscontinuityOffset(unsigned short PID);
         
         void CancelDownloads(bool WaitForRunningTasks = false);
         ///<summary>Gets the MPEG2 TS PID for a given media type</summary>
@@ -250,6 +296,10 @@ namespace Microsoft {
         ///<param name='type'>The media type to look for</param>
         ///<returns>true if found, false otherwise</returns>
         bool HasMediaType(ContentType type);
+        ///<summary>Gets the interval covered by the samples of a media type, without inspecting the sample queues</summary>
+        ///<remarks>Uses the discontinuity adjusted timestamps once they have been set - so the values are on the same timeline as the samples handed out</remarks>
+        ///<returns>False if the segment is not in memory or has no samples of the media type (a gap the stream needs ticks for)</returns>
+        bool GetMediaTypeCoverage(ContentType type, unsigned long long& Start, unsigned long long& End);
 
         ///<summary>Gets the next unread sample for a program</summary>
         ///<param name='PID'>The PID for the program in which we are looking for a sample</param>
@@ -393,11 +443,17 @@ namespace Microsoft {
 
         shared_ptr<MediaSegment> GetCloaking() {
           
-          return spCloaking;
+          return std::atomic_load(&spCloaking);
         };
         void SetCloaking(shared_ptr<MediaSegment> seg) {
-          std::lock_guard<std::recursive_mutex> lock(LockSegment);
-          spCloaking = seg;
+          std::atomic_store(&spCloaking, seg);
+        }
+        std::wstring GetMediaUri() {
+          auto uri = std::atomic_load(&spMediaUri);
+          return uri != nullptr ? *uri : L"";
+        }
+        void SetMediaUri(const std::wstring& uri) {
+          std::atomic_store(&spMediaUri, shared_ptr<const std::wstring>(make_shared<std::wstring>(uri)));
         }
         ///<summary>Checks to see if there are any samples to read</summary>
         ///<param name='PID'>The PID of the stream to check</param>
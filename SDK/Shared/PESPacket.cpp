@@ -43,7 +43,8 @@ ContentType PESPacket::GetContentType(TransportPacket *pParent,std::map<ContentT
 
   if ((this->HasHeader && StreamID >> 5 == 6) || (pParent->pParentParser->PMT.find(pParent->PID) != pParent->pParentParser->PMT.end() && pParent->pParentParser->PMT[pParent->PID] == 0x0F))
     return ContentType::AUDIO;
-  else if ((this->HasHeader && StreamID >> 4 == 14) || (pParent->pParentParser->PMT.find(pParent->PID) != pParent->pParentParser->PMT.end() && pParent->pParentParser->PMT[pParent->PID] == 0x1B))
+  else if ((this->HasHeader && StreamID >> 4 == 14) || (pParent->pParentParser->PMT.find(pParent->PID) != pParent->pParentParser->PMT.end() && 
+    (pParent->pParentParser->PMT[pParent->PID] == 0x1B || pParent->pParentParser->PMT[pParent->PID] == 0x24)))
     return ContentType::VIDEO;
   else if ((pParent->pParentParser->PMT.find(pParent->PID) != pParent->pParentParser->PMT.end() && pParent->pParentParser->PMT[pParent->PID] == 0x15) ||
     (this->HasHeader && PIDFilter.find(ContentType::METADATA) != PIDFilter.end() && PIDFilter[ContentType::METADATA] == StreamID)// ||
@@ -65,13 +66,14 @@ const std::shared_ptr<PESPacket> PESPacket::Parse(const BYTE *pesdata,
 {
   //std::shared_ptr<PESPacket> ret = std::make_shared<PESPacket>(pParent.get());
   std::shared_ptr<PESPacket> ret = std::make_shared<PESPacket>();
-
+  //false for a PID we only keep because the parser is indexing all PIDs
+  bool IsActive = true;
 
   if (pParent->PayloadUnitStartIndicator == 0x01)
   {
     ret->HasHeader = true;
-    unsigned long _tmpulong = BitOp::ToInteger<unsigned long>(pesdata, 4);
-    unsigned long startcodeprefix = BitOp::ExtractBits(_tmpulong, 0, 24);
+    unsigned int _tmpulong = BitOp::ToInteger<unsigned int>(pesdata, 4);
+    unsigned int startcodeprefix = BitOp::ExtractBits(_tmpulong, 0, 24);
     if (startcodeprefix != 0x000001) //wrong start code for PES
       return nullptr;
 
@@ -95,7 +97,9 @@ const std::shared_ptr<PESPacket> PESPacket::Parse(const BYTE *pesdata,
       }
       else if (foundcontenttypeinmap != MediaTypePIDMap.end() && foundcontenttypeinmap->second != pParent->PID)
       {
-        return nullptr; //not interested - we already have found a different PID for this media type - we only enable the lowest PID demuxed stream of a specific type or pick one from a supplied filter and ignore others
+        if (!pParent->pParentParser->IndexAllPIDs)
+          return nullptr; //not interested - we already have found a different PID for this media type - we only enable the lowest PID demuxed stream of a specific type or pick one from a supplied filter and ignore others
+        IsActive = false;
       }
     }
 
@@ -122,7 +126,8 @@ const std::shared_ptr<PESPacket> PESPacket::Parse(const BYTE *pesdata,
       if (PTS_DTS_flag == 0x02 || PTS_DTS_flag == 0x03)
       {
         ret->PresentationTimestamp = Timestamp::Parse(pesdata + 9, TimestampType::PTS);
-        Timeline.push_back(ret->PresentationTimestamp);
+        if (IsActive)
+          Timeline.push_back(ret->PresentationTimestamp);
       }
       if (PTS_DTS_flag == 0x03)
       {
@@ -184,6 +189,10 @@ const std::shared_ptr<PESPacket> PESPacket::Parse(const BYTE *pesdata,
   if (mediaType != ContentType::UNKNOWN)
   {
 
+    if ((mediaType == ContentType::AUDIO || mediaType == ContentType::VIDEO) && pParent->pParentParser->IndexAllPIDs)
+    {
+      pParent->pParentParser->ElementaryStreams[pParent->PID] = mediaType;
+    }
     if (MediaTypePIDMap.find(mediaType) == MediaTypePIDMap.end() && (mediaType == ContentType::AUDIO || mediaType == ContentType::VIDEO))
     {
       MediaTypePIDMap.emplace(std::pair<ContentType, unsigned short>(mediaType, pParent->PID));
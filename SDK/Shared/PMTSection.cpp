@@ -101,6 +101,7 @@ std::shared_ptr<PMTSection> PMTSection::Parse(const BYTE *pmtdata)
 
     if (streamType == 0x0F || //ADTS audio
       streamType == 0x1B || //AVC Video
+      streamType == 0x24 || //HEVC Video
       (streamType == 0x15 && IsHLSTimedMetadata(pmtdata + offset, ESInfoLength))) //HLS Timed (ID3) Metadata in PES packets 
     {
       ret->MapData.emplace(std::move(std::pair<unsigned short, BYTE>(elemStreamPID, streamType)));
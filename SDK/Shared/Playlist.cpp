@@ -38,19 +38,31 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Playlist.h"  
 #include "ContentDownloader.h"
 #include "ContentDownloadRegistry.h"
+#include "InitializationSegment.h"
 
 using namespace Microsoft::HLSClient::Private;
 using namespace std;
+
+//delay (in ticks) before following up on a blocking playlist reload that returned new segments
+#define BLOCKINGRELOADINTERVAL 100000ULL
+
 #pragma region Playlist  
 
 
 
 
 
+LockContentionCounter* Playlist::GetLockSegmentTrackingContentionTotal()
+{
+    return cpMediaSource != nullptr ? &(cpMediaSource->LockContention.LockSegmentTracking) : nullptr;
+}
+
 Playlist::~Playlist()
 {
 
     LOGIIF(IsVariant, "Root Playlist Destroyed", "Child Playlist Destroyed");
+    LOGIF(LockSegmentTrackingContention.Contentions > 0,
+        "Sample path lock contention : LockSegmentTracking " << LockSegmentTrackingContention.Contentions.load() << " of " << LockSegmentTrackingContention.Acquisitions.load());
 
     if (!IsVariant && spswPlaylistRefresh != nullptr && spswPlaylistRefresh->IsTicking)
         spswPlaylistRefresh->StopTicking();
@@ -379,6 +391,7 @@ void Playlist::StartVideoStreamTick()
     {
 
         spswVideoStreamTick = make_shared<StopWatch>();
+        spswVideoStreamTick->spSharedTimer = cpMediaSource->spSharedTimer;
         spswVideoStreamTick->TickEventFrequency = stream->ApproximateFrameDistance == 0 ? DEFAULT_VIDEO_STREAMTICK_OFFSET : stream->ApproximateFrameDistance;
         spswVideoStreamTick->StartTicking(OnVideoStreamTick);
     }
@@ -724,6 +737,25 @@ task<HRESULT> Playlist::DownloadPlaylistAsync(
     wstring url = URL;
     std::map<wstring, wstring> headers;
     std::vector<shared_ptr<Cookie>> cookies;
+    wstring lastmod, etag;
+    bool blockingreload = false;
+
+    //refresh of a single bitrate live playlist - same conditional and blocking reload rules as a variant refresh (see StreamInfo::DownloadPlaylistAsync())
+    if (Configuration::GetCurrent()->EnableLowLatencyLive && spPlaylist != nullptr && spPlaylist->IsLive && !spPlaylist->IsVariant)
+    {
+        std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
+        //the refresh that has not been merged yet is the most recent copy we have
+        auto latest = (spPlaylist->spPlaylistRefresh != nullptr && spPlaylist->spPlaylistRefresh->Segments.size() > 0) ? spPlaylist->spPlaylistRefresh : spPlaylist;
+        lastmod = spPlaylist->spPlaylistRefresh != nullptr ? spPlaylist->spPlaylistRefresh->LastModified : spPlaylist->LastModified;
+        etag = spPlaylist->spPlaylistRefresh != nullptr ? spPlaylist->spPlaylistRefresh->ETag : spPlaylist->ETag;
+        //ask the server to hold the request until the segment after the last one we know of is available
+        if (spPlaylist->UseBlockingReload() && latest->Segments.size() > 0)
+        {
+            url += (url.find(L'?') == wstring::npos ? L"?_HLS_msn=" : L"&_HLS_msn=") + to_wstring(latest->Segments.back()->SequenceNumber + 1);
+            blockingreload = true;
+        }
+    }
+
     Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
     ms->cpControllerFactory->RaisePrepareResourceRequest(ResourceType::PLAYLIST, url, cookies, headers, &external);
 
@@ -731,13 +763,13 @@ task<HRESULT> Playlist::DownloadPlaylistAsync(
 
     downloader->Initialize(ref new Platform::String(url.data()));
     if (external == nullptr)
-        downloader->SetParameters(nullptr, L"GET", cookies, headers);
+        downloader->SetParameters(nullptr, L"GET", cookies, headers, false, lastmod, etag);
     else
         downloader->SetParameters(nullptr, external);
 
 
     downloader->Completed += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^>(
-        [ms, &spPlaylist, url, tcePlaylistDownloaded](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
+        [ms, &spPlaylist, URL, tcePlaylistDownloaded, blockingreload](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
     {
         DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
 
@@ -754,7 +786,15 @@ task<HRESULT> Playlist::DownloadPlaylistAsync(
                 if (MemoryCache.size() == 0)
                     tcePlaylistDownloaded.set(E_FAIL);
                 else
-                    Playlist::OnPlaylistDownloadCompleted(args->ContentUri->AbsoluteUri->Data(), MemoryCache, spPlaylist, tcePlaylistDownloaded);
+                {
+                    wstring lastmod, etag;
+                    if (args->ResponseHeaders != nullptr && args->ResponseHeaders->HasKey(L"Last-Modified"))
+                        lastmod = args->ResponseHeaders->Lookup(L"Last-Modified")->Data();
+                    if (args->ResponseHeaders != nullptr && args->ResponseHeaders->HasKey(L"ETag"))
+                        etag = args->ResponseHeaders->Lookup(L"ETag")->Data();
+                    //a blocking reload carries our own query parameters so we keep the uri we already have
+                    Playlist::OnPlaylistDownloadCompleted(blockingreload ? URL : args->ContentUri->AbsoluteUri->Data(), MemoryCache, spPlaylist, tcePlaylistDownloaded, lastmod, etag);
+                }
             }
             else
                 tcePlaylistDownloaded.set(E_FAIL);
@@ -768,7 +808,10 @@ task<HRESULT> Playlist::DownloadPlaylistAsync(
     {
         DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
         //    ms->spDownloadRegistry->Unregister(downloader);
-        tcePlaylistDownloaded.set(E_FAIL);
+        if (args->StatusCode == Windows::Web::Http::HttpStatusCode::NotModified)
+            tcePlaylistDownloaded.set(S_OK);//conditional refresh - nothing changed
+        else
+            tcePlaylistDownloaded.set(E_FAIL);
     });
 
 
@@ -781,7 +824,9 @@ task<HRESULT> Playlist::DownloadPlaylistAsync(
 HRESULT Playlist::OnPlaylistDownloadCompleted(const std::wstring& Url,
     std::vector<BYTE> MemoryCache,
     std::shared_ptr<Playlist>& spPlaylist,
-    task_completion_event<HRESULT> tcePlaylistDownloaded)
+    task_completion_event<HRESULT> tcePlaylistDownloaded,
+    const std::wstring& lastmod,
+    const std::wstring& etag)
 {
     try
     {
@@ -791,6 +836,7 @@ HRESULT Playlist::OnPlaylistDownloadCompleted(const std::wstring& Url,
         if (spPlaylist == nullptr)
         {
             spPlaylist = std::make_shared<Playlist>(std::wstring(MemoryCache.begin(), MemoryCache.end()), baseuri, filename);
+            spPlaylist->SetLastModifiedSince(lastmod, etag);
             LOG("Playlist Download");
             LOG(spPlaylist->szData);
         }
@@ -798,6 +844,7 @@ HRESULT Playlist::OnPlaylistDownloadCompleted(const std::wstring& Url,
         {
             std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
             spPlaylist->spPlaylistRefresh = std::make_shared<Playlist>(std::wstring(MemoryCache.begin(), MemoryCache.end()), baseuri, filename);
+            spPlaylist->spPlaylistRefresh->SetLastModifiedSince(lastmod, etag);
             if (spPlaylist->szData != spPlaylist->spPlaylistRefresh->szData)
                 spPlaylist->spPlaylistRefresh->Parse();
 
@@ -815,6 +862,13 @@ HRESULT Playlist::OnPlaylistDownloadCompleted(const std::wstring& Url,
     return S_OK;
 }
 
+///<summary>Checks if live refreshes should be issued as blocking playlist reloads</summary>
+///<returns>True if low latency mode is on and the server advertised CAN-BLOCK-RELOAD</returns>
+bool Playlist::UseBlockingReload()
+{
+    return IsLive && CanBlockReload && Configuration::GetCurrent()->EnableLowLatencyLive;
+}
+
 void Playlist::SetStopwatchForNextPlaylistRefresh(unsigned long long refreshIntervalInTicks, bool lockmerge)
 {
 
@@ -869,6 +923,9 @@ void Playlist::SetStopwatchForNextPlaylistRefresh(unsigned long long refreshInte
                     pParentStream->spPlaylistRefresh = si->spPlaylistRefresh; //copy the refresh version over
                 }
 
+                //piggyback on the active variant refresh to keep the adjacent variants current
+                cpMediaSource->WarmAdjacentVariants();
+
                 {
                     //download the target playlist if a bitrate switch is pending
                     if (std::try_lock(this->cpMediaSource->cpVideoStream->LockSwitch, this->cpMediaSource->cpAudioStream->LockSwitch) < 0)
@@ -971,7 +1028,16 @@ void Playlist::SetStopwatchForNextPlaylistRefresh(unsigned long long refreshInte
             cpMediaSource->GetCurrentState() != MSS_STOPPED && cpMediaSource->GetCurrentState() != MSS_PAUSED)
         {
             if (spswPlaylistRefresh == nullptr && !this->LastLiveRefreshProcessed)//set it for the next refresh
-                SetStopwatchForNextPlaylistRefresh((unsigned long long)(this->DerivedTargetDuration / 2));
+            {
+                //a blocking reload that brought in a new segment can be followed up right away - the server holds the next request until there is more
+                auto refresh = this->pParentStream != nullptr ? this->pParentStream->spPlaylistRefresh : this->spPlaylistRefresh;
+                if (UseBlockingReload() && refresh != nullptr &&
+                    refresh->Segments.size() > 0 && this->Segments.size() > 0 &&
+                    refresh->Segments.back()->SequenceNumber > this->Segments.back()->SequenceNumber)
+                    SetStopwatchForNextPlaylistRefresh(BLOCKINGRELOADINTERVAL);
+                else
+                    SetStopwatchForNextPlaylistRefresh((unsigned long long)(this->DerivedTargetDuration / 2));
+            }
         }
         return;
     };
@@ -991,6 +1057,7 @@ void Playlist::SetStopwatchForNextPlaylistRefresh(unsigned long long refreshInte
             spswPlaylistRefresh.reset();
         }
         spswPlaylistRefresh = make_shared<StopWatch>();
+        spswPlaylistRefresh->spSharedTimer = cpMediaSource->spSharedTimer;
         spswPlaylistRefresh->TickEventFrequency = refreshIntervalInTicks;
         spswPlaylistRefresh->StartTickingOnce(StopwatchEvent);
     }
@@ -1186,9 +1253,17 @@ bool Playlist::MergeLivePlaylistChild()
                             cdur = itr->CumulativeDuration;
                             if (itr->EncKey != nullptr)
                                 itr->EncKey->pParentPlaylist = this;
+                            if (itr->spInitSegment != nullptr)
+                            {
+                                itr->spInitSegment->pParentPlaylist = this;
+                                if (itr->spInitSegment->EncKey != nullptr)
+                                    itr->spInitSegment->EncKey->pParentPlaylist = this;
+                            }
                         }
 
 
+                        //hand the merged list to readers - they keep walking the previous snapshot till now
+                        PublishSegmentSnapshot();
                         LOG("*** END MERGE ***");
                     }
 
@@ -1245,9 +1320,18 @@ bool Playlist::MergeLivePlaylistChild()
         pParentStream->IsActive &&
         cpMediaSource->GetCurrentState() != MSS_STOPPED && cpMediaSource->GetCurrentState() != MSS_ERROR && cpMediaSource->GetCurrentState() != MSS_UNINITIALIZED && cpMediaSource->GetCurrentState() != MSS_PAUSED) //this is the active playlist
     {
+        cpMediaSource->CheckLiveCatchup(this);
+
+        if (UseBlockingReload())
+        {
+            //a blocking reload in flight schedules the next one itself
+            std::unique_lock<std::recursive_mutex> LockSW(lockPlaylistRefreshStopWatch, std::try_to_lock);
+            if (LockSW.owns_lock() == false)
+                return Changed;
+        }
 
         if (Changed)
-            SetStopwatchForNextPlaylistRefresh(this->Segments.back()->Duration);
+            SetStopwatchForNextPlaylistRefresh(UseBlockingReload() ? BLOCKINGRELOADINTERVAL : this->Segments.back()->Duration);
         else
             SetStopwatchForNextPlaylistRefresh((unsigned long long)(this->DerivedTargetDuration / 2));
 
@@ -1373,9 +1457,16 @@ bool Playlist::MergeLivePlaylistMaster()
                                 cdur = itr->CumulativeDuration;
                                 if (itr->EncKey != nullptr)
                                     itr->EncKey->pParentPlaylist = this;
+                                if (itr->spInitSegment != nullptr)
+                                {
+                                    itr->spInitSegment->pParentPlaylist = this;
+                                    if (itr->spInitSegment->EncKey != nullptr)
+                                        itr->spInitSegment->EncKey->pParentPlaylist = this;
+                                }
                             }
 
 
+                            PublishSegmentSnapshot();
                             LOG("*** END MERGE ***");
                         }
 
@@ -1432,9 +1523,18 @@ bool Playlist::MergeLivePlaylistMaster()
     if (!this->LastLiveRefreshProcessed && //if this is the last playlist in the program this will be marked non-Live since we should find the EXE-X-ENDLIST - in that case we stop the stopwatch    
         cpMediaSource->GetCurrentState() != MSS_STOPPED && cpMediaSource->GetCurrentState() != MSS_ERROR && cpMediaSource->GetCurrentState() != MSS_UNINITIALIZED && cpMediaSource->GetCurrentState() != MSS_PAUSED) //this is the active playlist
     {
+        cpMediaSource->CheckLiveCatchup(this);
+
+        if (UseBlockingReload())
+        {
+            //a blocking reload in flight schedules the next one itself
+            std::unique_lock<std::recursive_mutex> LockSW(lockPlaylistRefreshStopWatch, std::try_to_lock);
+            if (LockSW.owns_lock() == false)
+                return Changed;
+        }
 
         if (Changed)
-            SetStopwatchForNextPlaylistRefresh(this->Segments.back()->Duration);
+            SetStopwatchForNextPlaylistRefresh(UseBlockingReload() ? BLOCKINGRELOADINTERVAL : this->Segments.back()->Duration);
         else
             SetStopwatchForNextPlaylistRefresh((unsigned long long)(this->DerivedTargetDuration / 2));
     }
@@ -1547,8 +1647,15 @@ bool Playlist::MergeAlternateRenditionPlaylist()
                             cdur = itr->CumulativeDuration;
                             if (itr->EncKey != nullptr)
                                 itr->EncKey->pParentPlaylist = this;
+                            if (itr->spInitSegment != nullptr)
+                            {
+                                itr->spInitSegment->pParentPlaylist = this;
+                                if (itr->spInitSegment->EncKey != nullptr)
+                                    itr->spInitSegment->EncKey->pParentPlaylist = this;
+                            }
                         }
 
+                        PublishSegmentSnapshot();
                         LOG("*** END MERGE ***");
                     }
 
@@ -1619,6 +1726,7 @@ void Playlist::Parse()
 
     //parse the vector of lines
     ParseTags(lines);
+    PublishSegmentSnapshot();
 
     //if the playlist is a variant master, process renditions (if any) and set the default bitrate bounds
     if (IsVariant)
@@ -1639,7 +1747,15 @@ void Playlist::Parse()
 
     }
 
-    if (!IsVariant && this->Segments.size() > 0 && IsLive)
+    if (!IsVariant && this->Segments.size() > 0 && IsLive && Configuration::GetCurrent()->EnableLowLatencyLive)
+    {
+        //honor the server hold back if there is one, and allow starting as close as one target duration from the edge
+        if (Configuration::GetCurrent()->MinimumLiveLatency == 0)
+            Configuration::GetCurrent()->MinimumLiveLatency = ServerHoldBack > 0 ? ServerHoldBack : 2 * PlaylistTargetDuration;
+        else if (Configuration::GetCurrent()->MinimumLiveLatency < PlaylistTargetDuration) //clamp
+            Configuration::GetCurrent()->MinimumLiveLatency = PlaylistTargetDuration;
+    }
+    else if (!IsVariant && this->Segments.size() > 0 && IsLive)
     {
         if (Configuration::GetCurrent()->MinimumLiveLatency == 0)
             Configuration::GetCurrent()->MinimumLiveLatency = 4 * PlaylistTargetDuration;
@@ -1739,6 +1855,7 @@ void Playlist::AssignRenditions()
 void Playlist::ParseTags(std::vector<std::wstring>& lines)
 {
     std::shared_ptr<EncryptionKey> lastKey = nullptr;
+    std::shared_ptr<InitializationSegment> lastMap = nullptr;
     shared_ptr<Timestamp> lastPDT = nullptr;
     bool HitDisconinuity = false;
     bool StartDiscontinuity = false;
@@ -1760,6 +1877,8 @@ void Playlist::ParseTags(std::vector<std::wstring>& lines)
             pendingms->SetUri(*itr);
             if (lastKey != nullptr) //associate the DRM key if any
                 pendingms->EncKey = lastKey;
+            if (lastMap != nullptr) //associate the fMP4 initialization section if any
+                pendingms->spInitSegment = lastMap;
             //set sequence number
             pendingms->SetSequenceNumber(static_cast<unsigned int>(Segments.size()) + BaseSequenceNumber);
             //add up the duration to set cumulative duration
@@ -1846,6 +1965,25 @@ void Playlist::ParseTags(std::vector<std::wstring>& lines)
             //read and store the allow cache directive
             Helpers::ReadAttributeValueFromPosition(Helpers::ReadAttributeList(*itr), 0, AllowCache);
         }
+        else if (tagName == TAGNAME::EXT_X_SERVER_CONTROL)
+        {
+            //match attribute names exactly - HOLD-BACK is a suffix of PART-HOLD-BACK
+            for (auto attrib : Helpers::SplitAttributeList(Helpers::ReadAttributeList(*itr)))
+            {
+                auto equalpos = attrib.find_first_of('=');
+                if (equalpos == std::wstring::npos) continue;
+                auto name = attrib.substr(0, equalpos);
+                auto val = attrib.substr(equalpos + 1);
+                if (name == L"CAN-BLOCK-RELOAD")
+                    CanBlockReload = (val == L"YES");
+                else if (name == L"HOLD-BACK")
+                {
+                    double holdback = 0;
+                    std::wistringstream(val) >> holdback;
+                    ServerHoldBack = (unsigned long long)(holdback * 10000000);
+                }
+            }
+        }
         else if (tagName == TAGNAME::EXT_X_PLAYLIST_TYPE)
         {
             wstring pltype;
@@ -1901,6 +2039,12 @@ void Playlist::ParseTags(std::vector<std::wstring>& lines)
             //store it temporarily
             lastKey = std::make_shared<EncryptionKey>((*itr), this);
         }
+        else if (tagName == TAGNAME::EXT_X_MAP) //fMP4 initialization section - applies to every segment after it till the next one
+        {
+            lastMap = std::make_shared<InitializationSegment>((*itr), this);
+            //an AES-128 key in effect here encrypts the section too
+            lastMap->EncKey = lastKey;
+        }
         else if (tagName == TAGNAME::EXT_X_STREAM_INF) //variant playlist entry
         {
             //make StreamInfo instance
@@ -1984,6 +2128,19 @@ shared_ptr<Timestamp> Playlist::FindApproximateLivePosition()
     }
 }
 
+///<summary>Estimates how far the playhead has fallen behind the live start position</summary>
+///<returns>Distance in ticks, 0 if the playhead is at or past the live start position</returns>
+unsigned long long Playlist::FindDistanceFromLivePosition()
+{
+    if (!IsLive || IsVariant || Segments.size() == 0) return 0;
+    //same anchor as FindApproximateLivePosition() - but measured in segment durations so that timestamp discontinuities do not skew it
+    auto liveseg = GetSegment(FindLiveStartSegmentSequenceNumber());
+    auto playseg = MinCurrentSegment();
+    if (liveseg == nullptr || playseg == nullptr || playseg->SequenceNumber >= liveseg->SequenceNumber)
+        return 0;
+    return liveseg->CumulativeDuration > playseg->CumulativeDuration ? liveseg->CumulativeDuration - playseg->CumulativeDuration : 0;
+}
+
 unsigned int Playlist::FindLiveStartSegmentSequenceNumber()
 {
     if (!IsLive || IsVariant) return 0;
@@ -2024,14 +2181,35 @@ unsigned int Playlist::FindAltRenditionMatchingSegment(Playlist* mainPlaylist, u
 
     unsigned int targetseq = 0;
 
+    //a live merge recalculates CumulativeDuration on the segments in place - read each playlist's durations under its merge lock (one at a time)
+    unsigned long long maintracklowerbound = 0, maintrackupperbound = MAXULONGLONG, mainsegcumduration = 0;
+    {
+        std::unique_lock<std::recursive_mutex> mainmergelock(mainPlaylist->LockMerge, std::defer_lock);
+        if (mainPlaylist->IsLive)
+            mainmergelock.lock();
+
+        mainsegcumduration = mainseg->CumulativeDuration;
+        auto prevseg = mainPlaylist->GetNextSegment(SequenceNumber, MFRATE_DIRECTION::MFRATE_REVERSE);
+        if (prevseg != nullptr)
+            maintracklowerbound = prevseg->CumulativeDuration;
+        auto nextseg = mainPlaylist->GetNextSegment(SequenceNumber, MFRATE_DIRECTION::MFRATE_FORWARD);
+        if (nextseg != nullptr)
+            maintrackupperbound = nextseg->CumulativeDuration;
+    }
+
+    std::unique_lock<std::recursive_mutex> mergelock(LockMerge, std::defer_lock);
+    if (IsLive)
+        mergelock.lock();
 
-    if (mainseg->ProgramDateTime != nullptr && Segments.front()->ProgramDateTime != nullptr)
+    auto snapshot = GetSegmentSnapshot();
+
+    if (mainseg->ProgramDateTime != nullptr && snapshot->front()->ProgramDateTime != nullptr)
     {
-        auto matchingseg = std::find_if(begin(this->Segments), end(this->Segments), [mainseg](shared_ptr<MediaSegment> ms)
+        auto matchingseg = std::find_if(snapshot->begin(), snapshot->end(), [mainseg](const shared_ptr<MediaSegment>& ms)
         {
             return ms->ProgramDateTime->ValueInTicks + ms->Duration >= mainseg->ProgramDateTime->ValueInTicks;
         });
-        if (matchingseg == end(this->Segments)) //something is wrong
+        if (matchingseg == snapshot->end()) //something is wrong
             targetseq = SequenceNumber;
         else
         {
@@ -2040,20 +2218,15 @@ unsigned int Playlist::FindAltRenditionMatchingSegment(Playlist* mainPlaylist, u
     }
     else
     {
-        if (SequenceNumber == mainPlaylist->Segments.front()->GetSequenceNumber())
-            targetseq = this->Segments.front()->SequenceNumber;
-
-        auto maintracklowerbound = mainPlaylist->GetNextSegment(SequenceNumber, MFRATE_DIRECTION::MFRATE_REVERSE)->CumulativeDuration;
-        auto nextseg = mainPlaylist->GetNextSegment(SequenceNumber, MFRATE_DIRECTION::MFRATE_FORWARD);
-        auto maintrackupperbound = nextseg != nullptr ? nextseg->CumulativeDuration : MAXULONGLONG;
+        if (SequenceNumber == mainPlaylist->GetSegmentSnapshot()->front()->GetSequenceNumber())
+            targetseq = snapshot->front()->SequenceNumber;
 
         {
-            std::lock_guard<recursive_mutex> lock(LockSegmentList);
-            auto matchingseg = std::find_if(begin(this->Segments), end(this->Segments), [maintracklowerbound, maintrackupperbound](shared_ptr<MediaSegment> ms)
+            auto matchingseg = std::find_if(snapshot->begin(), snapshot->end(), [maintracklowerbound, maintrackupperbound](const shared_ptr<MediaSegment>& ms)
             {
                 return ms->CumulativeDuration >= maintracklowerbound && ms->CumulativeDuration <= maintrackupperbound;
             });
-            if (matchingseg == end(this->Segments)) //something is wrong
+            if (matchingseg == snapshot->end()) //something is wrong
                 targetseq = SequenceNumber;
             else
                 targetseq = (*matchingseg)->SequenceNumber;
@@ -2064,7 +2237,7 @@ unsigned int Playlist::FindAltRenditionMatchingSegment(Playlist* mainPlaylist, u
 
     LOG("FindAltRenditionMatchingSegment: Main : " << SequenceNumber << " matched to " << targetseq);
 
-    EndsBeforeMain = GetSegment(targetseq)->CumulativeDuration < mainseg->CumulativeDuration;
+    EndsBeforeMain = GetSegment(targetseq)->CumulativeDuration < mainsegcumduration;
 
     return targetseq;
 }
@@ -2211,7 +2384,7 @@ tuple<HRESULT, std::map<ContentType, unsigned long long>> Playlist::SetCurrentPo
 
 
         if (sd != nullptr)
-            finalpos = (TargetSeg->Discontinous) ? pPlaylist->TSAbsoluteToRelative(sd->DiscontinousTS)->ValueInTicks : pPlaylist->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks;
+            finalpos = (TargetSeg->Discontinous) ? pPlaylist->TSAbsoluteToRelative(sd->GetDiscontinousTSValue())->ValueInTicks : pPlaylist->TSAbsoluteToRelative(sd->SamplePTS)->ValueInTicks;
 
     }
 
@@ -2222,7 +2395,7 @@ tuple<HRESULT, std::map<ContentType, unsigned long long>> Playlist::SetCurrentPo
     if (finalpos < pPlaylist->TotalDuration &&
         (
             (TargetSeg->Discontinous == false && TargetSeg->EndPTSNormalized != nullptr && finalpos < TargetSeg->EndPTSNormalized->ValueInTicks) ||
-            (TargetSeg->Discontinous && finalpos <= TargetSeg->GetLastSample()->DiscontinousTS->ValueInTicks)
+            (TargetSeg->Discontinous && finalpos <= TargetSeg->GetLastSample()->GetDiscontinousTSValue())
             ))
     {
         retActualPosition = TargetSeg->SetCurrentPosition(finalpos, pPlaylist->cpMediaSource->GetCurrentDirection());
@@ -2493,29 +2666,28 @@ tuple<HRESULT, std::map<ContentType, unsigned long long>> Playlist::SetCurrentPo
 ///<returns>The matching segment</returns>
 shared_ptr<MediaSegment> Playlist::GetSegmentAtTime(unsigned long long timeinticks, unsigned short retrycount)
 {
-    std::unique_lock<std::recursive_mutex> listlock(LockSegmentList, std::defer_lock);
+    //the snapshot keeps the list steady, but a live merge recalculates CumulativeDuration on the segments in place - hold merges off while we match on it
     std::unique_lock<std::recursive_mutex> mergelock(LockMerge, std::defer_lock);
     if (IsLive)
-    {
-        listlock.lock();
         mergelock.lock();
-    }
+
+    auto snapshot = GetSegmentSnapshot();
 
     std::shared_ptr<MediaSegment> ret = nullptr;
-    Playlist::SEGMENTVECTOR::iterator match = Segments.end();
+    Playlist::SEGMENTVECTOR::const_iterator match = snapshot->end();
 
     if (IsLive)
     {
-        auto firstinmem = std::find_if(Segments.begin(), Segments.end(), [this](shared_ptr<MediaSegment> spms)
+        auto firstinmem = std::find_if(snapshot->begin(), snapshot->end(), [this](const shared_ptr<MediaSegment>& spms)
         {
             return spms->GetCurrentState() == INMEMORYCACHE;
         });
 
-        if (firstinmem != Segments.end())
+        if (firstinmem != snapshot->end())
         {
             auto startoffset = (*firstinmem)->StartPTSNormalized->ValueInTicks;// -(*firstinmem)->CumulativeDuration - (*firstinmem)->Duration;
             //find the first segment for which the given time point is less than the start PTS - the target segment is the one prior to it then
-            match = std::find_if(Segments.begin(), Segments.end(), [timeinticks, startoffset, this](Playlist::SEGMENTVECTOR::value_type segdata)
+            match = std::find_if(snapshot->begin(), snapshot->end(), [timeinticks, startoffset, this](const Playlist::SEGMENTVECTOR::value_type& segdata)
             {
                 return segdata->CumulativeDuration > (timeinticks - startoffset);
             });
@@ -2524,13 +2696,13 @@ shared_ptr<MediaSegment> Playlist::GetSegmentAtTime(unsigned long long timeintic
     else
     {
         //find the first segment for which the given time point is less than the start PTS - the target segment is the one prior to it then
-        match = std::find_if(Segments.begin(), Segments.end(), [timeinticks, this](Playlist::SEGMENTVECTOR::value_type segdata)
+        match = std::find_if(snapshot->begin(), snapshot->end(), [timeinticks, this](const Playlist::SEGMENTVECTOR::value_type& segdata)
         {
             return segdata->IncludesTimePoint(timeinticks, MFRATE_FORWARD);//always search forward
         });
     }
 
-    if (match != Segments.end())
+    if (match != snapshot->end())
     {
         ret = *(match);
     }
@@ -2576,23 +2748,26 @@ unsigned long long Playlist::GetCurrentLABLength(unsigned int CurSegSeqNum, bool
 
     unsigned long long ret = 0;
 
-    std::unique_lock<std::recursive_mutex> listlock(LockSegmentList, std::defer_lock);
-    if (IsLive) listlock.lock();
-
-    auto seg = GetSegment(CurSegSeqNum);
-
+    //walk the published snapshot once, instead of looking up every next segment (and locking the list for the whole walk)
+    auto snapshot = GetSegmentSnapshot();
+    auto direction = cpMediaSource->GetCurrentDirection();
 
+    auto itr = std::find_if(snapshot->begin(), snapshot->end(), [CurSegSeqNum](const shared_ptr<MediaSegment>& seg)
+    {
+        return seg->SequenceNumber == CurSegSeqNum;
+    });
 
-    while (seg != nullptr)
+    while (itr != snapshot->end())
     {
+        auto seg = *itr;
         //LOG("GetCurrentLABLength:Evaluating Seg " << seg->GetSequenceNumber() << ", State = " << seg->GetCurrentState());
         //for segments that have data
-
-        if ((!IncludeDownloading && seg->GetCurrentState() == MediaSegmentState::INMEMORYCACHE) ||
-            (IncludeDownloading && (seg->GetCurrentState() == MediaSegmentState::INMEMORYCACHE || seg->GetCurrentState() == MediaSegmentState::DOWNLOADING)))
+        auto state = seg->GetCurrentState();
+        if ((!IncludeDownloading && state == MediaSegmentState::INMEMORYCACHE) ||
+            (IncludeDownloading && (state == MediaSegmentState::INMEMORYCACHE || state == MediaSegmentState::DOWNLOADING)))
         {
             //add up segment duration
-            ret += seg->GetSegmentLookahead(cpMediaSource->GetCurrentDirection());
+            ret += seg->GetSegmentLookahead(direction);
             if (StopIfBeyond > 0 && ret >= StopIfBeyond)
                 break;
         }
@@ -2600,8 +2775,12 @@ unsigned long long Playlist::GetCurrentLABLength(unsigned int CurSegSeqNum, bool
         else
             break;
 
-        seg = GetNextSegment(seg->SequenceNumber, cpMediaSource->GetCurrentDirection());
-
+        if (direction == MFRATE_FORWARD)
+            ++itr;
+        else if (itr == snapshot->begin())
+            break;
+        else
+            --itr;
     }
 
     //LOG("Evaluated LAB = " << ret << " , Min LAB " << Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate));
@@ -2628,14 +2807,14 @@ void  Playlist::CheckAndSetUpStreamTickCountersOnBRSwitch(Playlist* pPlaylist,
             if (prevsrcseg->UnreadQueues[vidpid].empty() == false)
                 pPlaylist->cpMediaSource->cpVideoStream->StreamTickBase =
                 make_shared<Timestamp>(prevsrcseg->Discontinous &&
-                    prevsrcseg->UnreadQueues[vidpid].back()->DiscontinousTS != nullptr ?
-                    prevsrcseg->UnreadQueues[vidpid].back()->DiscontinousTS->ValueInTicks :
+                    prevsrcseg->UnreadQueues[vidpid].back()->HasDiscontinousTS() ?
+                    prevsrcseg->UnreadQueues[vidpid].back()->GetDiscontinousTSValue() :
                     prevsrcseg->UnreadQueues[vidpid].back()->SamplePTS->ValueInTicks);
             else
                 pPlaylist->cpMediaSource->cpVideoStream->StreamTickBase =
                 make_shared<Timestamp>(prevsrcseg->Discontinous &&
-                    prevsrcseg->ReadQueues[vidpid].back()->DiscontinousTS != nullptr ?
-                    prevsrcseg->ReadQueues[vidpid].back()->DiscontinousTS->ValueInTicks :
+                    prevsrcseg->ReadQueues[vidpid].back()->HasDiscontinousTS() ?
+                    prevsrcseg->ReadQueues[vidpid].back()->GetDiscontinousTSValue() :
                     prevsrcseg->ReadQueues[vidpid].back()->SamplePTS->ValueInTicks);
         }
     }
@@ -2647,14 +2826,14 @@ void  Playlist::CheckAndSetUpStreamTickCountersOnBRSwitch(Playlist* pPlaylist,
             if (prevsrcseg->UnreadQueues[audpid].empty() == false)
                 pPlaylist->cpMediaSource->cpAudioStream->StreamTickBase =
                 make_shared<Timestamp>(prevsrcseg->Discontinous &&
-                    prevsrcseg->UnreadQueues[audpid].back()->DiscontinousTS != nullptr ?
-                    prevsrcseg->UnreadQueues[audpid].back()->DiscontinousTS->ValueInTicks :
+                    prevsrcseg->UnreadQueues[audpid].back()->HasDiscontinousTS() ?
+                    prevsrcseg->UnreadQueues[audpid].back()->GetDiscontinousTSValue() :
                     prevsrcseg->UnreadQueues[audpid].back()->SamplePTS->ValueInTicks);
             else
                 pPlaylist->cpMediaSource->cpAudioStream->StreamTickBase =
                 make_shared<Timestamp>(prevsrcseg->Discontinous &&
-                    prevsrcseg->ReadQueues[audpid].back()->DiscontinousTS != nullptr ?
-                    prevsrcseg->ReadQueues[audpid].back()->DiscontinousTS->ValueInTicks :
+                    prevsrcseg->ReadQueues[audpid].back()->HasDiscontinousTS() ?
+                    prevsrcseg->ReadQueues[audpid].back()->GetDiscontinousTSValue() :
                     prevsrcseg->ReadQueues[audpid].back()->SamplePTS->ValueInTicks);
         }
     }
@@ -2762,7 +2941,7 @@ bool Playlist::CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, uns
 
     if (type == VIDEO)
     {
-        if (videoswitch == nullptr || pPlaylist->cpMediaSource->GetCurrentPlaybackRate()->Rate != 1.0)
+        if (videoswitch == nullptr || !pPlaylist->cpMediaSource->IsNormalPlaybackRate())
             return vbrswitch;
 
         shared_ptr<MediaSegment> targetseg = nullptr;
@@ -3019,7 +3198,7 @@ bool Playlist::CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, uns
     {
         //get the target playlist
 
-        if (audioswitch != nullptr &&  pPlaylist->cpMediaSource->GetCurrentPlaybackRate()->Rate == 1.0 &&
+        if (audioswitch != nullptr &&  pPlaylist->cpMediaSource->IsNormalPlaybackRate() &&
             pPlaylist->pParentRendition == nullptr)
         {
             shared_ptr<MediaSegment> targetseg = nullptr;
@@ -3086,6 +3265,8 @@ bool Playlist::CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, uns
 
                                 targetseg->UnreadQueues[targetaudPID].push_front(*itr);
                             }
+                            //the moved samples follow the target segment's timeline from here on
+                            targetseg->ShareDiscontinuityOffset(targetaudPID);
                             samplestransferred = true;
                             LOG("Bitrate Switch: Transferred unread audio samples");
                         }
@@ -3293,6 +3474,7 @@ bool Playlist::CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, uns
         }
         pPlaylist->StopVideoStreamTick();
         pPlaylist->CancelDownloads();
+        pPlaylist->ResumeAfterSwitch();
         target->PauseBufferBuilding = false;
         //make target variant active
         target->pParentStream->MakeActive(true);
@@ -3330,12 +3512,17 @@ bool Playlist::CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, uns
             cpMediaSource->spHeuristicsManager->SetIgnoreDownshiftTolerance(false);
 
         if (pPlaylist->cpMediaSource->spHeuristicsManager != nullptr)
+        {
             pPlaylist->cpMediaSource->spHeuristicsManager->SetLastSuggestedBandwidth(pPlaylist->pParentStream->Bandwidth);//just to be safe - we have seen sometimes that with overlapping bitrate switch requests this does not get set properly
+            pPlaylist->cpMediaSource->spHeuristicsManager->SetSegmentDuration(pPlaylist->DerivedTargetDuration);
+        }
         if (vbrswitch && pPlaylist->cpMediaSource->cpVideoStream->GetPendingBitrateSwitch() == nullptr && cpMediaSource->GetCurrentState() != MSS_ERROR && cpMediaSource->GetCurrentState() != MSS_UNINITIALIZED)
             cpMediaSource->cpVideoStream->RaiseBitrateSwitched(oldbandwidth, pPlaylist->pParentStream->Bandwidth);
         if (abrswitch && pPlaylist->cpMediaSource->cpAudioStream->GetPendingBitrateSwitch() == nullptr && cpMediaSource->GetCurrentState() != MSS_ERROR && cpMediaSource->GetCurrentState() != MSS_UNINITIALIZED)
             cpMediaSource->cpAudioStream->RaiseBitrateSwitched(oldbandwidth, pPlaylist->pParentStream->Bandwidth);
 
+        //the neighbours have changed - get them ready for the next switch
+        cpMediaSource->WarmAdjacentVariants();
     }
 
     return type == VIDEO ? vbrswitch : abrswitch;
@@ -3348,7 +3535,7 @@ bool Playlist::CheckAndSwitchAudioRendition(Playlist *&pPlaylist, bool Following
     std::lock_guard<std::recursive_mutex> lockAudio(pPlaylist->cpMediaSource->cpAudioStream->LockSwitch);
     auto audioswitch = pPlaylist->cpMediaSource->cpAudioStream->GetPendingRenditionSwitch();
 
-    if (audioswitch == nullptr || pPlaylist->cpMediaSource->GetCurrentPlaybackRate()->Rate != 1.0)
+    if (audioswitch == nullptr || !pPlaylist->cpMediaSource->IsNormalPlaybackRate())
         return false;
 
     LOG("Attempting Rendition Switch...");
@@ -3421,11 +3608,10 @@ bool Playlist::IsEOS()
 bool Playlist::IsEOS(ContentType mediaType)
 {
     bool ret = true;
-    std::unique_lock<std::recursive_mutex> listlock(LockSegmentList, std::defer_lock);
-    if (IsLive) listlock.lock();
+    auto snapshot = GetSegmentSnapshot();
 
     auto curseg = GetCurrentSegmentTracker(mediaType);
-    auto lastseg = (cpMediaSource->GetCurrentDirection() == MFRATE_FORWARD ? Segments.back() : Segments.front());
+    auto lastseg = (cpMediaSource->GetCurrentDirection() == MFRATE_FORWARD ? snapshot->back() : snapshot->front());
     if (curseg->HasMediaType(mediaType) == false)//we do not have this media type;
         ret = true;
     //if we are not at the last segment OR if we are at the last segment, but that segment still has data - we return false,or if the playlist is still marked live (it won't be for the last refresh of a live stream since the last refresh should contain an EXT-X-ENDLIST)
@@ -3503,52 +3689,7 @@ void Playlist::ApplyStreamTick(ContentType type, shared_ptr<MediaSegment> curSeg
     if (stream == nullptr)
         return;
 
-    bool HasType = curSegment->HasMediaType(type);
-    auto pid = HasType ? curSegment->GetPIDForMediaType(type) : 0;
-    auto cumDur = (type == VIDEO ? cpMediaSource->spRootPlaylist->LiveVideoPlaybackCumulativeDuration :
-        cpMediaSource->spRootPlaylist->LiveAudioPlaybackCumulativeDuration);
-
-    if (stream->StreamTickBase == nullptr)
-    {
-        if (HasType && curSegment->ReadQueues.find(pid) != curSegment->ReadQueues.end() &&
-            curSegment->ReadQueues[pid].size() > 0)
-        {
-            stream->StreamTickBase =
-                make_shared<Timestamp>(curSegment->Discontinous &&
-                    curSegment->ReadQueues[pid].back()->DiscontinousTS != nullptr ?
-                    curSegment->ReadQueues[pid].back()->DiscontinousTS->ValueInTicks
-                    : curSegment->ReadQueues[pid].back()->SamplePTS->ValueInTicks);
-        }
-        else if (oldSrcSeg != nullptr && oldSrcSeg->GetCurrentState() == INMEMORYCACHE)
-        {
-            if (oldSrcSeg->HasMediaType(type))
-            {
-                auto pid = oldSrcSeg->GetPIDForMediaType(type);
-                if (oldSrcSeg->ReadQueues.find(pid) != oldSrcSeg->ReadQueues.end() &&
-                    oldSrcSeg->ReadQueues[pid].size() > 0)
-                {
-                    stream->StreamTickBase =
-                        make_shared<Timestamp>(oldSrcSeg->Discontinous &&
-                            oldSrcSeg->ReadQueues[pid].back()->DiscontinousTS != nullptr ?
-                            oldSrcSeg->ReadQueues[pid].back()->DiscontinousTS->ValueInTicks
-                            : oldSrcSeg->ReadQueues[pid].back()->SamplePTS->ValueInTicks);
-                }
-            }
-        }
-        else
-        {
-            if (IsLive)
-            {
-                stream->StreamTickBase =
-                    make_shared<Timestamp>(StartPTSOriginal->ValueInTicks + cumDur);
-            }
-            else
-            {
-                stream->StreamTickBase =
-                    make_shared<Timestamp>(oldSrcSeg != nullptr ? oldSrcSeg->CumulativeDuration : StartPTSOriginal->ValueInTicks);
-            }
-        }
-    }
+    SetupStreamTick(type, curSegment, oldSrcSeg);
 
     if (stream->StreamTickBase != nullptr)
     {
@@ -3578,57 +3719,48 @@ void Playlist::SetupStreamTick(ContentType type, shared_ptr<MediaSegment> curSeg
 {
     auto stream = (type == VIDEO ? dynamic_cast<CMFStreamCommonImpl*>(cpMediaSource->cpVideoStream.Get()) : dynamic_cast<CMFStreamCommonImpl*>(cpMediaSource->cpAudioStream.Get()));
 
-    if (stream == nullptr)
+    //the base is only set up once per gap - after that the tick just advances
+    if (stream == nullptr || stream->StreamTickBase != nullptr)
         return;
 
-    bool HasType = curSegment->HasMediaType(type);
-    auto pid = HasType ? curSegment->GetPIDForMediaType(type) : 0;
-    auto cumDur = (type == VIDEO ? cpMediaSource->spRootPlaylist->LiveVideoPlaybackCumulativeDuration :
-        cpMediaSource->spRootPlaylist->LiveAudioPlaybackCumulativeDuration);
+    unsigned long long coveragestart = 0, coverageend = 0;
 
-    if (stream->StreamTickBase == nullptr)
+    if (curSegment->HasMediaType(type))
     {
-        if (HasType && curSegment->ReadQueues.find(pid) != curSegment->ReadQueues.end() &&
+        //the segment has samples of this type - tick from the last one handed out
+        CountedLockGuard<std::recursive_mutex> lock(curSegment->LockSegment, curSegment->LockSegmentContention, curSegment->GetLockSegmentContentionTotal());
+        auto pid = curSegment->GetPIDForMediaType(type);
+        if (curSegment->ReadQueues.find(pid) != curSegment->ReadQueues.end() &&
             curSegment->ReadQueues[pid].size() > 0)
         {
+            auto lastread = curSegment->ReadQueues[pid].back();
             stream->StreamTickBase =
-                make_shared<Timestamp>(curSegment->Discontinous &&
-                    curSegment->ReadQueues[pid].back()->DiscontinousTS != nullptr ?
-                    curSegment->ReadQueues[pid].back()->DiscontinousTS->ValueInTicks
-                    : curSegment->ReadQueues[pid].back()->SamplePTS->ValueInTicks);
+                make_shared<Timestamp>(curSegment->Discontinous && lastread->HasDiscontinousTS() ?
+                    lastread->GetDiscontinousTSValue() : lastread->SamplePTS->ValueInTicks);
+            return;
         }
-        else if (oldSrcSeg != nullptr && oldSrcSeg->GetCurrentState() == INMEMORYCACHE)
+    }
+
+    //a gap in this media type - carry on from where the samples of the previous segment ended (recorded when that segment was parsed)
+    if (oldSrcSeg != nullptr && oldSrcSeg->GetMediaTypeCoverage(type, coveragestart, coverageend))
+    {
+        stream->StreamTickBase = make_shared<Timestamp>(coverageend);
+    }
+    else
+    {
+        if (IsLive)
         {
-            if (oldSrcSeg->HasMediaType(type))
-            {
-                auto pid = oldSrcSeg->GetPIDForMediaType(type);
-                if (oldSrcSeg->ReadQueues.find(pid) != oldSrcSeg->ReadQueues.end() &&
-                    oldSrcSeg->ReadQueues[pid].size() > 0)
-                {
-                    stream->StreamTickBase =
-                        make_shared<Timestamp>(oldSrcSeg->Discontinous &&
-                            oldSrcSeg->ReadQueues[pid].back()->DiscontinousTS != nullptr ?
-                            oldSrcSeg->ReadQueues[pid].back()->DiscontinousTS->ValueInTicks
-                            : oldSrcSeg->ReadQueues[pid].back()->SamplePTS->ValueInTicks);
-                }
-            }
+            auto cumDur = (type == VIDEO ? cpMediaSource->spRootPlaylist->LiveVideoPlaybackCumulativeDuration :
+                cpMediaSource->spRootPlaylist->LiveAudioPlaybackCumulativeDuration);
+            stream->StreamTickBase =
+                make_shared<Timestamp>(StartPTSOriginal->ValueInTicks + cumDur);
         }
         else
         {
-            if (IsLive)
-            {
-                stream->StreamTickBase =
-                    make_shared<Timestamp>(StartPTSOriginal->ValueInTicks + cumDur);
-            }
-            else
-            {
-                stream->StreamTickBase =
-                    make_shared<Timestamp>(oldSrcSeg != nullptr ? oldSrcSeg->CumulativeDuration : StartPTSOriginal->ValueInTicks);
-            }
+            stream->StreamTickBase =
+                make_shared<Timestamp>(oldSrcSeg != nullptr ? oldSrcSeg->CumulativeDuration : StartPTSOriginal->ValueInTicks);
         }
     }
-
-
 }
 
 void Playlist::WaitPlaylistRefreshPlaybackResume()
@@ -4028,9 +4160,11 @@ HRESULT Playlist::RequestVideoSample(Playlist *pPlaylist, IMFSample** ppSample)
 
     if (!brswitch && segswitch)
     {
-        std::lock_guard<std::recursive_mutex> lockvid(pPlaylist->cpMediaSource->cpVideoStream->LockSwitch);
+        CountedLockGuard<std::recursive_mutex> lockvid(pPlaylist->cpMediaSource->cpVideoStream->LockSwitch, pPlaylist->cpMediaSource->cpVideoStream->LockSwitchContention,
+            pPlaylist->cpMediaSource->cpVideoStream->GetLockSwitchContentionTotal());
         auto videoswitch = pPlaylist->cpMediaSource->cpVideoStream->GetPendingBitrateSwitch();
-        std::lock_guard<std::recursive_mutex> lockaud(pPlaylist->cpMediaSource->cpAudioStream->LockSwitch);
+        CountedLockGuard<std::recursive_mutex> lockaud(pPlaylist->cpMediaSource->cpAudioStream->LockSwitch, pPlaylist->cpMediaSource->cpAudioStream->LockSwitchContention,
+            pPlaylist->cpMediaSource->cpAudioStream->GetLockSwitchContentionTotal());
         auto audioswitch = pPlaylist->cpMediaSource->cpAudioStream->GetPendingBitrateSwitch();
 
         //we are switching on segment boundaries only and our current segment has moved beyond the originally targeted segment   
@@ -4043,9 +4177,10 @@ HRESULT Playlist::RequestVideoSample(Playlist *pPlaylist, IMFSample** ppSample)
                 auto oldtargetseg = videoswitch->targetPlaylist->GetCurrentSegmentTracker(VIDEO);
                 //if we are shifting up
                 //or shifting down and the segmnt has moved beyond the originally targeted segment (with a down shift the target segment can be at a distance from the current segment since we try to playout any buffer first)
+                //when switching on segment boundaries the target stays put in either direction till playback gets there - it may be downloading already
                 if (
-                    (videoswitch->targetPlaylist->pParentStream->Bandwidth > pPlaylist->pParentStream->Bandwidth) ||
-                    (videoswitch->targetPlaylist->pParentStream->Bandwidth < pPlaylist->pParentStream->Bandwidth &&
+                    (videoswitch->targetPlaylist->pParentStream->Bandwidth > pPlaylist->pParentStream->Bandwidth && !Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary) ||
+                    ((videoswitch->targetPlaylist->pParentStream->Bandwidth < pPlaylist->pParentStream->Bandwidth || Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary) &&
                         curSegment->SequenceNumber >= videoswitch->targetPlaylist->GetCurrentSegmentTracker(VIDEO)->SequenceNumber)
                     )
                 {
@@ -4626,7 +4761,8 @@ HRESULT Playlist::RequestAudioSample(Playlist *pPlaylist, IMFSample** ppSample)
         !curSegment->HasMediaType(VIDEO) &&
         curSegment->SequenceNumber >= pPlaylist->MaxBufferedSegment()->SequenceNumber)//the current targeted segment will no longer be useful to us
     {
-        std::lock_guard<std::recursive_mutex> lockswitch(pPlaylist->cpMediaSource->cpAudioStream->LockSwitch);
+        CountedLockGuard<std::recursive_mutex> lockswitch(pPlaylist->cpMediaSource->cpAudioStream->LockSwitch, pPlaylist->cpMediaSource->cpAudioStream->LockSwitchContention,
+            pPlaylist->cpMediaSource->cpAudioStream->GetLockSwitchContentionTotal());
         auto audioswitch = pPlaylist->cpMediaSource->cpAudioStream->GetPendingBitrateSwitch();
         if (audioswitch != nullptr && audioswitch->targetPlaylist != nullptr)
         {
@@ -4636,9 +4772,10 @@ HRESULT Playlist::RequestAudioSample(Playlist *pPlaylist, IMFSample** ppSample)
                 auto oldtargetseg = audioswitch->targetPlaylist->GetCurrentSegmentTracker(AUDIO);
                 //if we are shifting up
                 //or shifting down and the segmnt has moved beyond the originally targeted segment (with a down shift the target segment can be at a distance from the current segment since we try to playout any buffer first)
+                //when switching on segment boundaries the target stays put in either direction till playback gets there - it may be downloading already
                 if (
-                    (audioswitch->targetPlaylist->pParentStream->Bandwidth > pPlaylist->pParentStream->Bandwidth) ||
-                    (audioswitch->targetPlaylist->pParentStream->Bandwidth < pPlaylist->pParentStream->Bandwidth &&
+                    (audioswitch->targetPlaylist->pParentStream->Bandwidth > pPlaylist->pParentStream->Bandwidth && !Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary) ||
+                    ((audioswitch->targetPlaylist->pParentStream->Bandwidth < pPlaylist->pParentStream->Bandwidth || Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary) &&
                         curSegment->SequenceNumber >= audioswitch->targetPlaylist->GetCurrentSegmentTracker(AUDIO)->SequenceNumber)
                     )
                 {
@@ -4856,7 +4993,7 @@ task<tuple<HRESULT, unsigned int>> Playlist::CheckAndBufferIfNeeded(unsigned int
         unsigned long long time = GetCurrentLABLength(CurSegSeqNum, false, Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate));
 
         if (PauseBufferBuilding && time < DerivedTargetDuration * 2)
-            PauseBufferBuilding = false;
+            ResumeBufferBuilding();
 
         LOG("Buffer Left = " << time << ", Required LAB = " << Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate));
 
@@ -4873,9 +5010,10 @@ task<tuple<HRESULT, unsigned int>> Playlist::CheckAndBufferIfNeeded(unsigned int
             }
         }
 
-        //if LAB less than what config stipulates on the main playlist
+        //if LAB less than what config stipulates on the main playlist - and we either have no LAB left or have room in the memory budget
 
-        if (time < Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate) && !PauseBufferBuilding)
+        if (time < Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate) && !PauseBufferBuilding &&
+            (time <= 0 || !cpMediaSource->spMemoryBudget->IsExhausted()))
         {
             //start a chained download at given segment, with ForceWait or the current media source 
             //buffering state determining whether StartStreamingAsync should wait for an actual segment download before returning
@@ -4927,7 +5065,7 @@ HRESULT Playlist::CheckAndBufferForBRSwitch(unsigned int CurSegSeqNum)
                 Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate));
 
             if (PauseBufferBuilding && time < DerivedTargetDuration * 2)
-                PauseBufferBuilding = false;
+                ResumeBufferBuilding();
 
             LOG("Buffer Left = " << time << ", Required LAB = " << Configuration::GetCurrent()->GetRateAdjustedLABThreshold(cpMediaSource->curPlaybackRate->Rate));
             {
@@ -5164,14 +5302,13 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
         }
 
         {
-            std::unique_lock<std::recursive_mutex> listlock(pPlaylist->LockSegmentList, std::defer_lock);
-            if (pPlaylist->IsLive) listlock.lock();
+            auto snapshot = pPlaylist->GetSegmentSnapshot();
 
-            auto itrtargetSeg = std::find_if(pPlaylist->Segments.begin(), pPlaylist->Segments.end(), [SequenceNumber, Chained](shared_ptr<MediaSegment> seg)
+            auto itrtargetSeg = std::find_if(snapshot->begin(), snapshot->end(), [SequenceNumber, Chained](const shared_ptr<MediaSegment>& seg)
             {
                 return Chained ? seg->SequenceNumber >= SequenceNumber : seg->SequenceNumber == SequenceNumber; //in case of Live the sequence numbering might change in between two downloads - so if chained check for next greatest sequence number and start there
             });
-            if (itrtargetSeg == pPlaylist->Segments.end())
+            if (itrtargetSeg == snapshot->end())
             {
                 Notifier.set(tuple<HRESULT, unsigned int>(E_INVALIDARG, SequenceNumber));
                 return task<tuple<HRESULT, unsigned int>>(Notifier);
@@ -5421,6 +5558,15 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
             }
 
         }
+        //fMP4 segments cannot be parsed without their initialization section - reuse the last one we loaded if it is the same, or download it
+        if (targetSeg->spInitSegment != nullptr && !targetSeg->spInitSegment->IsLoaded)
+        {
+            if (targetSeg->spInitSegment->IsEqual(pPlaylist->cpMediaSource->spRootPlaylist->LastCachedInitSegment) && pPlaylist->cpMediaSource->spRootPlaylist->LastCachedInitSegment->IsLoaded)
+                targetSeg->spInitSegment = pPlaylist->cpMediaSource->spRootPlaylist->LastCachedInitSegment;
+            else if (SUCCEEDED(targetSeg->spInitSegment->Load()))
+                pPlaylist->cpMediaSource->spRootPlaylist->LastCachedInitSegment = targetSeg->spInitSegment;
+            //on failure the segment download fails when it tries to parse the segment
+        }
         //start download
         if (Chained) targetSeg->AssociateChain();
     }
@@ -5462,7 +5608,7 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
             if (FAILED(hr))
             {
                 targetSeg->SetCurrentState(UNAVAILABLE);
-                //LOG("Failed Download : Segment(seq=" << SequenceNumber << ",loc=" << targetSeg->MediaUri << ",speed=" << (targetSeg->pParentPlaylist->pParentStream != nullptr ? targetSeg->pParentPlaylist->pParentStream->Bandwidth : 0) << ")");
+                //LOG("Failed Download : Segment(seq=" << SequenceNumber << ",loc=" << targetSeg->GetMediaUri() << ",speed=" << (targetSeg->pParentPlaylist->pParentStream != nullptr ? targetSeg->pParentPlaylist->pParentStream->Bandwidth : 0) << ")");
                 Notifier.set(tuple<HRESULT, unsigned int>(hr, SequenceNumber));
                 return task<tuple<HRESULT, unsigned int>>(Notifier);
             }
@@ -5495,7 +5641,7 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
                         {
                             if (FAILED(hr = altseg->DownloadSegmentDataAsync().get()))
                             {
-                                //LOG("Failed Download : Alternate Rendition Segment(seq=" << altseg->SequenceNumber << ",loc=" << altseg->MediaUri);
+                                //LOG("Failed Download : Alternate Rendition Segment(seq=" << altseg->SequenceNumber << ",loc=" << altseg->GetMediaUri());
                                 targetSeg->tceSegmentProcessingCompleted.set(tuple<HRESULT, unsigned int>(hr, SequenceNumber));
                                 return task<tuple<HRESULT, unsigned int>>(Notifier);
                             }
@@ -5516,12 +5662,12 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
 
                     auto MaxVal = pPlaylist->cpMediaSource->GetCurrentDirection() == MFRATE_DIRECTION::MFRATE_FORWARD ? pPlaylist->MaxCurrentSegment()->SequenceNumber : pPlaylist->MinCurrentSegment()->SequenceNumber;
                     //get the LAB state after this download
-                    /*LOGIF(targetSeg->pParentPlaylist->pParentStream != nullptr, "StartStreamingAsync()::Checking for LAB on download(seq=" << MaxVal << ",loc=" << targetSeg->MediaUri << ",speed=" << targetSeg->pParentPlaylist->pParentStream->Bandwidth << ")");
-                    LOGIF(targetSeg->pParentPlaylist->pParentStream == nullptr, "StartStreamingAsync()::Checking for LAB on download(seq=" << MaxVal << ",loc=" << targetSeg->MediaUri << ")");*/
+                    /*LOGIF(targetSeg->pParentPlaylist->pParentStream != nullptr, "StartStreamingAsync()::Checking for LAB on download(seq=" << MaxVal << ",loc=" << targetSeg->GetMediaUri() << ",speed=" << targetSeg->pParentPlaylist->pParentStream->Bandwidth << ")");
+                    LOGIF(targetSeg->pParentPlaylist->pParentStream == nullptr, "StartStreamingAsync()::Checking for LAB on download(seq=" << MaxVal << ",loc=" << targetSeg->GetMediaUri() << ")");*/
                     unsigned long long LABLength = pPlaylist->GetCurrentLABLength(MaxVal, true);
 
                     if (pPlaylist->PauseBufferBuilding && LABLength < pPlaylist->DerivedTargetDuration * 2)
-                        pPlaylist->PauseBufferBuilding = false;
+                        pPlaylist->ResumeBufferBuilding();
 
                     if ((LABLength > 0 || (SequenceNumber == LastSegSeq)) && pPlaylist->cpMediaSource->IsBuffering())
                     {
@@ -5529,8 +5675,10 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
                         pPlaylist->cpMediaSource->EndBuffering();
                     }
                     //if LAB is above threshold or this was the last segment or we are at EOS or we are not chained
+                    //or we have some LAB and are out of memory budget
                     if (LABLength >= Configuration::GetCurrent()->GetRateAdjustedLABThreshold(pPlaylist->cpMediaSource->GetCurrentPlaybackRate() != nullptr ? pPlaylist->cpMediaSource->GetCurrentPlaybackRate()->Rate : 1)
-                        || SequenceNumber == LastSegSeq || Chained == false)
+                        || SequenceNumber == LastSegSeq || Chained == false
+                        || (LABLength > 0 && pPlaylist->cpMediaSource->spMemoryBudget->IsExhausted()))
                     {
                         //LOGIF(targetSeg->pParentPlaylist->pParentStream != nullptr, "StartStreamingAsync()::Stopping downloading after seq " << SequenceNumber << ",speed=" << targetSeg->pParentPlaylist->pParentStream->Bandwidth << " Chained = " << (Chained ? L"TRUE" : L"FALSE") << ")");
                         //stop downloading
@@ -5635,8 +5783,83 @@ task<tuple<HRESULT, unsigned int>> Playlist::StartStreamingAsync(
 
 
 
+///<summary>Finds the segment to switch to when switching on segment boundaries</summary>
+///<param name='fromPlaylist'>The playlist we are switching from</param>
+///<returns>The segment in this playlist that starts where the last segment the source has fetched (or is fetching) ends, or nullptr</returns>
+///<remarks>Nothing the source playlist has already downloaded gets thrown away, and the source has nothing left to download past the switch point. 
+///The segments are lined up using EXT-X-PROGRAM-DATE-TIME if both playlists have it, else the presentation timeline for VOD or the sequence number for live.</remarks>
+shared_ptr<MediaSegment> Playlist::GetAlignedBitrateSwitchTarget(Playlist *fromPlaylist)
+{
+    auto fromsnapshot = fromPlaylist->GetSegmentSnapshot();
+    auto snapshot = GetSegmentSnapshot();
+    auto cur = fromPlaylist->MaxCurrentSegment();
+    if (cur == nullptr || snapshot->empty())
+        return nullptr;
+
+    auto itr = std::find_if(fromsnapshot->begin(), fromsnapshot->end(), [cur](const shared_ptr<MediaSegment>& seg)
+    {
+        return seg->SequenceNumber == cur->SequenceNumber;
+    });
+    if (itr == fromsnapshot->end())
+        return nullptr;
+
+    //the last segment at or after the current one that is in memory or on its way
+    auto lastfetched = *itr;
+    for (++itr; itr != fromsnapshot->end(); ++itr)
+    {
+        auto state = (*itr)->GetCurrentState();
+        if (state != INMEMORYCACHE && state != DOWNLOADING)
+            break;
+        lastfetched = *itr;
+    }
+
+    shared_ptr<MediaSegment> targetSeg = nullptr;
+    long long boundary = 0;
+    long long mindiff = (long long)(DerivedTargetDuration / 2) + 1; //anything further off than half a segment is not a match
+
+    if (lastfetched->ProgramDateTime != nullptr && snapshot->front()->ProgramDateTime != nullptr)
+    {
+        //wall clock - the target starts at the date and time the last fetched source segment ends
+        boundary = (long long)(lastfetched->ProgramDateTime->ValueInTicks + lastfetched->Duration);
+        for (auto seg : *snapshot)
+        {
+            if (seg->ProgramDateTime == nullptr)
+                continue;
+            auto diff = abs((long long)seg->ProgramDateTime->ValueInTicks - boundary);
+            if (diff < mindiff)
+            {
+                mindiff = diff;
+                targetSeg = seg;
+            }
+        }
+    }
+    else if (!IsLive && !fromPlaylist->IsLive)
+    {
+        //presentation timeline - the target starts where the last fetched source segment ends
+        boundary = (long long)lastfetched->CumulativeDuration;
+        for (auto seg : *snapshot)
+        {
+            auto diff = abs((long long)(seg->CumulativeDuration - seg->Duration) - boundary);
+            if (diff < mindiff)
+            {
+                mindiff = diff;
+                targetSeg = seg;
+            }
+        }
+    }
+
+    if (targetSeg == nullptr) //no timing match - fall back to sequence numbers, which variants keep aligned
+        targetSeg = GetNextSegment(lastfetched->SequenceNumber, MFRATE_FORWARD);
+
+    LOGIF(targetSeg != nullptr, "GetAlignedBitrateSwitchTarget: source fetched up to " << lastfetched->SequenceNumber << ", switching at " << targetSeg->SequenceNumber);
+    return targetSeg;
+}
+
 shared_ptr<MediaSegment> Playlist::GetBitrateSwitchTarget(Playlist *fromPlaylist, bool IgnoreBuffer)
 {
+    if (Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary && cpMediaSource->GetCurrentDirection() == MFRATE_FORWARD)
+        return GetAlignedBitrateSwitchTarget(fromPlaylist);
+
     shared_ptr<MediaSegment> FromMaxCurrentSeg = nullptr;
 
     unsigned int FromBaseSequenceNum = 0;
@@ -5658,14 +5881,14 @@ shared_ptr<MediaSegment> Playlist::GetBitrateSwitchTarget(Playlist *fromPlaylist
     if (Configuration::GetCurrent()->MatchSegmentsUsing == Microsoft::HLSClient::SegmentMatchCriterion::PROGRAMDATETIME
         && FromMaxCurrentSeg->ProgramDateTime != nullptr)
     {
-        std::lock_guard<std::recursive_mutex> slock(LockSegmentList);
+        auto snapshot = GetSegmentSnapshot();
 
-        auto match = std::find_if(Segments.begin(), Segments.end(), [this, FromMaxCurrentSeg](shared_ptr<MediaSegment> ms)
+        auto match = std::find_if(snapshot->begin(), snapshot->end(), [this, FromMaxCurrentSeg](const shared_ptr<MediaSegment>& ms)
         {
             return ms->ProgramDateTime->ValueInTicks > FromMaxCurrentSeg->ProgramDateTime->ValueInTicks;
         });
 
-        if (match != Segments.end() &&
+        if (match != snapshot->end() &&
             abs((long long)((*match)->ProgramDateTime->ValueInTicks - FromMaxCurrentSeg->ProgramDateTime->ValueInTicks)) < (long long)(DerivedTargetDuration * 2)) // too far apart
             targetSeg = *match;
 
@@ -5704,6 +5927,9 @@ shared_ptr<MediaSegment> Playlist::GetBitrateSwitchTarget(Playlist *fromPlaylist
 
 shared_ptr<MediaSegment> Playlist::GetBitrateSwitchTarget(Playlist *fromPlaylist, MediaSegment *fromSegment, bool IgnoreBuffer)
 {
+    if (Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary && cpMediaSource->GetCurrentDirection() == MFRATE_FORWARD)
+        return GetAlignedBitrateSwitchTarget(fromPlaylist);
+
     unsigned int FromBaseSequenceNum = 0;
     unsigned int FromLastSegSequenceNum = 0;
 
@@ -5839,9 +6065,44 @@ bool Playlist::PrepareBitrateTransfer(Playlist *pTarget, bool IgnoreBuffer)
         if (targetSeg->GetCurrentState() == INMEMORYCACHE)
             targetSeg->SetPTSBoundaries();
 
+        shared_ptr<MediaSegment> inflight = nullptr;
+        if (Configuration::GetCurrent()->SwitchBitrateOnSegmentBoundary)
+        {
+            //the source has fetched everything up to the switch point - stop it from building any more buffer till the switch completes or is cancelled
+            PauseBufferBuilding = true;
+            PausedForSwitch = true;
+            pTarget->ResumeAfterSwitch();
+            auto snapshot = GetSegmentSnapshot();
+            auto found = std::find_if(snapshot->begin(), snapshot->end(), [](const shared_ptr<MediaSegment>& seg) { return seg->GetCurrentState() == DOWNLOADING; });
+            if (found != snapshot->end())
+                inflight = *found;
+        }
 
-
-        Playlist::StartStreamingAsync(pTarget, targetSeg->SequenceNumber, false, false, true);
+        if (inflight != nullptr)
+        {
+            //at most one segment in flight per media type - start on the target once the source download lands
+            LOG("Playlist::PrepareBitrateTransfer() : Deferring download of target sequence " << targetSeg->SequenceNumber << " till source sequence " << inflight->SequenceNumber << " completes");
+            auto ms = cpMediaSource;
+            auto targetseq = targetSeg->SequenceNumber;
+            cpMediaSource->protectionRegistry.Register(task<tuple<HRESULT, unsigned int>>(inflight->tceSegmentProcessingCompleted).then([ms, pTarget, targetseq](tuple<HRESULT, unsigned int>)
+            {
+                if (ms->GetCurrentState() == MSS_ERROR || ms->GetCurrentState() == MSS_UNINITIALIZED)
+                    return S_OK;
+                //the switch may have completed, been cancelled or been replaced by one to a different variant while the source download was in flight
+                auto videoswitch = ms->cpVideoStream != nullptr ? ms->cpVideoStream->GetPendingBitrateSwitch() : nullptr;
+                auto audioswitch = ms->cpAudioStream != nullptr ? ms->cpAudioStream->GetPendingBitrateSwitch() : nullptr;
+                if ((videoswitch == nullptr || videoswitch->targetPlaylist != pTarget) &&
+                    (audioswitch == nullptr || audioswitch->targetPlaylist != pTarget))
+                {
+                    LOG("Playlist::PrepareBitrateTransfer() : Dropping deferred download of target sequence " << targetseq << " - switch no longer pending");
+                    return S_OK;
+                }
+                Playlist::StartStreamingAsync(pTarget, targetseq, false, false, true);
+                return S_OK;
+            }, task_continuation_context::use_arbitrary()));
+        }
+        else
+            Playlist::StartStreamingAsync(pTarget, targetSeg->SequenceNumber, false, false, true);
 
     }
 
@@ -5928,6 +6189,8 @@ bool Playlist::CombinePlaylistBatch(shared_ptr<Playlist> spPlaylist)
                         lastEncKey = rpitr->EncKey;
                     if (rpitr->EncKey != nullptr)
                         rpitr->EncKey->pParentPlaylist = this;
+                    if (rpitr->spInitSegment != nullptr)
+                        rpitr->spInitSegment->pParentPlaylist = this;
 
 
                     if (Segments.size() > 0)
@@ -5940,6 +6203,7 @@ bool Playlist::CombinePlaylistBatch(shared_ptr<Playlist> spPlaylist)
                     rpitr->Discontinous = true;
                     Segments.push_back(rpitr);
                 }
+                PublishSegmentSnapshot();
                 this->TotalDuration += spPlaylist->TotalDuration;
                 if (this->cpMediaSource->spRootPlaylist->IsVariant && this->cpMediaSource->GetCurrentState() == MediaSourceState::MSS_OPENING)
                     this->cpMediaSource->spRootPlaylist->TotalDuration += spPlaylist->TotalDuration;
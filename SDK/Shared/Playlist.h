@@ -38,6 +38,8 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "StreamInfo.h"
 #include "StopWatch.h"  
 #include "TaskRegistry.h"
+#include "ID3MetadataTimeline.h"
+#include "LockContention.h"
 
 
 using namespace Concurrency;
@@ -111,6 +113,7 @@ namespace Microsoft {
         //holds the string data to be parsed (temporarily - cleared on parsing completion)
         std::wstring szData;
         shared_ptr<EncryptionKey> LastCachedKey;
+        shared_ptr<InitializationSegment> LastCachedInitSegment;
         shared_ptr<StopWatch> spswPlaylistRefresh;
         shared_ptr<StopWatch> spswVideoStreamTick;
         shared_ptr<Playlist> spPlaylistRefresh;
@@ -135,13 +138,20 @@ namespace Microsoft {
 
         unsigned int BaseSequenceNumber;
         bool AllowCache;
+        //EXT-X-SERVER-CONTROL : the server can hold a playlist request until a future segment is available
+        bool CanBlockReload;
+        //EXT-X-SERVER-CONTROL : recommended distance from the live edge in ticks (0 if not advertised)
+        unsigned long long ServerHoldBack;
         
         wstring LastModified;
         wstring ETag;
         Microsoft::HLSClient::HLSPlaylistType PlaylistType;
         shared_ptr<Timestamp> SlidingWindowStart, SlidingWindowEnd;
-        //collection of all segments - only valid for a child playlist
+        //collection of all segments - only valid for a child playlist. Live refreshes edit this in place under LockSegmentList and LockMerge - readers
+        //on the playback path use GetSegmentSnapshot() instead
         SEGMENTVECTOR Segments;
+        //last published copy of Segments - the list is never modified once published, only replaced (the segments in it are shared with Segments)
+        shared_ptr<const SEGMENTVECTOR> spSegmentSnapshot;
         //total duration - computed during parsing 
         unsigned long long TotalDuration;
         //variant playlist atributes
@@ -154,11 +164,19 @@ namespace Microsoft {
         std::vector<unsigned int> BitratesInPlaylistOrder;
         //collection of all variants - keyed by bandwidth - valid only for a variant parent
         VARIANTMAP Variants;
+        //timed metadata of every loaded segment - only used on the root playlist
+        ID3MetadataTimeline MetadataTimeline;
         //the currently active bandwidth
         StreamInfo *ActiveVariant;
         //control access to the playlist and the download registry
         recursive_mutex LockClient, LockMerge, LockSegmentList, LockSegmentTracking, LockCookie;
+        ///<summary>Contention on LockSegmentTracking (current segment per media type), which the sample request path takes on every sample. Logged when the playlist goes away.</summary>
+        LockContentionCounter LockSegmentTrackingContention;
+        ///<summary>The media source total LockSegmentTrackingContention adds to - nullptr if the playlist is not attached to a source</summary>
+        LockContentionCounter* GetLockSegmentTrackingContentionTotal();
         bool PauseBufferBuilding;
+        ///<summary>PauseBufferBuilding was set for a segment boundary switch away from this playlist - only the switch completing or being cancelled lifts it</summary>
+        bool PausedForSwitch;
         
         //The maximum and minimum allowed bitrate that a player would allow on this playlist
         unsigned int MaxAllowedBitrate, MinAllowedBitrate;
@@ -175,10 +193,12 @@ namespace Microsoft {
         //task<void> CancelDownloadsAndWaitForCompletion();
         void CancelDownloadsAndWaitForCompletion();
         shared_ptr<Timestamp> FindApproximateLivePosition();
+        unsigned long long FindDistanceFromLivePosition();
         unsigned int FindLiveStartSegmentSequenceNumber();
         unsigned int FindLiveStartSegmentSequenceNumber(unsigned int& offsetFromTail, unsigned long long& liveWindowDuration);
         unsigned int FindAltRenditionMatchingSegment(Playlist* mainPlaylist, unsigned int SequenceNumber, bool& EndsBeforeMain);
         unsigned int FindAltRenditionMatchingSegment(Playlist* mainPlaylist, unsigned int SequenceNumber);
+        shared_ptr<MediaSegment> GetAlignedBitrateSwitchTarget(Playlist *fromPlaylist);
         shared_ptr<MediaSegment> GetBitrateSwitchTarget(Playlist *fromPlaylist, bool IgnoreBuffer);
         shared_ptr<MediaSegment> GetBitrateSwitchTarget(Playlist *fromPlaylist, MediaSegment *fromSegment, bool IgnoreBuffer);
         unsigned long long GetCurrentLABLength(unsigned int CurSegSeqNum, bool IncludeDownloading = false, unsigned long long StopIfBeyond = 0);
@@ -212,7 +232,9 @@ namespace Microsoft {
           const std::wstring& Url,
           std::vector<BYTE> memorycache,
           std::shared_ptr<Playlist>& ppPlaylist,
-          task_completion_event<HRESULT> tcePlaylistDownloaded);
+          task_completion_event<HRESULT> tcePlaylistDownloaded,
+          const std::wstring& lastmod = L"",
+          const std::wstring& etag = L"");
 
         void WaitPlaylistRefreshPlaybackResume();
 
@@ -241,6 +263,18 @@ namespace Microsoft {
         ///<param name='pTarget'>Target playlist to transfer to</param>
         ///<returns>Indicates if a switch s possible</returns>
         bool PrepareBitrateTransfer(Playlist *pTargetPlaylist, bool IgnoreBuffer);
+        ///<summary>Lifts PauseBufferBuilding - unless it was set for a segment boundary switch away from this playlist that is still pending</summary>
+        void ResumeBufferBuilding()
+        {
+          if (!PausedForSwitch)
+            PauseBufferBuilding = false;
+        }
+        ///<summary>Lets the playlist build buffer again once a segment boundary switch away from it has completed or been cancelled</summary>
+        void ResumeAfterSwitch()
+        {
+          PausedForSwitch = false;
+          PauseBufferBuilding = false;
+        }
 
         void RaiseStreamSelectionChanged(TrackType from, TrackType to);
         bool CheckAndSwitchBitrate(Playlist *&pPlaylist, ContentType type, unsigned short PID);
@@ -290,6 +324,7 @@ namespace Microsoft {
         bool MergeAlternateRenditionPlaylist();
         bool CombinePlaylistBatch(shared_ptr<Playlist> spPlaylist);
         void SetStopwatchForNextPlaylistRefresh(unsigned long long refreshIntervalInTicks,bool lock = true);
+        bool UseBlockingReload();
        
         void SetupStreamTick(ContentType type, shared_ptr<MediaSegment> curSegment, shared_ptr<MediaSegment> oldSrcSeg);
         /** Playlist Batch functionality*/
@@ -319,6 +354,8 @@ namespace Microsoft {
           BaseSequenceNumber(0),
           DerivedTargetDuration(0),
           AllowCache(false),
+          CanBlockReload(false),
+          ServerHoldBack(0),
           Version(0),
           TotalDuration(0) ,
           MaxAllowedBitrate(UINT32_MAX),
@@ -329,9 +366,11 @@ namespace Microsoft {
           SlidingWindowEnd(nullptr),
           SlidingWindowStart(nullptr),
           PauseBufferBuilding(false),
+          PausedForSwitch(false),
           LiveVideoPlaybackCumulativeDuration(0),
           LiveAudioPlaybackCumulativeDuration(0),
           LastCachedKey(nullptr),
+          LastCachedInitSegment(nullptr),
           PlaylistType(Microsoft::HLSClient::HLSPlaylistType::UNKNOWN),
           StartLiveFromCurrentPos(false) 
         {
@@ -361,6 +400,8 @@ namespace Microsoft {
           BaseSequenceNumber(0),
           DerivedTargetDuration(0),
           AllowCache(false),
+          CanBlockReload(false),
+          ServerHoldBack(0),
           Version(0),
           TotalDuration(0),
           MaxAllowedBitrate(UINT32_MAX),
@@ -371,9 +412,11 @@ namespace Microsoft {
           SlidingWindowEnd(nullptr),
           SlidingWindowStart(nullptr),
           PauseBufferBuilding(false),
+          PausedForSwitch(false),
           LiveVideoPlaybackCumulativeDuration(0),
           LiveAudioPlaybackCumulativeDuration(0),
           LastCachedKey(nullptr),
+          LastCachedInitSegment(nullptr),
           PlaylistType(Microsoft::HLSClient::HLSPlaylistType::UNKNOWN),
           StartLiveFromCurrentPos(false) 
         {
@@ -404,6 +447,8 @@ namespace Microsoft {
           BaseSequenceNumber(0),
           DerivedTargetDuration(0),
           AllowCache(false),
+          CanBlockReload(false),
+          ServerHoldBack(0),
           Version(0),
           TotalDuration(0),
           MaxAllowedBitrate(UINT32_MAX),
@@ -414,9 +459,11 @@ namespace Microsoft {
           SlidingWindowEnd(nullptr),
           SlidingWindowStart(nullptr),
           PauseBufferBuilding(false),
+          PausedForSwitch(false),
           LiveVideoPlaybackCumulativeDuration(0),
           LiveAudioPlaybackCumulativeDuration(0),
           LastCachedKey(nullptr),
+          LastCachedInitSegment(nullptr),
           PlaylistType(Microsoft::HLSClient::HLSPlaylistType::UNKNOWN),
           StartLiveFromCurrentPos(false) 
         {
@@ -498,40 +545,56 @@ namespace Microsoft {
         ///<param name='mediaType'>Content type for the stream to check</param>
         bool IsEOS(ContentType mediaType);
 
+        ///<summary>Returns the segment list as it was last published</summary>
+        ///<remarks>A published list is never modified - a live refresh merges into Segments and then publishes a new list with an atomic swap. 
+        ///So the snapshot can be walked without LockSegmentList. The segments themselves are shared between snapshots, so their download state 
+        ///and sample queues carry over from one refresh to the next - but a merge also updates CumulativeDuration, Discontinous, pParentPlaylist 
+        ///and EncKey on them in place. Anything that matches on those fields of a live playlist still needs LockMerge.</remarks>
+        shared_ptr<const SEGMENTVECTOR> GetSegmentSnapshot()
+        {
+          auto snapshot = std::atomic_load(&spSegmentSnapshot);
+          return snapshot != nullptr ? snapshot : shared_ptr<const SEGMENTVECTOR>(make_shared<SEGMENTVECTOR>());
+        }
+
+        ///<summary>Publishes the current contents of Segments as the new snapshot - called by whoever changed Segments, while still holding LockSegmentList</summary>
+        void PublishSegmentSnapshot()
+        {
+          std::atomic_store(&spSegmentSnapshot, shared_ptr<const SEGMENTVECTOR>(make_shared<SEGMENTVECTOR>(Segments)));
+        }
+
         shared_ptr<MediaSegment> GetSegment(unsigned int SeqNum)
         {
-          std::unique_lock<std::recursive_mutex> listlock(LockSegmentList, std::defer_lock);
-          if (IsLive) listlock.lock();
-          auto itrMatch = std::find_if(Segments.begin(), Segments.end(), [SeqNum](shared_ptr<MediaSegment> seg)
+          auto snapshot = GetSegmentSnapshot();
+          auto itrMatch = std::find_if(snapshot->begin(), snapshot->end(), [SeqNum](const shared_ptr<MediaSegment>& seg)
           {
             return seg->SequenceNumber == SeqNum;
           });
-          return itrMatch == Segments.end() ? nullptr : *itrMatch;
+          return itrMatch == snapshot->end() ? nullptr : *itrMatch;
         }
 
         shared_ptr<MediaSegment> GetNextSegment(unsigned int SeqNum, MFRATE_DIRECTION dir)
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSegmentList);
+          auto snapshot = GetSegmentSnapshot();
           if (dir == MFRATE_FORWARD)
           {
-            auto itrMatch = std::find_if(Segments.begin(), Segments.end(), [SeqNum](shared_ptr<MediaSegment> seg)
+            auto itrMatch = std::find_if(snapshot->begin(), snapshot->end(), [SeqNum](const shared_ptr<MediaSegment>& seg)
             {
               return seg->SequenceNumber >= SeqNum + 1;// && 
               //!(seg->GetCurrentState() == INMEMORYCACHE && seg->LengthInBytes == 0); //skip zero length segments
             });
-            return itrMatch == Segments.end() ? nullptr : *itrMatch;
+            return itrMatch == snapshot->end() ? nullptr : *itrMatch;
           }
           else
           {
             if (SeqNum == 0)
               return nullptr;
 
-            auto itrMatch = std::find_if(Segments.rbegin(), Segments.rend(), [SeqNum](shared_ptr<MediaSegment> seg)
+            auto itrMatch = std::find_if(snapshot->rbegin(), snapshot->rend(), [SeqNum](const shared_ptr<MediaSegment>& seg)
             {
               return seg->SequenceNumber <= SeqNum - 1;// && 
               //!(seg->GetCurrentState() == INMEMORYCACHE && seg->LengthInBytes == 0); //skip zero length segments
             });
-            return itrMatch == Segments.rend() ? nullptr : *itrMatch;
+            return itrMatch == snapshot->rend() ? nullptr : *itrMatch;
           }
         }
 
@@ -561,31 +624,17 @@ namespace Microsoft {
 
           std::lock_guard<std::recursive_mutex> lockTrack(LockSegmentTracking);
 
+          auto snapshot = GetSegmentSnapshot();
+          if (snapshot->empty())
+            return maxseg;
 
-          std::unique_lock<std::recursive_mutex> lockList(LockSegmentList, std::defer_lock);
-          std::unique_lock<std::recursive_mutex> lockMerge(LockMerge, std::defer_lock);
-
-          if (IsLive)
-          {
-            lockList.lock();
-            lockMerge.lock();
-          }
-
-          if ((IsLive && lockList.owns_lock() && lockMerge.owns_lock()) || (!IsLive))
-          {
-
-            auto seg = std::find_if(Segments.begin(), Segments.end(), [this, maxseg](shared_ptr<MediaSegment> ms){
-              return ms->SequenceNumber > maxseg->SequenceNumber && ms->GetCurrentState() != INMEMORYCACHE;
-            });
-            if (seg == Segments.end())
-              return Segments.back();
-            else
-              return GetNextSegment((*seg)->GetSequenceNumber(), MFRATE_REVERSE);
-          }
+          auto seg = std::find_if(snapshot->begin(), snapshot->end(), [this, maxseg](const shared_ptr<MediaSegment>& ms){
+            return ms->SequenceNumber > maxseg->SequenceNumber && ms->GetCurrentState() != INMEMORYCACHE;
+          });
+          if (seg == snapshot->end())
+            return snapshot->back();
           else
-          {
-            return maxseg;
-          }
+            return seg == snapshot->begin() ? nullptr : *(seg - 1);
         }
 
         ///<summary>Returns the maximum current segment index value across all content types</summary>
@@ -608,25 +657,23 @@ namespace Microsoft {
 
         bool HasCurrentSegmentTracker(ContentType type)
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSegmentTracking);
+          CountedLockGuard<std::recursive_mutex> lock(LockSegmentTracking, LockSegmentTrackingContention, GetLockSegmentTrackingContentionTotal());
           return CurrentSegmentTracker.find(type) != CurrentSegmentTracker.end() && CurrentSegmentTracker[type] != nullptr;
         }
 
         shared_ptr<MediaSegment> GetCurrentSegmentTracker(ContentType type)
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSegmentTracking);
-          if (CurrentSegmentTracker.find(type) != CurrentSegmentTracker.end())
-            return CurrentSegmentTracker[type];
-          else
-            return nullptr;
+          CountedLockGuard<std::recursive_mutex> lock(LockSegmentTracking, LockSegmentTrackingContention, GetLockSegmentTrackingContentionTotal());
+          auto itr = CurrentSegmentTracker.find(type);
+          return itr != CurrentSegmentTracker.end() ? itr->second : nullptr;
         }
 
         shared_ptr<Timestamp> GetPlaylistStartTimestamp();
 
         bool IsSegmentPlayingBack(int SequenceNumber)
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSegmentTracking);
-          return std::find_if(CurrentSegmentTracker.begin(), CurrentSegmentTracker.end(), [SequenceNumber](std::pair < ContentType, shared_ptr<MediaSegment>> p)
+          CountedLockGuard<std::recursive_mutex> lock(LockSegmentTracking, LockSegmentTrackingContention, GetLockSegmentTrackingContentionTotal());
+          return std::find_if(CurrentSegmentTracker.begin(), CurrentSegmentTracker.end(), [SequenceNumber](const std::pair<const ContentType, shared_ptr<MediaSegment>>& p)
           {
             return p.second != nullptr && p.second->GetSequenceNumber() == SequenceNumber;
           }) != CurrentSegmentTracker.end();
@@ -635,7 +682,7 @@ namespace Microsoft {
 
         shared_ptr<MediaSegment> SetCurrentSegmentTracker(ContentType type, shared_ptr<MediaSegment> seg)
         {
-          std::lock_guard<std::recursive_mutex> lock(LockSegmentTracking);
+          CountedLockGuard<std::recursive_mutex> lock(LockSegmentTracking, LockSegmentTrackingContention, GetLockSegmentTrackingContentionTotal());
           CurrentSegmentTracker[type] = seg;
           return seg;
         }
@@ -42,3 +42,5 @@ const wchar_t *TAGNAME::EXT_X_DISCONTINUITY = L"EXT-X-DISCONTINUITY";
 const wchar_t *TAGNAME::EXT_X_I_FRAMES_ONLY = L"EXT-X-I-FRAMES-ONLY";
 const wchar_t *TAGNAME::EXT_X_I_FRAMES_STREAM_INF = L"EXT-X-I-FRAMES-STREAM-INF";
 const wchar_t *TAGNAME::EXT_X_VERSION = L"EXT-X-VERSION";
+const wchar_t *TAGNAME::EXT_X_SERVER_CONTROL = L"EXT-X-SERVER-CONTROL";
+const wchar_t *TAGNAME::EXT_X_MAP = L"EXT-X-MAP";
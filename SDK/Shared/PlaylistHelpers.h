@@ -63,6 +63,8 @@ namespace Microsoft {
         static const wchar_t *EXT_X_I_FRAMES_ONLY;
         static const wchar_t *EXT_X_I_FRAMES_STREAM_INF;
         static const wchar_t *EXT_X_VERSION;
+        static const wchar_t *EXT_X_SERVER_CONTROL;
+        static const wchar_t *EXT_X_MAP;
       };
 
 
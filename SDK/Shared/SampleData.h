@@ -34,6 +34,23 @@ namespace Microsoft {
 
 
 
+      ///<summary>Shift from the sample timestamps of one PID in a discontinuous segment to the presentation timeline</summary>
+      class DiscontinuityOffset
+      {
+      public:
+        bool IsSet;
+        long long Offset;
+        DiscontinuityOffset() : IsSet(false), Offset(0) {}
+
+        ///<summary>Points every sample in the range at spOffset</summary>
+        template<typename Iterator>
+        static void Attach(const std::shared_ptr<DiscontinuityOffset>& spOffset, Iterator first, Iterator last)
+        {
+          for (; first != last; ++first)
+            (*first)->spDiscontinuityOffset = spOffset;
+        }
+      };
+
       class SampleData
       {
       public:
@@ -41,18 +58,19 @@ namespace Microsoft {
         shared_ptr<tuple<shared_ptr<BYTE>, unsigned int>> spInBandCC;
         bool IsSampleIDR;
         std::shared_ptr<Timestamp> SamplePTS;
-        std::shared_ptr<Timestamp> DiscontinousTS;
+        ///<summary>Shared by all samples on the same PID of a segment - set when the segment is discontinuous</summary>
+        std::shared_ptr<DiscontinuityOffset> spDiscontinuityOffset;
         unsigned int TotalLen;
         bool CCRead;
         bool IsTick;
         bool ForceSampleDiscontinuity;
         unsigned int Index;
-        SampleData() : IsSampleIDR(false), TotalLen(0), CCRead(false), DiscontinousTS(nullptr), IsTick(false), ForceSampleDiscontinuity(false),Index(0){}
+        SampleData() : IsSampleIDR(false), TotalLen(0), CCRead(false), spDiscontinuityOffset(nullptr), IsTick(false), ForceSampleDiscontinuity(false),Index(0){}
 
         SampleData(SampleData&& src) : 
           CCRead(src.CCRead), IsTick(src.IsTick), TotalLen(src.TotalLen), 
           IsSampleIDR(src.IsSampleIDR), SamplePTS(src.SamplePTS), 
-          DiscontinousTS(src.DiscontinousTS)
+          spDiscontinuityOffset(src.spDiscontinuityOffset)
         {
           elemData = std::move(src.elemData);
           spInBandCC = std::move(src.spInBandCC);
@@ -75,6 +93,23 @@ namespace Microsoft {
           return CCRead;
         }
 
+        bool HasDiscontinousTS()
+        {
+          return spDiscontinuityOffset != nullptr && spDiscontinuityOffset->IsSet;
+        }
+
+        ///<summary>Timestamp on the presentation timeline - same as the sample timestamp if the sample has not been remapped</summary>
+        unsigned long long GetDiscontinousTSValue()
+        {
+          return HasDiscontinousTS() ? (unsigned long long)((long long) SamplePTS->ValueInTicks + spDiscontinuityOffset->Offset) : SamplePTS->ValueInTicks;
+        }
+
+        ///<summary>Timestamp on the presentation timeline, or nullptr if the sample has not been remapped</summary>
+        std::shared_ptr<Timestamp> GetDiscontinousTS()
+        {
+          return HasDiscontinousTS() ? std::make_shared<Timestamp>(GetDiscontinousTSValue()) : nullptr;
+        }
+
       };
 
     }
@@ -0,0 +1,132 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <algorithm>
+#include "SegmentMemoryBudget.h"
+#include "HLSMediaSource.h"
+#include "MFVideoStream.h"
+#include "MFAudioStream.h"
+#include "Playlist.h"
+#include "MediaSegment.h"
+#include "StreamInfo.h"
+#include "Rendition.h"
+#include "FileLogger.h"
+
+using namespace std;
+using namespace Microsoft::HLSClient::Private;
+
+///<summary>Order in which an in memory segment gets evicted - lower goes first, -1 means it has to stay</summary>
+int SegmentMemoryBudget::GetEvictionRank(shared_ptr<MediaSegment> seg, Playlist *pPlaylist, std::vector<MediaSegment*>& cloakedcopies, Playlist *videotarget, Playlist *audiotarget)
+{
+  if (seg->GetCurrentState() != INMEMORYCACHE || pPlaylist->IsSegmentPlayingBack(seg->GetSequenceNumber()))
+    return -1;
+  //all samples read
+  if (seg->CanScavenge())
+    return 0;
+  //another segment downloaded the same data in its place
+  if (std::find(cloakedcopies.begin(), cloakedcopies.end(), seg.get()) != cloakedcopies.end())
+    return 1;
+  //variant or rendition we are not playing, and not switching to
+  if ((pPlaylist->pParentStream != nullptr && !pPlaylist->pParentStream->IsActive && pPlaylist != videotarget && pPlaylist != audiotarget) ||
+    (pPlaylist->pParentRendition != nullptr && !pPlaylist->pParentRendition->IsActive))
+    return 2;
+  return -1;
+}
+
+void SegmentMemoryBudget::Enforce(Playlist *pRootPlaylist)
+{
+  if (!IsExhausted() || pRootPlaylist == nullptr)
+    return;
+
+  //one eviction pass at a time - whoever is already at it will bring us back under the limit
+  std::unique_lock<std::recursive_mutex> lock(_lockevict, std::try_to_lock);
+  if (!lock.owns_lock())
+    return;
+
+  std::vector<Playlist*> playlists;
+  if (pRootPlaylist->IsVariant)
+  {
+    for (auto itr : pRootPlaylist->Variants)
+    {
+      if (itr.second->spPlaylist != nullptr)
+        playlists.push_back(itr.second->spPlaylist.get());
+    }
+    for (auto renmap : { &(pRootPlaylist->AudioRenditions), &(pRootPlaylist->VideoRenditions) })
+    {
+      for (auto itr : *renmap)
+      {
+        for (auto ren : *(itr.second))
+        {
+          if (ren->spPlaylist != nullptr)
+            playlists.push_back(ren->spPlaylist.get());
+        }
+      }
+    }
+  }
+  else
+    playlists.push_back(pRootPlaylist);
+
+  CHLSMediaSource *ms = pRootPlaylist->cpMediaSource;
+  Playlist *videotarget = nullptr, *audiotarget = nullptr;
+  if (ms->cpVideoStream != nullptr && ms->cpVideoStream->GetPendingBitrateSwitch() != nullptr)
+    videotarget = ms->cpVideoStream->GetPendingBitrateSwitch()->targetPlaylist;
+  if (ms->cpAudioStream != nullptr && ms->cpAudioStream->GetPendingBitrateSwitch() != nullptr)
+    audiotarget = ms->cpAudioStream->GetPendingBitrateSwitch()->targetPlaylist;
+
+  //in memory segments, and the segments they are cloaking with
+  std::vector<tuple<shared_ptr<MediaSegment>, Playlist*>> inmemory;
+  std::vector<MediaSegment*> cloakedcopies;
+  for (auto pPlaylist : playlists)
+  {
+    auto snapshot = pPlaylist->GetSegmentSnapshot();
+    for (auto seg : *snapshot)
+    {
+      if (seg->GetCurrentState() != INMEMORYCACHE)
+        continue;
+      inmemory.push_back(tuple<shared_ptr<MediaSegment>, Playlist*>(seg, pPlaylist));
+      if (seg->GetCloaking() != nullptr)
+        cloakedcopies.push_back(seg->GetCloaking().get());
+    }
+  }
+
+  std::vector<tuple<int, shared_ptr<MediaSegment>>> candidates;
+  for (auto itm : inmemory)
+  {
+    auto rank = GetEvictionRank(std::get<0>(itm), std::get<1>(itm), cloakedcopies, videotarget, audiotarget);
+    if (rank >= 0)
+      candidates.push_back(tuple<int, shared_ptr<MediaSegment>>(rank, std::get<0>(itm)));
+  }
+  //segments keep playlist order within a rank - oldest first
+  std::stable_sort(candidates.begin(), candidates.end(), [](const tuple<int, shared_ptr<MediaSegment>>& a, const tuple<int, shared_ptr<MediaSegment>>& b)
+  {
+    return std::get<0>(a) < std::get<0>(b);
+  });
+
+  for (auto itm : candidates)
+  {
+    if (!IsExhausted())
+      break;
+    LOG("SegmentMemoryBudget::Enforce() - Evicting segment " << std::get<1>(itm)->GetSequenceNumber() << "(rank " << std::get<0>(itm) << "), " << _usedbytes.load() << " bytes in use");
+    std::get<1>(itm)->Scavenge(true);
+  }
+}
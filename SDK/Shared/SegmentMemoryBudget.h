@@ -0,0 +1,72 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include "Configuration.h"
+
+using namespace std;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      class Playlist;
+      class MediaSegment;
+
+      ///<summary>Byte budget for the segment data a media source holds in memory</summary>
+      ///<remarks>Segments charge the size of their data when it lands in memory and give it back when they are scavenged. Once the total
+      ///goes over Configuration::MaximumBufferSizeInBytes we scavenge played segments first, then copies of segments that another segment
+      ///is cloaking with, then segments of variants and renditions that are not playing. Segments on the playback path that have not been
+      ///played are never evicted - the download chain stops early instead.</remarks>
+      class SegmentMemoryBudget
+      {
+      private:
+        std::atomic<unsigned long long> _usedbytes;
+        std::recursive_mutex _lockevict;
+
+        static int GetEvictionRank(shared_ptr<MediaSegment> seg, Playlist *pPlaylist, std::vector<MediaSegment*>& cloakedcopies, Playlist *videotarget, Playlist *audiotarget);
+      public:
+        SegmentMemoryBudget() : _usedbytes(0) {}
+
+        void Charge(unsigned long long bytes) { _usedbytes += bytes; }
+        void Release(unsigned long long bytes) { _usedbytes -= bytes; }
+        unsigned long long GetUsedBytes() { return _usedbytes; }
+
+        ///<summary>True if there is a limit and the segments in memory are at or over it</summary>
+        bool IsExhausted()
+        {
+          auto limit = Configuration::GetCurrent()->MaximumBufferSizeInBytes;
+          return limit > 0 && _usedbytes >= limit;
+        }
+
+        ///<summary>Scavenges segments in eviction order till we are back under the limit</summary>
+        ///<param name='pRootPlaylist'>Root playlist of the media source</param>
+        void Enforce(Playlist *pRootPlaylist);
+      };
+    }
+  }
+}
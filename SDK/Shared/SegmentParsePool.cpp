@@ -0,0 +1,126 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <thread>
+#include <ppltasks.h>
+#include "SegmentParsePool.h"
+
+using namespace std;
+using namespace concurrency;
+using namespace Microsoft::HLSClient::Private;
+
+SegmentParsePool::SegmentParsePool(unsigned int MaxWorkers) : _maxworkers(MaxWorkers), _runningworkers(0), _queuedticks(0), _shutdown(false)
+{
+  if (_maxworkers == 0)
+    _maxworkers = __max(1, std::thread::hardware_concurrency());
+}
+
+bool SegmentParsePool::Enqueue(unsigned long long DurationInTicks, unsigned long long BudgetInTicks, function<void()> Work, function<void(HRESULT)> OnFailure)
+{
+  std::unique_lock<std::recursive_mutex> lock(_lockthis);
+  if (_shutdown)
+  {
+    lock.unlock();
+    if (OnFailure != nullptr)
+      OnFailure(E_FAIL);
+    return false;
+  }
+  //always accept at least one item so that a single long segment still gets a worker
+  bool withinbudget = _queue.empty() || _queuedticks + DurationInTicks <= BudgetInTicks;
+
+  _queue.push_back(std::make_tuple(DurationInTicks, Work, OnFailure));
+  _queuedticks += DurationInTicks;
+
+  //over budget - wait for the workers we have (there is at least one, since the queue was not empty)
+  if ((withinbudget || _runningworkers == 0) && _runningworkers < _maxworkers)
+  {
+    _runningworkers++;
+    //the workers hold on to the pool until the queue is drained
+    auto spThis = shared_from_this();
+    task<void>([spThis]() { spThis->Drain(); }, task_options(task_continuation_context::use_arbitrary()));
+  }
+  return withinbudget;
+}
+
+void SegmentParsePool::Drain()
+{
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lockthis);
+    _workerthreads.insert(std::this_thread::get_id());
+  }
+
+  while (true)
+  {
+    function<void()> work;
+    function<void(HRESULT)> onfailure;
+    {
+      std::lock_guard<std::recursive_mutex> lock(_lockthis);
+      if (_queue.empty() || _shutdown)
+      {
+        _workerthreads.erase(std::this_thread::get_id());
+        _runningworkers--;
+        _workerexited.notify_all();
+        return;
+      }
+      work = std::get<1>(_queue.front());
+      onfailure = std::get<2>(_queue.front());
+      _queuedticks -= std::get<0>(_queue.front());
+      _queue.pop_front();
+    }
+
+    try
+    {
+      work();
+    }
+    catch (...)
+    {
+      if (onfailure != nullptr)
+        onfailure(E_FAIL);
+    }
+  }
+}
+
+void SegmentParsePool::Shutdown()
+{
+  std::deque<std::tuple<unsigned long long, function<void()>, function<void(HRESULT)>>> cancelled;
+  bool onworker = false;
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lockthis);
+    _shutdown = true;
+    cancelled.swap(_queue);
+    _queuedticks = 0;
+    onworker = _workerthreads.find(std::this_thread::get_id()) != _workerthreads.end();
+  }
+
+  for (auto& itm : cancelled)
+  {
+    if (std::get<2>(itm) != nullptr)
+      std::get<2>(itm)(E_FAIL);
+  }
+
+  if (onworker)
+    return;
+
+  std::unique_lock<std::recursive_mutex> lock(_lockthis);
+  _workerexited.wait(lock, [this]() { return _runningworkers == 0; });
+}
@@ -0,0 +1,78 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <deque>
+#include <tuple>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <thread>
+#include <functional>
+#include <memory>
+
+using namespace std;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      ///<summary>Bounded pool that decrypts and parses downloaded segments off the network completion callbacks</summary>
+      ///<remarks>At most one worker per core drains the queue, so a prefetch of several segments is parsed in parallel. Parallelism is
+      ///bounded by media duration: once the queued segments add up to the LAB threshold, further work waits behind them without 
+      ///starting another worker. Since a segment only completes once it is parsed, that holds back the download chain feeding the 
+      ///pool, and the network completion callbacks never parse.</remarks>
+      class SegmentParsePool : public std::enable_shared_from_this<SegmentParsePool>
+      {
+      private:
+        //queued work with the media duration it covers, and what to tell the segment if the work throws
+        std::deque<std::tuple<unsigned long long, function<void()>, function<void(HRESULT)>>> _queue;
+        std::recursive_mutex _lockthis;
+        unsigned int _maxworkers;
+        unsigned int _runningworkers;
+        unsigned long long _queuedticks;
+        bool _shutdown;
+        //signalled when a worker exits
+        std::condition_variable_any _workerexited;
+        std::set<std::thread::id> _workerthreads;
+
+        void Drain();
+      public:
+        ///<summary>Constructor</summary>
+        ///<param name='MaxWorkers'>Maximum number of concurrent workers - 0 to use the number of cores</param>
+        SegmentParsePool(unsigned int MaxWorkers = 0);
+        ///<summary>Queues work for a segment</summary>
+        ///<param name='DurationInTicks'>Media duration of the segment</param>
+        ///<param name='BudgetInTicks'>Media duration the queue may hold before it stops adding workers - the LAB threshold</param>
+        ///<param name='OnFailure'>Called with the error if Work throws, so that the segment does not wait forever</param>
+        ///<returns>False if the queue was over budget and the work waits for a busy worker</returns>
+        bool Enqueue(unsigned long long DurationInTicks, unsigned long long BudgetInTicks, function<void()> Work, function<void(HRESULT)> OnFailure);
+        unsigned int GetMaxWorkers() { return _maxworkers; }
+        ///<summary>Fails the queued work and waits for the running work to finish - work enqueued afterwards fails right away</summary>
+        ///<remarks>The media source calls this before it goes away, since the work runs against the source. Called on a worker (the work
+        ///released the last reference to the source) it cannot wait for itself, and only fails the queued work</remarks>
+        void Shutdown();
+      };
+    }
+  }
+}
@@ -0,0 +1,168 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <ppltasks.h>
+#include "SharedTimer.h"
+
+using namespace std;
+using namespace concurrency;
+using namespace Microsoft::HLSClient::Private;
+
+SharedTimer::SharedTimer(unsigned long long ResolutionInTicks) : _wheel(ResolutionInTicks), cpTimer(nullptr), _armedfor(0),
+hiresctr_freq(1), hiresctr_startcount(0), _shutdown(false)
+{
+  LARGE_INTEGER li;
+  if (QueryPerformanceFrequency(&li))
+    hiresctr_freq = li.QuadPart;
+  if (QueryPerformanceCounter(&li))
+    hiresctr_startcount = li.QuadPart;
+}
+
+SharedTimer::~SharedTimer()
+{
+  Shutdown();
+}
+
+unsigned long long SharedTimer::Now()
+{
+  LARGE_INTEGER li;
+  QueryPerformanceCounter(&li);
+  //ticks elapsed since construction
+  return (unsigned long long) ((li.QuadPart - hiresctr_startcount) * 10000000 / hiresctr_freq);
+}
+
+TimerWheel::timerid_t SharedTimer::Schedule(unsigned long long DueInTicks, unsigned long long PeriodInTicks, function<void()> Callback)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lockthis);
+  if (_shutdown)
+    return 0;
+
+  auto id = _wheel.Schedule(Now() + DueInTicks, PeriodInTicks, Callback);
+  Rearm();
+  return id;
+}
+
+void SharedTimer::Cancel(TimerWheel::timerid_t ID)
+{
+  std::lock_guard<std::recursive_mutex> lock(_lockthis);
+  if (!_wheel.Cancel(ID))
+  {
+    auto itr = _firing.find(ID);
+    if (itr != _firing.end())
+    {
+      itr->second->Cancelled = true;
+      _firing.erase(itr);
+    }
+  }
+  //we do not re-arm - an early wakeup with nothing to do is cheaper than recreating the thread pool timer
+}
+
+void SharedTimer::Shutdown()
+{
+  std::lock_guard<std::recursive_mutex> lock(_lockthis);
+  _shutdown = true;
+  if (cpTimer != nullptr)
+  {
+    cpTimer->Cancel();
+    cpTimer = nullptr;
+  }
+  _armedfor = 0;
+  _firing.clear();
+  _wheel = TimerWheel(_wheel.GetResolution());
+}
+
+void SharedTimer::Rearm()
+{
+  unsigned long long expiry = 0;
+  if (_shutdown || !_wheel.GetNextExpiry(expiry))
+    return;
+
+  //already armed to wake up in time
+  if (cpTimer != nullptr && _armedfor <= expiry)
+    return;
+
+  if (cpTimer != nullptr)
+    cpTimer->Cancel();
+
+  auto now = Now();
+  Windows::Foundation::TimeSpan tsDelay;
+  tsDelay.Duration = (long long) (expiry > now ? expiry - now : 1);//100 ns ticks
+  _armedfor = expiry;
+  //the thread pool timer must not keep us alive - Shutdown() cancels it, but it may already be on its way
+  weak_ptr<SharedTimer> wpThis = shared_from_this();
+  cpTimer = Windows::System::Threading::ThreadPoolTimer::CreateTimer(ref new Windows::System::Threading::TimerElapsedHandler(
+    [wpThis](Windows::System::Threading::IThreadPoolTimer ^timer)
+  {
+    auto spThis = wpThis.lock();
+    if (spThis != nullptr)
+      spThis->OnTimer(timer);
+  }), tsDelay);
+}
+
+void SharedTimer::OnTimer(Windows::System::Threading::IThreadPoolTimer^ timer)
+{
+  std::vector<shared_ptr<TimerWheel::Timer>> fired;
+  {
+    std::lock_guard<std::recursive_mutex> lock(_lockthis);
+    if (_shutdown)
+      return;
+    //a timer we replaced while re-arming may still go off - it just advances the wheel early
+    if (timer == cpTimer)
+    {
+      cpTimer = nullptr;
+      _armedfor = 0;
+    }
+    fired = _wheel.Advance(Now());
+    for (auto firedtimer : fired)
+    {
+      if (firedtimer->Period == 0)
+        _firing[firedtimer->ID] = firedtimer;
+    }
+    Rearm();
+  }
+
+  if (fired.empty())
+    return;
+
+  //callbacks may block (e.g. a playlist refresh waiting on a download) - all but the last one are handed to the thread pool so that
+  //they do not hold each other up, which is what separate thread pool timers used to give us
+  //each one holds on to us until its callback returns
+  auto spThis = shared_from_this();
+  auto Raise = [spThis](shared_ptr<TimerWheel::Timer> firedtimer)
+  {
+    {
+      std::lock_guard<std::recursive_mutex> lock(spThis->_lockthis);
+      if (firedtimer->Period == 0)
+        spThis->_firing.erase(firedtimer->ID);
+      if (firedtimer->Cancelled || spThis->_shutdown)
+        return;
+    }
+    firedtimer->Callback();
+  };
+  for (size_t i = 0; i + 1 < fired.size(); i++)
+  {
+    auto firedtimer = fired[i];
+    task<void>([Raise, firedtimer]() { Raise(firedtimer); }, task_options(task_continuation_context::use_arbitrary()));
+  }
+  Raise(fired.back());
+}
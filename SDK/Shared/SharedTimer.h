@@ -0,0 +1,77 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <mutex>
+#include <functional>
+#include <windows.system.threading.h>
+#include "TimerWheel.h"
+
+using namespace std;
+
+//slot length of the shared timer wheel - timers expiring within the same 10 ms are serviced by one wakeup
+#define DEFAULT_SHAREDTIMER_RESOLUTION 100000
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      ///<summary>Drives a TimerWheel with a single thread pool timer, so that all the timers of a media source share one wakeup</summary>
+      ///<remarks>The thread pool timer is one shot and is re-armed for the earliest expiry on the wheel after every wakeup, or when
+      ///a timer that expires earlier is scheduled. Callbacks run on the thread pool without any lock held, and keep the SharedTimer
+      ///alive while they run - so it must be created with make_shared.</remarks>
+      class SharedTimer : public std::enable_shared_from_this<SharedTimer>
+      {
+      private:
+        TimerWheel _wheel;
+        std::recursive_mutex _lockthis;
+        Windows::System::Threading::IThreadPoolTimer^ cpTimer;
+        //expiry the thread pool timer is currently armed for
+        unsigned long long _armedfor;
+        //one shot timers that fired and are waiting to be raised - the wheel has let go of them, but they can still be cancelled
+        std::map<TimerWheel::timerid_t, shared_ptr<TimerWheel::Timer>> _firing;
+        long long hiresctr_freq;
+        long long hiresctr_startcount;
+        bool _shutdown;
+
+        unsigned long long Now();
+        void Rearm();
+        void OnTimer(Windows::System::Threading::IThreadPoolTimer^ timer);
+      public:
+        SharedTimer(unsigned long long ResolutionInTicks = DEFAULT_SHAREDTIMER_RESOLUTION);
+        ~SharedTimer();
+        ///<summary>Schedules a callback</summary>
+        ///<param name='DueInTicks'>Delay before the first callback</param>
+        ///<param name='PeriodInTicks'>Interval between subsequent callbacks - 0 for a one shot timer</param>
+        ///<returns>The timer ID to cancel with - 0 if the timer has been shut down</returns>
+        TimerWheel::timerid_t Schedule(unsigned long long DueInTicks, unsigned long long PeriodInTicks, function<void()> Callback);
+        ///<summary>Cancels a timer</summary>
+        ///<remarks>A callback that is already running is not waited for (callers cancel while holding locks the callback may need), 
+        ///so callbacks must not capture raw pointers to the objects that cancel them</remarks>
+        void Cancel(TimerWheel::timerid_t ID);
+        ///<summary>Cancels all timers - no callbacks are raised after this</summary>
+        void Shutdown();
+      };
+    }
+  }
+}
@@ -28,6 +28,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <functional>
 #include <ppltasks.h> 
 #include <windows.system.threading.h> 
+#include "SharedTimer.h"
 
 using namespace concurrency;
 using namespace std;
@@ -51,6 +52,27 @@ namespace Microsoft {
         std::wstring _id;
         bool Paused;
         Windows::System::Threading::IThreadPoolTimer^ cpTimer;
+        TimerWheel::timerid_t _sharedtimerid;
+
+        ///<summary>What a one shot callback needs to update the stopwatch with - the callback can outlive the stopwatch, since 
+        ///cancelling does not wait for a callback that is already running</summary>
+        struct TickState
+        {
+          std::mutex LockState;
+          StopWatch *pStopWatch;
+        };
+        shared_ptr<TickState> spTickState;
+
+        ///<summary>Marks the stopwatch as no longer ticking, if it is still around</summary>
+        static void OnTickedOnce(shared_ptr<TickState> spState, bool ClearSharedTimerID)
+        {
+          std::lock_guard<std::mutex> lock(spState->LockState);
+          if (spState->pStopWatch == nullptr)
+            return;
+          spState->pStopWatch->IsTicking = false;
+          if (ClearSharedTimerID)
+            spState->pStopWatch->_sharedtimerid = 0;
+        }
 
       public:
         ///<summary>Handler for a timer tick event</summary>
@@ -59,10 +81,15 @@ namespace Microsoft {
         unsigned long long TickEventFrequency;
         ///<summary>Stopwatch state flag</summary>
         bool IsTicking;
+        ///<summary>Timer the tick events are scheduled on - a thread pool timer is created for this stopwatch if this is not set</summary>
+        shared_ptr<SharedTimer> spSharedTimer;
 
         ///<summary>Constructor</summary>
         StopWatch() : usinghires_ctr(true), hiresctr_freq(0), hiresctr_startcount(0), hiresctr_pausestartcount(0),
-          _startticks(0), _endticks(0), _pausestartticks(0), _totalpauseticks(0), Paused(false), TickEventFrequency(0), IsTicking(false) {
+          _startticks(0), _endticks(0), _pausestartticks(0), _totalpauseticks(0), Paused(false), _sharedtimerid(0), TickEventFrequency(0), IsTicking(false), spSharedTimer(nullptr) {
+
+          spTickState = make_shared<TickState>();
+          spTickState->pStopWatch = this;
 
           //create a GUID to represent the unique ID for the stopwatch
           WCHAR buff[128];
@@ -76,6 +103,10 @@ namespace Microsoft {
         ///<summary>Destructor</summary>
         ~StopWatch()
         {
+          {
+            std::lock_guard<std::mutex> lock(spTickState->LockState);
+            spTickState->pStopWatch = nullptr;
+          }
           if (IsTicking)
             StopTicking();
         }
@@ -89,6 +120,13 @@ namespace Microsoft {
         ///<summary>Starts the timer</summary>
         HRESULT StartTicking(function<void()> tickEvent)
         {
+          if (spSharedTimer != nullptr)
+          {
+            _sharedtimerid = spSharedTimer->Schedule(TickEventFrequency, TickEventFrequency, tickEvent);
+            if (_sharedtimerid == 0) return E_FAIL;
+            IsTicking = true;
+            return S_OK;
+          }
 
           Windows::Foundation::TimeSpan tsInterval;
           tsInterval.Duration = (long long) TickEventFrequency;//100 ns ticks
@@ -109,6 +147,15 @@ namespace Microsoft {
         {
           //set state
           IsTicking = false;
+          TimerWheel::timerid_t sharedtimerid = 0;
+          {
+            //a one shot callback may be clearing it at the same time
+            std::lock_guard<std::mutex> lock(spTickState->LockState);
+            sharedtimerid = _sharedtimerid;
+            _sharedtimerid = 0;
+          }
+          if (spSharedTimer != nullptr && sharedtimerid != 0)
+            spSharedTimer->Cancel(sharedtimerid);
           if (cpTimer)
           {
             cpTimer->Cancel();
@@ -117,9 +164,23 @@ namespace Microsoft {
 
         HRESULT StartTickingOnce(function<void()> tickEvent)
         {
+          if (spSharedTimer != nullptr)
+          {
+            //the handler may release this stopwatch - so update the state before raising the event
+            auto spState = spTickState;
+            _sharedtimerid = spSharedTimer->Schedule(TickEventFrequency, 0, [spState, tickEvent]()
+            {
+              OnTickedOnce(spState, true);
+              tickEvent();
+            });
+            if (_sharedtimerid == 0) return E_FAIL;
+            IsTicking = true;
+            return S_OK;
+          }
 
           Windows::Foundation::TimeSpan tsInterval;
           tsInterval.Duration = (long long) TickEventFrequency;//100 ns ticks
+          auto spState = spTickState;
           cpTimer = Windows::System::Threading::ThreadPoolTimer::CreateTimer(ref new Windows::System::Threading::TimerElapsedHandler(
             [tickEvent](Windows::System::Threading::IThreadPoolTimer ^timer)
           {
@@ -127,9 +188,9 @@ namespace Microsoft {
             return;
           }), 
           tsInterval,
-          ref new Windows::System::Threading::TimerDestroyedHandler([this](Windows::System::Threading::IThreadPoolTimer ^timer)
+          ref new Windows::System::Threading::TimerDestroyedHandler([spState](Windows::System::Threading::IThreadPoolTimer ^timer)
           {
-            IsTicking = false;
+            OnTickedOnce(spState, false);
           }));
           if (cpTimer == nullptr) return E_FAIL;
           //set state
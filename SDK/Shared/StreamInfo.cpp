@@ -21,6 +21,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 ***********************************************************************************************************************/ 
 #include <memory>
+#include <cmath>
 #include <ppltasks.h>
 #include "Cookie.h"
 #include "StreamInfo.h" 
@@ -71,7 +72,11 @@ SubtitleRenditions(nullptr),
 pActiveAudioRendition(nullptr),
 pActiveVideoRendition(nullptr),
 DownloadFailureCount(0),
-FailureCountMeasureTimestamp(0)
+FailureCountMeasureTimestamp(0),
+WarmupPending(false),
+ActiveMirror(0),
+MirrorSwitchPending(false),
+LastMirrorSwitch(0)
 {
 
   spDownloadRegistry = make_shared<ContentDownloadRegistry>();
@@ -80,7 +85,8 @@ FailureCountMeasureTimestamp(0)
     PlaylistUri = playlisturi;
   else
     PlaylistUri = Helpers::JoinUri(parentPlaylist->BaseUri, playlisturi);
-
+  PrimaryPlaylistUri = PlaylistUri;
+  MirrorStats.push_back(MirrorHealth());
 
   //parse attributes
   std::wstring allattribs = Helpers::ReadAttributeList(tagWithAttributes);
@@ -133,8 +139,185 @@ void StreamInfo::AddBackupPlaylistUri(wstring uri)
   if (!Helpers::IsAbsoluteUri(uri))
     uri = Helpers::JoinUri(pParentPlaylist->BaseUri, uri);
 
+  std::lock_guard<std::recursive_mutex> lock(LockMirrors);
   if (std::find_if(BackupPlaylistUris.begin(), BackupPlaylistUris.end(), [uri](wstring u) { return u == uri; }) == BackupPlaylistUris.end())
+  {
     BackupPlaylistUris.push_back(uri);
+    MirrorStats.push_back(MirrorHealth());
+  }
+}
+
+unsigned int StreamInfo::GetActiveMirror()
+{
+  std::lock_guard<std::recursive_mutex> lock(LockMirrors);
+  return ActiveMirror;
+}
+
+std::wstring StreamInfo::GetMirrorUri(unsigned int Mirror)
+{
+  return Mirror == 0 ? PrimaryPlaylistUri : BackupPlaylistUris[Mirror - 1];
+}
+
+double StreamInfo::GetMirrorScore(unsigned int Mirror, ULONGLONG Now)
+{
+  auto& mh = MirrorStats[Mirror];
+  if (mh.Samples == 0 && mh.ErrorScore == 0.0)
+    return MIRRORUNMEASUREDSCORE;
+
+  //recent failures dominate - but they fade so that a mirror that recovered gets used again
+  double score = 2.0 * mh.ErrorScore * pow(0.5, (double)(Now - mh.LastUpdated) / MIRRORERRORHALFLIFE);
+  //playlist latency in seconds
+  score += mh.AvgLatency / 1000.0;
+  //throughput shortfall against what this variant needs (with 50% headroom)
+  if (mh.AvgThroughput > 0.0 && Bandwidth > 0 && mh.AvgThroughput < 1.5 * (Bandwidth / 8.0))
+    score += 1.5 - mh.AvgThroughput / (Bandwidth / 8.0);
+  return score;
+}
+
+unsigned int StreamInfo::GetMirrorFailures(unsigned int Mirror, ULONGLONG Now)
+{
+  auto& mh = MirrorStats[Mirror];
+  if (mh.LastFailure == 0 || Now - mh.LastFailure >= DOWNLOADFAILUREQUARANTINEDURATION)
+    return 0;
+  return mh.DownloadFailures;
+}
+
+void StreamInfo::RecordMirrorHealth(unsigned int Mirror, bool Succeeded, ULONGLONG ElapsedMs, unsigned long long Bytes, bool IsPlaylist)
+{
+  unsigned int target = 0;
+  {
+    std::lock_guard<std::recursive_mutex> lock(LockMirrors);
+    //no redundant streams - nothing to choose from
+    if (BackupPlaylistUris.empty() || Mirror >= MirrorStats.size())
+      return;
+
+    ULONGLONG now = ::GetTickCount64();
+    auto& mh = MirrorStats[Mirror];
+    if (mh.LastUpdated > 0)
+      mh.ErrorScore *= pow(0.5, (double)(now - mh.LastUpdated) / MIRRORERRORHALFLIFE);
+    mh.LastUpdated = now;
+
+    if (!Succeeded)
+    {
+      mh.ErrorScore += 1.0;
+      mh.DownloadFailures = GetMirrorFailures(Mirror, now) + 1;
+      mh.LastFailure = now;
+    }
+    else
+    {
+      if (IsPlaylist)
+        mh.AvgLatency = mh.Samples == 0 ? (double)ElapsedMs : MIRRORHEALTHSMOOTHING * ElapsedMs + (1.0 - MIRRORHEALTHSMOOTHING) * mh.AvgLatency;
+      else if (Bytes > 0 && ElapsedMs > 0)
+      {
+        double tput = Bytes * 1000.0 / ElapsedMs;
+        mh.AvgThroughput = mh.AvgThroughput == 0.0 ? tput : MIRRORHEALTHSMOOTHING * tput + (1.0 - MIRRORHEALTHSMOOTHING) * mh.AvgThroughput;
+      }
+      mh.Samples++;
+    }
+
+    if (MirrorSwitchPending || (LastMirrorSwitch > 0 && now - LastMirrorSwitch < MIRRORMINSWITCHINTERVAL))
+      return;
+
+    auto curscore = GetMirrorScore(ActiveMirror, now);
+    if (curscore < MIRRORDEGRADEDSCORE)
+      return;
+
+    target = ActiveMirror;
+    auto bestscore = curscore;
+    for (unsigned int i = 0; i < MirrorStats.size(); i++)
+    {
+      //a mirror that has run up enough recent failures to be quarantined is not a candidate
+      if (i == ActiveMirror || GetMirrorFailures(i, now) >= MAXALLOWEDDOWNLOADFAILURES)
+        continue;
+      auto score = GetMirrorScore(i, now);
+      if (score < bestscore - MIRRORSWITCHMARGIN)
+      {
+        target = i;
+        bestscore = score;
+      }
+    }
+    if (target == ActiveMirror)
+      return;
+
+    LOG("Mirror for variant " << Bandwidth << " degraded (score " << curscore << ") - moving to " << GetMirrorUri(target) << " (score " << bestscore << ")");
+    MirrorSwitchPending = true;
+  }
+
+  //switch in the background - we may be on a download completion callback
+  pParentPlaylist->cpMediaSource->protectionRegistry.Register(task<HRESULT>([this, target]()
+  {
+    SwitchToMirror(target);
+    return S_OK;
+  }, task_options(task_continuation_context::use_arbitrary())));
+}
+
+void StreamInfo::SwitchToMirror(unsigned int Mirror)
+{
+  auto olduri = PlaylistUri;
+  auto mirroruri = GetMirrorUri(Mirror);
+  shared_ptr<Playlist> pl = nullptr;
+  ULONGLONG started = ::GetTickCount64();
+
+  HRESULT hr = E_FAIL;
+  try
+  {
+    hr = DownloadBatchPlaylist(pl, mirroruri).get();
+  }
+  catch (...)
+  {
+    hr = E_FAIL;
+  }
+
+  bool switched = false;
+  if (SUCCEEDED(hr) && pl != nullptr && pl->IsValid)
+  {
+    if (spPlaylist != nullptr)
+    {
+      //point the segments we have not started on yet at the mirror - redundant streams share sequence numbers
+      std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
+      std::lock_guard<std::recursive_mutex> listlock(spPlaylist->LockSegmentList);
+      for (auto seg : spPlaylist->Segments)
+      {
+        auto state = seg->GetCurrentState();
+        if (state == INMEMORYCACHE || state == DOWNLOADING)
+          continue;
+        auto mirrorseg = pl->GetSegment(seg->SequenceNumber);
+        if (mirrorseg == nullptr)
+          continue;
+        seg->SetMediaUri(mirrorseg->GetMediaUri());
+        //keys we already hold are identical across redundant streams - only the ones still to be fetched move
+        if (seg->EncKey != nullptr && mirrorseg->EncKey != nullptr && seg->EncKey->Method != NOENCRYPTION)
+          seg->EncKey->RepointKeyUri(mirrorseg->EncKey->GetKeyUri());
+      }
+    }
+    switched = true;
+  }
+  else //DownloadBatchPlaylist() follows redirects into PlaylistUri - undo that
+    PlaylistUri = olduri;
+
+  std::lock_guard<std::recursive_mutex> lock(LockMirrors);
+  auto& mh = MirrorStats[Mirror];
+  auto now = ::GetTickCount64();
+  if (switched)
+  {
+    mh.AvgLatency = mh.Samples == 0 ? (double)(now - started) : MIRRORHEALTHSMOOTHING * (now - started) + (1.0 - MIRRORHEALTHSMOOTHING) * mh.AvgLatency;
+    mh.Samples++;
+    ActiveMirror = Mirror;
+    //the quarantine count follows the mirror - a mirror that keeps failing and getting switched back to still ends up quarantined
+    auto failures = GetMirrorFailures(Mirror, now);
+    DownloadFailureCount = failures > MAXALLOWEDDOWNLOADFAILURES ? MAXALLOWEDDOWNLOADFAILURES : failures;
+    FailureCountMeasureTimestamp = 0;
+  }
+  else
+  {
+    mh.ErrorScore += 1.0;
+    mh.DownloadFailures = GetMirrorFailures(Mirror, now) + 1;
+    mh.LastFailure = now;
+  }
+  mh.LastUpdated = now;
+
+  LastMirrorSwitch = mh.LastUpdated;
+  MirrorSwitchPending = false;
 }
 
 /// <summary>Parses the codec string and translates to matching media foundation media subtypes</summary>
@@ -162,6 +345,9 @@ void StreamInfo::ParseCodecsString(std::wstring& codecstring)
     //H.264 video 
     if (codecup.find(L"AVC") != std::wstring::npos)
       this->VideoMediaType = MFVideoFormat_H264;
+    //HEVC video
+    else if (codecup.find(L"HVC1") != std::wstring::npos || codecup.find(L"HEV1") != std::wstring::npos)
+      this->VideoMediaType = MFVideoFormat_HEVC;
   }
   else //nothing supplied
   {
@@ -225,6 +411,24 @@ task<HRESULT> StreamInfo::DownloadPlaylistAsync(task_completion_event<HRESULT> t
   std::map<wstring, wstring> headers;
   std::vector<shared_ptr<Cookie>> cookies;
   wstring url = PlaylistUri;
+  wstring lastmod, etag;
+  bool blockingreload = false;
+
+  if (Configuration::GetCurrent()->EnableLowLatencyLive && spPlaylist != nullptr && spPlaylist->IsLive)
+  {
+    std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
+    //the refresh that has not been merged yet is the most recent copy we have
+    auto latest = (spPlaylistRefresh != nullptr && spPlaylistRefresh->Segments.size() > 0) ? spPlaylistRefresh : spPlaylist;
+    lastmod = spPlaylistRefresh != nullptr ? spPlaylistRefresh->LastModified : spPlaylist->LastModified;
+    etag = spPlaylistRefresh != nullptr ? spPlaylistRefresh->ETag : spPlaylist->ETag;
+    //ask the server to hold the request until the segment after the last one we know of is available (warmups of other variants should not wait)
+    if (IsActive && spPlaylist->UseBlockingReload() && latest->Segments.size() > 0)
+    {
+      url += (url.find(L'?') == wstring::npos ? L"?_HLS_msn=" : L"&_HLS_msn=") + to_wstring(latest->Segments.back()->SequenceNumber + 1);
+      blockingreload = true;
+    }
+  }
+
   Microsoft::HLSClient::IHLSContentDownloader^ external = nullptr;
   ms->cpController->RaisePrepareResourceRequest(ResourceType::PLAYLIST, url, cookies, headers, &external);
 
@@ -232,12 +436,15 @@ task<HRESULT> StreamInfo::DownloadPlaylistAsync(task_completion_event<HRESULT> t
   //start the async download
   downloader->Initialize(ref new Platform::String(url.data()));
   if (external == nullptr)
-    downloader->SetParameters(  nullptr, L"GET", cookies, headers);
+    downloader->SetParameters(  nullptr, L"GET", cookies, headers, false, lastmod, etag);
   else
     downloader->SetParameters(  nullptr, external);
 
+  auto mirror = GetActiveMirror();
+  ULONGLONG started = ::GetTickCount64();
+
   downloader->Completed += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^>(
-    [this, tcePlaylistDownloaded, ms](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
+    [this, tcePlaylistDownloaded, ms, blockingreload, mirror, started](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args)
   {
     DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
 
@@ -256,19 +463,24 @@ task<HRESULT> StreamInfo::DownloadPlaylistAsync(task_completion_event<HRESULT> t
         if (MemoryCache.size() == 0)
         {
           DownloadFailureCount++;
+          RecordMirrorHealth(mirror, false);
           tcePlaylistDownloaded.set(E_FAIL);
         } 
         else
         {
-          //in case there was a redirect
-          PlaylistUri = args->ContentUri->AbsoluteUri->Data();
+          //a blocking reload is held by the server on purpose - its latency says nothing about mirror health
+          RecordMirrorHealth(mirror, true, blockingreload ? 0 : ::GetTickCount64() - started, MemoryCache.size(), !blockingreload);
+          //in case there was a redirect - a blocking reload carries our own query parameters so we keep the uri we already have
+          if (!blockingreload)
+            PlaylistUri = args->ContentUri->AbsoluteUri->Data();
 
-          this->OnPlaylistDownloadCompleted(MemoryCache, tcePlaylistDownloaded);
+          this->OnPlaylistDownloadCompleted(MemoryCache, args, tcePlaylistDownloaded);
         }
       }
       else
       {
         DownloadFailureCount++;
+        RecordMirrorHealth(mirror, false);
         tcePlaylistDownloaded.set(E_FAIL);
       } 
     }
@@ -277,13 +489,16 @@ task<HRESULT> StreamInfo::DownloadPlaylistAsync(task_completion_event<HRESULT> t
   });
 
   downloader->Error += ref new Windows::Foundation::TypedEventHandler<Microsoft::HLSClient::IHLSContentDownloader ^, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^>(
-    [this, tcePlaylistDownloaded](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
+    [this, tcePlaylistDownloaded, mirror](Microsoft::HLSClient::IHLSContentDownloader ^sender, Microsoft::HLSClient::IHLSContentDownloadErrorArgs ^args)
   {
     DefaultContentDownloader^ downloader = static_cast<DefaultContentDownloader^>(sender);
   ///  spDownloadRegistry->Unregister(downloader);
-    if (args->StatusCode != Windows::Web::Http::HttpStatusCode::Ok)
+    if (args->StatusCode == Windows::Web::Http::HttpStatusCode::NotModified)
+      tcePlaylistDownloaded.set(S_OK);//conditional refresh - nothing changed
+    else if (args->StatusCode != Windows::Web::Http::HttpStatusCode::Ok)
     {
       DownloadFailureCount++;
+      RecordMirrorHealth(mirror, false);
       tcePlaylistDownloaded.set(E_FAIL);
     }
     else
@@ -298,7 +513,61 @@ task<HRESULT> StreamInfo::DownloadPlaylistAsync(task_completion_event<HRESULT> t
   return task<HRESULT>(tcePlaylistDownloaded);
 }
 
-HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, task_completion_event<HRESULT> tcePlaylistDownloaded)
+task<HRESULT> StreamInfo::WarmPlaylistAsync()
+{
+  task_completion_event<HRESULT> tceWarmup;
+  {
+    std::lock_guard<std::recursive_mutex> lock(LockStream);
+
+    //nothing to do for the active variant (it refreshes itself), for a variant we cannot reach or for a VOD playlist we already have
+    if (IsActive || WarmupPending || IsQuarantined() || (spPlaylist != nullptr && spPlaylist->IsLive == false))
+      return task_from_result<HRESULT>(S_OK);
+
+    WarmupPending = true;
+    taskWarmup = task<HRESULT>(tceWarmup);
+  }
+
+  DownloadPlaylistAsync().then([this, tceWarmup](task<HRESULT> t)
+  {
+    HRESULT hr = E_FAIL;
+    try
+    {
+      hr = t.get();
+    }
+    catch (...)
+    {
+    }
+
+    {
+      std::lock_guard<std::recursive_mutex> lock(LockStream);
+      WarmupPending = false;
+    }
+    tceWarmup.set(hr);
+  }, task_continuation_context::use_arbitrary());
+
+  return task<HRESULT>(tceWarmup);
+}
+
+void StreamInfo::WaitForPendingWarmup()
+{
+  task<HRESULT> t;
+  {
+    std::lock_guard<std::recursive_mutex> lock(LockStream);
+    if (!WarmupPending)
+      return;
+    t = taskWarmup;
+  }
+
+  try
+  {
+    t.wait();
+  }
+  catch (...)
+  {
+  }
+}
+
+HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args, task_completion_event<HRESULT> tcePlaylistDownloaded)
 {
 
   if (this->pParentPlaylist->cpMediaSource->GetCurrentState() == MSS_ERROR || this->pParentPlaylist->cpMediaSource->GetCurrentState() == MSS_UNINITIALIZED)
@@ -310,6 +579,13 @@ HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, t
   std::wstring baseuri, filename;
   //split the uri for later use
   Helpers::SplitUri(PlaylistUri, baseuri, filename);
+  std::wstring lastmod, etag;
+
+  if (args->ResponseHeaders->HasKey(L"Last-Modified"))
+    lastmod = args->ResponseHeaders->Lookup(L"Last-Modified")->Data();
+  if (args->ResponseHeaders->HasKey(L"ETag"))
+    etag = args->ResponseHeaders->Lookup(L"ETag")->Data();
+
   if (spPlaylist == nullptr) //first time download
   {
 
@@ -319,6 +595,7 @@ HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, t
     std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
     //attach the media source
     spPlaylist->AttachMediaSource(this->pParentPlaylist->cpMediaSource);
+    spPlaylist->SetLastModifiedSince(lastmod, etag);
 
     LOG(" *** PLAYLIST DOWNLOAD *** ");
     LOG(spPlaylist->szData);
@@ -331,6 +608,9 @@ HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, t
       return E_FAIL;
     }
 
+    if (this->pParentPlaylist->cpMediaSource->GetCurrentState() == MSS_OPENING)
+      this->pParentPlaylist->cpMediaSource->MarkStartupPhase(&StartupPhaseTimes::MediaPlaylistReady);
+
     if (this->pParentPlaylist->cpMediaSource->GetCurrentState() != MSS_OPENING){
       auto audioren = this->GetActiveAudioRendition();
       auto videoren = this->GetActiveVideoRendition();
@@ -363,6 +643,7 @@ HRESULT StreamInfo::OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, t
   {
     std::lock_guard<std::recursive_mutex> lockmerge(spPlaylist->LockMerge);
     spPlaylistRefresh = make_shared<Playlist>(std::wstring(MemoryCache.begin(), MemoryCache.end()), baseuri, filename, this);
+    spPlaylistRefresh->SetLastModifiedSince(lastmod, etag);
     if (spPlaylist->szData != spPlaylistRefresh->szData)
       spPlaylistRefresh->Parse();
     if (spPlaylistRefresh->Segments.size() > 0 && spPlaylistRefresh->Segments.back()->SequenceNumber > spPlaylist->Segments.back()->SequenceNumber) //only do next if the main playlist changes
@@ -102,13 +102,56 @@ namespace Microsoft {
         const unsigned int DOWNLOADFAILUREQUARANTINEDURATION = 30000;
         unsigned int DownloadFailureCount;
         ULONGLONG FailureCountMeasureTimestamp;
+        //is a speculative (warmup) playlist download in progress ?
+        bool WarmupPending;
+        task<HRESULT> taskWarmup;
+
+        //decaying health record for one mirror (primary or backup uri) of the variant
+        struct MirrorHealth
+        {
+          //smoothed request latency for playlist fetches (ms)
+          double AvgLatency;
+          //smoothed download throughput (bytes/sec)
+          double AvgThroughput;
+          //failure count that halves every MIRRORERRORHALFLIFE ms
+          double ErrorScore;
+          ULONGLONG LastUpdated;
+          unsigned int Samples;
+          //download failures within the last DOWNLOADFAILUREQUARANTINEDURATION ms - survives switching away from and back to the mirror
+          unsigned int DownloadFailures;
+          ULONGLONG LastFailure;
+          MirrorHealth() : AvgLatency(0.0), AvgThroughput(0.0), ErrorScore(0.0), LastUpdated(0), Samples(0), DownloadFailures(0), LastFailure(0) {}
+        };
+        const double MIRRORHEALTHSMOOTHING = 0.3;
+        const double MIRRORERRORHALFLIFE = 30000.0;
+        //score a mirror gets before we have measured it
+        const double MIRRORUNMEASUREDSCORE = 0.5;
+        //current mirror score above which we start looking for a better one
+        const double MIRRORDEGRADEDSCORE = 1.0;
+        //how much better the alternative has to be
+        const double MIRRORSWITCHMARGIN = 0.5;
+        const ULONGLONG MIRRORMINSWITCHINTERVAL = 10000;
+        //index 0 is the primary uri, index n is BackupPlaylistUris[n-1]
+        std::vector<MirrorHealth> MirrorStats;
+        std::wstring PrimaryPlaylistUri;
+        unsigned int ActiveMirror;
+        bool MirrorSwitchPending;
+        ULONGLONG LastMirrorSwitch;
+        recursive_mutex LockMirrors;
+        /// <summary>Scores a mirror - lower is healthier</summary>
+        double GetMirrorScore(unsigned int Mirror, ULONGLONG Now);
+        /// <summary>Failures recorded against a mirror that have not aged out of the quarantine window yet</summary>
+        unsigned int GetMirrorFailures(unsigned int Mirror, ULONGLONG Now);
+        std::wstring GetMirrorUri(unsigned int Mirror);
+        /// <summary>Moves the variant to a different mirror - fetches the mirror playlist and points the segments we have not downloaded yet at it</summary>
+        void SwitchToMirror(unsigned int Mirror);
         //active alternate renditions
         Rendition  *pActiveAudioRendition, *pActiveVideoRendition;
         /// <summary>Parses the codec string and translates to matching media foundation media subtypes</summary>
         /// <remarks>We only support H.264 and AAC in this version. In case no codec string is supplied we assume H.264 and AAC.</remarks>
         /// <param name='codecstring'>The codec string extracted from the playlist</param>
         void ParseCodecsString(std::wstring& codecstring); 
-        HRESULT OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, task_completion_event<HRESULT> tcePlaylistDownloaded);
+        HRESULT OnPlaylistDownloadCompleted(std::vector<BYTE> MemoryCache, Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args, task_completion_event<HRESULT> tcePlaylistDownloaded);
         HRESULT OnBatchPlaylistDownloadCompleted(
           shared_ptr<Playlist>& spPlaylist, 
           Microsoft::HLSClient::IHLSContentDownloadCompletedArgs ^args, 
@@ -134,6 +177,12 @@ namespace Microsoft {
         /// <param name='tcePlaylistDownloaded'>Task completion event that is used to create a waitable task to be returned</param>
         /// <returns>Task to wait on</returns>
         task<HRESULT> DownloadPlaylistAsync(task_completion_event<HRESULT> tcePlaylistDownloaded = task_completion_event<HRESULT>());
+        /// <summary>Speculatively downloads (or refreshes if live) the variant playlist ahead of a possible bitrate switch</summary>
+        /// <remarks>No-op if the variant is active, quarantined, already has a VOD playlist or a warmup is already in progress.</remarks>
+        /// <returns>Task to wait on</returns>
+        task<HRESULT> WarmPlaylistAsync();
+        /// <summary>Blocks until an in progress warmup download (if any) completes</summary>
+        void WaitForPendingWarmup();
         task<HRESULT> DownloadBatchPlaylist(shared_ptr<Playlist>& pPlaylist, wstring& uri, task_completion_event<HRESULT> tcePlaylistDownloaded = task_completion_event<HRESULT>());
 
 
@@ -167,6 +216,16 @@ namespace Microsoft {
         }
 
         void AddBackupPlaylistUri(wstring uri);
+
+        /// <summary>Returns the index of the mirror (0 = primary) requests are currently going to</summary>
+        unsigned int GetActiveMirror();
+        /// <summary>Records the outcome of a playlist or segment request against a mirror, and moves to a healthier mirror if the current one is degrading</summary>
+        /// <param name='Mirror'>The mirror the request went to</param>
+        /// <param name='Succeeded'>False if the request failed</param>
+        /// <param name='ElapsedMs'>Time taken by the request</param>
+        /// <param name='Bytes'>Bytes received</param>
+        /// <param name='IsPlaylist'>True for playlist requests (latency bound), false for segment requests (throughput bound)</param>
+        void RecordMirrorHealth(unsigned int Mirror, bool Succeeded, ULONGLONG ElapsedMs = 0, unsigned long long Bytes = 0, bool IsPlaylist = false);
       };
 
       
@@ -0,0 +1,151 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#include "pch.h"
+#include <algorithm>
+#include "TimerWheel.h"
+
+using namespace std;
+using namespace Microsoft::HLSClient::Private;
+
+TimerWheel::TimerWheel(unsigned long long ResolutionInTicks, unsigned long long NowInTicks) :
+_resolution(ResolutionInTicks == 0 ? 1 : ResolutionInTicks), _current(0), _nextid(1)
+{
+  _current = NowInTicks / _resolution;
+}
+
+TimerWheel::timerid_t TimerWheel::Schedule(unsigned long long ExpiryInTicks, unsigned long long PeriodInTicks, function<void()> Callback)
+{
+  auto timer = make_shared<Timer>();
+  timer->ID = _nextid++;
+  timer->Due = ExpiryInTicks;
+  timer->Period = PeriodInTicks;
+  timer->Callback = Callback;
+  timer->Cancelled = false;
+
+  _timers[timer->ID] = timer;
+  Insert(timer);
+  return timer->ID;
+}
+
+bool TimerWheel::Cancel(timerid_t ID)
+{
+  auto itr = _timers.find(ID);
+  if (itr == _timers.end())
+    return false;
+  //the entry is dropped from its slot when the wheel gets to it
+  itr->second->Cancelled = true;
+  _timers.erase(itr);
+  return true;
+}
+
+std::vector<shared_ptr<TimerWheel::Timer>> TimerWheel::Advance(unsigned long long NowInTicks)
+{
+  std::vector<shared_ptr<Timer>> fired;
+  auto target = NowInTicks / _resolution;
+
+  while (_current < target)
+  {
+    _current++;
+    //when a level wraps around, move the timers of the next slot on the level above down
+    for (unsigned int level = 1; level < LevelCount && (_current & ((1ULL << (SlotBits * level)) - 1)) == 0; level++)
+      Cascade(level);
+
+    auto& slot = _slots[0][_current & (SlotCount - 1)];
+    if (slot.empty())
+      continue;
+
+    std::list<shared_ptr<Timer>> due;
+    due.swap(slot);
+    for (auto timer : due)
+    {
+      if (timer->Cancelled)
+        continue;
+      if (timer->Expiry > _current) //not in this round
+      {
+        Insert(timer);
+        continue;
+      }
+
+      fired.push_back(timer);
+      if (timer->Period > 0)
+      {
+        timer->Due += timer->Period;
+        if (timer->Due <= NowInTicks)
+          timer->Due += ((NowInTicks - timer->Due) / timer->Period + 1) * timer->Period;
+        Insert(timer);
+      }
+      else
+        _timers.erase(timer->ID);
+    }
+  }
+
+  return fired;
+}
+
+bool TimerWheel::GetNextExpiry(unsigned long long& ExpiryInTicks)
+{
+  if (_timers.empty())
+    return false;
+
+  auto itr = std::min_element(_timers.begin(), _timers.end(), [](const pair<const timerid_t, shared_ptr<Timer>>& a, const pair<const timerid_t, shared_ptr<Timer>>& b)
+  {
+    return a.second->Expiry < b.second->Expiry;
+  });
+  ExpiryInTicks = itr->second->Expiry * _resolution;
+  return true;
+}
+
+void TimerWheel::Insert(shared_ptr<Timer> timer)
+{
+  //round up to the slot boundary - this is what coalesces timers that expire close to each other
+  timer->Expiry = __max((timer->Due + _resolution - 1) / _resolution, _current + 1);
+
+  auto delta = timer->Expiry - _current;
+  unsigned int level = 0;
+  while (level < LevelCount - 1 && delta >= (1ULL << (SlotBits * (level + 1))))
+    level++;
+
+  //timers beyond the range of the top level wait in its furthest slot and get placed again when it cascades
+  auto expiry = __min(timer->Expiry, _current + (1ULL << (SlotBits * LevelCount)) - 1);
+  _slots[level][(expiry >> (SlotBits * level)) & (SlotCount - 1)].push_back(timer);
+}
+
+void TimerWheel::Cascade(unsigned int Level)
+{
+  auto& slot = _slots[Level][(_current >> (SlotBits * Level)) & (SlotCount - 1)];
+  std::list<shared_ptr<Timer>> moving;
+  moving.swap(slot);
+  for (auto timer : moving)
+  {
+    if (timer->Cancelled)
+      continue;
+    //due in the slot Advance() is about to service - Insert() would push it out to the next one
+    if ((timer->Due + _resolution - 1) / _resolution <= _current)
+    {
+      timer->Expiry = _current;
+      _slots[0][_current & (SlotCount - 1)].push_back(timer);
+    }
+    else
+      Insert(timer);
+  }
+}
@@ -0,0 +1,97 @@
+/*********************************************************************************************************************
+Microsft HLS SDK for Windows
+
+Copyright (c) Microsoft Corporation
+
+All rights reserved.
+
+MIT License
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation
+files (the ""Software""), to deal in the Software without restriction, including without limitation the rights to use, copy,
+modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software
+is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED *AS IS*, WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE
+FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+***********************************************************************************************************************/
+#pragma once
+
+#include <vector>
+#include <list>
+#include <map>
+#include <memory>
+#include <functional>
+
+using namespace std;
+
+namespace Microsoft {
+  namespace HLSClient {
+    namespace Private {
+
+      ///<summary>Hierarchical timer wheel - keeps the timers of a media source so that a single platform timer can drive all of them</summary>
+      ///<remarks>The wheel has no clock of its own. Time only moves when Advance() is called, which lets the owner coalesce wakeups
+      ///(expiries are rounded up to the wheel resolution) and lets the wheel be driven by a virtual clock.</remarks>
+      class TimerWheel
+      {
+      public:
+        typedef unsigned long long timerid_t;
+
+        struct Timer
+        {
+          timerid_t ID;
+          ///<summary>Exact due time in ticks - kept so that periodic timers do not drift by the rounding to a slot</summary>
+          unsigned long long Due;
+          ///<summary>Period in ticks - 0 for a one shot timer</summary>
+          unsigned long long Period;
+          ///<summary>Expiry in wheel slots</summary>
+          unsigned long long Expiry;
+          function<void()> Callback;
+          bool Cancelled;
+        };
+
+        ///<summary>Constructor</summary>
+        ///<param name='ResolutionInTicks'>Length of a wheel slot - timers expiring within the same slot fire together</param>
+        ///<param name='NowInTicks'>Current time on the clock that will drive the wheel</param>
+        TimerWheel(unsigned long long ResolutionInTicks, unsigned long long NowInTicks = 0);
+        ///<summary>Adds a timer</summary>
+        ///<param name='ExpiryInTicks'>Absolute time of the first expiry</param>
+        ///<param name='PeriodInTicks'>Interval between subsequent expiries - 0 for a one shot timer</param>
+        ///<returns>The timer ID to cancel with</returns>
+        timerid_t Schedule(unsigned long long ExpiryInTicks, unsigned long long PeriodInTicks, function<void()> Callback);
+        ///<summary>Removes a timer - returns false if the timer already fired (one shot) or was already cancelled</summary>
+        bool Cancel(timerid_t ID);
+        ///<summary>Moves the wheel to the supplied time and returns the timers that expired, in expiry order</summary>
+        ///<remarks>Callbacks are not invoked by the wheel, so that the caller can invoke them without holding its own locks.
+        ///Periodic timers are rescheduled before they are returned - periods that were missed entirely (e.g. the device was suspended)
+        ///are skipped rather than fired in a burst.</remarks>
+        std::vector<shared_ptr<Timer>> Advance(unsigned long long NowInTicks);
+        ///<summary>Returns false if there are no timers - else the earliest expiry in ticks (rounded up to the wheel resolution)</summary>
+        bool GetNextExpiry(unsigned long long& ExpiryInTicks);
+        ///<summary>Number of active timers</summary>
+        size_t Count() { return _timers.size(); }
+        unsigned long long GetResolution() { return _resolution; }
+
+      private:
+        static const unsigned int SlotBits = 6;
+        static const unsigned int SlotCount = 1 << SlotBits;
+        static const unsigned int LevelCount = 4;
+
+        unsigned long long _resolution;
+        ///<summary>Current time in wheel slots</summary>
+        unsigned long long _current;
+        timerid_t _nextid;
+        std::list<shared_ptr<Timer>> _slots[LevelCount][SlotCount];
+        std::map<timerid_t, shared_ptr<Timer>> _timers;
+
+        void Insert(shared_ptr<Timer> timer);
+        void Cascade(unsigned int Level);
+      };
+    }
+  }
+}
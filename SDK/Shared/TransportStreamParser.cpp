@@ -24,7 +24,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 using namespace Microsoft::HLSClient::Private;
 
-TransportStreamParser::TransportStreamParser() : HasPCR(false), PCRPID(0)
+TransportStreamParser::TransportStreamParser(bool indexallpids) : HasPCR(false), PCRPID(0), IndexAllPIDs(indexallpids)
 {
   //::InitializeCriticalSectionEx(&csSample,0,0);
 }
@@ -65,10 +65,21 @@ HRESULT TransportStreamParser::BuildSample(unsigned short PID,
 
   if (MediaTypePIDMap.find(VIDEO) != MediaTypePIDMap.end() && MediaTypePIDMap[VIDEO] == PID)
   {
-    avcparser.Parse(sd);
+    if (IsHEVC(PID))
+      hevcparsers[PID].Parse(sd);
+    else
+      avcparser.Parse(sd);
     if (sd->spInBandCC != nullptr)
       CCSamples.push_back(sd);
   }
+  else if (ElementaryStreams.find(PID) != ElementaryStreams.end() && ElementaryStreams[PID] == VIDEO)
+  {
+    //video PID we are not playing right now - we still need the key frames marked if we switch to it later
+    if (IsHEVC(PID))
+      hevcparsers[PID].Parse(sd);
+    else
+      avcparser.Parse(sd);
+  }
   UnreadQueues[PID].push_back(sd);
   sd->Index = (unsigned int)UnreadQueues[PID].size() - 1;
   return S_OK;
@@ -147,6 +158,16 @@ void TransportStreamParser::Parse(const BYTE *tsd, ULONG size,
       //sort the sample queue 
     }
   }
+  for (auto itr = ElementaryStreams.begin(); itr != ElementaryStreams.end(); itr++)
+  {
+    if (SampleBuilder[itr->first].empty() == false)
+    {
+      //build and store sample
+      BuildSample(itr->first, MediaTypePIDMap, MetadataStreams, UnreadQueues, CCSamples);
+      //clear sample builder
+      SampleBuilder[itr->first].clear();
+    }
+  }
   for (auto itr = MetadataStreams.begin(); itr != MetadataStreams.end(); itr++)
   {
     if (SampleBuilder[*itr].empty() == false)
@@ -38,6 +38,7 @@ WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "TSConstants.h"
 #include "TransportPacket.h" 
 #include "AVCParser.h"
+#include "HEVCParser.h"
 
 using namespace std;
 
@@ -58,8 +59,10 @@ namespace Microsoft {
       {
         friend class AdaptationField;
         friend class MediaSegment;
+        friend class InbandCCExtractor;
         friend class PESPacket;
         friend class TransportPacket;
+        friend class TransportStreamParserTest;
       private:
         
         std::map<unsigned short, std::vector<std::shared_ptr<TransportPacket>>> SampleBuilder;
@@ -68,8 +71,33 @@ namespace Microsoft {
         bool HasPCR;
         unsigned short PCRPID;
         std::vector<const BYTE*> OutOfOrderTSP;
+        ///<summary>Keep samples for every audio and video PID instead of just the one picked for each media type</summary>
+        bool IndexAllPIDs;
+        ///<summary>Media type of every audio and video PID we kept samples for - only filled in when IndexAllPIDs is set</summary>
+        std::map<unsigned short, ContentType> ElementaryStreams;
         static bool IsTransportStream(const BYTE *tsd);
         AVCParser avcparser;
+        ///<summary>One HEVC parser per video PID - each keeps the parameter sets of its own stream</summary>
+        std::map<unsigned short, HEVCParser> hevcparsers;
+
+        ///<summary>True if the PMT says the PID carries HEVC video</summary>
+        bool IsHEVC(unsigned short PID)
+        {
+          return PMT.find(PID) != PMT.end() && PMT[PID] == 0x24;
+        }
+
+        ///<summary>Parameter sets of every HEVC PID in the PMT - a PID is listed even if its parameter sets were not found</summary>
+        std::map<unsigned short, std::vector<BYTE>> TakeHEVCParameterSets()
+        {
+          std::map<unsigned short, std::vector<BYTE>> ret;
+          for (auto itm : PMT)
+          {
+            if (itm.second != 0x24) continue;
+            auto found = hevcparsers.find(itm.first);
+            ret[itm.first] = found != hevcparsers.end() ? std::move(found->second.ParameterSets) : std::vector<BYTE>();
+          }
+          return ret;
+        }
 
         void Parse(const BYTE *tsdata, ULONG size,
           std::map<ContentType, unsigned short>& MediaTypePIDMap,
@@ -92,9 +120,11 @@ namespace Microsoft {
           SampleBuilder.clear();
           PAT.clear();
           PMT.clear(); 
+          ElementaryStreams.clear();
+          hevcparsers.clear();
         }
       public:
-        TransportStreamParser();
+        TransportStreamParser(bool indexallpids = false);
         ~TransportStreamParser()
         {
           Clear();
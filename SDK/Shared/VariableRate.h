@@ -33,8 +33,10 @@ namespace Microsoft {
         float Rate;
         bool Thinned;
         unsigned short IDRSkipCount;
+        //a slightly faster than normal rate used to catch up with the live edge - otherwise treated like normal playback
+        bool LiveCatchup;
 
-        VariableRate(float rate, bool thinned, unsigned short idrSkipCount) : Rate(rate), Thinned(thinned), IDRSkipCount(idrSkipCount)
+        VariableRate(float rate, bool thinned, unsigned short idrSkipCount, bool liveCatchup = false) : Rate(rate), Thinned(thinned), IDRSkipCount(idrSkipCount), LiveCatchup(liveCatchup)
         {
         }
 